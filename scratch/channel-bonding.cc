@@ -36,6 +36,8 @@
 #include "ns3/wifi-net-device.h"
 #include "ns3/random-variable-stream.h"
 #include "ns3/wifi-utils.h"
+#include "ns3/sweep-runner.h"
+#include "ns3/channel-bonding-scenario-helper.h"
 
 // for tracking packets and bytes received. will be reallocated once we finalize
 // number of nodes
@@ -46,17 +48,7 @@ double expn = 3.5, Pref = -30, Pn = -94, TxP = 20;
 using namespace ns3;
 
 NS_LOG_COMPONENT_DEFINE ("WifiChannelBonding");
-// Parse context strings of the form "/NodeList/3/DeviceList/1/Mac/Assoc"
-// to extract the NodeId
-uint32_t
-ContextToNodeId (std::string context)
-{
-  std::string sub = context.substr (10); // skip "/NodeList/"
-  uint32_t pos = sub.find ("/Device");
-  uint32_t nodeId = atoi (sub.substr (0, pos).c_str ());
-  NS_LOG_DEBUG ("Found NodeId " << nodeId);
-  return nodeId;
-}
+
 void
 AddClient (ApplicationContainer &clientApps, Ipv4Address address, Ptr<Node> node, uint16_t port,
            Time interval, uint32_t payloadSize)
@@ -101,17 +93,149 @@ AddServer (ApplicationContainer &serverApps, UdpServerHelper &server, Ptr<Node>
 }
 
 void
-PacketRx (std::string context, const Ptr<const Packet> p, const Address &srcAddress,
+PacketRx (uint32_t nodeId, const Ptr<const Packet> p, const Address &srcAddress,
           const Address &destAddress)
 {
-  uint32_t nodeId = ContextToNodeId (context);
   uint32_t pktSize = p->GetSize ();
   bytesReceived[nodeId] += pktSize;
   packetsReceived[nodeId]++;
 }
 
+// Run the simulation and report the throughput received by every node
 int
-main (int argc, char *argv[])
+RunAndReport (uint32_t numNodes, double simulationTime, std::string Test)
+{
+  // the node id is bound to the sink, rather than parsed from a context
+  Config::CompiledPath rxPath ("/NodeList/*/ApplicationList/*/$ns3::UdpServer/RxWithAddresses");
+  rxPath.ConnectWithIndex (MakeCallback (&PacketRx));
+
+  Simulator::Stop (Seconds (simulationTime + 1));
+  Simulator::Run ();
+
+  Simulator::Destroy ();
+
+  if (SweepRunner::IsRunning ())
+    {
+      // report the results of every node to the sweep, which writes them to a single file
+      for (uint32_t k = 0; k < numNodes; k++)
+        {
+          std::ostringstream throughput;
+          throughput.setf (std::ios_base::fixed);
+          throughput << bytesReceived[k] * 8 / 1e6 / simulationTime;
+          SweepRunner::AddResultRow ({{"node", std::to_string (k)},
+                                      {"packets", std::to_string (packetsReceived[k])},
+                                      {"bytes", std::to_string (bytesReceived[k])},
+                                      {"throughput", throughput.str ()}});
+        }
+      return 0;
+    }
+
+  // allocate in the order of AP_A, STAs_A, AP_B, STAs_B
+  std::string filename;
+  filename = "Res_" + Test + ".csv";
+  std::ofstream TputFile;
+  TputFile.open (filename.c_str (), std::ofstream::out | std::ofstream::trunc);
+  TputFile.setf (std::ios_base::fixed);
+  TputFile.flush ();
+  if (!TputFile.is_open ())
+    {
+      NS_LOG_ERROR ("Can't open file " << filename);
+      return 1;
+    }
+
+  double rxThroughputPerNode[numNodes];
+  // output for all nodes
+  for (uint32_t k = 0; k < numNodes; k++)
+    {
+      double bitsReceived = bytesReceived[k] * 8;
+      rxThroughputPerNode[k] = static_cast<double> (bitsReceived) / 1e6 / simulationTime;
+      std::cout << "Node, " << k << ", pkts, " << packetsReceived[k] << ", bytes, " << bytesReceived[k]
+                << ", throughput [MMb/s], " << rxThroughputPerNode[k] << std::endl;
+          TputFile << rxThroughputPerNode[k] << std::endl;
+
+    }
+
+  TputFile << std::endl;
+  TputFile.close ();
+
+  return 0;
+}
+
+// Build the BSSs listed in a table (see ChannelBondingScenarioHelper) along
+// with their traffic, and return the number of nodes
+uint32_t
+InstallBssTable (std::string bssTable, uint32_t payloadSize, double ccaSdThreshold,
+                 std::string channelBondingType, uint32_t maxMissedBeacons)
+{
+  ChannelBondingScenarioHelper scenario;
+  scenario.LoadBssTable (bssTable);
+  scenario.SetMaxMissedBeacons (maxMissedBeacons);
+
+  SpectrumWifiPhyHelper phy = SpectrumWifiPhyHelper::Default ();
+  phy.Set ("TxPowerStart", DoubleValue (TxP));
+  phy.Set ("TxPowerEnd", DoubleValue (TxP));
+  phy.SetPreambleDetectionModel ("ns3::ThresholdPreambleDetectionModel","Threshold", DoubleValue (ccaSdThreshold + 94));
+
+  Ptr<MultiModelSpectrumChannel> channel = CreateObject<MultiModelSpectrumChannel> ();
+  // nodes do not move, hence the gain of every path can be computed once
+  channel->SetAttribute ("CachePaths", BooleanValue (true));
+  Ptr<LogDistancePropagationLossModel> lossModel = CreateObject<LogDistancePropagationLossModel> ();
+  lossModel->SetAttribute ("ReferenceDistance", DoubleValue (1));
+  lossModel->SetAttribute ("Exponent", DoubleValue (expn));
+  lossModel->SetAttribute ("ReferenceLoss", DoubleValue (TxP - Pref));
+  channel->AddPropagationLossModel (lossModel);
+  phy.SetChannel (channel);
+
+  WifiHelper wifi;
+  wifi.SetStandard (WIFI_PHY_STANDARD_80211ac);
+  wifi.SetChannelBondingManager ("ns3::" + channelBondingType + "ChannelBondingManager");
+  NodeContainer allNodes = scenario.Install (phy, wifi, 100);
+
+  InternetStackHelper stack;
+  stack.Install (allNodes);
+  Ipv4AddressHelper address;
+  address.SetBase ("192.168.1.0", "255.255.255.0");
+
+  ApplicationContainer serverApps;
+  ApplicationContainer clientApps;
+  for (std::size_t i = 0; i < scenario.GetNBss (); i++)
+    {
+      const ChannelBondingScenarioHelper::BssParameters &bss = scenario.GetBss (i);
+      NodeContainer staNodes = scenario.GetStaNodes (i);
+      Ipv4InterfaceContainer staInterfaces = address.Assign (scenario.GetStaDevices (i));
+      Ipv4InterfaceContainer apInterface = address.Assign (scenario.GetApDevices ().Get (i));
+      address.NewNetwork ();
+
+      uint16_t uplinkPort = 9 + 2 * i;
+      uint16_t downlinkPort = 10 + 2 * i;
+      UdpServerHelper uplinkServer (uplinkPort);
+      UdpServerHelper downlinkServer (downlinkPort);
+      Time uplinkInterval = MicroSeconds (payloadSize * 8 / (bss.uplinkMbps / bss.nStations));
+      Time downlinkInterval = MicroSeconds (payloadSize * 8 / (bss.downlinkMbps / bss.nStations));
+      for (uint32_t j = 0; j < staNodes.GetN (); j++)
+        {
+          if (bss.uplinkMbps > 0)
+            {
+              AddClient (clientApps, apInterface.GetAddress (0), staNodes.Get (j),
+                         uplinkPort, uplinkInterval, payloadSize);
+            }
+          if (bss.downlinkMbps > 0)
+            {
+              AddClient (clientApps, staInterfaces.GetAddress (j), scenario.GetApNodes ().Get (i),
+                         downlinkPort, downlinkInterval, payloadSize);
+              AddServer (serverApps, downlinkServer, staNodes.Get (j));
+            }
+        }
+      if (bss.uplinkMbps > 0)
+        {
+          AddServer (serverApps, uplinkServer, scenario.GetApNodes ().Get (i));
+        }
+    }
+  return allNodes.GetN ();
+}
+
+int
+RunChannelBonding (int argc, char *argv[])
 {
 
 
@@ -188,6 +312,7 @@ uint16_t primaryChannelBss=36;
 
   std::string channelBondingType = "ConstantThreshold";
   std::string Test = "";
+  std::string bssTable = "";
 
   uint16_t n = 1;
   uint16_t nBss = 1;
@@ -219,6 +344,8 @@ uint16_t primaryChannelBss=36;
   cmd.AddValue ("channelBssF", "The selected channel for BSS F", channelBssF);
   cmd.AddValue ("channelBssG", "The selected channel for BSS G", channelBssG);
   cmd.AddValue ("Test", "Test name", Test);
+  cmd.AddValue ("bssTable", "File listing the BSSs to simulate, which replaces the per-BSS "
+                "values, nBss, n, distance and interBssDistance", bssTable);
   cmd.AddValue ("primaryChannelBssA", "The primary 20 MHz channel for BSS A", primaryChannelBssA);
   cmd.AddValue ("primaryChannelBssB", "The primary 20 MHz channel for BSS B", primaryChannelBssB);
   cmd.AddValue ("primaryChannelBssC", "The primary 20 MHz channel for BSS C", primaryChannelBssC);
@@ -318,6 +445,15 @@ uint16_t primaryChannelBss=36;
   Config::SetDefault ("ns3::SpectrumWifiPhy::TxMaskOuterBandMaximumRejection",
                       DoubleValue (txMaskOuterBandMaximumRejection));
 
+  if (!bssTable.empty ())
+    {
+      uint32_t numNodes = InstallBssTable (bssTable, payloadSize, ccaSdThreshold,
+                                           channelBondingType, maxMissedBeacons);
+      packetsReceived = std::vector<uint64_t> (numNodes);
+      bytesReceived = std::vector<uint64_t> (numNodes);
+      return RunAndReport (numNodes, simulationTime, Test);
+    }
+
   uint32_t numNodes = nBss * (n + 1);
   packetsReceived = std::vector<uint64_t> (numNodes);
   bytesReceived = std::vector<uint64_t> (numNodes);
@@ -907,6 +1043,8 @@ InterferenceVal7=maxSecInterference7;
   phy.SetPreambleDetectionModel ("ns3::ThresholdPreambleDetectionModel","Threshold", DoubleValue (ccaSdThreshold + 94));
 
   Ptr<MultiModelSpectrumChannel> channel = CreateObject<MultiModelSpectrumChannel> ();
+  // nodes do not move, hence the gain of every path can be computed once
+  channel->SetAttribute ("CachePaths", BooleanValue (true));
   Ptr<LogDistancePropagationLossModel> lossModel = CreateObject<LogDistancePropagationLossModel> ();
   lossModel->SetAttribute ("ReferenceDistance", DoubleValue (1));
   lossModel->SetAttribute ("Exponent", DoubleValue (expn));
@@ -1953,55 +2091,18 @@ else
   uint32_t maxAmpduSizeBss5 = 131071;
   uint32_t maxAmpduSizeBss6 = 131071;
   uint32_t maxAmpduSizeBss7 = 131071;
-  for (uint16_t i = 0; i < ((n + 1) * nBss); i++)
+  uint32_t maxAmpduSizeBss[] = {maxAmpduSizeBss1, maxAmpduSizeBss2, maxAmpduSizeBss3, maxAmpduSizeBss4,
+                                 maxAmpduSizeBss5, maxAmpduSizeBss6, maxAmpduSizeBss7};
+  for (uint16_t bss = 0; bss < std::min<uint16_t> (nBss, 7); bss++)
     {
-      if (i < (n + 1)) // BSS 1
-        {
-          std::stringstream stmp;
-          stmp << "/NodeList/" << i << "/DeviceList/*/$ns3::WifiNetDevice/Mac/BE_MaxAmpduSize";
-          Config::Set (stmp.str (), UintegerValue (std::min (maxAmpduSizeBss1, 4194303u)));
-        }
-      else if (i < (2 * (n + 1))) // BSS 2
-        {
-          std::stringstream stmp;
-          stmp << "/NodeList/" << i << "/DeviceList/*/$ns3::WifiNetDevice/Mac/BE_MaxAmpduSize";
-          Config::Set (stmp.str (), UintegerValue (std::min (maxAmpduSizeBss2, 4194303u)));
-        }
-      else if (i < (3 * (n + 1))) // BSS 3
-        {
-          std::stringstream stmp;
-          stmp << "/NodeList/" << i << "/DeviceList/*/$ns3::WifiNetDevice/Mac/BE_MaxAmpduSize";
-          Config::Set (stmp.str (), UintegerValue (std::min (maxAmpduSizeBss3, 4194303u)));
-        }
-      else if (i < (4 * (n + 1))) // BSS 4
-        {
-          std::stringstream stmp;
-          stmp << "/NodeList/" << i << "/DeviceList/*/$ns3::WifiNetDevice/Mac/BE_MaxAmpduSize";
-          Config::Set (stmp.str (), UintegerValue (std::min (maxAmpduSizeBss4, 4194303u)));
-        }
-      else if (i < (5 * (n + 1))) // BSS 5
-        {
-          std::stringstream stmp;
-          stmp << "/NodeList/" << i << "/DeviceList/*/$ns3::WifiNetDevice/Mac/BE_MaxAmpduSize";
-          Config::Set (stmp.str (), UintegerValue (std::min (maxAmpduSizeBss5, 4194303u)));
-        }
-      else if (i < (6 * (n + 1))) // BSS 6
-        {
-          std::stringstream stmp;
-          stmp << "/NodeList/" << i << "/DeviceList/*/$ns3::WifiNetDevice/Mac/BE_MaxAmpduSize";
-          Config::Set (stmp.str (), UintegerValue (std::min (maxAmpduSizeBss6, 4194303u)));
-        }
-      else if (i < (7 * (n + 1))) // BSS 7
-        {
-          std::stringstream stmp;
-          stmp << "/NodeList/" << i << "/DeviceList/*/$ns3::WifiNetDevice/Mac/BE_MaxAmpduSize";
-          Config::Set (stmp.str (), UintegerValue (std::min (maxAmpduSizeBss7, 4194303u)));
-        }
+      // the nodes of a BSS are matched at once, the path being resolved only once per BSS
+      std::stringstream stmp;
+      stmp << "/NodeList/[" << bss * (n + 1) << "-" << (bss + 1) * (n + 1) - 1
+           << "]/DeviceList/*/$ns3::WifiNetDevice/Mac/BE_MaxAmpduSize";
+      Config::CompiledPath maxAmpduSizePath (stmp.str ());
+      maxAmpduSizePath.Set (UintegerValue (std::min (maxAmpduSizeBss[bss], 4194303u)));
     }
 
-  Config::Connect ("/NodeList/*/ApplicationList/*/$ns3::UdpServer/RxWithAddresses",
-                   MakeCallback (&PacketRx));
-
   // phy.EnablePcap ("staA_pcap", staDeviceA);
  // phy.EnablePcap ("apA_pcap", apDeviceA);
   /*
@@ -2011,37 +2112,13 @@ phy.EnablePcap ("staC_pcap", staDeviceC);
 phy.EnablePcap ("apC_pcap", apDeviceC);
 */
 
-  Simulator::Stop (Seconds (simulationTime + 1));
-  Simulator::Run ();
-
-  Simulator::Destroy ();
-  // allocate in the order of AP_A, STAs_A, AP_B, STAs_B
-  std::string filename;
-  filename = "Res_" + Test + ".csv";
-  std::ofstream TputFile;
-  TputFile.open (filename.c_str (), std::ofstream::out | std::ofstream::trunc);
-  TputFile.setf (std::ios_base::fixed);
-  TputFile.flush ();
-  if (!TputFile.is_open ())
-    {
-      NS_LOG_ERROR ("Can't open file " << filename);
-      return 1;
-    }
-
-  double rxThroughputPerNode[numNodes];
-  // output for all nodes
-  for (uint32_t k = 0; k < numNodes; k++)
-    {
-      double bitsReceived = bytesReceived[k] * 8;
-      rxThroughputPerNode[k] = static_cast<double> (bitsReceived) / 1e6 / simulationTime;
-      std::cout << "Node, " << k << ", pkts, " << packetsReceived[k] << ", bytes, " << bytesReceived[k]
-                << ", throughput [MMb/s], " << rxThroughputPerNode[k] << std::endl;
-          TputFile << rxThroughputPerNode[k] << std::endl;
-
-    }
-
-  TputFile << std::endl;
-  TputFile.close ();
+  return RunAndReport (numNodes, simulationTime, Test);
+}
 
-  return 0;
+// Run the points of a sweep in this process with --sweep=<file> (see
+// SweepRunner), e.g. ./waf --run "channel-bonding --sweep=scratch/MySim.sweep"
+int
+main (int argc, char *argv[])
+{
+  return SweepRunner::Main (&RunChannelBonding, argc, argv);
 }
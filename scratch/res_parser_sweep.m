@@ -0,0 +1,15 @@
+clear
+clc
+close all
+set(gca,'fontname','times')
+% results of Sim1.sweep, all the points being in a single file
+res=readtable('../Sim1.csv');
+% throughput of the nodes 2 to 11 of every point
+sta=res(res.node>=2 & res.node<=11,:);
+Tput=groupsummary(sta,{'point','mcs1','RngRun'},'sum','throughput');
+% average over the runs
+avg=groupsummary(Tput,'mcs1','mean','sum_throughput');
+bar(categorical(avg.mcs1),avg.mean_sum_throughput)
+xlabel('MCS of BSS A','FontName','Times','FontSize',12);
+ylabel('Throughput [Mb/s]','FontName','Times','FontSize',12);
+grid;
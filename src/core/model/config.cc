@@ -25,6 +25,7 @@
 #include "names.h"
 #include "pointer.h"
 #include "log.h"
+#include "type-id.h"
 
 #include <sstream>
 
@@ -316,6 +317,15 @@ private:
    * \returns The current Config path.
    */
   std::string GetResolvedPath (void) const;
+protected:
+  /**
+   * Get the indices of the objects found in the object containers on the
+   * current Config path.
+   *
+   * \returns The indices, from the root of the Config path.
+   */
+  const std::vector<uint32_t> & GetResolvedIndices (void) const;
+private:
   /**
    * Handle one found object.
    *
@@ -326,6 +336,8 @@ private:
 
   /** Current list of path tokens. */
   std::vector<std::string> m_workStack;
+  /** Current list of indices in object containers. */
+  std::vector<uint32_t> m_indexStack;
   /** The Config path. */
   std::string m_path;
 
@@ -382,6 +394,13 @@ Resolver::GetResolvedPath (void) const
   return fullPath;
 }
 
+const std::vector<uint32_t> &
+Resolver::GetResolvedIndices (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_indexStack;
+}
+
 void 
 Resolver::DoResolveOne (Ptr<Object> object)
 {
@@ -570,7 +589,9 @@ Resolver::DoArrayResolve (std::string path, const ObjectPtrContainerValue &conta
           std::ostringstream oss;
           oss << (*it).first;
           m_workStack.push_back (oss.str ());
+          m_indexStack.push_back ((*it).first);
           DoResolve (pathLeft, (*it).second);
+          m_indexStack.pop_back ();
           m_workStack.pop_back ();
         }
     }
@@ -782,6 +803,213 @@ ConfigImpl::GetRootNamespaceObject (std::size_t i) const
 }
 
 
+CompiledPath::CompiledPath ()
+{
+  NS_LOG_FUNCTION (this);
+}
+CompiledPath::CompiledPath (std::string path)
+  : m_path (path)
+{
+  NS_LOG_FUNCTION (this << path);
+  std::string::size_type slash = path.find_last_of ("/");
+  NS_ASSERT (slash != std::string::npos);
+  m_root = path.substr (0, slash);
+  m_leaf = path.substr (slash + 1, path.size () - (slash + 1));
+  Resolve ();
+}
+void
+CompiledPath::Resolve (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_targets.clear ();
+  if (m_path.empty ())
+    {
+      return;
+    }
+  class CompiledPathResolver : public Resolver
+  {
+  public:
+    CompiledPathResolver (std::string path, std::string leaf, std::vector<Target> *targets)
+      : Resolver (path),
+        m_leaf (leaf),
+        m_targets (targets)
+    {}
+    virtual void DoOne (Ptr<Object> object, std::string path)
+    {
+      Target target;
+      target.object = object;
+      target.context = path + m_leaf;
+      target.indices = GetResolvedIndices ();
+      target.settable = false;
+      TypeId tid = object->GetInstanceTypeId ();
+      struct TypeId::AttributeInformation info;
+      if (tid.LookupAttributeByName (m_leaf, &info))
+        {
+          target.attributeAccessor = info.accessor;
+          target.attributeChecker = info.checker;
+          target.settable = (info.flags & TypeId::ATTR_SET) && info.accessor->HasSetter ();
+        }
+      target.traceAccessor = tid.LookupTraceSourceByName (m_leaf);
+      m_targets->push_back (target);
+    }
+    std::string m_leaf;
+    std::vector<Target> *m_targets;
+  } resolver = CompiledPathResolver (m_root, m_leaf, &m_targets);
+  ConfigImpl *impl = ConfigImpl::Get ();
+  for (std::size_t i = 0; i < impl->GetRootNamespaceObjectN (); ++i)
+    {
+      resolver.Resolve (impl->GetRootNamespaceObject (i));
+    }
+  // as in ConfigImpl::LookupMatches, look into the object name service last
+  resolver.Resolve (0);
+  if (m_targets.empty ())
+    {
+      NS_LOG_WARN ("No object matches " << m_root);
+    }
+}
+std::size_t
+CompiledPath::GetN (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_targets.size ();
+}
+Ptr<Object>
+CompiledPath::Get (std::size_t i) const
+{
+  NS_LOG_FUNCTION (this << i);
+  return m_targets[i].object;
+}
+std::vector<uint32_t>
+CompiledPath::GetMatchedIndices (std::size_t i) const
+{
+  NS_LOG_FUNCTION (this << i);
+  return m_targets[i].indices;
+}
+std::string
+CompiledPath::GetMatchedPath (std::size_t i) const
+{
+  NS_LOG_FUNCTION (this << i);
+  return m_targets[i].context;
+}
+std::string
+CompiledPath::GetPath (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_path;
+}
+
+void
+CompiledPath::DoSet (std::size_t i, const AttributeValue &value)
+{
+  NS_LOG_FUNCTION (this << i << &value);
+  const Target &target = m_targets[i];
+  if (!target.attributeAccessor->Set (PeekPointer (target.object), value))
+    {
+      NS_FATAL_ERROR ("Attribute " << target.context << " could not be set");
+    }
+}
+void
+CompiledPath::Set (const AttributeValue &value)
+{
+  NS_LOG_FUNCTION (this << &value);
+  // the matching objects usually share the same checker, hence the value
+  // checked for the previous object is reused
+  Ptr<const AttributeChecker> checker;
+  Ptr<AttributeValue> checked;
+  for (std::size_t i = 0; i < m_targets.size (); ++i)
+    {
+      const Target &target = m_targets[i];
+      if (!target.settable)
+        {
+          NS_FATAL_ERROR ("Attribute " << target.context << " does not exist or is not settable");
+        }
+      if (target.attributeChecker != checker)
+        {
+          checker = target.attributeChecker;
+          checked = checker->CreateValidValue (value);
+        }
+      if (checked == 0)
+        {
+          NS_FATAL_ERROR ("Attribute " << target.context << " could not be set");
+        }
+      DoSet (i, *checked);
+    }
+}
+void
+CompiledPath::Set (std::size_t i, const AttributeValue &value)
+{
+  NS_LOG_FUNCTION (this << i << &value);
+  const Target &target = m_targets[i];
+  if (!target.settable)
+    {
+      NS_FATAL_ERROR ("Attribute " << target.context << " does not exist or is not settable");
+    }
+  Ptr<AttributeValue> checked = target.attributeChecker->CreateValidValue (value);
+  if (checked == 0)
+    {
+      NS_FATAL_ERROR ("Attribute " << target.context << " could not be set");
+    }
+  DoSet (i, *checked);
+}
+void
+CompiledPath::Connect (const CallbackBase &cb)
+{
+  NS_LOG_FUNCTION (this << &cb);
+  for (std::vector<Target>::const_iterator i = m_targets.begin (); i != m_targets.end (); ++i)
+    {
+      if (i->traceAccessor != 0)
+        {
+          i->traceAccessor->Connect (PeekPointer (i->object), i->context, cb);
+        }
+    }
+}
+void
+CompiledPath::ConnectWithoutContext (const CallbackBase &cb)
+{
+  NS_LOG_FUNCTION (this << &cb);
+  for (std::vector<Target>::const_iterator i = m_targets.begin (); i != m_targets.end (); ++i)
+    {
+      if (i->traceAccessor != 0)
+        {
+          i->traceAccessor->ConnectWithoutContext (PeekPointer (i->object), cb);
+        }
+    }
+}
+void
+CompiledPath::DoConnectWithoutContext (std::size_t i, const CallbackBase &cb)
+{
+  NS_LOG_FUNCTION (this << i << &cb);
+  const Target &target = m_targets[i];
+  if (target.traceAccessor != 0)
+    {
+      target.traceAccessor->ConnectWithoutContext (PeekPointer (target.object), cb);
+    }
+}
+void
+CompiledPath::Disconnect (const CallbackBase &cb)
+{
+  NS_LOG_FUNCTION (this << &cb);
+  for (std::vector<Target>::const_iterator i = m_targets.begin (); i != m_targets.end (); ++i)
+    {
+      if (i->traceAccessor != 0)
+        {
+          i->traceAccessor->Disconnect (PeekPointer (i->object), i->context, cb);
+        }
+    }
+}
+void
+CompiledPath::DisconnectWithoutContext (const CallbackBase &cb)
+{
+  NS_LOG_FUNCTION (this << &cb);
+  for (std::vector<Target>::const_iterator i = m_targets.begin (); i != m_targets.end (); ++i)
+    {
+      if (i->traceAccessor != 0)
+        {
+          i->traceAccessor->DisconnectWithoutContext (PeekPointer (i->object), cb);
+        }
+    }
+}
+
 void Reset (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
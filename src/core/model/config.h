@@ -21,6 +21,9 @@
 #define CONFIG_H
 
 #include "ptr.h"
+#include "attribute.h"
+#include "trace-source-accessor.h"
+#include "assert.h"
 #include <string>
 #include <vector>
 
@@ -250,6 +253,179 @@ private:
   std::string m_path;
 };
 
+/**
+ * \ingroup config
+ * \brief A Config path resolved once, to set an attribute or connect a
+ * trace source of all the matching objects any number of times.
+ *
+ * Config::Set and Config::Connect parse their path and walk the object
+ * graph on every call, and look up the attribute or the trace source by
+ * name on every matching object. A CompiledPath does this work once, when
+ * it is constructed, and keeps the matching objects along with the accessor
+ * of their attribute or trace source, hence setting or connecting is then
+ * linear in the number of matching objects:
+ *
+ * \code
+ *   Config::CompiledPath path ("/NodeList/[0-9]/DeviceList/0/$ns3::WifiNetDevice/Mac/BE_MaxAmpduSize");
+ *   path.Set (UintegerValue (65535));
+ * \endcode
+ *
+ * The objects created after the path has been compiled are not matched
+ * until Resolve is called again.
+ */
+class CompiledPath
+{
+public:
+  CompiledPath ();
+  /**
+   * Compile a path and resolve it.
+   *
+   * \param [in] path The path, whose last element is the name of an
+   *                  attribute or of a trace source.
+   */
+  CompiledPath (std::string path);
+
+  /**
+   * Match again the objects, to take into account the changes made to the
+   * object graph since the path has been resolved.
+   */
+  void Resolve (void);
+
+  /**
+   * \returns The number of objects matching the path
+   */
+  std::size_t GetN (void) const;
+  /**
+   * \param [in] i Index of the matching object ([0,n[)
+   * \returns The matching object
+   */
+  Ptr<Object> Get (std::size_t i) const;
+  /**
+   * \param [in] i Index of the matching object ([0,n[)
+   * \returns The indices of the objects found in the object containers along
+   *          the path of the matching object, from the root of the path:
+   *          for instance, the node id and the index of the device for a
+   *          /NodeList/x/DeviceList/y path
+   */
+  std::vector<uint32_t> GetMatchedIndices (std::size_t i) const;
+  /**
+   * \param [in] i Index of the matching object ([0,n[)
+   * \returns The fully-qualified path of the attribute or trace source of
+   *          the matching object
+   */
+  std::string GetMatchedPath (std::size_t i) const;
+  /**
+   * \returns The compiled path
+   */
+  std::string GetPath (void) const;
+
+  /**
+   * \param [in] value Value to set to the attribute
+   *
+   * Set the attribute of all the matching objects. The value is checked
+   * once per attribute checker, rather than once per object.
+   * \sa ns3::Config::Set
+   */
+  void Set (const AttributeValue &value);
+  /**
+   * \param [in] i Index of the matching object ([0,n[)
+   * \param [in] value Value to set to the attribute
+   *
+   * Set the attribute of a single matching object.
+   */
+  void Set (std::size_t i, const AttributeValue &value);
+  /**
+   * \param [in] cb The sink to connect to the trace source
+   *
+   * Connect the sink to the trace source of all the matching objects.
+   * \sa ns3::Config::Connect
+   */
+  void Connect (const CallbackBase &cb);
+  /**
+   * \param [in] cb The sink to connect to the trace source
+   *
+   * Connect the sink to the trace source of all the matching objects.
+   * \sa ns3::Config::ConnectWithoutContext
+   */
+  void ConnectWithoutContext (const CallbackBase &cb);
+  /**
+   * \param [in] cb The sink to connect to the trace source, whose first
+   *                argument is the first index matched along the path
+   *
+   * Connect the sink to the trace source of all the matching objects,
+   * binding to it the first index returned by GetMatchedIndices, e.g. the
+   * node id for a /NodeList/x path. Unlike the context of Connect, this
+   * index is passed to the sink as an integer, hence no string is built
+   * when the trace source fires.
+   */
+  template <typename R, typename T1, typename T2, typename T3, typename T4,
+            typename T5, typename T6, typename T7, typename T8, typename T9>
+  void ConnectWithIndex (Callback<R,T1,T2,T3,T4,T5,T6,T7,T8,T9> cb);
+  /**
+   * \param [in] cb The sink to connect to the trace source, whose first two
+   *                arguments are the first two indices matched along the path
+   *
+   * Connect the sink to the trace source of all the matching objects,
+   * binding to it the first two indices returned by GetMatchedIndices, e.g.
+   * the node id and the index of the device for a /NodeList/x/DeviceList/y
+   * path.
+   */
+  template <typename R, typename T1, typename T2, typename T3, typename T4,
+            typename T5, typename T6, typename T7, typename T8, typename T9>
+  void ConnectWithIndices (Callback<R,T1,T2,T3,T4,T5,T6,T7,T8,T9> cb);
+  /**
+   * \param [in] cb The sink to disconnect from the trace source
+   *
+   * Disconnect the sink from the trace source of all the matching objects.
+   * \sa ns3::Config::Disconnect
+   */
+  void Disconnect (const CallbackBase &cb);
+  /**
+   * \param [in] cb The sink to disconnect from the trace source
+   *
+   * Disconnect the sink from the trace source of all the matching objects.
+   * \sa ns3::Config::DisconnectWithoutContext
+   */
+  void DisconnectWithoutContext (const CallbackBase &cb);
+
+private:
+  /**
+   * Set the attribute of a matching object to a value already checked.
+   *
+   * \param [in] i Index of the matching object
+   * \param [in] value The checked value
+   */
+  void DoSet (std::size_t i, const AttributeValue &value);
+  /**
+   * Connect a sink to the trace source of a matching object.
+   *
+   * \param [in] i Index of the matching object
+   * \param [in] cb The sink
+   */
+  void DoConnectWithoutContext (std::size_t i, const CallbackBase &cb);
+
+  /** An object matching the path. */
+  struct Target
+  {
+    Ptr<Object> object;                               //!< The object
+    std::string context;                              //!< The fully-qualified path
+    std::vector<uint32_t> indices;                    //!< The indices in the object containers
+    Ptr<const AttributeAccessor> attributeAccessor;   //!< The accessor of the attribute, if any
+    Ptr<const AttributeChecker> attributeChecker;     //!< The checker of the attribute, if any
+    bool settable;                                    //!< Whether the attribute can be set
+    Ptr<const TraceSourceAccessor> traceAccessor;     //!< The accessor of the trace source, if any
+  };
+
+  /** The compiled path. */
+  std::string m_path;
+  /** The path of the objects, up to the last slash. */
+  std::string m_root;
+  /** The name of the attribute or of the trace source. */
+  std::string m_leaf;
+  /** The objects matching the path. */
+  std::vector<Target> m_targets;
+};
+
 /**
  * \ingroup config
  * \param [in] path The path to perform a match against
@@ -287,6 +463,35 @@ std::size_t GetRootNamespaceObjectN (void);
  */
 Ptr<Object> GetRootNamespaceObject (uint32_t i);
 
+
+/***************************************************************
+ *  Implementation of the templates declared above.
+ ***************************************************************/
+
+template <typename R, typename T1, typename T2, typename T3, typename T4,
+          typename T5, typename T6, typename T7, typename T8, typename T9>
+void
+CompiledPath::ConnectWithIndex (Callback<R,T1,T2,T3,T4,T5,T6,T7,T8,T9> cb)
+{
+  for (std::size_t i = 0; i < m_targets.size (); ++i)
+    {
+      NS_ASSERT_MSG (m_targets[i].indices.size () >= 1, "No index matched on " << m_targets[i].context);
+      DoConnectWithoutContext (i, cb.Bind (m_targets[i].indices[0]));
+    }
+}
+
+template <typename R, typename T1, typename T2, typename T3, typename T4,
+          typename T5, typename T6, typename T7, typename T8, typename T9>
+void
+CompiledPath::ConnectWithIndices (Callback<R,T1,T2,T3,T4,T5,T6,T7,T8,T9> cb)
+{
+  for (std::size_t i = 0; i < m_targets.size (); ++i)
+    {
+      NS_ASSERT_MSG (m_targets[i].indices.size () >= 2, "Less than two indices matched on " << m_targets[i].context);
+      DoConnectWithoutContext (i, cb.TwoBind (m_targets[i].indices[0], m_targets[i].indices[1]));
+    }
+}
+
 } // namespace Config
 
 } // namespace ns3
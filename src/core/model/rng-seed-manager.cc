@@ -105,4 +105,10 @@ uint64_t RngSeedManager::GetNextStreamIndex (void)
   return next;
 }
 
+void RngSeedManager::ResetNextStreamIndex (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  g_nextStreamIndex = 0;
+}
+
 } // namespace ns3
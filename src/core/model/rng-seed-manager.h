@@ -105,6 +105,13 @@ public:
    */
   static uint64_t GetNextStreamIndex(void);
 
+  /**
+   * Reset the next automatically assigned stream index, so that the
+   * random variables created afterwards use the same streams as in a
+   * new process.
+   */
+  static void ResetNextStreamIndex (void);
+
 };
 
 /** Alias for compatibility. */
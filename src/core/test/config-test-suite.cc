@@ -830,6 +830,228 @@ SearchAttributesOfParentObjectsTestCase::DoRun (void)
 
 }
 
+/**
+ * \ingroup config-tests
+ * Test for setting and connecting through a compiled path.
+ */
+class CompiledPathConfigTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  CompiledPathConfigTestCase ();
+  /** Destructor. */
+  virtual ~CompiledPathConfigTestCase () {}
+
+  /**
+   * Trace callback with context path.
+   * \param path The context path.
+   * \param old The old value.
+   * \param newValue The new value.
+   */
+  void TraceWithPath (std::string path, int16_t old, int16_t newValue)
+  {
+    NS_UNUSED (old);
+    m_newValue = newValue;
+    m_path = path;
+  }
+
+private:
+  virtual void DoRun (void);
+
+  int16_t m_newValue; //!< Flag to detect tracing result.
+  std::string m_path; //!< The context path.
+};
+
+CompiledPathConfigTestCase::CompiledPathConfigTestCase ()
+  : TestCase ("Check setting and tracing through a compiled path")
+{
+}
+
+void
+CompiledPathConfigTestCase::DoRun (void)
+{
+  IntegerValue iv;
+
+  Ptr<ConfigTestObject> root = CreateObject<ConfigTestObject> ();
+  Config::RegisterRootNamespaceObject (root);
+  Ptr<ConfigTestObject> a = CreateObject<ConfigTestObject> ();
+  root->SetNodeB (a);
+  Ptr<ConfigTestObject> obj0 = CreateObject<ConfigTestObject> ();
+  Ptr<ConfigTestObject> obj1 = CreateObject<ConfigTestObject> ();
+  Ptr<ConfigTestObject> obj2 = CreateObject<ConfigTestObject> ();
+  a->AddNodeA (obj0);
+  a->AddNodeA (obj1);
+  a->AddNodeA (obj2);
+
+  //
+  // Set an attribute of all the matching objects at once.
+  //
+  Config::CompiledPath path ("/NodeB/NodesA/0|2/A");
+  NS_TEST_ASSERT_MSG_EQ (path.GetN (), 2, "Unexpected number of matching objects");
+  NS_TEST_ASSERT_MSG_EQ (path.GetMatchedPath (1), "/NodeB/NodesA/2/A", "Unexpected matched path");
+  path.Set (IntegerValue (-3));
+  obj0->GetAttribute ("A", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), -3, "Object Attribute \"A\" not set as expected");
+  obj1->GetAttribute ("A", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), 10, "Object Attribute \"A\" unexpectedly set");
+  obj2->GetAttribute ("A", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), -3, "Object Attribute \"A\" not set as expected");
+
+  //
+  // Set the attribute of a single object.
+  //
+  path.Set (1, IntegerValue (-4));
+  obj0->GetAttribute ("A", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), -3, "Object Attribute \"A\" unexpectedly set");
+  obj2->GetAttribute ("A", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), -4, "Object Attribute \"A\" not set as expected");
+
+  //
+  // The objects added after compilation are only matched once the path is
+  // resolved again.
+  //
+  Config::CompiledPath all ("/NodeB/NodesA/*/A");
+  Ptr<ConfigTestObject> obj3 = CreateObject<ConfigTestObject> ();
+  a->AddNodeA (obj3);
+  all.Set (IntegerValue (5));
+  obj3->GetAttribute ("A", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), 10, "Object Attribute \"A\" unexpectedly set");
+  all.Resolve ();
+  NS_TEST_ASSERT_MSG_EQ (all.GetN (), 4, "Unexpected number of matching objects");
+  all.Set (IntegerValue (5));
+  obj3->GetAttribute ("A", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), 5, "Object Attribute \"A\" not set as expected");
+
+  //
+  // Connect and disconnect a trace source of all the matching objects.
+  //
+  Config::CompiledPath source ("/NodeB/NodesA/[1-3]/Source");
+  source.Connect (MakeCallback (&CompiledPathConfigTestCase::TraceWithPath, this));
+  m_newValue = 0;
+  m_path = "";
+  obj0->SetAttribute ("Source", IntegerValue (-1));
+  NS_TEST_ASSERT_MSG_EQ (m_newValue, 0, "Trace 0 fired unexpectedly");
+  obj3->SetAttribute ("Source", IntegerValue (-2));
+  NS_TEST_ASSERT_MSG_EQ (m_newValue, -2, "Trace 3 did not fire as expected");
+  NS_TEST_ASSERT_MSG_EQ (m_path, "/NodeB/NodesA/3/Source", "Trace 3 did not provide expected context");
+
+  source.Disconnect (MakeCallback (&CompiledPathConfigTestCase::TraceWithPath, this));
+  m_newValue = 0;
+  obj3->SetAttribute ("Source", IntegerValue (-3));
+  NS_TEST_ASSERT_MSG_EQ (m_newValue, 0, "Trace 3 fired after being disconnected");
+
+  Config::UnregisterRootNamespaceObject (root);
+}
+
+/**
+ * \ingroup config-tests
+ * Test for tracing through a compiled path with the matched indices bound
+ * to the sink.
+ */
+class CompiledPathIndexConfigTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  CompiledPathIndexConfigTestCase ();
+  /** Destructor. */
+  virtual ~CompiledPathIndexConfigTestCase () {}
+
+  /**
+   * Trace callback with the first matched index.
+   * \param index The first index.
+   * \param old The old value.
+   * \param newValue The new value.
+   */
+  void TraceWithIndex (uint32_t index, int16_t old, int16_t newValue)
+  {
+    NS_UNUSED (old);
+    m_newValue = newValue;
+    m_index = index;
+  }
+  /**
+   * Trace callback with the first two matched indices.
+   * \param index The first index.
+   * \param subIndex The second index.
+   * \param old The old value.
+   * \param newValue The new value.
+   */
+  void TraceWithIndices (uint32_t index, uint32_t subIndex, int16_t old, int16_t newValue)
+  {
+    NS_UNUSED (old);
+    m_newValue = newValue;
+    m_index = index;
+    m_subIndex = subIndex;
+  }
+
+private:
+  virtual void DoRun (void);
+
+  int16_t m_newValue;  //!< Flag to detect tracing result.
+  uint32_t m_index;    //!< The first index.
+  uint32_t m_subIndex; //!< The second index.
+};
+
+CompiledPathIndexConfigTestCase::CompiledPathIndexConfigTestCase ()
+  : TestCase ("Check tracing through a compiled path with the matched indices")
+{
+}
+
+void
+CompiledPathIndexConfigTestCase::DoRun (void)
+{
+  //
+  // Build /NodeB/NodesA/i/NodesB/j, with two objects at each level.
+  //
+  Ptr<ConfigTestObject> root = CreateObject<ConfigTestObject> ();
+  Config::RegisterRootNamespaceObject (root);
+  Ptr<ConfigTestObject> a = CreateObject<ConfigTestObject> ();
+  root->SetNodeB (a);
+  std::vector<Ptr<ConfigTestObject> > leaves;
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Ptr<ConfigTestObject> obj = CreateObject<ConfigTestObject> ();
+      a->AddNodeA (obj);
+      for (uint32_t j = 0; j < 2; j++)
+        {
+          Ptr<ConfigTestObject> leaf = CreateObject<ConfigTestObject> ();
+          obj->AddNodeB (leaf);
+          leaves.push_back (leaf);
+        }
+    }
+
+  Config::CompiledPath path ("/NodeB/NodesA/*/NodesB/*/Source");
+  NS_TEST_ASSERT_MSG_EQ (path.GetN (), 4, "Unexpected number of matching objects");
+  std::vector<uint32_t> indices = path.GetMatchedIndices (3);
+  NS_TEST_ASSERT_MSG_EQ (indices.size (), 2, "Unexpected number of matched indices");
+  NS_TEST_ASSERT_MSG_EQ (indices[0], 1, "Unexpected first index");
+  NS_TEST_ASSERT_MSG_EQ (indices[1], 1, "Unexpected second index");
+
+  //
+  // The first index is bound to the sink.
+  //
+  path.ConnectWithIndex (MakeCallback (&CompiledPathIndexConfigTestCase::TraceWithIndex, this));
+  m_newValue = 0;
+  m_index = 0;
+  leaves[2]->SetAttribute ("Source", IntegerValue (-7));
+  NS_TEST_ASSERT_MSG_EQ (m_newValue, -7, "Trace did not fire as expected");
+  NS_TEST_ASSERT_MSG_EQ (m_index, 1, "Trace did not provide expected index");
+
+  //
+  // The first two indices are bound to the sink.
+  //
+  Config::CompiledPath subPath ("/NodeB/NodesA/0/NodesB/1/Source");
+  subPath.ConnectWithIndices (MakeCallback (&CompiledPathIndexConfigTestCase::TraceWithIndices, this));
+  m_newValue = 0;
+  m_index = 5;
+  m_subIndex = 0;
+  leaves[1]->SetAttribute ("Source", IntegerValue (-2));
+  NS_TEST_ASSERT_MSG_EQ (m_newValue, -2, "Trace did not fire as expected");
+  NS_TEST_ASSERT_MSG_EQ (m_index, 0, "Trace did not provide expected first index");
+  NS_TEST_ASSERT_MSG_EQ (m_subIndex, 1, "Trace did not provide expected second index");
+
+  Config::UnregisterRootNamespaceObject (root);
+}
+
 /**
  * \ingroup config-tests
  * The Test Suite that glues all of the Test Cases together.
@@ -848,6 +1070,8 @@ ConfigTestSuite::ConfigTestSuite ()
   AddTestCase (new UnderRootNamespaceConfigTestCase);
   AddTestCase (new ObjectVectorConfigTestCase);
   AddTestCase (new SearchAttributesOfParentObjectsTestCase);
+  AddTestCase (new CompiledPathConfigTestCase);
+  AddTestCase (new CompiledPathIndexConfigTestCase);
 }
 
 /**
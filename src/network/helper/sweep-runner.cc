@@ -0,0 +1,712 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 University of Washington
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Sébastien Deronne <sebastien.deronne@gmail.com>
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <map>
+#include <cerrno>
+#include <cstring>
+#include <csignal>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "ns3/simulator.h"
+#include "ns3/config.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/mac48-address.h"
+#include "sweep-runner.h"
+
+/**
+ * \file
+ * \ingroup network
+ * ns3::SweepRunner implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SweepRunner");
+
+std::vector<SweepRunner::ResultRow> *SweepRunner::m_rows = 0;
+
+/**
+ * \param field a field of a CSV file
+ * \return the field, quoted if needed
+ */
+static std::string
+CsvField (const std::string &field)
+{
+  if (field.find_first_of (",\"\n") == std::string::npos)
+    {
+      return field;
+    }
+  std::string quoted = "\"";
+  for (auto c : field)
+    {
+      if (c == '"')
+        {
+          quoted += '"';
+        }
+      quoted += c;
+    }
+  return quoted + "\"";
+}
+
+/**
+ * Write a field of the results returned by a worker process, prefixed
+ * with its length so that it may contain any character.
+ *
+ * \param os the output stream
+ * \param field the field
+ */
+static void
+WriteWorkerField (std::ostream &os, const std::string &field)
+{
+  os << field.size () << ':' << field << '\n';
+}
+
+/**
+ * Read a field written by WriteWorkerField.
+ *
+ * \param is the input stream
+ * \param field the field read
+ * \return true if a well-formed field has been read
+ */
+static bool
+ReadWorkerField (std::istream &is, std::string &field)
+{
+  std::size_t length;
+  char separator;
+  if (!(is >> length) || !is.get (separator) || separator != ':')
+    {
+      return false;
+    }
+  field.assign (length, '\0');
+  if (length > 0 && !is.read (&field[0], length))
+    {
+      return false;
+    }
+  return is.get (separator) && separator == '\n';
+}
+
+/**
+ * Read the rows of results returned by a worker process.
+ *
+ * \param is the input stream
+ * \param rows the rows read
+ * \return true if the whole stream is made of well-formed rows
+ */
+static bool
+ReadWorkerRows (std::istream &is, std::vector<SweepRunner::ResultRow> &rows)
+{
+  std::size_t nValues;
+  while (is >> nValues)
+    {
+      SweepRunner::ResultRow row;
+      for (std::size_t i = 0; i < nValues; ++i)
+        {
+          std::pair<std::string, std::string> value;
+          if (!ReadWorkerField (is, value.first) || !ReadWorkerField (is, value.second))
+            {
+              return false;
+            }
+          row.push_back (value);
+        }
+      rows.push_back (row);
+    }
+  return is.eof ();
+}
+
+SweepRunner::SweepRunner (Scenario scenario)
+  : m_scenario (scenario),
+    m_nWorkers (0),
+    m_timeout (Seconds (0))
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+SweepRunner::SetFixedValue (std::string name, std::string value)
+{
+  NS_LOG_FUNCTION (this << name << value);
+  m_fixedValues.push_back (std::make_pair (name, value));
+}
+
+void
+SweepRunner::AddArgument (std::string argument)
+{
+  NS_LOG_FUNCTION (this << argument);
+  m_arguments.push_back (argument);
+}
+
+void
+SweepRunner::AddAxis (std::vector<std::string> names, std::vector<std::string> values)
+{
+  NS_LOG_FUNCTION (this << names.size () << values.size ());
+  NS_ASSERT (!names.empty () && !values.empty ());
+  Axis axis;
+  axis.names = names;
+  axis.values = values;
+  m_axes.push_back (axis);
+}
+
+void
+SweepRunner::AddPoint (Values values)
+{
+  NS_LOG_FUNCTION (this << values.size ());
+  m_points.push_back (values);
+}
+
+void
+SweepRunner::AddRuns (uint32_t first, uint32_t nRuns)
+{
+  NS_LOG_FUNCTION (this << first << nRuns);
+  std::vector<std::string> runs;
+  for (uint32_t run = first; run < first + nRuns; ++run)
+    {
+      runs.push_back (std::to_string (run));
+    }
+  AddAxis (std::vector<std::string> (1, "RngRun"), runs);
+}
+
+bool
+SweepRunner::Load (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  std::ifstream is (filename.c_str ());
+  if (!is.is_open ())
+    {
+      std::cerr << "Cannot open sweep specification " << filename << std::endl;
+      return false;
+    }
+  std::string line;
+  uint32_t lineNumber = 0;
+  while (std::getline (is, line))
+    {
+      lineNumber++;
+      std::size_t comment = line.find ('#');
+      if (comment != std::string::npos)
+        {
+          line.erase (comment);
+        }
+      std::istringstream iss (line);
+      std::string directive;
+      if (!(iss >> directive))
+        {
+          continue;
+        }
+      std::vector<std::string> tokens;
+      std::string token;
+      while (iss >> token)
+        {
+          tokens.push_back (token);
+        }
+      if (directive == "set" && (tokens.size () == 1 || tokens.size () == 2))
+        {
+          SetFixedValue (tokens[0], tokens.size () == 2 ? tokens[1] : "");
+        }
+      else if (directive == "grid" && tokens.size () >= 2)
+        {
+          std::vector<std::string> names;
+          std::istringstream namesStream (tokens[0]);
+          std::string name;
+          while (std::getline (namesStream, name, '+'))
+            {
+              names.push_back (name);
+            }
+          AddAxis (names, std::vector<std::string> (tokens.begin () + 1, tokens.end ()));
+        }
+      else if (directive == "point" && !tokens.empty ())
+        {
+          Values values;
+          for (auto const& value : tokens)
+            {
+              std::size_t equal = value.find ('=');
+              if (equal == std::string::npos)
+                {
+                  std::cerr << filename << ":" << lineNumber << ": expected name=value, got " << value << std::endl;
+                  return false;
+                }
+              values.push_back (std::make_pair (value.substr (0, equal), value.substr (equal + 1)));
+            }
+          AddPoint (values);
+        }
+      else if (directive == "runs" && tokens.size () == 2)
+        {
+          uint32_t first = 0;
+          uint32_t nRuns = 0;
+          std::istringstream runsStream (tokens[0] + " " + tokens[1]);
+          if (!(runsStream >> first >> nRuns) || nRuns == 0)
+            {
+              std::cerr << filename << ":" << lineNumber << ": invalid runs: " << line << std::endl;
+              return false;
+            }
+          AddRuns (first, nRuns);
+        }
+      else
+        {
+          std::cerr << filename << ":" << lineNumber << ": invalid directive: " << line << std::endl;
+          return false;
+        }
+    }
+  return true;
+}
+
+std::size_t
+SweepRunner::GetNPoints (void) const
+{
+  std::size_t nPoints = std::max<std::size_t> (m_points.size (), 1);
+  for (auto const& axis : m_axes)
+    {
+      nPoints *= axis.values.size ();
+    }
+  return nPoints;
+}
+
+std::vector<std::string>
+SweepRunner::GetSweptNames (void) const
+{
+  std::vector<std::string> names;
+  for (auto const& point : m_points)
+    {
+      for (auto const& value : point)
+        {
+          if (std::find (names.begin (), names.end (), value.first) == names.end ())
+            {
+              names.push_back (value.first);
+            }
+        }
+    }
+  for (auto const& axis : m_axes)
+    {
+      for (auto const& name : axis.names)
+        {
+          if (std::find (names.begin (), names.end (), name) == names.end ())
+            {
+              names.push_back (name);
+            }
+        }
+    }
+  return names;
+}
+
+SweepRunner::Values
+SweepRunner::GetPoint (std::size_t index) const
+{
+  NS_ASSERT (index < GetNPoints ());
+  Values values = m_fixedValues;
+  std::size_t nGridPoints = GetNPoints () / std::max<std::size_t> (m_points.size (), 1);
+  if (!m_points.empty ())
+    {
+      const Values &point = m_points[index / nGridPoints];
+      values.insert (values.end (), point.begin (), point.end ());
+    }
+  //the last axis varies fastest
+  std::size_t gridIndex = index % nGridPoints;
+  std::size_t stride = nGridPoints;
+  for (auto const& axis : m_axes)
+    {
+      stride /= axis.values.size ();
+      const std::string &value = axis.values[(gridIndex / stride) % axis.values.size ()];
+      for (auto const& name : axis.names)
+        {
+          values.push_back (std::make_pair (name, value));
+        }
+    }
+  return values;
+}
+
+int
+SweepRunner::RunPoint (std::size_t index, std::vector<ResultRow> &rows)
+{
+  NS_LOG_FUNCTION (this << index);
+  //reset the state left by the previous simulation
+  Simulator::Destroy ();
+  Config::Reset ();
+  RngSeedManager::ResetNextStreamIndex ();
+  Mac48Address::ResetAllocationIndex ();
+
+  std::vector<std::string> arguments;
+  arguments.push_back ("sweep-point");
+  //the fixed values come first, then the arguments passed unchanged and
+  //the swept values, so that the latter take precedence
+  Values point = GetPoint (index);
+  Values::const_iterator swept = point.begin () + m_fixedValues.size ();
+  for (Values::const_iterator it = point.begin (); it != swept; ++it)
+    {
+      arguments.push_back ("--" + it->first + "=" + it->second);
+    }
+  arguments.insert (arguments.end (), m_arguments.begin (), m_arguments.end ());
+  for (Values::const_iterator it = swept; it != point.end (); ++it)
+    {
+      arguments.push_back ("--" + it->first + "=" + it->second);
+    }
+  std::vector<char *> argv;
+  for (auto & argument : arguments)
+    {
+      argv.push_back (&argument[0]);
+    }
+  argv.push_back (0);
+
+  m_rows = &rows;
+  int ret = m_scenario (static_cast<int> (arguments.size ()), argv.data ());
+  m_rows = 0;
+  Simulator::Destroy ();
+  return ret;
+}
+
+void
+SweepRunner::WriteHeader (std::ostream &os, const ResultRow &row) const
+{
+  os << "point";
+  for (auto const& name : GetSweptNames ())
+    {
+      os << "," << CsvField (name);
+    }
+  for (auto const& value : row)
+    {
+      os << "," << CsvField (value.first);
+    }
+  os << std::endl;
+}
+
+void
+SweepRunner::WriteRow (std::ostream &os, std::size_t index, const Values &point, const ResultRow &row) const
+{
+  os << index;
+  for (auto const& name : GetSweptNames ())
+    {
+      //the last value given for a name is the one used by the scenario
+      std::string sweptValue;
+      for (auto const& value : point)
+        {
+          if (value.first == name)
+            {
+              sweptValue = value.second;
+            }
+        }
+      os << "," << CsvField (sweptValue);
+    }
+  NS_ASSERT_MSG (row.size () == m_resultColumns.size (), "All the result rows must have the same columns");
+  for (std::size_t i = 0; i < row.size (); ++i)
+    {
+      NS_ASSERT_MSG (row[i].first == m_resultColumns[i], "All the result rows must have the same columns");
+      os << "," << CsvField (row[i].second);
+    }
+  os << std::endl;
+}
+
+void
+SweepRunner::WriteRows (std::ostream &os, std::size_t index, const std::vector<ResultRow> &rows)
+{
+  Values point = GetPoint (index);
+  for (auto const& row : rows)
+    {
+      if (m_resultColumns.empty ())
+        {
+          WriteHeader (os, row);
+          for (auto const& value : row)
+            {
+              m_resultColumns.push_back (value.first);
+            }
+        }
+      WriteRow (os, index, point, row);
+    }
+  os.flush ();
+}
+
+void
+SweepRunner::SetNWorkers (uint32_t nWorkers)
+{
+  NS_LOG_FUNCTION (this << nWorkers);
+  m_nWorkers = nWorkers;
+}
+
+void
+SweepRunner::SetTimeout (Time timeout)
+{
+  NS_LOG_FUNCTION (this << timeout);
+  m_timeout = timeout;
+}
+
+int
+SweepRunner::Run (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  std::ofstream os (filename.c_str (), std::ofstream::out | std::ofstream::trunc);
+  if (!os.is_open ())
+    {
+      std::cerr << "Cannot open sweep results file " << filename << std::endl;
+      return -1;
+    }
+  m_resultColumns.clear ();
+  if (m_nWorkers == 0)
+    {
+      return RunInProcess (os);
+    }
+  return RunForked (os, filename);
+}
+
+int
+SweepRunner::RunInProcess (std::ostream &os)
+{
+  NS_LOG_FUNCTION (this);
+  int nFailures = 0;
+  std::size_t nPoints = GetNPoints ();
+  for (std::size_t index = 0; index < nPoints; ++index)
+    {
+      NS_LOG_INFO ("Running point " << index + 1 << "/" << nPoints);
+      std::vector<ResultRow> rows;
+      int ret = RunPoint (index, rows);
+      if (ret != 0)
+        {
+          std::cerr << "Point " << index << " failed with exit code " << ret << std::endl;
+          nFailures++;
+        }
+      WriteRows (os, index, rows);
+    }
+  return nFailures;
+}
+
+int
+SweepRunner::RunForked (std::ostream &os, std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  int nFailures = 0;
+  std::size_t nPoints = GetNPoints ();
+  std::size_t nextToRun = 0;
+  std::size_t nextToWrite = 0;
+  //the points being run, indexed by the process ids of their workers
+  std::map<pid_t, std::size_t> running;
+  //the results of the points run but not written yet
+  std::map<std::size_t, std::vector<ResultRow> > done;
+  while (nextToWrite < nPoints)
+    {
+      while (running.size () < m_nWorkers && nextToRun < nPoints)
+        {
+          std::size_t index = nextToRun++;
+          std::string rowsFilename = filename + ".point" + std::to_string (index);
+          NS_LOG_INFO ("Starting point " << index + 1 << "/" << nPoints);
+          //do not let the worker output what is buffered by this process
+          std::cout.flush ();
+          std::cerr.flush ();
+          pid_t pid = ::fork ();
+          if (pid == 0)
+            {
+              if (!m_timeout.IsZero ())
+                {
+                  //SIGALRM terminates the worker
+                  ::alarm (static_cast<unsigned int> (std::ceil (m_timeout.GetSeconds ())));
+                }
+              std::vector<ResultRow> rows;
+              int ret = RunPoint (index, rows);
+              std::ofstream rowsFile (rowsFilename.c_str (), std::ofstream::out | std::ofstream::trunc | std::ofstream::binary);
+              for (auto const& row : rows)
+                {
+                  rowsFile << row.size () << '\n';
+                  for (auto const& value : row)
+                    {
+                      WriteWorkerField (rowsFile, value.first);
+                      WriteWorkerField (rowsFile, value.second);
+                    }
+                }
+              rowsFile.close ();
+              std::cout.flush ();
+              std::cerr.flush ();
+              //skip the destructors of the objects shared with the parent
+              ::_exit (ret == 0 && rowsFile ? 0 : 1);
+            }
+          if (pid == -1)
+            {
+              std::cerr << "Point " << index << " not run, fork failed: " << std::strerror (errno) << std::endl;
+              nFailures++;
+              done[index];
+            }
+          else
+            {
+              running[pid] = index;
+            }
+        }
+
+      if (!running.empty ())
+        {
+          int status;
+          pid_t pid = ::waitpid (-1, &status, 0);
+          if (pid == -1)
+            {
+              NS_ABORT_MSG_IF (errno != EINTR, "waitpid() failed: " << std::strerror (errno));
+              continue;
+            }
+          auto it = running.find (pid);
+          if (it == running.end ())
+            {
+              continue;
+            }
+          std::size_t index = it->second;
+          running.erase (it);
+          std::string rowsFilename = filename + ".point" + std::to_string (index);
+          std::vector<ResultRow> &rows = done[index];
+          if (WIFEXITED (status) && WEXITSTATUS (status) == 0)
+            {
+              std::ifstream rowsFile (rowsFilename.c_str (), std::ifstream::in | std::ifstream::binary);
+              if (!rowsFile.is_open () || !ReadWorkerRows (rowsFile, rows))
+                {
+                  std::cerr << "Point " << index << " failed, its results cannot be read from " << rowsFilename << std::endl;
+                  rows.clear ();
+                  nFailures++;
+                }
+            }
+          else if (WIFSIGNALED (status) && WTERMSIG (status) == SIGALRM)
+            {
+              std::cerr << "Point " << index << " timed out" << std::endl;
+              nFailures++;
+            }
+          else if (WIFSIGNALED (status))
+            {
+              std::cerr << "Point " << index << " crashed with signal " << WTERMSIG (status) << std::endl;
+              nFailures++;
+            }
+          else
+            {
+              std::cerr << "Point " << index << " failed with exit code " << WEXITSTATUS (status) << std::endl;
+              nFailures++;
+            }
+          std::remove (rowsFilename.c_str ());
+        }
+
+      //the rows are written in the order of the points
+      for (auto it = done.find (nextToWrite); it != done.end (); it = done.find (nextToWrite))
+        {
+          WriteRows (os, nextToWrite, it->second);
+          done.erase (it);
+          nextToWrite++;
+        }
+    }
+  return nFailures;
+}
+
+void
+SweepRunner::AddResultRow (const ResultRow &row)
+{
+  if (m_rows != 0)
+    {
+      m_rows->push_back (row);
+    }
+}
+
+bool
+SweepRunner::IsRunning (void)
+{
+  return m_rows != 0;
+}
+
+int
+SweepRunner::Main (Scenario scenario, int argc, char *argv[])
+{
+  std::string sweepFilename;
+  std::string outputFilename = "sweep-results.csv";
+  uint32_t nWorkers = 0;
+  double timeout = 0;
+  //the arguments other than the --sweep options, passed unchanged to the scenario
+  std::vector<char *> scenarioArgv (argv, argv + std::min (argc, 1));
+  for (int i = 1; i < argc; ++i)
+    {
+      //like CommandLine, accept options with one or two leading dashes
+      std::string argument = argv[i];
+      std::string name;
+      if (argument.compare (0, 2, "--") == 0)
+        {
+          name = argument.substr (2);
+        }
+      else if (argument.compare (0, 1, "-") == 0)
+        {
+          name = argument.substr (1);
+        }
+      std::size_t equal = name.find ('=');
+      std::string value = equal == std::string::npos ? "true" : name.substr (equal + 1);
+      name = name.substr (0, equal);
+      if (name == "sweep")
+        {
+          sweepFilename = value;
+        }
+      else if (name == "sweepOutput")
+        {
+          outputFilename = value;
+        }
+      else if (name == "sweepWorkers" && value == "auto")
+        {
+          nWorkers = std::max<long> (::sysconf (_SC_NPROCESSORS_ONLN), 1);
+        }
+      else if (name == "sweepWorkers")
+        {
+          std::istringstream iss (value);
+          if (!(iss >> nWorkers) || !iss.eof ())
+            {
+              std::cerr << "Invalid number of workers " << value << std::endl;
+              return 1;
+            }
+        }
+      else if (name == "sweepTimeout")
+        {
+          std::istringstream iss (value);
+          if (!(iss >> timeout) || !iss.eof () || timeout < 0)
+            {
+              std::cerr << "Invalid timeout " << value << std::endl;
+              return 1;
+            }
+        }
+      else
+        {
+          scenarioArgv.push_back (argv[i]);
+        }
+    }
+  if (sweepFilename.empty ())
+    {
+      int scenarioArgc = static_cast<int> (scenarioArgv.size ());
+      scenarioArgv.push_back (0);
+      return scenario (scenarioArgc, scenarioArgv.data ());
+    }
+
+  SweepRunner runner (scenario);
+  if (!runner.Load (sweepFilename))
+    {
+      return 1;
+    }
+  //the arguments given on the command line take precedence over the values set by the specification
+  for (std::size_t i = 1; i < scenarioArgv.size (); ++i)
+    {
+      runner.AddArgument (scenarioArgv[i]);
+    }
+  runner.SetNWorkers (nWorkers);
+  runner.SetTimeout (Seconds (timeout));
+  int nFailures = runner.Run (outputFilename);
+  if (nFailures != 0)
+    {
+      return 1;
+    }
+  std::cout << "Ran " << runner.GetNPoints () << " points, results written to " << outputFilename << std::endl;
+  return 0;
+}
+
+} // namespace ns3
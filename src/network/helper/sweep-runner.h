@@ -0,0 +1,287 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 University of Washington
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Sébastien Deronne <sebastien.deronne@gmail.com>
+ */
+#ifndef SWEEP_RUNNER_H
+#define SWEEP_RUNNER_H
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include "ns3/nstime.h"
+
+/**
+ * \file
+ * \ingroup network
+ * ns3::SweepRunner declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup network
+ *
+ * \brief Run the points of a parameter sweep of a simulation program back to
+ * back in the same process.
+ *
+ * A scenario is the main function of a simulation program, which parses its
+ * command-line values with CommandLine. Every point of the sweep is a set of
+ * command-line values, with which the scenario is called. Between points, the
+ * simulator is destroyed (along with the NodeList and the ChannelList), the
+ * attribute defaults and the global values are reset by Config::Reset, the
+ * automatic assignment of RNG streams starts over and so does the allocation
+ * of MAC addresses by Mac48Address::Allocate. The rest of the process-wide
+ * state is not reset: for instance, the packet uids keep increasing from one
+ * point to the next, and the caches shared by all the simulations of a
+ * process (e.g., the TX power spectral densities of WifiSpectrumValueHelper
+ * or the payload parameters of WifiPhy) keep their content. A point only gives
+ * the same results as a new process run with the same values if its scenario
+ * does not depend on such state.
+ *
+ * The points are specified in a file, one directive per line:
+ *
+ * \code
+ *   # values passed to every point
+ *   set simulationTime 10
+ *   # grid axes: the points are the cartesian product of the axes, the
+ *   # last axis varying fastest; an axis may set several values at once
+ *   grid ccaSdThreshold -90 -82 -62
+ *   grid mcs1+mcs2+mcs3+mcs4 VhtMcs0 VhtMcs5
+ *   # explicit points, each combined with every combination of the grid axes
+ *   point nBss=4 n=10
+ *   point nBss=7 n=5
+ *   # a grid axis setting RngRun to 1, 2, ..., 200
+ *   runs 1 200
+ * \endcode
+ *
+ * The scenario reports its results with AddResultRow. The rows of all the
+ * points are written to a single CSV file, each row being prefixed with the
+ * index of the point and the swept values.
+ *
+ * The points can also be run by a pool of worker processes (see
+ * SetNWorkers), each point being run in a process forked for it. A point
+ * that crashes or exceeds the timeout set by SetTimeout is reported as
+ * failed without affecting the other points. Since the values of a point,
+ * including its RngRun, only depend on its index, the results do not depend
+ * on the number of workers nor on the order in which the points complete,
+ * and the rows are always written in the order of the points.
+ */
+class SweepRunner
+{
+public:
+  /// The main function of a simulation program
+  typedef int (* Scenario)(int argc, char *argv[]);
+  /// A row of results, made of (column name, value) pairs
+  typedef std::vector<std::pair<std::string, std::string> > ResultRow;
+  /// A set of command-line values, made of (name, value) pairs
+  typedef std::vector<std::pair<std::string, std::string> > Values;
+
+  /**
+   * Constructor
+   *
+   * \param scenario the scenario run for every point
+   */
+  SweepRunner (Scenario scenario);
+
+  /**
+   * Set a command-line value passed to every point.
+   *
+   * \param name the name of the command-line value
+   * \param value the value
+   */
+  void SetFixedValue (std::string name, std::string value);
+  /**
+   * Add a command-line argument passed unchanged to every point, after the
+   * fixed values and before the swept values.
+   *
+   * \param argument the command-line argument
+   */
+  void AddArgument (std::string argument);
+  /**
+   * Add a grid axis.
+   *
+   * \param names the names of the command-line values set by the axis
+   * \param values the values taken along the axis
+   */
+  void AddAxis (std::vector<std::string> names, std::vector<std::string> values);
+  /**
+   * Add an explicit point.
+   *
+   * \param values the command-line values of the point
+   */
+  void AddPoint (Values values);
+  /**
+   * Add a grid axis setting RngRun to consecutive run numbers.
+   *
+   * \param first the first run number
+   * \param nRuns the number of runs
+   */
+  void AddRuns (uint32_t first, uint32_t nRuns);
+  /**
+   * Load a sweep specification from a file.
+   *
+   * \param filename the name of the file
+   * \return true if the file has been loaded
+   */
+  bool Load (std::string filename);
+
+  /**
+   * \return the number of points of the sweep
+   */
+  std::size_t GetNPoints (void) const;
+  /**
+   * \return the names of the swept command-line values
+   */
+  std::vector<std::string> GetSweptNames (void) const;
+  /**
+   * \param index the index of the point
+   * \return the command-line values of the point, the fixed values first
+   */
+  Values GetPoint (std::size_t index) const;
+
+  /**
+   * Set the number of worker processes running the points. With no worker,
+   * which is the default, the points are run in this process.
+   *
+   * \param nWorkers the number of worker processes
+   */
+  void SetNWorkers (uint32_t nWorkers);
+  /**
+   * Set the (wall-clock) time after which a point run by a worker process is
+   * killed and reported as failed. A zero timeout, which is the default,
+   * disables it.
+   *
+   * \param timeout the timeout, rounded up to the second
+   */
+  void SetTimeout (Time timeout);
+
+  /**
+   * Run every point of the sweep, in this process or by worker processes.
+   *
+   * \param filename the name of the CSV file the results are written to
+   * \return the number of points whose scenario failed, or -1 if the file
+   *         cannot be opened
+   */
+  int Run (std::string filename);
+  /**
+   * Run a single point of the sweep in this process, after resetting the
+   * state left by the previous simulation.
+   *
+   * \param index the index of the point
+   * \param rows the results reported by the scenario
+   * \return the value returned by the scenario
+   */
+  int RunPoint (std::size_t index, std::vector<ResultRow> &rows);
+
+  /**
+   * Report a row of results of the point being run. This is a no-op if no
+   * sweep is being run.
+   *
+   * \param row the row of results
+   */
+  static void AddResultRow (const ResultRow &row);
+  /**
+   * \return true if a sweep is being run, in which case the results reported
+   *         by AddResultRow are collected
+   */
+  static bool IsRunning (void);
+
+  /**
+   * Run a simulation program: if its command line contains --sweep=<file>,
+   * run the points of the sweep specified in that file, the results being
+   * written to the file given by --sweepOutput=<file> (sweep-results.csv by
+   * default). The points are run by the number of worker processes given by
+   * --sweepWorkers=<n>, or one per processor with --sweepWorkers=auto, and
+   * the ones lasting more than --sweepTimeout=<seconds> are killed.
+   * Otherwise, run the scenario once. In both cases, the --sweep options are
+   * removed from the command line and the other arguments are passed
+   * unchanged to the scenario, which parses them with CommandLine.
+   *
+   * \param scenario the scenario
+   * \param argc the number of command-line arguments
+   * \param argv the command-line arguments
+   * \return the exit code of the program
+   */
+  static int Main (Scenario scenario, int argc, char *argv[]);
+
+
+private:
+  /**
+   * Write the header of the results.
+   *
+   * \param os the output stream
+   * \param row the first row of results
+   */
+  void WriteHeader (std::ostream &os, const ResultRow &row) const;
+  /**
+   * Write a row of results.
+   *
+   * \param os the output stream
+   * \param index the index of the point
+   * \param point the command-line values of the point
+   * \param row the row of results
+   */
+  void WriteRow (std::ostream &os, std::size_t index, const Values &point, const ResultRow &row) const;
+  /**
+   * Write the rows of results of a point, preceded by the header if they are
+   * the first rows written.
+   *
+   * \param os the output stream
+   * \param index the index of the point
+   * \param rows the rows of results
+   */
+  void WriteRows (std::ostream &os, std::size_t index, const std::vector<ResultRow> &rows);
+  /**
+   * Run every point of the sweep in this process.
+   *
+   * \param os the output stream
+   * \return the number of points whose scenario failed
+   */
+  int RunInProcess (std::ostream &os);
+  /**
+   * Run every point of the sweep by worker processes.
+   *
+   * \param os the output stream
+   * \param filename the name of the CSV file, used to name the files
+   *        through which the workers return their results
+   * \return the number of points whose scenario failed
+   */
+  int RunForked (std::ostream &os, std::string filename);
+
+  /// A grid axis
+  struct Axis
+  {
+    std::vector<std::string> names;  //!< the names of the command-line values set by the axis
+    std::vector<std::string> values; //!< the values taken along the axis
+  };
+
+  Scenario m_scenario;              //!< the scenario
+  Values m_fixedValues;             //!< the values passed to every point
+  std::vector<std::string> m_arguments; //!< the arguments passed unchanged to every point
+  std::vector<Axis> m_axes;         //!< the grid axes
+  std::vector<Values> m_points;     //!< the explicit points
+  std::vector<std::string> m_resultColumns; //!< the names of the result columns
+  uint32_t m_nWorkers;              //!< the number of worker processes
+  Time m_timeout;                   //!< the timeout of the points run by workers
+
+  static std::vector<ResultRow> *m_rows; //!< the rows reported by the point being run, if any
+};
+
+} // namespace ns3
+
+#endif /* SWEEP_RUNNER_H */
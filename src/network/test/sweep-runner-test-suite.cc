@@ -0,0 +1,530 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 University of Washington
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Sébastien Deronne <sebastien.deronne@gmail.com>
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+#include "ns3/test.h"
+#include "ns3/sweep-runner.h"
+#include "ns3/command-line.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/mac48-address.h"
+
+/**
+ * \file
+ * \ingroup network-test
+ * \ingroup sweep-runner-tests
+ * SweepRunner test suite.
+ */
+
+/**
+ * \ingroup network-test
+ * \defgroup sweep-runner-tests SweepRunner test suite
+ */
+
+namespace ns3 {
+
+  namespace tests {
+
+
+/**
+ * \ingroup sweep-runner-tests
+ * Check the points generated from a sweep specification.
+ */
+class SweepRunnerSpecTestCase : public TestCase
+{
+public:
+  SweepRunnerSpecTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \param values the command-line values of a point
+   * \param name the name of a command-line value
+   * \return the last value given for the name, or an empty string
+   */
+  std::string GetValue (const SweepRunner::Values &values, std::string name) const;
+};
+
+SweepRunnerSpecTestCase::SweepRunnerSpecTestCase ()
+  : TestCase ("Check the points generated from a sweep specification")
+{
+}
+
+std::string
+SweepRunnerSpecTestCase::GetValue (const SweepRunner::Values &values, std::string name) const
+{
+  std::string found;
+  for (auto const& value : values)
+    {
+      if (value.first == name)
+        {
+          found = value.second;
+        }
+    }
+  return found;
+}
+
+void
+SweepRunnerSpecTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("sweep-spec.txt");
+  std::ofstream os (filename.c_str ());
+  os << "# comment line" << std::endl
+     << "set simulationTime 10" << std::endl
+     << "grid a 1 2 3   # trailing comment" << std::endl
+     << "grid b+c x y" << std::endl
+     << "point n=4" << std::endl
+     << "point n=7 m=5" << std::endl;
+  os.close ();
+
+  SweepRunner runner (0);
+  NS_TEST_ASSERT_MSG_EQ (runner.Load (filename), true, "Failed to load the specification");
+  NS_TEST_ASSERT_MSG_EQ (runner.GetNPoints (), 12, "Unexpected number of points");
+
+  std::vector<std::string> names = runner.GetSweptNames ();
+  NS_TEST_ASSERT_MSG_EQ (names.size (), 5, "Unexpected number of swept names");
+  NS_TEST_EXPECT_MSG_EQ (names[0], "n", "Unexpected swept name");
+  NS_TEST_EXPECT_MSG_EQ (names[1], "m", "Unexpected swept name");
+  NS_TEST_EXPECT_MSG_EQ (names[2], "a", "Unexpected swept name");
+  NS_TEST_EXPECT_MSG_EQ (names[3], "b", "Unexpected swept name");
+  NS_TEST_EXPECT_MSG_EQ (names[4], "c", "Unexpected swept name");
+
+  const char *a[] = {"1", "1", "2", "2", "3", "3"};
+  const char *bc[] = {"x", "y"};
+  for (std::size_t index = 0; index < runner.GetNPoints (); ++index)
+    {
+      SweepRunner::Values point = runner.GetPoint (index);
+      NS_TEST_EXPECT_MSG_EQ (point.front ().first, "simulationTime", "Fixed values must come first");
+      NS_TEST_EXPECT_MSG_EQ (GetValue (point, "simulationTime"), "10", "Unexpected fixed value");
+      NS_TEST_EXPECT_MSG_EQ (GetValue (point, "n"), (index < 6 ? "4" : "7"), "Unexpected value of point " << index);
+      NS_TEST_EXPECT_MSG_EQ (GetValue (point, "m"), (index < 6 ? "" : "5"), "Unexpected value of point " << index);
+      NS_TEST_EXPECT_MSG_EQ (GetValue (point, "a"), a[index % 6], "Unexpected value of point " << index);
+      NS_TEST_EXPECT_MSG_EQ (GetValue (point, "b"), bc[index % 2], "Unexpected value of point " << index);
+      NS_TEST_EXPECT_MSG_EQ (GetValue (point, "c"), bc[index % 2], "Unexpected value of point " << index);
+    }
+
+  std::ofstream invalid (filename.c_str ());
+  invalid << "point n" << std::endl;
+  invalid.close ();
+  SweepRunner invalidRunner (0);
+  NS_TEST_EXPECT_MSG_EQ (invalidRunner.Load (filename), false, "An invalid specification must not be loaded");
+}
+
+
+/**
+ * \ingroup sweep-runner-tests
+ * Check that the points run in the same process are independent.
+ */
+class SweepRunnerResetTestCase : public TestCase
+{
+public:
+  SweepRunnerResetTestCase ();
+
+  /**
+   * A scenario drawing a random number from an automatically assigned
+   * stream and allocating a MAC address, after changing the default of a
+   * global value.
+   *
+   * \param argc the number of command-line arguments
+   * \param argv the command-line arguments
+   * \return 0
+   */
+  static int Scenario (int argc, char *argv[]);
+
+private:
+  virtual void DoRun (void);
+};
+
+SweepRunnerResetTestCase::SweepRunnerResetTestCase ()
+  : TestCase ("Check that the points run in the same process are independent")
+{
+}
+
+int
+SweepRunnerResetTestCase::Scenario (int argc, char *argv[])
+{
+  uint32_t nDraws = 1;
+  CommandLine cmd;
+  cmd.AddValue ("nDraws", "Number of random variables created", nDraws);
+  cmd.Parse (argc, argv);
+
+  double value = 0;
+  for (uint32_t i = 0; i < nDraws; ++i)
+    {
+      Ptr<UniformRandomVariable> rv = CreateObject<UniformRandomVariable> ();
+      value = rv->GetValue ();
+    }
+  std::ostringstream oss;
+  oss.precision (17);
+  oss << value;
+  std::ostringstream address;
+  address << Mac48Address::Allocate ();
+  SweepRunner::AddResultRow ({{"run", std::to_string (RngSeedManager::GetRun ())}, {"value", oss.str ()},
+                              {"address", address.str ()}});
+  return 0;
+}
+
+void
+SweepRunnerResetTestCase::DoRun (void)
+{
+  SweepRunner runner (&SweepRunnerResetTestCase::Scenario);
+  runner.AddPoint ({{"RngRun", "2"}, {"nDraws", "3"}});
+  runner.AddPoint ({{"nDraws", "1"}});
+  runner.AddPoint ({{"RngRun", "2"}, {"nDraws", "3"}});
+  runner.AddPoint ({{"nDraws", "1"}});
+  NS_TEST_ASSERT_MSG_EQ (runner.GetNPoints (), 4, "Unexpected number of points");
+
+  std::vector<std::vector<SweepRunner::ResultRow> > results (runner.GetNPoints ());
+  for (std::size_t index = 0; index < runner.GetNPoints (); ++index)
+    {
+      NS_TEST_EXPECT_MSG_EQ (runner.RunPoint (index, results[index]), 0, "Unexpected return value");
+      NS_TEST_ASSERT_MSG_EQ (results[index].size (), 1, "Unexpected number of result rows");
+    }
+  NS_TEST_EXPECT_MSG_EQ (SweepRunner::IsRunning (), false, "No point must be running");
+
+  //the global value set by a point must not leak into the next one
+  NS_TEST_EXPECT_MSG_EQ (results[0][0][0].second, "2", "Unexpected run number");
+  NS_TEST_EXPECT_MSG_EQ (results[1][0][0].second, "1", "The run number has not been reset");
+  //the same values must give the same results, regardless of the streams
+  //assigned by the previous points
+  NS_TEST_EXPECT_MSG_EQ (results[2][0][1].second, results[0][0][1].second, "Points with the same values differ");
+  NS_TEST_EXPECT_MSG_EQ (results[3][0][1].second, results[1][0][1].second, "Points with the same values differ");
+  NS_TEST_EXPECT_MSG_NE (results[0][0][1].second, results[1][0][1].second, "Points with different values must differ");
+  //the MAC addresses allocated by the previous points are not in use anymore
+  for (std::size_t index = 0; index < runner.GetNPoints (); ++index)
+    {
+      NS_TEST_EXPECT_MSG_EQ (results[index][0][2].second, "00:00:00:00:00:01", "The MAC address allocation has not been reset");
+    }
+
+  //the results of all the points are written to a single file
+  std::string filename = CreateTempDirFilename ("sweep-results.csv");
+  NS_TEST_EXPECT_MSG_EQ (runner.Run (filename), 0, "Unexpected number of failures");
+  std::ifstream is (filename.c_str ());
+  std::string line;
+  std::vector<std::string> lines;
+  while (std::getline (is, line))
+    {
+      lines.push_back (line);
+    }
+  NS_TEST_ASSERT_MSG_EQ (lines.size (), 5, "Unexpected number of lines");
+  NS_TEST_EXPECT_MSG_EQ (lines[0], "point,RngRun,nDraws,run,value,address", "Unexpected header");
+  NS_TEST_EXPECT_MSG_EQ (lines[1], "0,2,3,2," + results[0][0][1].second + ",00:00:00:00:00:01", "Unexpected row");
+  NS_TEST_EXPECT_MSG_EQ (lines[2], "1,,1,1," + results[1][0][1].second + ",00:00:00:00:00:01", "Unexpected row");
+}
+
+
+/**
+ * \ingroup sweep-runner-tests
+ * Check the points run by worker processes.
+ */
+class SweepRunnerForkTestCase : public TestCase
+{
+public:
+  SweepRunnerForkTestCase ();
+
+  /**
+   * A scenario which, depending on its mode, reports a row with a random
+   * number or with one of the texts of m_texts, crashes, never returns or
+   * exits after writing malformed results to m_malformedFilename, as a
+   * worker would do.
+   *
+   * \param argc the number of command-line arguments
+   * \param argv the command-line arguments
+   * \return 0
+   */
+  static int Scenario (int argc, char *argv[]);
+
+  static const std::vector<std::string> m_texts; //!< the texts reported in text mode
+  static std::string m_malformedFilename;        //!< the file written in malformed mode
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \param filename the name of a file
+   * \return the content of the file
+   */
+  std::string ReadFile (std::string filename) const;
+};
+
+const std::vector<std::string> SweepRunnerForkTestCase::m_texts = {"a,b", "12\n34\n", "\"c\"\n\n5:d", "", " 3:e \n"};
+std::string SweepRunnerForkTestCase::m_malformedFilename;
+
+SweepRunnerForkTestCase::SweepRunnerForkTestCase ()
+  : TestCase ("Check the points run by worker processes")
+{
+}
+
+int
+SweepRunnerForkTestCase::Scenario (int argc, char *argv[])
+{
+  std::string mode = "ok";
+  uint32_t nDraws = 1;
+  uint32_t text = 0;
+  CommandLine cmd;
+  cmd.AddValue ("mode", "ok, text, crash, hang or malformed", mode);
+  cmd.AddValue ("nDraws", "Number of random variables created", nDraws);
+  cmd.AddValue ("text", "Index of the text reported in text mode", text);
+  cmd.Parse (argc, argv);
+
+  if (mode == "crash")
+    {
+      std::abort ();
+    }
+  while (mode == "hang")
+    {
+      ::sleep (1);
+    }
+  if (mode == "malformed")
+    {
+      std::ofstream rowsFile (m_malformedFilename.c_str ());
+      rowsFile << "1" << std::endl << "value" << std::endl;
+      rowsFile.close ();
+      ::_exit (0);
+    }
+  if (mode == "text")
+    {
+      SweepRunner::AddResultRow ({{"value", m_texts.at (text)}});
+      return 0;
+    }
+  double value = 0;
+  for (uint32_t i = 0; i < nDraws; ++i)
+    {
+      Ptr<UniformRandomVariable> rv = CreateObject<UniformRandomVariable> ();
+      value = rv->GetValue ();
+    }
+  std::ostringstream oss;
+  oss.precision (17);
+  oss << value;
+  SweepRunner::AddResultRow ({{"value", oss.str ()}});
+  return 0;
+}
+
+std::string
+SweepRunnerForkTestCase::ReadFile (std::string filename) const
+{
+  std::ifstream is (filename.c_str ());
+  std::ostringstream oss;
+  oss << is.rdbuf ();
+  return oss.str ();
+}
+
+void
+SweepRunnerForkTestCase::DoRun (void)
+{
+  SweepRunner runner (&SweepRunnerForkTestCase::Scenario);
+  runner.AddRuns (1, 3);
+  runner.AddAxis ({"nDraws"}, {"1", "2", "3"});
+  NS_TEST_ASSERT_MSG_EQ (runner.GetNPoints (), 9, "Unexpected number of points");
+
+  //the results do not depend on the number of workers
+  std::string inProcessFilename = CreateTempDirFilename ("in-process.csv");
+  NS_TEST_EXPECT_MSG_EQ (runner.Run (inProcessFilename), 0, "Unexpected number of failures");
+  std::string forkedFilename = CreateTempDirFilename ("forked.csv");
+  runner.SetNWorkers (4);
+  NS_TEST_EXPECT_MSG_EQ (runner.Run (forkedFilename), 0, "Unexpected number of failures");
+  std::string results = ReadFile (inProcessFilename);
+  NS_TEST_EXPECT_MSG_EQ (std::count (results.begin (), results.end (), '\n'), 10, "Unexpected number of lines");
+  NS_TEST_EXPECT_MSG_EQ (ReadFile (forkedFilename), results, "The results depend on the number of workers");
+
+  //the points which crash or time out do not prevent the others from completing
+  SweepRunner failingRunner (&SweepRunnerForkTestCase::Scenario);
+  failingRunner.AddAxis ({"mode"}, {"ok", "crash", "hang", "ok"});
+  failingRunner.SetNWorkers (2);
+  failingRunner.SetTimeout (Seconds (1));
+  std::string failingFilename = CreateTempDirFilename ("failing.csv");
+  NS_TEST_EXPECT_MSG_EQ (failingRunner.Run (failingFilename), 2, "Unexpected number of failures");
+  std::istringstream iss (ReadFile (failingFilename));
+  std::vector<std::string> lines;
+  std::string line;
+  while (std::getline (iss, line))
+    {
+      lines.push_back (line);
+    }
+  NS_TEST_ASSERT_MSG_EQ (lines.size (), 3, "Unexpected number of lines");
+  NS_TEST_EXPECT_MSG_EQ (lines[1].substr (0, 5), "0,ok,", "Unexpected row");
+  NS_TEST_EXPECT_MSG_EQ (lines[2].substr (0, 5), "3,ok,", "Unexpected row");
+
+  //the results returned by the workers may contain any character
+  SweepRunner textRunner (&SweepRunnerForkTestCase::Scenario);
+  textRunner.SetFixedValue ("mode", "text");
+  textRunner.AddAxis ({"text"}, {"0", "1", "2", "3", "4"});
+  std::string textInProcessFilename = CreateTempDirFilename ("text-in-process.csv");
+  NS_TEST_EXPECT_MSG_EQ (textRunner.Run (textInProcessFilename), 0, "Unexpected number of failures");
+  std::string textForkedFilename = CreateTempDirFilename ("text-forked.csv");
+  textRunner.SetNWorkers (2);
+  NS_TEST_EXPECT_MSG_EQ (textRunner.Run (textForkedFilename), 0, "Unexpected number of failures");
+  std::string textResults = ReadFile (textInProcessFilename);
+  NS_TEST_EXPECT_MSG_NE (textResults.find ("\"12\n34\n\""), std::string::npos, "The text has not been reported");
+  NS_TEST_EXPECT_MSG_EQ (ReadFile (textForkedFilename), textResults, "The results returned by the workers differ");
+
+  //a point whose results cannot be read fails without preventing the others from completing
+  SweepRunner malformedRunner (&SweepRunnerForkTestCase::Scenario);
+  std::string malformedFilename = CreateTempDirFilename ("malformed.csv");
+  //the worker of the first point writes its results to <output>.point0
+  m_malformedFilename = malformedFilename + ".point0";
+  malformedRunner.AddAxis ({"mode"}, {"malformed", "ok"});
+  malformedRunner.SetNWorkers (1);
+  NS_TEST_EXPECT_MSG_EQ (malformedRunner.Run (malformedFilename), 1, "Unexpected number of failures");
+  iss.clear ();
+  iss.str (ReadFile (malformedFilename));
+  lines.clear ();
+  while (std::getline (iss, line))
+    {
+      lines.push_back (line);
+    }
+  NS_TEST_ASSERT_MSG_EQ (lines.size (), 2, "Unexpected number of lines");
+  NS_TEST_EXPECT_MSG_EQ (lines[1].substr (0, 5), "1,ok,", "Unexpected row");
+}
+
+
+/**
+ * \ingroup sweep-runner-tests
+ * Check the command line handled by SweepRunner::Main.
+ */
+class SweepRunnerMainTestCase : public TestCase
+{
+public:
+  SweepRunnerMainTestCase ();
+
+  /**
+   * A scenario reporting the values it parsed with CommandLine.
+   *
+   * \param argc the number of command-line arguments
+   * \param argv the command-line arguments
+   * \return 0
+   */
+  static int Scenario (int argc, char *argv[]);
+
+  static std::string m_label; //!< the non-option argument parsed by the last run of the scenario
+  static uint32_t m_nDraws;   //!< the number of draws parsed by the last run of the scenario
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Run SweepRunner::Main with a command line.
+   *
+   * \param arguments the command-line arguments, after the program name
+   * \return the value returned by SweepRunner::Main
+   */
+  int RunMain (std::vector<std::string> arguments);
+};
+
+std::string SweepRunnerMainTestCase::m_label;
+uint32_t SweepRunnerMainTestCase::m_nDraws = 0;
+
+SweepRunnerMainTestCase::SweepRunnerMainTestCase ()
+  : TestCase ("Check the command line handled by SweepRunner::Main")
+{
+}
+
+int
+SweepRunnerMainTestCase::Scenario (int argc, char *argv[])
+{
+  std::string label;
+  uint32_t nDraws = 1;
+  CommandLine cmd;
+  cmd.AddValue ("nDraws", "Number of random variables created", nDraws);
+  cmd.AddNonOption ("label", "Label of the run", label);
+  cmd.Parse (argc, argv);
+
+  m_label = label;
+  m_nDraws = nDraws;
+  SweepRunner::AddResultRow ({{"label", label}, {"draws", std::to_string (nDraws)}});
+  return 0;
+}
+
+int
+SweepRunnerMainTestCase::RunMain (std::vector<std::string> arguments)
+{
+  arguments.insert (arguments.begin (), "sweep-runner-main");
+  std::vector<char *> argv;
+  for (auto & argument : arguments)
+    {
+      argv.push_back (&argument[0]);
+    }
+  argv.push_back (0);
+  return SweepRunner::Main (&SweepRunnerMainTestCase::Scenario, static_cast<int> (arguments.size ()), argv.data ());
+}
+
+void
+SweepRunnerMainTestCase::DoRun (void)
+{
+  std::string outputFilename = CreateTempDirFilename ("main.csv");
+
+  //without sweep, the scenario is run once with the arguments other than the --sweep options
+  m_label = "";
+  m_nDraws = 0;
+  NS_TEST_EXPECT_MSG_EQ (RunMain ({"-nDraws=2", "--sweepOutput=" + outputFilename, "single"}), 0, "Unexpected exit code");
+  NS_TEST_EXPECT_MSG_EQ (m_label, "single", "The non-option argument has not been passed");
+  NS_TEST_EXPECT_MSG_EQ (m_nDraws, 2, "The option has not been passed");
+
+  //with a sweep, the arguments are passed to every point, before the swept values
+  std::string specFilename = CreateTempDirFilename ("main.sweep");
+  std::ofstream spec (specFilename.c_str ());
+  spec << "set nDraws 5" << std::endl;
+  spec << "grid nDraws 3 4" << std::endl;
+  spec.close ();
+  NS_TEST_EXPECT_MSG_EQ (RunMain ({"--sweep=" + specFilename, "--nDraws=2", "swept", "-sweepOutput=" + outputFilename}),
+                         0, "Unexpected exit code");
+  std::ifstream is (outputFilename.c_str ());
+  std::string line;
+  std::vector<std::string> lines;
+  while (std::getline (is, line))
+    {
+      lines.push_back (line);
+    }
+  NS_TEST_ASSERT_MSG_EQ (lines.size (), 3, "Unexpected number of lines");
+  NS_TEST_EXPECT_MSG_EQ (lines[0], "point,nDraws,label,draws", "Unexpected header");
+  NS_TEST_EXPECT_MSG_EQ (lines[1], "0,3,swept,3", "Unexpected row");
+  NS_TEST_EXPECT_MSG_EQ (lines[2], "1,4,swept,4", "Unexpected row");
+}
+
+
+/**
+ * \ingroup sweep-runner-tests
+ * SweepRunner test suite.
+ */
+class SweepRunnerTestSuite : public TestSuite
+{
+public:
+  SweepRunnerTestSuite ()
+    : TestSuite ("sweep-runner")
+  {
+    AddTestCase (new SweepRunnerSpecTestCase ());
+    AddTestCase (new SweepRunnerResetTestCase ());
+    AddTestCase (new SweepRunnerForkTestCase ());
+    AddTestCase (new SweepRunnerMainTestCase ());
+  }
+};
+
+/**
+ * \ingroup sweep-runner-tests
+ * SweepRunnerTestSuite instance variable.
+ */
+static SweepRunnerTestSuite g_sweepRunnerTestSuite;
+
+
+  }  // namespace tests
+
+}  // namespace ns3
@@ -131,12 +131,13 @@ Mac48Address::ConvertFrom (const Address &address)
   address.CopyTo (retval.m_address);
   return retval;
 }
+uint64_t Mac48Address::m_allocationIndex = 0;
+
 Mac48Address 
 Mac48Address::Allocate (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
-  static uint64_t id = 0;
-  id++;
+  uint64_t id = ++m_allocationIndex;
   Mac48Address address;
   address.m_address[0] = (id >> 40) & 0xff;
   address.m_address[1] = (id >> 32) & 0xff;
@@ -146,6 +147,12 @@ Mac48Address::Allocate (void)
   address.m_address[5] = (id >> 0) & 0xff;
   return address;
 }
+void
+Mac48Address::ResetAllocationIndex (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  m_allocationIndex = 0;
+}
 uint8_t 
 Mac48Address::GetType (void)
 {
@@ -89,6 +89,13 @@ public:
    * \returns newly allocated mac48Address
    */
   static Mac48Address Allocate (void);
+  /**
+   * Reset the allocation index, so that the next allocated address is
+   * 00:00:00:00:00:01. This is meant for running several simulations in
+   * the same process (see SweepRunner); the addresses allocated before the
+   * reset must no longer be in use.
+   */
+  static void ResetAllocationIndex (void);
 
   /**
    * \returns true if this is a broadcast address, false otherwise.
@@ -195,6 +202,7 @@ private:
    */
   friend std::istream& operator>> (std::istream& is, Mac48Address & address);
 
+  static uint64_t m_allocationIndex; //!< index of the last allocated address
   uint8_t m_address[6]; //!< address value
 };
 
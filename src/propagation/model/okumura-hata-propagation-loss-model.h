@@ -82,6 +82,7 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual bool DoIsDeterministic (void) const;
   
   EnvironmentType m_environment;  //!< Environment Scenario
   CitySize m_citySize;  //!< Size of the city
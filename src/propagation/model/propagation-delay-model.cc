@@ -47,6 +47,12 @@ PropagationDelayModel::AssignStreams (int64_t stream)
   return DoAssignStreams (stream);
 }
 
+bool
+PropagationDelayModel::IsDeterministic (void) const
+{
+  return false;
+}
+
 // ------------------------------------------------------------------------- //
 
 NS_OBJECT_ENSURE_REGISTERED (RandomPropagationDelayModel);
@@ -113,6 +119,11 @@ ConstantSpeedPropagationDelayModel::GetDelay (Ptr<MobilityModel> a, Ptr<Mobility
   double seconds = distance / m_speed;
   return Seconds (seconds);
 }
+bool
+ConstantSpeedPropagationDelayModel::IsDeterministic (void) const
+{
+  return true;
+}
 void
 ConstantSpeedPropagationDelayModel::SetSpeed (double speed)
 {
@@ -62,6 +62,15 @@ public:
    * \return the number of stream indices assigned by this model
    */
   int64_t AssignStreams (int64_t stream);
+  /**
+   * Check whether the delay computed by this model only depends on the
+   * positions of the source and of the destination, in which case callers
+   * may cache the delay of a path as long as its end points do not move.
+   * The default is false.
+   *
+   * \return true if this delay model is deterministic
+   */
+  virtual bool IsDeterministic (void) const;
 private:
   /**
    * Subclasses must implement this; those not using random variables
@@ -114,6 +123,7 @@ public:
    */
   ConstantSpeedPropagationDelayModel ();
   virtual Time GetDelay (Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
+  virtual bool IsDeterministic (void) const;
   /**
    * \param speed the new speed (m/s)
    */
@@ -94,6 +94,22 @@ PropagationLossModel::AssignStreams (int64_t stream)
   return (currentStream - stream);
 }
 
+bool
+PropagationLossModel::IsDeterministic (void) const
+{
+  if (!DoIsDeterministic ())
+    {
+      return false;
+    }
+  return (m_next == 0 || m_next->IsDeterministic ());
+}
+
+bool
+PropagationLossModel::DoIsDeterministic (void) const
+{
+  return false;
+}
+
 // ------------------------------------------------------------------------- //
 
 NS_OBJECT_ENSURE_REGISTERED (RandomPropagationLossModel);
@@ -277,6 +293,12 @@ FriisPropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+bool
+FriisPropagationLossModel::DoIsDeterministic (void) const
+{
+  return true;
+}
+
 // ------------------------------------------------------------------------- //
 // -- Two-Ray Ground Model ported from NS-2 -- tomhewer@mac.com -- Nov09 //
 
@@ -451,6 +473,12 @@ TwoRayGroundPropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+bool
+TwoRayGroundPropagationLossModel::DoIsDeterministic (void) const
+{
+  return true;
+}
+
 // ------------------------------------------------------------------------- //
 
 NS_OBJECT_ENSURE_REGISTERED (LogDistancePropagationLossModel);
@@ -540,6 +568,12 @@ LogDistancePropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+bool
+LogDistancePropagationLossModel::DoIsDeterministic (void) const
+{
+  return true;
+}
+
 // ------------------------------------------------------------------------- //
 
 NS_OBJECT_ENSURE_REGISTERED (ThreeLogDistancePropagationLossModel);
@@ -642,6 +676,12 @@ ThreeLogDistancePropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+bool
+ThreeLogDistancePropagationLossModel::DoIsDeterministic (void) const
+{
+  return true;
+}
+
 // ------------------------------------------------------------------------- //
 
 NS_OBJECT_ENSURE_REGISTERED (NakagamiPropagationLossModel);
@@ -804,6 +844,12 @@ FixedRssLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+bool
+FixedRssLossModel::DoIsDeterministic (void) const
+{
+  return true;
+}
+
 // ------------------------------------------------------------------------- //
 
 NS_OBJECT_ENSURE_REGISTERED (MatrixPropagationLossModel);
@@ -884,6 +930,12 @@ MatrixPropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+bool
+MatrixPropagationLossModel::DoIsDeterministic (void) const
+{
+  return true;
+}
+
 // ------------------------------------------------------------------------- //
 
 NS_OBJECT_ENSURE_REGISTERED (RangePropagationLossModel);
@@ -930,6 +982,12 @@ RangePropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+bool
+RangePropagationLossModel::DoIsDeterministic (void) const
+{
+  return true;
+}
+
 // ------------------------------------------------------------------------- //
 
 } // namespace ns3
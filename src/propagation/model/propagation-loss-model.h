@@ -106,6 +106,16 @@ public:
    */
   int64_t AssignStreams (int64_t stream);
 
+  /**
+   * Check whether the loss computed by this model and by all the models
+   * chained to it only depends on the transmit power and on the positions
+   * of the source and of the destination, in which case callers may cache
+   * the loss of a path as long as its end points do not move.
+   *
+   * \return true if the chain of loss models is deterministic
+   */
+  bool IsDeterministic (void) const;
+
 private:
   /**
    * \brief Copy constructor
@@ -140,6 +150,15 @@ private:
    */
   virtual int64_t DoAssignStreams (int64_t stream) = 0;
 
+  /**
+   * Subclasses whose loss only depends on the transmit power and on the
+   * positions of the source and of the destination can override this
+   * to return true; the default is false.
+   *
+   * \return true if this particular model is deterministic
+   */
+  virtual bool DoIsDeterministic (void) const;
+
   Ptr<PropagationLossModel> m_next; //!< Next propagation loss model in the list
 };
 
@@ -322,6 +341,7 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual bool DoIsDeterministic (void) const;
 
   /**
    * Transforms a Dbm value to Watt
@@ -442,6 +462,7 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual bool DoIsDeterministic (void) const;
 
   /**
    * Transforms a Dbm value to Watt
@@ -530,6 +551,7 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual bool DoIsDeterministic (void) const;
 
   /**
    *  Creates a default reference loss model
@@ -613,6 +635,7 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual bool DoIsDeterministic (void) const;
 
   double m_distance0; //!< Beginning of the first (near) distance field
   double m_distance1; //!< Beginning of the second (middle) distance field.
@@ -747,6 +770,7 @@ private:
                                 Ptr<MobilityModel> b) const;
 
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual bool DoIsDeterministic (void) const;
   double m_rss; //!< the received signal strength
 };
 
@@ -806,6 +830,7 @@ private:
                                 Ptr<MobilityModel> b) const;
 
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual bool DoIsDeterministic (void) const;
 private:
   double m_default; //!< default loss
 
@@ -852,6 +877,7 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual bool DoIsDeterministic (void) const;
 private:
   double m_range; //!< Maximum Transmission Range (meters)
 };
@@ -0,0 +1,252 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 University of Washington
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Sébastien Deronne <sebastien.deronne@gmail.com>
+ */
+#ifndef PROPAGATION_PATH_CACHE_H
+#define PROPAGATION_PATH_CACHE_H
+
+#include "ns3/mobility-model.h"
+#include "ns3/callback.h"
+#include <functional>
+#include <unordered_map>
+
+namespace ns3
+{
+/**
+ * \ingroup propagation
+ * \brief Hash-based cache of the data computed by a channel for the path
+ * between a transmitter and a receiver.
+ *
+ * Unlike PropagationCache, a path is directed and identified by a couple
+ * of opaque end points (typically, the transmitting and receiving PHYs),
+ * and the cached data is invalidated whenever the CourseChange trace of
+ * the mobility model of either end point fires. Paths whose end points
+ * are moving (i.e., have a non-null velocity) are never cached, because
+ * their position changes without notification.
+ *
+ * Users are responsible for only caching data that are a deterministic
+ * function of the positions of the end points (see, e.g.,
+ * PropagationLossModel::IsDeterministic) and for calling Clear whenever
+ * the models used to compute the data are reconfigured.
+ */
+template<class T>
+class PropagationPathCache
+{
+public:
+  PropagationPathCache () {};
+  ~PropagationPathCache ()
+  {
+    Clear ();
+  };
+
+  /**
+   * Get the data cached for a path
+   * \param tx the transmitting end point
+   * \param rx the receiving end point
+   * \param txMobility the mobility model of the transmitting end point
+   * \param rxMobility the mobility model of the receiving end point
+   * \return the cached data, or 0 if none is cached or if either end point
+   *         has changed course since the data was added
+   */
+  T * Lookup (const void *tx, const void *rx, Ptr<const MobilityModel> txMobility, Ptr<const MobilityModel> rxMobility)
+  {
+    typename PathMap::iterator it = m_paths.find (PathIdentifier (tx, rx));
+    if (it == m_paths.end ())
+      {
+        return 0;
+      }
+    const Path &path = it->second;
+    if (path.txMobility != PeekPointer (txMobility) || path.rxMobility != PeekPointer (rxMobility)
+        || *path.txCourse != path.txCourseSeen || *path.rxCourse != path.rxCourseSeen)
+      {
+        return 0;
+      }
+    return &it->second.data;
+  };
+
+  /**
+   * Cache the data of a path, replacing the data previously cached for
+   * the path if any. Nothing is cached if either end point is moving.
+   * \param tx the transmitting end point
+   * \param rx the receiving end point
+   * \param txMobility the mobility model of the transmitting end point
+   * \param rxMobility the mobility model of the receiving end point
+   * \param data the data to cache
+   */
+  void Add (const void *tx, const void *rx, Ptr<MobilityModel> txMobility, Ptr<MobilityModel> rxMobility, const T &data)
+  {
+    if (IsMoving (txMobility) || IsMoving (rxMobility))
+      {
+        return;
+      }
+    Path &path = m_paths[PathIdentifier (tx, rx)];
+    path.txMobility = PeekPointer (txMobility);
+    path.rxMobility = PeekPointer (rxMobility);
+    path.txCourse = Track (txMobility);
+    path.rxCourse = Track (rxMobility);
+    path.txCourseSeen = *path.txCourse;
+    path.rxCourseSeen = *path.rxCourse;
+    path.data = data;
+  };
+
+  /**
+   * Remove all the cached paths and stop tracking the mobility models
+   */
+  void Clear (void)
+  {
+    for (typename MobilityMap::iterator it = m_mobilities.begin (); it != m_mobilities.end (); ++it)
+      {
+        it->second.mobility->TraceDisconnectWithoutContext ("CourseChange", MakeCallback (&PropagationPathCache<T>::NotifyCourseChange, this));
+      }
+    m_mobilities.clear ();
+    m_paths.clear ();
+  };
+
+  /**
+   * \return the number of cached paths, including the invalidated ones
+   */
+  std::size_t GetSize (void) const
+  {
+    return m_paths.size ();
+  };
+
+private:
+  /**
+   * \brief Copy constructor
+   *
+   * Defined and unimplemented to avoid misuse
+   */
+  PropagationPathCache (const PropagationPathCache &);
+  /**
+   * \brief Copy constructor
+   *
+   * Defined and unimplemented to avoid misuse
+   * \returns
+   */
+  PropagationPathCache &operator = (const PropagationPathCache &);
+
+  /**
+   * \param mobility a mobility model
+   * \return true if the mobility model has a non-null velocity
+   */
+  static bool IsMoving (Ptr<const MobilityModel> mobility)
+  {
+    Vector velocity = mobility->GetVelocity ();
+    return (velocity.x != 0 || velocity.y != 0 || velocity.z != 0);
+  };
+
+  /**
+   * Start tracking the course changes of a mobility model, if not done yet
+   * \param mobility the mobility model
+   * \return a pointer to the number of course changes of the mobility model
+   */
+  const uint64_t * Track (Ptr<MobilityModel> mobility)
+  {
+    typename MobilityMap::iterator it = m_mobilities.find (PeekPointer (mobility));
+    if (it == m_mobilities.end ())
+      {
+        mobility->TraceConnectWithoutContext ("CourseChange", MakeCallback (&PropagationPathCache<T>::NotifyCourseChange, this));
+        it = m_mobilities.insert (std::make_pair (PeekPointer (mobility), MobilityInfo ())).first;
+        it->second.mobility = mobility;
+        it->second.courseChanges = 0;
+      }
+    return &it->second.courseChanges;
+  };
+
+  /**
+   * Invalidate the paths of the end points using a mobility model
+   * \param mobility the mobility model whose course changed
+   */
+  void NotifyCourseChange (Ptr<const MobilityModel> mobility)
+  {
+    typename MobilityMap::iterator it = m_mobilities.find (PeekPointer (mobility));
+    if (it != m_mobilities.end ())
+      {
+        it->second.courseChanges++;
+      }
+  };
+
+  /// Each path is identified by its end points
+  struct PathIdentifier
+  {
+    /**
+     * Constructor
+     * @param tx the transmitting end point
+     * @param rx the receiving end point
+     */
+    PathIdentifier (const void *tx, const void *rx) :
+      m_tx (tx), m_rx (rx)
+    {};
+    const void *m_tx; //!< the transmitting end point
+    const void *m_rx; //!< the receiving end point
+
+    /**
+     * Equality operator.
+     * \param other Right value of the operator.
+     * \returns True if both paths have the same end points.
+     */
+    bool operator == (const PathIdentifier & other) const
+    {
+      return m_tx == other.m_tx && m_rx == other.m_rx;
+    }
+  };
+
+  /// Hash function of a PathIdentifier
+  struct PathIdentifierHash
+  {
+    /**
+     * \param id the path identifier
+     * \return the hash of the path identifier
+     */
+    std::size_t operator () (const PathIdentifier &id) const
+    {
+      std::size_t h = std::hash<const void *> () (id.m_tx);
+      return h ^ (std::hash<const void *> () (id.m_rx) + 0x9e3779b9 + (h << 6) + (h >> 2));
+    }
+  };
+
+  /// A cached path
+  struct Path
+  {
+    const MobilityModel *txMobility; //!< the mobility model of the transmitting end point
+    const MobilityModel *rxMobility; //!< the mobility model of the receiving end point
+    const uint64_t *txCourse;        //!< the number of course changes of txMobility
+    const uint64_t *rxCourse;        //!< the number of course changes of rxMobility
+    uint64_t txCourseSeen;           //!< the number of course changes of txMobility when the data was cached
+    uint64_t rxCourseSeen;           //!< the number of course changes of rxMobility when the data was cached
+    T data;                          //!< the cached data
+  };
+
+  /// A tracked mobility model
+  struct MobilityInfo
+  {
+    Ptr<MobilityModel> mobility; //!< the mobility model
+    uint64_t courseChanges;      //!< the number of course changes notified so far
+  };
+
+  /// Typedef: PathIdentifier, Path
+  typedef std::unordered_map<PathIdentifier, Path, PathIdentifierHash> PathMap;
+  /// Typedef: mobility model, MobilityInfo
+  typedef std::unordered_map<const MobilityModel *, MobilityInfo> MobilityMap;
+
+  PathMap m_paths;           //!< the cached paths
+  MobilityMap m_mobilities;  //!< the tracked mobility models
+};
+} // namespace ns3
+
+#endif // PROPAGATION_PATH_CACHE_H
@@ -29,7 +29,9 @@
 #include <ns3/net-device.h>
 #include <ns3/node.h>
 #include <ns3/double.h>
+#include <ns3/boolean.h>
 #include <ns3/mobility-model.h>
+#include <ns3/constant-position-mobility-model.h>
 #include <ns3/spectrum-phy.h>
 #include <ns3/spectrum-converter.h>
 #include <ns3/spectrum-propagation-loss-model.h>
@@ -79,7 +81,15 @@ RxSpectrumModelInfo::RxSpectrumModelInfo (Ptr<const SpectrumModel> rxSpectrumMod
 }
 
 MultiModelSpectrumChannel::MultiModelSpectrumChannel ()
-  : m_numDevices {0}
+  : m_numDevices {0},
+    m_shareTxPsd (true),
+    m_spatialIndex (false),
+    m_maxRange (0),
+    m_derivedMaxRange (0),
+    m_derivedMaxRangeMaxLossDb (0),
+    m_rxSequence (0),
+    m_cachePaths (false),
+    m_pathCacheMaxLossDb (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -90,6 +100,12 @@ MultiModelSpectrumChannel::DoDispose ()
   NS_LOG_FUNCTION (this);
   m_txSpectrumModelInfoMap.clear ();
   m_rxSpectrumModelInfoMap.clear ();
+  m_receiverGrid.Clear ();
+  m_candidates.clear ();
+  m_derivedMaxRangeLossModel = 0;
+  m_pathCache.Clear ();
+  m_pathCacheLossModel = 0;
+  m_pathCacheDelayModel = 0;
   SpectrumChannel::DoDispose ();
 }
 
@@ -100,7 +116,39 @@ MultiModelSpectrumChannel::GetTypeId (void)
     .SetParent<SpectrumChannel> ()
     .SetGroupName ("Spectrum")
     .AddConstructor<MultiModelSpectrumChannel> ()
-
+    .AddAttribute ("ShareTxPsd",
+                   "If true, receivers supporting it get the transmitted PSD shared "
+                   "between all the receivers together with a per-receiver scalar gain, "
+                   "instead of a private copy scaled by the path gain.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&MultiModelSpectrumChannel::m_shareTxPsd),
+                   MakeBooleanChecker ())
+    .AddAttribute ("SpatialIndex",
+                   "If true, receivers are indexed by position in a uniform grid and "
+                   "the receivers located beyond the maximum range of a transmitter "
+                   "are skipped without computing their loss.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&MultiModelSpectrumChannel::m_spatialIndex),
+                   MakeBooleanChecker ())
+    .AddAttribute ("MaxRange",
+                   "The maximum distance (m) at which a receiver can receive a signal, "
+                   "used when SpatialIndex is true. If 0, it is derived from MaxLossDb "
+                   "and the PropagationLossModel, assuming that the loss is deterministic, "
+                   "only depends on and increases with the distance, and that the antenna "
+                   "gains do not exceed 0 dBi; this value must be set explicitly otherwise. "
+                   "No receiver is culled if it is 0 and the PropagationLossModel is not "
+                   "deterministic.",
+                   DoubleValue (0),
+                   MakeDoubleAccessor (&MultiModelSpectrumChannel::m_maxRange),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("CachePaths",
+                   "If true and the propagation loss and delay models are deterministic, "
+                   "the antenna gains, propagation loss and delay between a transmitter "
+                   "and a receiver are cached until either of them changes course. The "
+                   "models must not be reconfigured during the simulation.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&MultiModelSpectrumChannel::m_cachePaths),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
@@ -134,6 +182,8 @@ MultiModelSpectrumChannel::AddRx (Ptr<SpectrumPhy> phy)
     }
 
   ++m_numDevices;
+  // the key preserves the order in which receivers are visited by StartTx
+  m_receiverGrid.Add (phy, (static_cast<uint64_t> (rxSpectrumModelUid) << 32) | m_rxSequence++);
 
   RxSpectrumModelInfoMap_t::iterator rxInfoIterator = m_rxSpectrumModelInfoMap.find (rxSpectrumModelUid);
 
@@ -221,6 +271,7 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
   NS_ASSERT (txParams->txPhy);
   NS_ASSERT (txParams->psd);
   Ptr<SpectrumSignalParameters> txParamsTrace = txParams->Copy (); // copy it since traced value cannot be const (because of potential underlying DynamicCasts)
+  txParamsTrace->MaterializePsd ();
   m_txSigParamsTrace (txParamsTrace);
 
   Ptr<MobilityModel> txMobility = txParams->txPhy->GetMobility ();
@@ -235,6 +286,39 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
   NS_LOG_LOGIC ("converter map size: " << txInfoIteratorerator->second.m_spectrumConverterMap.size ());
   NS_LOG_LOGIC ("converter map first element: " << txInfoIteratorerator->second.m_spectrumConverterMap.begin ()->first);
 
+  bool usePathCache = CheckPathCache ();
+  double maxRange = m_spatialIndex ? GetMaxRange () : 0;
+  if (txMobility && maxRange > 0)
+    {
+      // only visit the receivers that may be within range, in the same order
+      // as the loop below (i.e., by RX SpectrumModel, then by order of addition)
+      if (m_receiverGrid.GetCellSize () != maxRange)
+        {
+          m_receiverGrid.SetCellSize (maxRange);
+        }
+      m_receiverGrid.GetCandidates (txMobility->GetPosition (), maxRange, m_candidates);
+      NS_LOG_LOGIC (m_candidates.size () << " candidate receivers out of " << m_numDevices << " within " << maxRange << " m");
+      SpectrumModelUid_t rxSpectrumModelUid = 0;
+      Ptr<SpectrumValue> convertedTxPowerSpectrum;
+      for (std::vector<Ptr<SpectrumPhy> >::const_iterator rxPhyIterator = m_candidates.begin ();
+           rxPhyIterator != m_candidates.end ();
+           ++rxPhyIterator)
+        {
+          SpectrumModelUid_t uid = (*rxPhyIterator)->GetRxSpectrumModel ()->GetUid ();
+          if (uid != rxSpectrumModelUid || rxPhyIterator == m_candidates.begin ())
+            {
+              rxSpectrumModelUid = uid;
+              convertedTxPowerSpectrum = ConvertTxPowerSpectrum (txParams->psd, txInfoIteratorerator, rxSpectrumModelUid);
+            }
+          if (convertedTxPowerSpectrum)
+            {
+              StartTxToReceiver (txParams, convertedTxPowerSpectrum, txMobility, *rxPhyIterator, usePathCache);
+            }
+        }
+      m_candidates.clear ();
+      return;
+    }
+
   for (RxSpectrumModelInfoMap_t::const_iterator rxInfoIterator = m_rxSpectrumModelInfoMap.begin ();
        rxInfoIterator != m_rxSpectrumModelInfoMap.end ();
        ++rxInfoIterator)
@@ -242,22 +326,10 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
       SpectrumModelUid_t rxSpectrumModelUid = rxInfoIterator->second.m_rxSpectrumModel->GetUid ();
       NS_LOG_LOGIC ("rxSpectrumModelUids " << rxSpectrumModelUid);
 
-      Ptr <SpectrumValue> convertedTxPowerSpectrum;
-      if (txSpectrumModelUid == rxSpectrumModelUid)
+      Ptr <SpectrumValue> convertedTxPowerSpectrum = ConvertTxPowerSpectrum (txParams->psd, txInfoIteratorerator, rxSpectrumModelUid);
+      if (convertedTxPowerSpectrum == 0)
         {
-          NS_LOG_LOGIC ("no spectrum conversion needed");
-          convertedTxPowerSpectrum = txParams->psd;
-        }
-      else
-        {
-          NS_LOG_LOGIC ("converting txPowerSpectrum SpectrumModelUids" << txSpectrumModelUid << " --> " << rxSpectrumModelUid);
-          SpectrumConverterMap_t::const_iterator rxConverterIterator = txInfoIteratorerator->second.m_spectrumConverterMap.find (rxSpectrumModelUid);
-          if (rxConverterIterator == txInfoIteratorerator->second.m_spectrumConverterMap.end ())
-            {
-              // No converter means TX SpectrumModel is orthogonal to RX SpectrumModel
-              continue;
-            }
-          convertedTxPowerSpectrum = rxConverterIterator->second.Convert (txParams->psd);
+          continue;
         }
 
       for (auto rxPhyIterator = rxInfoIterator->second.m_rxPhys.begin ();
@@ -266,86 +338,251 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
         {
           NS_ASSERT_MSG ((*rxPhyIterator)->GetRxSpectrumModel ()->GetUid () == rxSpectrumModelUid,
                          "SpectrumModel change was not notified to MultiModelSpectrumChannel (i.e., AddRx should be called again after model is changed)");
+          StartTxToReceiver (txParams, convertedTxPowerSpectrum, txMobility, *rxPhyIterator, usePathCache);
+        }
+    }
+}
 
-          if ((*rxPhyIterator) != txParams->txPhy)
+Ptr<SpectrumValue>
+MultiModelSpectrumChannel::ConvertTxPowerSpectrum (Ptr<SpectrumValue> txPsd,
+                                                   TxSpectrumModelInfoMap_t::const_iterator txInfoIterator,
+                                                   SpectrumModelUid_t rxSpectrumModelUid) const
+{
+  if (txPsd->GetSpectrumModelUid () == rxSpectrumModelUid)
+    {
+      NS_LOG_LOGIC ("no spectrum conversion needed");
+      return txPsd;
+    }
+  NS_LOG_LOGIC ("converting txPowerSpectrum SpectrumModelUids" << txPsd->GetSpectrumModelUid () << " --> " << rxSpectrumModelUid);
+  SpectrumConverterMap_t::const_iterator rxConverterIterator = txInfoIterator->second.m_spectrumConverterMap.find (rxSpectrumModelUid);
+  if (rxConverterIterator == txInfoIterator->second.m_spectrumConverterMap.end ())
+    {
+      // No converter means TX SpectrumModel is orthogonal to RX SpectrumModel
+      return 0;
+    }
+  return rxConverterIterator->second.Convert (txPsd);
+}
+
+void
+MultiModelSpectrumChannel::StartTxToReceiver (Ptr<SpectrumSignalParameters> txParams, Ptr<SpectrumValue> convertedTxPowerSpectrum,
+                                              Ptr<MobilityModel> txMobility, Ptr<SpectrumPhy> rxPhy, bool usePathCache)
+{
+  if (rxPhy == txParams->txPhy)
+    {
+      return;
+    }
+  NS_LOG_LOGIC ("copying signal parameters " << txParams);
+  Ptr<SpectrumSignalParameters> rxParams = txParams->Copy ();
+  rxParams->psd = convertedTxPowerSpectrum;
+  bool sharePsd = m_shareTxPsd && !m_spectrumPropagationLoss && rxPhy->IsSharedPsdSupported ();
+  if (!sharePsd)
+    {
+      rxParams->MaterializePsd ();
+    }
+  Time delay = MicroSeconds (0);
+
+  Ptr<MobilityModel> receiverMobility = rxPhy->GetMobility ();
+
+  if (txMobility && receiverMobility)
+    {
+      Ptr<AntennaModel> rxAntenna = rxPhy->GetRxAntenna ();
+      PathData *path = 0;
+      PathData computedPath;
+      if (usePathCache)
+        {
+          path = m_pathCache.Lookup (PeekPointer (txParams->txPhy), PeekPointer (rxPhy), txMobility, receiverMobility);
+          if (path != 0 && (path->txAntenna != PeekPointer (rxParams->txAntenna) || path->rxAntenna != PeekPointer (rxAntenna)))
+            {
+              path = 0;
+            }
+        }
+      if (path == 0)
+        {
+          computedPath = ComputePath (rxParams->txAntenna, txMobility, rxAntenna, receiverMobility);
+          if (usePathCache)
             {
-              NS_LOG_LOGIC ("copying signal parameters " << txParams);
-              Ptr<SpectrumSignalParameters> rxParams = txParams->Copy ();
-              rxParams->psd = Copy<SpectrumValue> (convertedTxPowerSpectrum);
-              Time delay = MicroSeconds (0);
-
-              Ptr<MobilityModel> receiverMobility = (*rxPhyIterator)->GetMobility ();
-
-              if (txMobility && receiverMobility)
-                {
-                  double txAntennaGain = 0;
-                  double rxAntennaGain = 0;
-                  double propagationGainDb = 0;
-                  double pathLossDb = 0;
-                  if (rxParams->txAntenna != 0)
-                    {
-                      Angles txAngles (receiverMobility->GetPosition (), txMobility->GetPosition ());
-                      txAntennaGain = rxParams->txAntenna->GetGainDb (txAngles);
-                      NS_LOG_LOGIC ("txAntennaGain = " << txAntennaGain << " dB");
-                      pathLossDb -= txAntennaGain;
-                    }
-                  Ptr<AntennaModel> rxAntenna = (*rxPhyIterator)->GetRxAntenna ();
-                  if (rxAntenna != 0)
-                    {
-                      Angles rxAngles (txMobility->GetPosition (), receiverMobility->GetPosition ());
-                      rxAntennaGain = rxAntenna->GetGainDb (rxAngles);
-                      NS_LOG_LOGIC ("rxAntennaGain = " << rxAntennaGain << " dB");
-                      pathLossDb -= rxAntennaGain;
-                    }
-                  if (m_propagationLoss)
-                    {
-                      propagationGainDb = m_propagationLoss->CalcRxPower (0, txMobility, receiverMobility);
-                      NS_LOG_LOGIC ("propagationGainDb = " << propagationGainDb << " dB");
-                      pathLossDb -= propagationGainDb;
-                    }                    
-                  NS_LOG_LOGIC ("total pathLoss = " << pathLossDb << " dB");
-                  // Gain trace
-                  m_gainTrace (txMobility, receiverMobility, txAntennaGain, rxAntennaGain, propagationGainDb, pathLossDb);
-                  // Pathloss trace
-                  m_pathLossTrace (txParams->txPhy, *rxPhyIterator, pathLossDb);
-                  if (pathLossDb > m_maxLossDb)
-                    {
-                      // beyond range
-                      continue;
-                    }
-                  double pathGainLinear = std::pow (10.0, (-pathLossDb) / 10.0);
-                  *(rxParams->psd) *= pathGainLinear;              
-
-                  if (m_spectrumPropagationLoss)
-                    {
-                      rxParams->psd = m_spectrumPropagationLoss->CalcRxPowerSpectralDensity (rxParams->psd, txMobility, receiverMobility);
-                    }
-
-                  if (m_propagationDelay)
-                    {
-                      delay = m_propagationDelay->GetDelay (txMobility, receiverMobility);
-                    }
-                }
-
-              Ptr<NetDevice> netDev = (*rxPhyIterator)->GetDevice ();
-              if (netDev)
-                {
-                  // the receiver has a NetDevice, so we expect that it is attached to a Node
-                  uint32_t dstNode =  netDev->GetNode ()->GetId ();
-                  Simulator::ScheduleWithContext (dstNode, delay, &MultiModelSpectrumChannel::StartRx, this,
-                                                  rxParams, *rxPhyIterator);
-                }
-              else
-                {
-                  // the receiver is not attached to a NetDevice, so we cannot assume that it is attached to a node
-                  Simulator::Schedule (delay, &MultiModelSpectrumChannel::StartRx, this,
-                                       rxParams, *rxPhyIterator);
-                }
+              m_pathCache.Add (PeekPointer (txParams->txPhy), PeekPointer (rxPhy), txMobility, receiverMobility, computedPath);
             }
+          path = &computedPath;
+        }
+      else
+        {
+          NS_LOG_LOGIC ("using cached path loss = " << path->pathLossDb << " dB");
+        }
+      // Gain trace
+      m_gainTrace (txMobility, receiverMobility, path->txAntennaGainDb, path->rxAntennaGainDb, path->propagationGainDb, path->pathLossDb);
+      // Pathloss trace
+      m_pathLossTrace (txParams->txPhy, rxPhy, path->pathLossDb);
+      if (path->skip)
+        {
+          // beyond range
+          return;
+        }
+      if (sharePsd)
+        {
+          rxParams->psdGain *= path->pathGainLinear;
+        }
+      else
+        {
+          *(rxParams->psd) *= path->pathGainLinear;
         }
 
+      if (m_spectrumPropagationLoss)
+        {
+          rxParams->psd = m_spectrumPropagationLoss->CalcRxPowerSpectralDensity (rxParams->psd, txMobility, receiverMobility);
+        }
+
+      delay = path->delay;
+    }
+
+  Ptr<NetDevice> netDev = rxPhy->GetDevice ();
+  if (netDev)
+    {
+      // the receiver has a NetDevice, so we expect that it is attached to a Node
+      uint32_t dstNode =  netDev->GetNode ()->GetId ();
+      Simulator::ScheduleWithContext (dstNode, delay, &MultiModelSpectrumChannel::StartRx, this,
+                                      rxParams, rxPhy);
+    }
+  else
+    {
+      // the receiver is not attached to a NetDevice, so we cannot assume that it is attached to a node
+      Simulator::Schedule (delay, &MultiModelSpectrumChannel::StartRx, this,
+                           rxParams, rxPhy);
+    }
+}
+
+MultiModelSpectrumChannel::PathData
+MultiModelSpectrumChannel::ComputePath (Ptr<AntennaModel> txAntenna, Ptr<MobilityModel> txMobility,
+                                        Ptr<AntennaModel> rxAntenna, Ptr<MobilityModel> rxMobility) const
+{
+  PathData path;
+  path.txAntenna = PeekPointer (txAntenna);
+  path.rxAntenna = PeekPointer (rxAntenna);
+  path.txAntennaGainDb = 0;
+  path.rxAntennaGainDb = 0;
+  path.propagationGainDb = 0;
+  path.pathLossDb = 0;
+  if (txAntenna != 0)
+    {
+      Angles txAngles (rxMobility->GetPosition (), txMobility->GetPosition ());
+      path.txAntennaGainDb = txAntenna->GetGainDb (txAngles);
+      NS_LOG_LOGIC ("txAntennaGain = " << path.txAntennaGainDb << " dB");
+      path.pathLossDb -= path.txAntennaGainDb;
+    }
+  if (rxAntenna != 0)
+    {
+      Angles rxAngles (txMobility->GetPosition (), rxMobility->GetPosition ());
+      path.rxAntennaGainDb = rxAntenna->GetGainDb (rxAngles);
+      NS_LOG_LOGIC ("rxAntennaGain = " << path.rxAntennaGainDb << " dB");
+      path.pathLossDb -= path.rxAntennaGainDb;
+    }
+  if (m_propagationLoss)
+    {
+      path.propagationGainDb = m_propagationLoss->CalcRxPower (0, txMobility, rxMobility);
+      NS_LOG_LOGIC ("propagationGainDb = " << path.propagationGainDb << " dB");
+      path.pathLossDb -= path.propagationGainDb;
+    }
+  NS_LOG_LOGIC ("total pathLoss = " << path.pathLossDb << " dB");
+  path.skip = (path.pathLossDb > m_maxLossDb);
+  path.pathGainLinear = 0;
+  path.delay = MicroSeconds (0);
+  if (!path.skip)
+    {
+      path.pathGainLinear = std::pow (10.0, (-path.pathLossDb) / 10.0);
+      if (m_propagationDelay)
+        {
+          path.delay = m_propagationDelay->GetDelay (txMobility, rxMobility);
+        }
+    }
+  return path;
+}
+
+bool
+MultiModelSpectrumChannel::CheckPathCache (void)
+{
+  if (!m_cachePaths
+      || (m_propagationLoss && !m_propagationLoss->IsDeterministic ())
+      || (m_propagationDelay && !m_propagationDelay->IsDeterministic ()))
+    {
+      return false;
     }
+  if (m_pathCacheLossModel != m_propagationLoss || m_pathCacheDelayModel != m_propagationDelay
+      || m_pathCacheMaxLossDb != m_maxLossDb)
+    {
+      NS_LOG_DEBUG ("Dropping " << m_pathCache.GetSize () << " cached paths");
+      m_pathCache.Clear ();
+      m_pathCacheLossModel = m_propagationLoss;
+      m_pathCacheDelayModel = m_propagationDelay;
+      m_pathCacheMaxLossDb = m_maxLossDb;
+    }
+  return true;
+}
 
+double
+MultiModelSpectrumChannel::GetMaxRange (void)
+{
+  if (m_maxRange > 0)
+    {
+      return m_maxRange;
+    }
+  if (m_derivedMaxRangeLossModel != m_propagationLoss || m_derivedMaxRangeMaxLossDb != m_maxLossDb)
+    {
+      m_derivedMaxRange = DeriveMaxRange ();
+      m_derivedMaxRangeLossModel = m_propagationLoss;
+      m_derivedMaxRangeMaxLossDb = m_maxLossDb;
+      NS_LOG_DEBUG ("Maximum range derived from MaxLossDb=" << m_maxLossDb << " dB: " << m_derivedMaxRange << " m");
+    }
+  return m_derivedMaxRange;
+}
+
+double
+MultiModelSpectrumChannel::DeriveMaxRange (void) const
+{
+  if (m_propagationLoss == 0)
+    {
+      return 0;
+    }
+  if (!m_propagationLoss->IsDeterministic ())
+    {
+      // probing the loss model would draw random variates, and the range
+      // derived from a single draw would cull receivers that other draws reach
+      NS_LOG_WARN ("Not culling receivers: MaxRange must be set to use SpatialIndex with a non-deterministic PropagationLossModel");
+      return 0;
+    }
+  Ptr<ConstantPositionMobilityModel> a = CreateObject<ConstantPositionMobilityModel> ();
+  Ptr<ConstantPositionMobilityModel> b = CreateObject<ConstantPositionMobilityModel> ();
+  a->SetPosition (Vector (0, 0, 0));
+  // find a distance at which the loss exceeds MaxLossDb
+  const double maxDistance = 1e7;
+  double lowDistance = 0;
+  double highDistance = 1;
+  b->SetPosition (Vector (highDistance, 0, 0));
+  while (-m_propagationLoss->CalcRxPower (0, a, b) <= m_maxLossDb)
+    {
+      lowDistance = highDistance;
+      highDistance *= 2;
+      if (highDistance > maxDistance)
+        {
+          // receivers are always within range
+          return 0;
+        }
+      b->SetPosition (Vector (highDistance, 0, 0));
+    }
+  // then refine by bisection, keeping a distance at which the loss exceeds MaxLossDb
+  while (highDistance - lowDistance > 1e-3 * highDistance)
+    {
+      double distance = (lowDistance + highDistance) / 2;
+      b->SetPosition (Vector (distance, 0, 0));
+      if (-m_propagationLoss->CalcRxPower (0, a, b) <= m_maxLossDb)
+        {
+          lowDistance = distance;
+        }
+      else
+        {
+          highDistance = distance;
+        }
+    }
+  return highDistance;
 }
 
 void
@@ -27,6 +27,8 @@
 #include <ns3/spectrum-channel.h>
 #include <ns3/spectrum-propagation-loss-model.h>
 #include <ns3/propagation-delay-model.h>
+#include <ns3/propagation-path-cache.h>
+#include <ns3/spectrum-receiver-grid.h>
 #include <map>
 #include <set>
 
@@ -102,6 +104,26 @@ typedef std::map<SpectrumModelUid_t, RxSpectrumModelInfo> RxSpectrumModelInfoMap
  * for this to work is that, after the SpectrumPhy switched its
  * SpectrumModel,  MultiModelSpectrumChannel::AddRx () is
  * called again passing the pointer to that SpectrumPhy.
+ *
+ * \note Unless the ShareTxPsd attribute is disabled, receivers supporting
+ * shared PSDs (see SpectrumPhy::IsSharedPsdSupported) are handed the
+ * transmitted PSD (converted to their SpectrumModel if needed) together
+ * with a scalar gain, rather than a scaled copy of it. A private copy is
+ * still made for the other receivers and whenever a
+ * SpectrumPropagationLossModel is configured, since such a model shapes
+ * the PSD per receiver.
+ *
+ * \note If the SpatialIndex attribute is enabled, receivers are indexed
+ * by position and the receivers located beyond the maximum range of a
+ * transmitter (see the MaxRange attribute) are skipped without computing
+ * their loss, hence without firing the PathLoss and Gain traces for them.
+ *
+ * \note If the CachePaths attribute is enabled and the propagation loss
+ * and delay models are deterministic (see
+ * PropagationLossModel::IsDeterministic), the antenna gains, propagation
+ * loss and delay of each path are computed once and reused until either
+ * end point changes course. The models must then not be reconfigured
+ * during the simulation.
  */
 class MultiModelSpectrumChannel : public SpectrumChannel
 {
@@ -149,6 +171,78 @@ private:
    */
   virtual void StartRx (Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver);
 
+  /**
+   * Convert the PSD of a transmitted signal to a RX SpectrumModel
+   *
+   * \param txPsd the PSD of the transmitted signal
+   * \param txInfoIterator the entry of the TX SpectrumModel of the signal
+   * \param rxSpectrumModelUid the UID of the RX SpectrumModel
+   * \return the converted PSD, or 0 if the SpectrumModels are orthogonal
+   */
+  Ptr<SpectrumValue> ConvertTxPowerSpectrum (Ptr<SpectrumValue> txPsd,
+                                             TxSpectrumModelInfoMap_t::const_iterator txInfoIterator,
+                                             SpectrumModelUid_t rxSpectrumModelUid) const;
+
+  /**
+   * Compute the loss between the transmitter and a receiver and, if the
+   * receiver is within range, schedule the reception of the signal.
+   *
+   * \param txParams the parameters of the transmitted signal
+   * \param convertedTxPowerSpectrum the transmitted PSD converted to the RX SpectrumModel
+   * \param txMobility the mobility model of the transmitter
+   * \param rxPhy the receiver
+   */
+  void StartTxToReceiver (Ptr<SpectrumSignalParameters> txParams, Ptr<SpectrumValue> convertedTxPowerSpectrum,
+                          Ptr<MobilityModel> txMobility, Ptr<SpectrumPhy> rxPhy, bool usePathCache);
+
+  /// The gains and delay of the path between a transmitter and a receiver
+  struct PathData
+  {
+    const AntennaModel *txAntenna; //!< the TX antenna the gains were computed for
+    const AntennaModel *rxAntenna; //!< the RX antenna the gains were computed for
+    double txAntennaGainDb;        //!< the TX antenna gain (dB)
+    double rxAntennaGainDb;        //!< the RX antenna gain (dB)
+    double propagationGainDb;      //!< the propagation gain (dB)
+    double pathLossDb;             //!< the total path loss (dB)
+    double pathGainLinear;         //!< the total path gain (linear)
+    bool skip;                     //!< whether the path loss exceeds MaxLossDb
+    Time delay;                    //!< the propagation delay
+  };
+
+  /**
+   * Compute the gains and delay of the path between a transmitter and a receiver
+   *
+   * \param txAntenna the TX antenna, if any
+   * \param txMobility the mobility model of the transmitter
+   * \param rxAntenna the RX antenna, if any
+   * \param rxMobility the mobility model of the receiver
+   * \return the gains and delay of the path
+   */
+  PathData ComputePath (Ptr<AntennaModel> txAntenna, Ptr<MobilityModel> txMobility,
+                        Ptr<AntennaModel> rxAntenna, Ptr<MobilityModel> rxMobility) const;
+
+  /**
+   * Check whether paths can be cached, and drop the cached paths if the
+   * models they were computed with have changed.
+   *
+   * \return true if the path cache can be used
+   */
+  bool CheckPathCache (void);
+
+  /**
+   * \return the maximum range (m) used by the spatial index, 0 if unlimited
+   */
+  double GetMaxRange (void);
+
+  /**
+   * Derive the distance beyond which the loss computed by the propagation
+   * loss model exceeds MaxLossDb. The range is unlimited if the propagation
+   * loss model is not deterministic.
+   *
+   * \return the derived maximum range (m), 0 if unlimited
+   */
+  double DeriveMaxRange (void) const;
+
   /**
    * Data structure holding, for each TX SpectrumModel,  all the
    * converters to any RX SpectrumModel, and all the corresponding
@@ -169,6 +263,23 @@ private:
    */
   std::size_t m_numDevices;
 
+  bool m_shareTxPsd; //!< whether the transmitted PSD is shared between the receivers supporting it
+
+  bool m_spatialIndex;                                   //!< whether out of range receivers are culled using m_receiverGrid
+  double m_maxRange;                                     //!< the configured maximum range (m), 0 to derive it
+  double m_derivedMaxRange;                              //!< the maximum range (m) derived from the propagation loss model
+  Ptr<PropagationLossModel> m_derivedMaxRangeLossModel;  //!< the propagation loss model m_derivedMaxRange was derived for
+  double m_derivedMaxRangeMaxLossDb;                     //!< the maximum loss (dB) m_derivedMaxRange was derived for
+  SpectrumReceiverGrid m_receiverGrid;                   //!< the receivers indexed by position
+  uint32_t m_rxSequence;                                 //!< the sequence number of the next receiver added
+  std::vector<Ptr<SpectrumPhy> > m_candidates;           //!< the candidate receivers, reused across transmissions
+
+  bool m_cachePaths;                                     //!< whether the gains and delay of static paths are cached
+  PropagationPathCache<PathData> m_pathCache;            //!< the cached paths
+  Ptr<PropagationLossModel> m_pathCacheLossModel;        //!< the propagation loss model the cached paths were computed with
+  Ptr<PropagationDelayModel> m_pathCacheDelayModel;      //!< the propagation delay model the cached paths were computed with
+  double m_pathCacheMaxLossDb;                           //!< the maximum loss (dB) the cached paths were computed with
+
 };
 
 
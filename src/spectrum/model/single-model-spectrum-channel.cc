@@ -87,6 +87,7 @@ SingleModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
   NS_ASSERT_MSG (txParams->txPhy, "NULL txPhy");
 
   Ptr<SpectrumSignalParameters> txParamsTrace = txParams->Copy (); // copy it since traced value cannot be const (because of potential underlying DynamicCasts)
+  txParamsTrace->MaterializePsd ();
   m_txSigParamsTrace (txParamsTrace);
 
   // just a sanity check routine. We might want to remove it to save some computational load -- one "if" statement  ;-)
@@ -117,6 +118,7 @@ SingleModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
           Ptr<MobilityModel> receiverMobility = (*rxPhyIterator)->GetMobility ();
           NS_LOG_LOGIC ("copying signal parameters " << txParams);
           Ptr<SpectrumSignalParameters> rxParams = txParams->Copy ();
+          rxParams->MaterializePsd ();
 
           if (senderMobility && receiverMobility)
             {
@@ -68,6 +68,7 @@ SpectrumModel::SpectrumModel (std::vector<double> centerFreqs)
         }
       m_bands.push_back (e);
     }
+  ComputeBandWidths ();
 }
 
 SpectrumModel::SpectrumModel (Bands bands)
@@ -75,6 +76,18 @@ SpectrumModel::SpectrumModel (Bands bands)
   m_uid = ++m_uidCount;
   NS_LOG_INFO ("creating new SpectrumModel, m_uid=" << m_uid);
   m_bands = bands;
+  ComputeBandWidths ();
+}
+
+void
+SpectrumModel::ComputeBandWidths ()
+{
+  m_bandWidths.clear ();
+  m_bandWidths.reserve (m_bands.size ());
+  for (Bands::const_iterator it = m_bands.begin (); it != m_bands.end (); ++it)
+    {
+      m_bandWidths.push_back (it->fh - it->fl);
+    }
 }
 
 Bands::const_iterator
@@ -89,6 +102,12 @@ SpectrumModel::End () const
   return m_bands.end ();
 }
 
+const std::vector<double>&
+SpectrumModel::GetBandWidths () const
+{
+  return m_bandWidths;
+}
+
 size_t
 SpectrumModel::GetNumBands () const
 {
@@ -120,6 +120,14 @@ public:
    */
   Bands::const_iterator End () const;
 
+  /**
+   * The widths are stored contiguously so that they can be processed by
+   * the vectorized SpectrumValue kernels.
+   *
+   * \return the width (fh - fl) of each band, in Hz
+   */
+  const std::vector<double>& GetBandWidths () const;
+
   /**
    * Check if another SpectrumModels has bands orthogonal to our bands.
    *
@@ -129,7 +137,13 @@ public:
   bool IsOrthogonal (const SpectrumModel &other) const;
 
 private:
+  /**
+   * Compute the width of each band
+   */
+  void ComputeBandWidths ();
+
   Bands m_bands;         //!< Actual definition of frequency bands within this SpectrumModel
+  std::vector<double> m_bandWidths; //!< Width of each band
   SpectrumModelUid_t m_uid;        //!< unique id for a given set of frequencies
   static SpectrumModelUid_t m_uidCount;    //!< counter to assign m_uids
 };
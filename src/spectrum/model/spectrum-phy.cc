@@ -52,5 +52,11 @@ SpectrumPhy::~SpectrumPhy ()
   NS_LOG_FUNCTION (this);
 }
 
+bool
+SpectrumPhy::IsSharedPsdSupported () const
+{
+  return false;
+}
+
 
 } // namespace
@@ -112,6 +112,17 @@ public:
    */
   virtual void StartRx (Ptr<SpectrumSignalParameters> params) = 0;
 
+  /**
+   * Whether this SpectrumPhy can receive signals whose PSD is shared with
+   * other receivers. Such a SpectrumPhy must take the scalar gain
+   * SpectrumSignalParameters::psdGain into account and must never modify
+   * the received PSD; channels are then allowed to avoid copying the
+   * transmitted PSD for each receiver.
+   *
+   * @return true if shared PSDs are supported (false by default)
+   */
+  virtual bool IsSharedPsdSupported () const;
+
 private:
   /**
    * \brief Copy constructor
@@ -0,0 +1,332 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 University of Washington
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Sébastien Deronne <sebastien.deronne@gmail.com>
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <ns3/log.h>
+#include <ns3/assert.h>
+#include <ns3/callback.h>
+#include <ns3/mobility-model.h>
+#include <ns3/spectrum-phy.h>
+#include "spectrum-receiver-grid.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SpectrumReceiverGrid");
+
+/**
+ * \param a the first position
+ * \param b the second position
+ * \return the squared distance between the two positions
+ */
+static double
+GetDistanceSquared (const Vector &a, const Vector &b)
+{
+  double dx = b.x - a.x;
+  double dy = b.y - a.y;
+  double dz = b.z - a.z;
+  return dx * dx + dy * dy + dz * dz;
+}
+
+bool
+SpectrumReceiverGrid::Cell::operator< (const Cell &other) const
+{
+  if (x != other.x)
+    {
+      return x < other.x;
+    }
+  if (y != other.y)
+    {
+      return y < other.y;
+    }
+  return z < other.z;
+}
+
+SpectrumReceiverGrid::SpectrumReceiverGrid ()
+  : m_cellSize (100)
+{
+}
+
+SpectrumReceiverGrid::~SpectrumReceiverGrid ()
+{
+  Clear ();
+}
+
+void
+SpectrumReceiverGrid::SetCellSize (double cellSize)
+{
+  NS_LOG_FUNCTION (this << cellSize);
+  NS_ASSERT (cellSize > 0);
+  if (cellSize == m_cellSize)
+    {
+      return;
+    }
+  for (std::map<const SpectrumPhy *, Entry>::iterator it = m_entries.begin (); it != m_entries.end (); ++it)
+    {
+      if (it->second.indexed)
+        {
+          Erase (it->second);
+        }
+    }
+  m_cellSize = cellSize;
+  for (std::map<const SpectrumPhy *, Entry>::iterator it = m_entries.begin (); it != m_entries.end (); ++it)
+    {
+      if (it->second.mobility != 0 && m_unindexed.find (it->first) == m_unindexed.end ())
+        {
+          Insert (it->second);
+        }
+    }
+}
+
+double
+SpectrumReceiverGrid::GetCellSize (void) const
+{
+  return m_cellSize;
+}
+
+void
+SpectrumReceiverGrid::Add (Ptr<SpectrumPhy> phy, uint64_t key)
+{
+  NS_LOG_FUNCTION (this << phy << key);
+  std::map<const SpectrumPhy *, Entry>::iterator it = m_entries.find (PeekPointer (phy));
+  if (it != m_entries.end ())
+    {
+      it->second.key = key;
+      return;
+    }
+  Entry entry;
+  entry.phy = phy;
+  entry.key = key;
+  entry.indexed = false;
+  m_entries.insert (std::make_pair (PeekPointer (phy), entry));
+  m_pending.insert (PeekPointer (phy));
+  m_unindexed.insert (PeekPointer (phy));
+}
+
+void
+SpectrumReceiverGrid::Remove (Ptr<SpectrumPhy> phy)
+{
+  NS_LOG_FUNCTION (this << phy);
+  std::map<const SpectrumPhy *, Entry>::iterator it = m_entries.find (PeekPointer (phy));
+  if (it == m_entries.end ())
+    {
+      return;
+    }
+  Erase (it->second);
+  m_pending.erase (it->first);
+  if (it->second.mobility != 0)
+    {
+      std::map<const MobilityModel *, MobilityInfo>::iterator mobIt = m_mobilities.find (PeekPointer (it->second.mobility));
+      NS_ASSERT (mobIt != m_mobilities.end ());
+      mobIt->second.phys.erase (it->first);
+      if (mobIt->second.phys.empty ())
+        {
+          mobIt->second.mobility->TraceDisconnectWithoutContext ("CourseChange", MakeCallback (&SpectrumReceiverGrid::NotifyCourseChange, this));
+          m_mobilities.erase (mobIt);
+        }
+    }
+  m_entries.erase (it);
+}
+
+void
+SpectrumReceiverGrid::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::map<const MobilityModel *, MobilityInfo>::iterator it = m_mobilities.begin (); it != m_mobilities.end (); ++it)
+    {
+      it->second.mobility->TraceDisconnectWithoutContext ("CourseChange", MakeCallback (&SpectrumReceiverGrid::NotifyCourseChange, this));
+    }
+  m_mobilities.clear ();
+  m_entries.clear ();
+  m_cells.clear ();
+  m_unindexed.clear ();
+  m_pending.clear ();
+}
+
+SpectrumReceiverGrid::Cell
+SpectrumReceiverGrid::GetCell (const Vector &position) const
+{
+  Cell cell;
+  cell.x = static_cast<int64_t> (std::floor (position.x / m_cellSize));
+  cell.y = static_cast<int64_t> (std::floor (position.y / m_cellSize));
+  cell.z = static_cast<int64_t> (std::floor (position.z / m_cellSize));
+  return cell;
+}
+
+void
+SpectrumReceiverGrid::Insert (Entry &entry)
+{
+  const SpectrumPhy *phy = PeekPointer (entry.phy);
+  Vector velocity = (entry.mobility != 0) ? entry.mobility->GetVelocity () : Vector ();
+  if (entry.mobility == 0 || velocity.x != 0 || velocity.y != 0 || velocity.z != 0)
+    {
+      // the position of the receiver is unknown or may change without notification
+      m_unindexed.insert (phy);
+      entry.indexed = false;
+      return;
+    }
+  entry.position = entry.mobility->GetPosition ();
+  entry.cell = GetCell (entry.position);
+  entry.indexed = true;
+  m_cells[entry.cell].insert (phy);
+}
+
+void
+SpectrumReceiverGrid::Erase (Entry &entry)
+{
+  const SpectrumPhy *phy = PeekPointer (entry.phy);
+  if (entry.indexed)
+    {
+      std::map<Cell, std::set<const SpectrumPhy *> >::iterator cellIt = m_cells.find (entry.cell);
+      NS_ASSERT (cellIt != m_cells.end ());
+      cellIt->second.erase (phy);
+      if (cellIt->second.empty ())
+        {
+          m_cells.erase (cellIt);
+        }
+      entry.indexed = false;
+    }
+  else
+    {
+      m_unindexed.erase (phy);
+    }
+}
+
+void
+SpectrumReceiverGrid::ResolvePending (void)
+{
+  for (std::set<const SpectrumPhy *>::iterator it = m_pending.begin (); it != m_pending.end (); )
+    {
+      Entry &entry = m_entries.find (*it)->second;
+      Ptr<MobilityModel> mobility = entry.phy->GetMobility ();
+      if (mobility == 0)
+        {
+          ++it;
+          continue;
+        }
+      NS_LOG_LOGIC ("Indexing receiver " << entry.phy << " with mobility model " << mobility);
+      entry.mobility = mobility;
+      std::map<const MobilityModel *, MobilityInfo>::iterator mobIt = m_mobilities.find (PeekPointer (mobility));
+      if (mobIt == m_mobilities.end ())
+        {
+          mobility->TraceConnectWithoutContext ("CourseChange", MakeCallback (&SpectrumReceiverGrid::NotifyCourseChange, this));
+          mobIt = m_mobilities.insert (std::make_pair (PeekPointer (mobility), MobilityInfo ())).first;
+          mobIt->second.mobility = mobility;
+        }
+      mobIt->second.phys.insert (*it);
+      Erase (entry);
+      Insert (entry);
+      m_pending.erase (it++);
+    }
+}
+
+void
+SpectrumReceiverGrid::NotifyCourseChange (Ptr<const MobilityModel> mobility)
+{
+  NS_LOG_FUNCTION (this << mobility);
+  std::map<const MobilityModel *, MobilityInfo>::iterator mobIt = m_mobilities.find (PeekPointer (mobility));
+  if (mobIt == m_mobilities.end ())
+    {
+      return;
+    }
+  for (std::set<const SpectrumPhy *>::const_iterator it = mobIt->second.phys.begin (); it != mobIt->second.phys.end (); ++it)
+    {
+      Entry &entry = m_entries.find (*it)->second;
+      Erase (entry);
+      Insert (entry);
+    }
+}
+
+void
+SpectrumReceiverGrid::GetCandidates (const Vector &position, double range, std::vector<Ptr<SpectrumPhy> > &candidates)
+{
+  NS_LOG_FUNCTION (this << position << range);
+  ResolvePending ();
+  std::vector<const Entry *> entries;
+  entries.reserve (m_unindexed.size ());
+  for (std::set<const SpectrumPhy *>::const_iterator it = m_unindexed.begin (); it != m_unindexed.end (); ++it)
+    {
+      entries.push_back (&m_entries.find (*it)->second);
+    }
+
+  double rangeSquared = range * range;
+  Cell center = GetCell (position);
+  int64_t span = static_cast<int64_t> (std::ceil (range / m_cellSize));
+  double nCellsInRange = std::pow (2.0 * span + 1, 3);
+  std::map<Cell, std::set<const SpectrumPhy *> >::const_iterator cellIt;
+  if (nCellsInRange < m_cells.size ())
+    {
+      // look up the cells within range
+      Cell cell;
+      for (cell.x = center.x - span; cell.x <= center.x + span; cell.x++)
+        {
+          for (cell.y = center.y - span; cell.y <= center.y + span; cell.y++)
+            {
+              for (cell.z = center.z - span; cell.z <= center.z + span; cell.z++)
+                {
+                  cellIt = m_cells.find (cell);
+                  if (cellIt == m_cells.end ())
+                    {
+                      continue;
+                    }
+                  for (std::set<const SpectrumPhy *>::const_iterator it = cellIt->second.begin (); it != cellIt->second.end (); ++it)
+                    {
+                      const Entry *entry = &m_entries.find (*it)->second;
+                      if (GetDistanceSquared (entry->position, position) <= rangeSquared)
+                        {
+                          entries.push_back (entry);
+                        }
+                    }
+                }
+            }
+        }
+    }
+  else
+    {
+      // there are fewer non-empty cells than cells within range
+      for (cellIt = m_cells.begin (); cellIt != m_cells.end (); ++cellIt)
+        {
+          if (std::abs (cellIt->first.x - center.x) > span
+              || std::abs (cellIt->first.y - center.y) > span
+              || std::abs (cellIt->first.z - center.z) > span)
+            {
+              continue;
+            }
+          for (std::set<const SpectrumPhy *>::const_iterator it = cellIt->second.begin (); it != cellIt->second.end (); ++it)
+            {
+              const Entry *entry = &m_entries.find (*it)->second;
+              if (GetDistanceSquared (entry->position, position) <= rangeSquared)
+                {
+                  entries.push_back (entry);
+                }
+            }
+        }
+    }
+
+  std::sort (entries.begin (), entries.end (), [] (const Entry *a, const Entry *b) { return a->key < b->key; });
+  candidates.clear ();
+  candidates.reserve (entries.size ());
+  for (std::vector<const Entry *>::const_iterator it = entries.begin (); it != entries.end (); ++it)
+    {
+      candidates.push_back ((*it)->phy);
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,173 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 University of Washington
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Sébastien Deronne <sebastien.deronne@gmail.com>
+ */
+
+#ifndef SPECTRUM_RECEIVER_GRID_H
+#define SPECTRUM_RECEIVER_GRID_H
+
+#include <ns3/ptr.h>
+#include <ns3/vector.h>
+#include <map>
+#include <set>
+#include <vector>
+
+namespace ns3 {
+
+class SpectrumPhy;
+class MobilityModel;
+
+/**
+ * \ingroup spectrum
+ *
+ * Uniform grid indexing the receivers of a channel by the position of
+ * their MobilityModel, so that the receivers located within a given
+ * range of a transmitter can be found without visiting all the receivers.
+ *
+ * Positions are kept up to date through the CourseChange trace source of
+ * the mobility models. Receivers that are moving (i.e., whose velocity is
+ * not null) or whose mobility model is not known yet cannot be indexed,
+ * hence they are always returned as candidates.
+ *
+ * Every receiver is associated with a key provided by the user of the
+ * grid; candidates are returned sorted by increasing key, which allows
+ * the channel to preserve the order in which receivers are processed.
+ */
+class SpectrumReceiverGrid
+{
+public:
+  SpectrumReceiverGrid ();
+  ~SpectrumReceiverGrid ();
+
+  /**
+   * Set the size of the cells of the grid. Receivers already added are
+   * moved to the cells of the new grid.
+   *
+   * \param cellSize the size of the cells (m)
+   */
+  void SetCellSize (double cellSize);
+  /**
+   * \return the size of the cells of the grid (m)
+   */
+  double GetCellSize (void) const;
+
+  /**
+   * Add a receiver to the grid, or update its key if it is already present.
+   * The mobility model of the receiver is only retrieved upon the next
+   * call to GetCandidates.
+   *
+   * \param phy the receiver
+   * \param key the key of the receiver
+   */
+  void Add (Ptr<SpectrumPhy> phy, uint64_t key);
+  /**
+   * Remove a receiver from the grid
+   *
+   * \param phy the receiver
+   */
+  void Remove (Ptr<SpectrumPhy> phy);
+  /**
+   * Remove all the receivers and disconnect from their mobility models
+   */
+  void Clear (void);
+
+  /**
+   * Get the receivers that may be located within a given range of a
+   * position: these are the indexed receivers that are actually within
+   * range plus all the receivers that cannot be indexed.
+   *
+   * \param position the position of the transmitter
+   * \param range the range (m)
+   * \param candidates the candidate receivers, sorted by increasing key
+   */
+  void GetCandidates (const Vector &position, double range, std::vector<Ptr<SpectrumPhy> > &candidates);
+
+private:
+  /// Index of a cell along the three axes
+  struct Cell
+  {
+    int64_t x; ///< index along the x axis
+    int64_t y; ///< index along the y axis
+    int64_t z; ///< index along the z axis
+    /**
+     * \param other the other cell
+     * \return true if this cell is ordered before the other cell
+     */
+    bool operator< (const Cell &other) const;
+  };
+
+  /// State of a receiver
+  struct Entry
+  {
+    Ptr<SpectrumPhy> phy;          ///< the receiver
+    Ptr<MobilityModel> mobility;   ///< the mobility model of the receiver, if known
+    uint64_t key;                  ///< the key of the receiver
+    bool indexed;                  ///< whether the receiver is stored in a cell
+    Cell cell;                     ///< the cell storing the receiver, if indexed
+    Vector position;               ///< the position of the receiver, if indexed
+  };
+
+  /**
+   * \param position a position
+   * \return the cell containing the given position
+   */
+  Cell GetCell (const Vector &position) const;
+  /**
+   * Store a receiver in the cell containing its position if it is not
+   * moving, or in the set of receivers that cannot be indexed otherwise.
+   *
+   * \param entry the receiver
+   */
+  void Insert (Entry &entry);
+  /**
+   * Remove a receiver from its cell or from the set of receivers that
+   * cannot be indexed.
+   *
+   * \param entry the receiver
+   */
+  void Erase (Entry &entry);
+  /**
+   * Retrieve the mobility model of the receivers for which it is not known
+   * yet, and index them if possible.
+   */
+  void ResolvePending (void);
+  /**
+   * Called when the course of a mobility model changes
+   *
+   * \param mobility the mobility model
+   */
+  void NotifyCourseChange (Ptr<const MobilityModel> mobility);
+
+  /// The receivers using a mobility model whose course changes are tracked
+  struct MobilityInfo
+  {
+    Ptr<MobilityModel> mobility;          ///< the mobility model
+    std::set<const SpectrumPhy *> phys;   ///< the receivers using the mobility model
+  };
+
+  double m_cellSize; //!< the size of the cells (m)
+  std::map<const SpectrumPhy *, Entry> m_entries; //!< the state of each receiver
+  std::map<Cell, std::set<const SpectrumPhy *> > m_cells; //!< the receivers stored in each cell
+  std::set<const SpectrumPhy *> m_unindexed; //!< the receivers that cannot be indexed
+  std::set<const SpectrumPhy *> m_pending; //!< the receivers whose mobility model is not known yet
+  std::map<const MobilityModel *, MobilityInfo> m_mobilities; //!< the mobility models whose course changes are tracked
+};
+
+} // namespace ns3
+
+#endif /* SPECTRUM_RECEIVER_GRID_H */
@@ -82,6 +82,13 @@ struct SpectrumSignalParameters : public SimpleRefCount<SpectrumSignalParameters
    */
   virtual Ptr<SpectrumSignalParameters> Copy ();
 
+  /**
+   * Replace the PSD by a private copy to which psdGain has been applied,
+   * so that it can be modified without affecting the other receivers of
+   * the same signal. psdGain is then reset to 1.
+   */
+  void MaterializePsd ();
+
   /**
    * The Power Spectral Density of the
    * waveform, in linear units. The exact unit will depend on the
@@ -89,10 +96,18 @@ struct SpectrumSignalParameters : public SimpleRefCount<SpectrumSignalParameters
    * underwater acoustic communications. Other transmission media to
    * be defined.
    *
-   * \note when SpectrumSignalParameters is copied, only the pointer to the PSD will be copied. This is because SpectrumChannel objects normally overwrite the psd anyway, so there is no point in making a copy.
+   * \note when SpectrumSignalParameters is copied, only the pointer to the PSD will be copied. This is because SpectrumChannel objects normally overwrite the psd anyway, so there is no point in making a copy. Whoever needs to modify the PSD must call MaterializePsd first.
    */
   Ptr <SpectrumValue> psd;
 
+  /**
+   * Scalar gain, in linear units, to be applied to psd to obtain the
+   * actual Power Spectral Density of the signal. This allows channels to
+   * share a single immutable PSD between all the receivers of a signal
+   * (see SpectrumPhy::IsSharedPsdSupported).
+   */
+  double psdGain;
+
   /**
    * The duration of the packet transmission. It is
    * assumed that the Power Spectral Density remains constant for the
@@ -0,0 +1,462 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 University of Washington
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Sébastien Deronne <sebastien.deronne@gmail.com>
+ */
+
+#include "spectrum-value-kernels.h"
+#include <ns3/log.h>
+#include <ns3/assert.h>
+#include <ns3/abort.h>
+
+#if defined (__GNUC__) && (defined (__x86_64__) || defined (__i386__))
+#define SPECTRUM_VALUE_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SpectrumValueKernels");
+
+namespace {
+
+/// Set of kernel implementations for a given instruction set
+struct KernelTable
+{
+  void (*scale) (double *x, std::size_t n, double s);               //!< Scale implementation
+  void (*divideScalar) (double *x, std::size_t n, double s);        //!< DivideScalar implementation
+  void (*addScalar) (double *x, std::size_t n, double s);           //!< AddScalar implementation
+  void (*maskedAdd) (double *x, const double *y, std::size_t begin, std::size_t end); //!< MaskedAdd implementation
+  void (*subtract) (double *x, const double *y, std::size_t n);     //!< Subtract implementation
+  void (*multiply) (double *x, const double *y, std::size_t n);     //!< Multiply implementation
+  void (*divide) (double *x, const double *y, std::size_t n);       //!< Divide implementation
+  double (*multiplyIntegrate) (const double *x, const double *w, std::size_t begin, std::size_t end); //!< MultiplyIntegrate implementation
+};
+
+/*
+ * Scalar implementations
+ */
+
+void
+ScaleScalar (double *x, std::size_t n, double s)
+{
+  for (std::size_t i = 0; i < n; i++)
+    {
+      x[i] *= s;
+    }
+}
+
+void
+DivideScalarScalar (double *x, std::size_t n, double s)
+{
+  for (std::size_t i = 0; i < n; i++)
+    {
+      x[i] /= s;
+    }
+}
+
+void
+AddScalarScalar (double *x, std::size_t n, double s)
+{
+  for (std::size_t i = 0; i < n; i++)
+    {
+      x[i] += s;
+    }
+}
+
+void
+MaskedAddScalar (double *x, const double *y, std::size_t begin, std::size_t end)
+{
+  for (std::size_t i = begin; i < end; i++)
+    {
+      x[i] += y[i];
+    }
+}
+
+void
+SubtractScalar (double *x, const double *y, std::size_t n)
+{
+  for (std::size_t i = 0; i < n; i++)
+    {
+      x[i] -= y[i];
+    }
+}
+
+void
+MultiplyScalar (double *x, const double *y, std::size_t n)
+{
+  for (std::size_t i = 0; i < n; i++)
+    {
+      x[i] *= y[i];
+    }
+}
+
+void
+DivideScalar (double *x, const double *y, std::size_t n)
+{
+  for (std::size_t i = 0; i < n; i++)
+    {
+      x[i] /= y[i];
+    }
+}
+
+double
+MultiplyIntegrateScalar (const double *x, const double *w, std::size_t begin, std::size_t end)
+{
+  double sum = 0;
+  for (std::size_t i = begin; i < end; i++)
+    {
+      sum += x[i] * w[i];
+    }
+  return sum;
+}
+
+const KernelTable g_scalarKernels = {
+  &ScaleScalar,
+  &DivideScalarScalar,
+  &AddScalarScalar,
+  &MaskedAddScalar,
+  &SubtractScalar,
+  &MultiplyScalar,
+  &DivideScalar,
+  &MultiplyIntegrateScalar
+};
+
+#ifdef SPECTRUM_VALUE_KERNELS_X86
+
+/*
+ * SIMD implementations. The element-wise kernels only differ by the
+ * intrinsic applied to each vector and by the width of the vectors, hence
+ * they are generated by the following macros. The tail of the arrays that
+ * does not fill a whole vector is processed by the scalar code.
+ */
+
+/**
+ * Define an element-wise kernel combining an array with a scalar.
+ *
+ * \param name the name of the kernel
+ * \param isa the instruction set the kernel is compiled for
+ * \param vtype the vector type
+ * \param width the number of doubles in a vector
+ * \param set1 the intrinsic broadcasting a double to a vector
+ * \param loadu the intrinsic loading an unaligned vector
+ * \param storeu the intrinsic storing an unaligned vector
+ * \param vop the intrinsic applying the operation to two vectors
+ * \param op the scalar compound assignment operator
+ */
+#define SPECTRUM_VALUE_SCALAR_KERNEL(name, isa, vtype, width, set1, loadu, storeu, vop, op) \
+  __attribute__ ((target (isa))) void                                        \
+  name (double *x, std::size_t n, double s)                                   \
+  {                                                                           \
+    const vtype vs = set1 (s);                                                \
+    std::size_t i = 0;                                                        \
+    for (; i + width <= n; i += width)                                        \
+      {                                                                       \
+        storeu (x + i, vop (loadu (x + i), vs));                              \
+      }                                                                       \
+    for (; i < n; i++)                                                        \
+      {                                                                       \
+        x[i] op s;                                                            \
+      }                                                                       \
+  }
+
+/**
+ * Define an element-wise kernel combining two arrays over an index range.
+ *
+ * \param name the name of the kernel
+ * \param isa the instruction set the kernel is compiled for
+ * \param width the number of doubles in a vector
+ * \param loadu the intrinsic loading an unaligned vector
+ * \param storeu the intrinsic storing an unaligned vector
+ * \param vop the intrinsic applying the operation to two vectors
+ * \param op the scalar compound assignment operator
+ */
+#define SPECTRUM_VALUE_RANGE_KERNEL(name, isa, width, loadu, storeu, vop, op) \
+  __attribute__ ((target (isa))) void                                        \
+  name (double *x, const double *y, std::size_t begin, std::size_t end)       \
+  {                                                                           \
+    std::size_t i = begin;                                                    \
+    for (; i + width <= end; i += width)                                      \
+      {                                                                       \
+        storeu (x + i, vop (loadu (x + i), loadu (y + i)));                   \
+      }                                                                       \
+    for (; i < end; i++)                                                      \
+      {                                                                       \
+        x[i] op y[i];                                                         \
+      }                                                                       \
+  }
+
+SPECTRUM_VALUE_SCALAR_KERNEL (ScaleSse2, "sse2", __m128d, 2, _mm_set1_pd, _mm_loadu_pd, _mm_storeu_pd, _mm_mul_pd, *=)
+SPECTRUM_VALUE_SCALAR_KERNEL (DivideScalarSse2, "sse2", __m128d, 2, _mm_set1_pd, _mm_loadu_pd, _mm_storeu_pd, _mm_div_pd, /=)
+SPECTRUM_VALUE_SCALAR_KERNEL (AddScalarSse2, "sse2", __m128d, 2, _mm_set1_pd, _mm_loadu_pd, _mm_storeu_pd, _mm_add_pd, +=)
+SPECTRUM_VALUE_RANGE_KERNEL (MaskedAddSse2, "sse2", 2, _mm_loadu_pd, _mm_storeu_pd, _mm_add_pd, +=)
+SPECTRUM_VALUE_RANGE_KERNEL (SubtractRangeSse2, "sse2", 2, _mm_loadu_pd, _mm_storeu_pd, _mm_sub_pd, -=)
+SPECTRUM_VALUE_RANGE_KERNEL (MultiplyRangeSse2, "sse2", 2, _mm_loadu_pd, _mm_storeu_pd, _mm_mul_pd, *=)
+SPECTRUM_VALUE_RANGE_KERNEL (DivideRangeSse2, "sse2", 2, _mm_loadu_pd, _mm_storeu_pd, _mm_div_pd, /=)
+
+SPECTRUM_VALUE_SCALAR_KERNEL (ScaleAvx2, "avx2", __m256d, 4, _mm256_set1_pd, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_mul_pd, *=)
+SPECTRUM_VALUE_SCALAR_KERNEL (DivideScalarAvx2, "avx2", __m256d, 4, _mm256_set1_pd, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_div_pd, /=)
+SPECTRUM_VALUE_SCALAR_KERNEL (AddScalarAvx2, "avx2", __m256d, 4, _mm256_set1_pd, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_add_pd, +=)
+SPECTRUM_VALUE_RANGE_KERNEL (MaskedAddAvx2, "avx2", 4, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_add_pd, +=)
+SPECTRUM_VALUE_RANGE_KERNEL (SubtractRangeAvx2, "avx2", 4, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_sub_pd, -=)
+SPECTRUM_VALUE_RANGE_KERNEL (MultiplyRangeAvx2, "avx2", 4, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_mul_pd, *=)
+SPECTRUM_VALUE_RANGE_KERNEL (DivideRangeAvx2, "avx2", 4, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_div_pd, /=)
+
+void
+SubtractSse2 (double *x, const double *y, std::size_t n)
+{
+  SubtractRangeSse2 (x, y, 0, n);
+}
+
+void
+MultiplySse2 (double *x, const double *y, std::size_t n)
+{
+  MultiplyRangeSse2 (x, y, 0, n);
+}
+
+void
+DivideSse2 (double *x, const double *y, std::size_t n)
+{
+  DivideRangeSse2 (x, y, 0, n);
+}
+
+void
+SubtractAvx2 (double *x, const double *y, std::size_t n)
+{
+  SubtractRangeAvx2 (x, y, 0, n);
+}
+
+void
+MultiplyAvx2 (double *x, const double *y, std::size_t n)
+{
+  MultiplyRangeAvx2 (x, y, 0, n);
+}
+
+void
+DivideAvx2 (double *x, const double *y, std::size_t n)
+{
+  DivideRangeAvx2 (x, y, 0, n);
+}
+
+__attribute__ ((target ("sse2"))) double
+MultiplyIntegrateSse2 (const double *x, const double *w, std::size_t begin, std::size_t end)
+{
+  // two independent accumulators hide the latency of the additions
+  __m128d acc0 = _mm_setzero_pd ();
+  __m128d acc1 = _mm_setzero_pd ();
+  std::size_t i = begin;
+  for (; i + 4 <= end; i += 4)
+    {
+      acc0 = _mm_add_pd (acc0, _mm_mul_pd (_mm_loadu_pd (x + i), _mm_loadu_pd (w + i)));
+      acc1 = _mm_add_pd (acc1, _mm_mul_pd (_mm_loadu_pd (x + i + 2), _mm_loadu_pd (w + i + 2)));
+    }
+  double lanes[2];
+  _mm_storeu_pd (lanes, _mm_add_pd (acc0, acc1));
+  double sum = lanes[0] + lanes[1];
+  for (; i < end; i++)
+    {
+      sum += x[i] * w[i];
+    }
+  return sum;
+}
+
+__attribute__ ((target ("avx2"))) double
+MultiplyIntegrateAvx2 (const double *x, const double *w, std::size_t begin, std::size_t end)
+{
+  // two independent accumulators hide the latency of the additions
+  __m256d acc0 = _mm256_setzero_pd ();
+  __m256d acc1 = _mm256_setzero_pd ();
+  std::size_t i = begin;
+  for (; i + 8 <= end; i += 8)
+    {
+      acc0 = _mm256_add_pd (acc0, _mm256_mul_pd (_mm256_loadu_pd (x + i), _mm256_loadu_pd (w + i)));
+      acc1 = _mm256_add_pd (acc1, _mm256_mul_pd (_mm256_loadu_pd (x + i + 4), _mm256_loadu_pd (w + i + 4)));
+    }
+  double lanes[4];
+  _mm256_storeu_pd (lanes, _mm256_add_pd (acc0, acc1));
+  double sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+  for (; i < end; i++)
+    {
+      sum += x[i] * w[i];
+    }
+  return sum;
+}
+
+const KernelTable g_sse2Kernels = {
+  &ScaleSse2,
+  &DivideScalarSse2,
+  &AddScalarSse2,
+  &MaskedAddSse2,
+  &SubtractSse2,
+  &MultiplySse2,
+  &DivideSse2,
+  &MultiplyIntegrateSse2
+};
+
+const KernelTable g_avx2Kernels = {
+  &ScaleAvx2,
+  &DivideScalarAvx2,
+  &AddScalarAvx2,
+  &MaskedAddAvx2,
+  &SubtractAvx2,
+  &MultiplyAvx2,
+  &DivideAvx2,
+  &MultiplyIntegrateAvx2
+};
+
+#endif /* SPECTRUM_VALUE_KERNELS_X86 */
+
+/**
+ * \param isa the instruction set
+ * \return the kernel implementations for the given instruction set
+ */
+const KernelTable *
+GetKernelTable (SpectrumValueKernels::Isa isa)
+{
+  switch (isa)
+    {
+#ifdef SPECTRUM_VALUE_KERNELS_X86
+    case SpectrumValueKernels::AVX2:
+      return &g_avx2Kernels;
+    case SpectrumValueKernels::SSE2:
+      return &g_sse2Kernels;
+#endif
+    default:
+      return &g_scalarKernels;
+    }
+}
+
+SpectrumValueKernels::Isa g_isa = SpectrumValueKernels::SCALAR; //!< instruction set in use
+const KernelTable *g_kernels = 0; //!< kernel implementations in use, selected upon first use
+
+/**
+ * \return the kernel implementations in use
+ */
+inline const KernelTable *
+Kernels (void)
+{
+  if (g_kernels == 0)
+    {
+      g_isa = SpectrumValueKernels::GetBestSupportedIsa ();
+      g_kernels = GetKernelTable (g_isa);
+    }
+  return g_kernels;
+}
+
+} // unnamed namespace
+
+bool
+SpectrumValueKernels::IsSupported (Isa isa)
+{
+  switch (isa)
+    {
+    case SCALAR:
+      return true;
+#ifdef SPECTRUM_VALUE_KERNELS_X86
+    case SSE2:
+      __builtin_cpu_init ();
+      return __builtin_cpu_supports ("sse2");
+    case AVX2:
+      __builtin_cpu_init ();
+      return __builtin_cpu_supports ("avx2");
+#endif
+    default:
+      return false;
+    }
+}
+
+SpectrumValueKernels::Isa
+SpectrumValueKernels::GetBestSupportedIsa (void)
+{
+  if (IsSupported (AVX2))
+    {
+      return AVX2;
+    }
+  if (IsSupported (SSE2))
+    {
+      return SSE2;
+    }
+  return SCALAR;
+}
+
+SpectrumValueKernels::Isa
+SpectrumValueKernels::GetIsa (void)
+{
+  Kernels ();
+  return g_isa;
+}
+
+void
+SpectrumValueKernels::SetIsa (Isa isa)
+{
+  NS_LOG_FUNCTION (isa);
+  NS_ABORT_MSG_UNLESS (IsSupported (isa), "Instruction set " << isa << " not supported by this CPU");
+  g_isa = isa;
+  g_kernels = GetKernelTable (isa);
+}
+
+void
+SpectrumValueKernels::Scale (double *x, std::size_t n, double s)
+{
+  Kernels ()->scale (x, n, s);
+}
+
+void
+SpectrumValueKernels::DivideScalar (double *x, std::size_t n, double s)
+{
+  Kernels ()->divideScalar (x, n, s);
+}
+
+void
+SpectrumValueKernels::AddScalar (double *x, std::size_t n, double s)
+{
+  Kernels ()->addScalar (x, n, s);
+}
+
+void
+SpectrumValueKernels::MaskedAdd (double *x, const double *y, std::size_t begin, std::size_t end)
+{
+  NS_ASSERT (begin <= end);
+  Kernels ()->maskedAdd (x, y, begin, end);
+}
+
+void
+SpectrumValueKernels::Subtract (double *x, const double *y, std::size_t n)
+{
+  Kernels ()->subtract (x, y, n);
+}
+
+void
+SpectrumValueKernels::Multiply (double *x, const double *y, std::size_t n)
+{
+  Kernels ()->multiply (x, y, n);
+}
+
+void
+SpectrumValueKernels::Divide (double *x, const double *y, std::size_t n)
+{
+  Kernels ()->divide (x, y, n);
+}
+
+double
+SpectrumValueKernels::MultiplyIntegrate (const double *x, const double *w, std::size_t begin, std::size_t end)
+{
+  NS_ASSERT (begin <= end);
+  return Kernels ()->multiplyIntegrate (x, w, begin, end);
+}
+
+} // namespace ns3
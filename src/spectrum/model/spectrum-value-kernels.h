@@ -0,0 +1,145 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 University of Washington
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Sébastien Deronne <sebastien.deronne@gmail.com>
+ */
+
+#ifndef SPECTRUM_VALUE_KERNELS_H
+#define SPECTRUM_VALUE_KERNELS_H
+
+#include <cstddef>
+
+namespace ns3 {
+
+/**
+ * \ingroup spectrum
+ *
+ * In-place arithmetic kernels operating on contiguous arrays of doubles,
+ * as stored by SpectrumValue. Each kernel has a scalar, an SSE2 and an
+ * AVX2 implementation; the implementation used is selected at runtime
+ * according to the instruction sets supported by the CPU, unless forced
+ * through SetIsa.
+ *
+ * Element-wise kernels perform exactly the same floating point operation
+ * on every element whatever the instruction set, hence they produce
+ * identical results. Reductions (MultiplyIntegrate) accumulate in several
+ * lanes and may therefore differ from the scalar implementation in the
+ * last bits.
+ */
+class SpectrumValueKernels
+{
+public:
+  /// Instruction set used by the kernels
+  enum Isa
+  {
+    SCALAR = 0,
+    SSE2,
+    AVX2
+  };
+
+  /**
+   * \return the instruction set currently used by the kernels
+   */
+  static Isa GetIsa (void);
+  /**
+   * \return the most efficient instruction set supported by the CPU
+   */
+  static Isa GetBestSupportedIsa (void);
+  /**
+   * \param isa the instruction set
+   * \return true if the CPU supports the given instruction set
+   */
+  static bool IsSupported (Isa isa);
+  /**
+   * Force the instruction set used by the kernels. This is mostly
+   * useful to compare the different implementations.
+   *
+   * \param isa the instruction set, which must be supported by the CPU
+   */
+  static void SetIsa (Isa isa);
+
+  /**
+   * Compute x[i] = x[i] * s for i in [0, n)
+   *
+   * \param x the array to update
+   * \param n the number of elements
+   * \param s the scaling factor
+   */
+  static void Scale (double *x, std::size_t n, double s);
+  /**
+   * Compute x[i] = x[i] / s for i in [0, n)
+   *
+   * \param x the array to update
+   * \param n the number of elements
+   * \param s the divisor
+   */
+  static void DivideScalar (double *x, std::size_t n, double s);
+  /**
+   * Compute x[i] = x[i] + s for i in [0, n)
+   *
+   * \param x the array to update
+   * \param n the number of elements
+   * \param s the value to add
+   */
+  static void AddScalar (double *x, std::size_t n, double s);
+  /**
+   * Compute x[i] = x[i] + y[i] for i in [begin, end), leaving the
+   * elements outside the index range untouched.
+   *
+   * \param x the array to update
+   * \param y the array to add
+   * \param begin the first index to update
+   * \param end one past the last index to update
+   */
+  static void MaskedAdd (double *x, const double *y, std::size_t begin, std::size_t end);
+  /**
+   * Compute x[i] = x[i] - y[i] for i in [0, n)
+   *
+   * \param x the array to update
+   * \param y the array to subtract
+   * \param n the number of elements
+   */
+  static void Subtract (double *x, const double *y, std::size_t n);
+  /**
+   * Compute x[i] = x[i] * y[i] for i in [0, n)
+   *
+   * \param x the array to update
+   * \param y the multiplier array
+   * \param n the number of elements
+   */
+  static void Multiply (double *x, const double *y, std::size_t n);
+  /**
+   * Compute x[i] = x[i] / y[i] for i in [0, n)
+   *
+   * \param x the array to update
+   * \param y the divisor array
+   * \param n the number of elements
+   */
+  static void Divide (double *x, const double *y, std::size_t n);
+  /**
+   * \param x the first array
+   * \param w the second array (e.g., the band widths)
+   * \param begin the first index
+   * \param end one past the last index
+   * \return the sum of x[i] * w[i] for i in [begin, end)
+   */
+  static double MultiplyIntegrate (const double *x, const double *w, std::size_t begin, std::size_t end);
+};
+
+} // namespace ns3
+
+#endif /* SPECTRUM_VALUE_KERNELS_H */
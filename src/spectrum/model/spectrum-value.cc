@@ -20,6 +20,7 @@
  */
 
 #include <ns3/spectrum-value.h>
+#include <ns3/spectrum-value-kernels.h>
 #include <ns3/math.h>
 #include <ns3/log.h>
 
@@ -106,31 +107,16 @@ SpectrumValue::ConstBandsEnd () const
 void
 SpectrumValue::Add (const SpectrumValue& x)
 {
-  Values::iterator it1 = m_values.begin ();
-  Values::const_iterator it2 = x.m_values.begin ();
-
   NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
-
-  while (it1 != m_values.end ())
-    {
-      NS_ASSERT ( it2 != x.m_values.end ());
-      *it1 += *it2;
-      ++it1;
-      ++it2;
-    }
+  NS_ASSERT (m_values.size () == x.m_values.size ());
+  SpectrumValueKernels::MaskedAdd (m_values.data (), x.m_values.data (), 0, m_values.size ());
 }
 
 
 void
 SpectrumValue::Add (double s)
 {
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
-    {
-      *it1 += s;
-      ++it1;
-    }
+  SpectrumValueKernels::AddScalar (m_values.data (), m_values.size (), s);
 }
 
 
@@ -138,18 +124,9 @@ SpectrumValue::Add (double s)
 void
 SpectrumValue::Subtract (const SpectrumValue& x)
 {
-  Values::iterator it1 = m_values.begin ();
-  Values::const_iterator it2 = x.m_values.begin ();
-
   NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
-
-  while (it1 != m_values.end ())
-    {
-      NS_ASSERT ( it2 != x.m_values.end ());
-      *it1 -= *it2;
-      ++it1;
-      ++it2;
-    }
+  NS_ASSERT (m_values.size () == x.m_values.size ());
+  SpectrumValueKernels::Subtract (m_values.data (), x.m_values.data (), m_values.size ());
 }
 
 
@@ -164,31 +141,16 @@ SpectrumValue::Subtract (double s)
 void
 SpectrumValue::Multiply (const SpectrumValue& x)
 {
-  Values::iterator it1 = m_values.begin ();
-  Values::const_iterator it2 = x.m_values.begin ();
-
   NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
-
-  while (it1 != m_values.end ())
-    {
-      NS_ASSERT ( it2 != x.m_values.end ());
-      *it1 *= *it2;
-      ++it1;
-      ++it2;
-    }
+  NS_ASSERT (m_values.size () == x.m_values.size ());
+  SpectrumValueKernels::Multiply (m_values.data (), x.m_values.data (), m_values.size ());
 }
 
 
 void
 SpectrumValue::Multiply (double s)
 {
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
-    {
-      *it1 *= s;
-      ++it1;
-    }
+  SpectrumValueKernels::Scale (m_values.data (), m_values.size (), s);
 }
 
 
@@ -197,18 +159,9 @@ SpectrumValue::Multiply (double s)
 void
 SpectrumValue::Divide (const SpectrumValue& x)
 {
-  Values::iterator it1 = m_values.begin ();
-  Values::const_iterator it2 = x.m_values.begin ();
-
   NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
-
-  while (it1 != m_values.end ())
-    {
-      NS_ASSERT ( it2 != x.m_values.end ());
-      *it1 /= *it2;
-      ++it1;
-      ++it2;
-    }
+  NS_ASSERT (m_values.size () == x.m_values.size ());
+  SpectrumValueKernels::Divide (m_values.data (), x.m_values.data (), m_values.size ());
 }
 
 
@@ -216,13 +169,7 @@ void
 SpectrumValue::Divide (double s)
 {
   NS_LOG_FUNCTION (this << s);
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
-    {
-      *it1 /= s;
-      ++it1;
-    }
+  SpectrumValueKernels::DivideScalar (m_values.data (), m_values.size (), s);
 }
 
 
@@ -231,13 +178,7 @@ SpectrumValue::Divide (double s)
 void
 SpectrumValue::ChangeSign ()
 {
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
-    {
-      *it1 = -(*it1);
-      ++it1;
-    }
+  SpectrumValueKernels::Scale (m_values.data (), m_values.size (), -1);
 }
 
 
@@ -347,14 +288,13 @@ SpectrumValue::Log ()
 double
 Norm (const SpectrumValue& x)
 {
-  double s = 0;
-  Values::const_iterator it1 = x.ConstValuesBegin ();
-  while (it1 != x.ConstValuesEnd ())
+  std::size_t n = x.ConstValuesEnd () - x.ConstValuesBegin ();
+  if (n == 0)
     {
-      s += (*it1) * (*it1);
-      ++it1;
+      return 0;
     }
-  return std::sqrt (s);
+  const double *values = &(*x.ConstValuesBegin ());
+  return std::sqrt (SpectrumValueKernels::MultiplyIntegrate (values, values, 0, n));
 }
 
 
@@ -389,18 +329,14 @@ Prod (const SpectrumValue& x)
 double
 Integral (const SpectrumValue& arg)
 {
-  double i = 0;
-  Values::const_iterator vit = arg.ConstValuesBegin ();
-  Bands::const_iterator bit = arg.ConstBandsBegin ();
-  while (vit != arg.ConstValuesEnd ())
+  const std::vector<double>& widths = arg.GetSpectrumModel ()->GetBandWidths ();
+  std::size_t n = arg.ConstValuesEnd () - arg.ConstValuesBegin ();
+  NS_ASSERT (n == widths.size ());
+  if (n == 0)
     {
-      NS_ASSERT (bit != arg.ConstBandsEnd ());
-      i += (*vit) * (bit->fh - bit->fl);
-      ++vit;
-      ++bit;
+      return 0;
     }
-  NS_ASSERT (bit == arg.ConstBandsEnd ());
-  return i;
+  return SpectrumValueKernels::MultiplyIntegrate (&(*arg.ConstValuesBegin ()), widths.data (), 0, n);
 }
 
 
@@ -467,9 +403,8 @@ operator+ (double lhs, const SpectrumValue& rhs)
 SpectrumValue
 operator- (const SpectrumValue& lhs, const SpectrumValue& rhs)
 {
-  SpectrumValue res = rhs;
-  res.ChangeSign ();
-  res.Add (lhs);
+  SpectrumValue res = lhs;
+  res.Subtract (rhs);
   return res;
 }
 
@@ -23,8 +23,11 @@
  */
 
 #include <map>
+#include <list>
+#include <tuple>
 #include <cmath>
 #include "wifi-spectrum-value-helper.h"
+#include "spectrum-value-kernels.h"
 #include "ns3/log.h"
 #include "ns3/fatal-error.h"
 #include "ns3/assert.h"
@@ -448,6 +451,126 @@ WifiSpectrumValueHelper::CreateHeMuOfdmTxPowerSpectralDensity (uint32_t centerFr
   return c;
 }
 
+///< Wifi transmit PSD structure
+struct WifiTxPsdId
+{
+  WifiSpectrumValueHelper::TxPsdKind m_kind; ///< kind of transmit PSD
+  uint32_t m_centerFrequency; ///< center frequency (in MHz)
+  uint16_t m_channelWidth;    ///< channel width (in MHz)
+  double m_txPowerW;          ///< transmit power (in W)
+  uint16_t m_guardBandwidth;  ///< guard band width (in MHz)
+  double m_minInnerBandDbr;   ///< minimum relative power in the inner band (in dBr)
+  double m_minOuterBandDbr;   ///< minimum relative power in the outer band (in dBr)
+  double m_lowestPointDbr;    ///< maximum relative power of the outermost subcarriers of the guard band (in dBr)
+  WifiSpectrumBand m_ru;      ///< RU band used by the STA
+};
+
+/**
+ * Less than operator
+ * \param a the first transmit PSD to compare
+ * \param b the second transmit PSD to compare
+ * \returns true if the first transmit PSD is less than the second transmit PSD
+ */
+bool
+operator < (const WifiTxPsdId& a, const WifiTxPsdId& b)
+{
+  return std::tie (a.m_kind, a.m_centerFrequency, a.m_channelWidth, a.m_txPowerW, a.m_guardBandwidth,
+                   a.m_minInnerBandDbr, a.m_minOuterBandDbr, a.m_lowestPointDbr, a.m_ru)
+         < std::tie (b.m_kind, b.m_centerFrequency, b.m_channelWidth, b.m_txPowerW, b.m_guardBandwidth,
+                     b.m_minInnerBandDbr, b.m_minOuterBandDbr, b.m_lowestPointDbr, b.m_ru);
+}
+
+/// Transmit PSDs, from the most to the least recently used
+typedef std::list<std::pair<WifiTxPsdId, Ptr<const SpectrumValue> > > WifiTxPsdList;
+
+static WifiTxPsdList g_wifiTxPsdList; ///< cached transmit PSDs, most recently used first
+static std::map<WifiTxPsdId, WifiTxPsdList::iterator> g_wifiTxPsdMap; ///< index of the cached transmit PSDs
+static std::size_t g_wifiTxPsdCacheSize = 64; ///< maximum number of cached transmit PSDs
+
+Ptr<const SpectrumValue>
+WifiSpectrumValueHelper::GetTxPowerSpectralDensity (TxPsdKind kind, uint32_t centerFrequency, uint16_t channelWidth, double txPowerW,
+                                                    uint16_t guardBandwidth, double minInnerBandDbr, double minOuterbandDbr,
+                                                    double lowestPointDbr, WifiSpectrumBand ru)
+{
+  NS_LOG_FUNCTION (kind << centerFrequency << channelWidth << txPowerW << guardBandwidth << minInnerBandDbr
+                   << minOuterbandDbr << lowestPointDbr << ru.first << ru.second);
+  WifiTxPsdId key;
+  key.m_kind = kind;
+  key.m_centerFrequency = centerFrequency;
+  key.m_channelWidth = (kind == TX_PSD_DSSS) ? 0 : channelWidth;
+  key.m_txPowerW = txPowerW;
+  key.m_guardBandwidth = guardBandwidth;
+  bool masked = (kind != TX_PSD_DSSS && kind != TX_PSD_HE_MU_OFDM);
+  key.m_minInnerBandDbr = masked ? minInnerBandDbr : 0;
+  key.m_minOuterBandDbr = masked ? minOuterbandDbr : 0;
+  key.m_lowestPointDbr = masked ? lowestPointDbr : 0;
+  key.m_ru = (kind == TX_PSD_HE_MU_OFDM) ? ru : WifiSpectrumBand (0, 0);
+
+  std::map<WifiTxPsdId, WifiTxPsdList::iterator>::iterator it = g_wifiTxPsdMap.find (key);
+  if (it != g_wifiTxPsdMap.end ())
+    {
+      NS_LOG_LOGIC ("reusing cached transmit PSD");
+      g_wifiTxPsdList.splice (g_wifiTxPsdList.begin (), g_wifiTxPsdList, it->second);
+      return it->second->second;
+    }
+
+  Ptr<SpectrumValue> psd;
+  switch (kind)
+    {
+    case TX_PSD_DSSS:
+      psd = CreateDsssTxPowerSpectralDensity (centerFrequency, txPowerW, guardBandwidth);
+      break;
+    case TX_PSD_OFDM:
+      psd = CreateOfdmTxPowerSpectralDensity (centerFrequency, channelWidth, txPowerW, guardBandwidth, minInnerBandDbr, minOuterbandDbr, lowestPointDbr);
+      break;
+    case TX_PSD_HT_OFDM:
+      psd = CreateHtOfdmTxPowerSpectralDensity (centerFrequency, channelWidth, txPowerW, guardBandwidth, minInnerBandDbr, minOuterbandDbr, lowestPointDbr);
+      break;
+    case TX_PSD_HE_OFDM:
+      psd = CreateHeOfdmTxPowerSpectralDensity (centerFrequency, channelWidth, txPowerW, guardBandwidth, minInnerBandDbr, minOuterbandDbr, lowestPointDbr);
+      break;
+    case TX_PSD_HE_MU_OFDM:
+      psd = CreateHeMuOfdmTxPowerSpectralDensity (centerFrequency, channelWidth, txPowerW, guardBandwidth, ru);
+      break;
+    default:
+      NS_FATAL_ERROR ("Unknown kind of transmit PSD");
+      break;
+    }
+  if (g_wifiTxPsdCacheSize == 0)
+    {
+      return psd;
+    }
+  if (g_wifiTxPsdList.size () == g_wifiTxPsdCacheSize)
+    {
+      NS_LOG_LOGIC ("evicting the least recently used transmit PSD");
+      g_wifiTxPsdMap.erase (g_wifiTxPsdList.back ().first);
+      g_wifiTxPsdList.pop_back ();
+    }
+  g_wifiTxPsdList.push_front (std::make_pair (key, Ptr<const SpectrumValue> (psd)));
+  g_wifiTxPsdMap.insert (std::make_pair (key, g_wifiTxPsdList.begin ()));
+  return psd;
+}
+
+void
+WifiSpectrumValueHelper::SetTxPowerSpectralDensityCacheSize (std::size_t size)
+{
+  NS_LOG_FUNCTION (size);
+  g_wifiTxPsdCacheSize = size;
+  while (g_wifiTxPsdList.size () > size)
+    {
+      g_wifiTxPsdMap.erase (g_wifiTxPsdList.back ().first);
+      g_wifiTxPsdList.pop_back ();
+    }
+}
+
+void
+WifiSpectrumValueHelper::ClearTxPowerSpectralDensityCache (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  g_wifiTxPsdMap.clear ();
+  g_wifiTxPsdList.clear ();
+}
+
 Ptr<SpectrumValue>
 WifiSpectrumValueHelper::CreateNoisePowerSpectralDensity (uint32_t centerFrequency, uint16_t channelWidth, uint32_t bandBandwidth, double noiseFigure, uint16_t guardBandwidth)
 {
@@ -492,6 +615,16 @@ WifiSpectrumValueHelper::CreateRfFilter (uint32_t centerFrequency, uint16_t chan
   return c;
 }
 
+double
+WifiSpectrumValueHelper::GetBandPowerW (Ptr<const SpectrumValue> psd, const WifiSpectrumBand &band)
+{
+  NS_ASSERT (band.first <= band.second);
+  NS_ASSERT (band.second < psd->GetSpectrumModel ()->GetNumBands ());
+  return SpectrumValueKernels::MultiplyIntegrate (&(*psd->ConstValuesBegin ()),
+                                                 psd->GetSpectrumModel ()->GetBandWidths ().data (),
+                                                 band.first, band.second + 1);
+}
+
 void
 WifiSpectrumValueHelper::CreateSpectrumMaskForOfdm (Ptr<SpectrumValue> c, std::vector <WifiSpectrumBand> allocatedSubBands, WifiSpectrumBand maskBand,
                                                     double txPowerPerBandW, uint32_t nGuardBands, uint32_t innerSlopeWidth,
@@ -551,9 +684,8 @@ WifiSpectrumValueHelper::CreateSpectrumMaskForOfdm (Ptr<SpectrumValue> c, std::v
 
   //Build spectrum mask
   Values::iterator vit = c->ValuesBegin ();
-  Bands::const_iterator bit = c->ConstBandsBegin ();
   double txPowerW = 0.0;
-  for (size_t i = 0; i < numBands; i++, vit++, bit++)
+  for (size_t i = 0; i < numBands; i++, vit++)
     {
       if (i < maskBand.first || i > maskBand.second) //outside the spectrum mask
         {
@@ -613,8 +745,10 @@ WifiSpectrumValueHelper::CreateSpectrumMaskForOfdm (Ptr<SpectrumValue> c, std::v
         }
       double txPowerDbr = 10 * std::log10 (txPowerW / txPowerPerBandW);
       NS_LOG_LOGIC (uint32_t (i) << " -> " << txPowerDbr);
-      *vit = txPowerW / (bit->fh - bit->fl);
+      *vit = txPowerW;
     }
+  //Convert the power of each band into a power spectral density
+  SpectrumValueKernels::Divide (&(*c->ValuesBegin ()), c->GetSpectrumModel ()->GetBandWidths ().data (), numBands);
   NS_LOG_INFO ("Added signal power to subbands " << allocatedSubBands.front ().first << "-" << allocatedSubBands.back ().second);
 }
 
@@ -627,11 +761,7 @@ WifiSpectrumValueHelper::NormalizeSpectrumMask (Ptr<SpectrumValue> c, double txP
   double normalizationRatio = currentTxPowerW / txPowerW;
   NS_LOG_LOGIC ("Current power: " << currentTxPowerW << "W vs expected power: " << txPowerW << "W" <<
                 " -> ratio (C/E) = " << normalizationRatio);
-  Values::iterator vit = c->ValuesBegin ();
-  for (size_t i = 0; i < c->GetSpectrumModel ()->GetNumBands (); i++, vit++)
-    {
-      *vit = (*vit) / normalizationRatio;
-    }
+  SpectrumValueKernels::DivideScalar (&(*c->ValuesBegin ()), c->GetSpectrumModel ()->GetNumBands (), normalizationRatio);
 }
 
 double
@@ -148,6 +148,55 @@ public:
    */
   static Ptr<SpectrumValue> CreateHeMuOfdmTxPowerSpectralDensity (uint32_t centerFrequency, uint16_t channelWidth, double txPowerW, uint16_t guardBandwidth, WifiSpectrumBand ru);
 
+  /// The kinds of transmit power spectral density
+  enum TxPsdKind
+  {
+    TX_PSD_DSSS,       //!< DSSS (see CreateDsssTxPowerSpectralDensity)
+    TX_PSD_OFDM,       //!< OFDM (see CreateOfdmTxPowerSpectralDensity)
+    TX_PSD_HT_OFDM,    //!< HT OFDM (see CreateHtOfdmTxPowerSpectralDensity)
+    TX_PSD_HE_OFDM,    //!< HE OFDM (see CreateHeOfdmTxPowerSpectralDensity)
+    TX_PSD_HE_MU_OFDM  //!< OFDMA part of HE TB PPDUs (see CreateHeMuOfdmTxPowerSpectralDensity)
+  };
+
+  /**
+   * Get a transmit power spectral density of the given kind, created by
+   * the corresponding Create function the first time these parameters are
+   * requested. The most recently used values are kept in a bounded cache
+   * (see SetTxPowerSpectralDensityCacheSize) and shared between all the
+   * callers, hence they must not be modified; copy them first if needed.
+   * Parameters that are irrelevant to the requested kind (e.g., the mask
+   * rejections for TX_PSD_DSSS, or the RU for any kind but TX_PSD_HE_MU_OFDM)
+   * are ignored.
+   *
+   * \param kind the kind of transmit power spectral density
+   * \param centerFrequency center frequency (MHz)
+   * \param channelWidth channel width (MHz)
+   * \param txPowerW  transmit power (W) to allocate
+   * \param guardBandwidth width of the guard band (MHz)
+   * \param minInnerBandDbr the minimum relative power in the inner band (in dBr)
+   * \param minOuterbandDbr the minimum relative power in the outer band (in dBr)
+   * \param lowestPointDbr maximum relative power of the outermost subcarriers of the guard band (in dBr)
+   * \param ru the RU band used by the STA
+   * \return a pointer to a shared SpectrumValue representing the Transmit Power Spectral Density in W/Hz for each Band
+   */
+  static Ptr<const SpectrumValue> GetTxPowerSpectralDensity (TxPsdKind kind, uint32_t centerFrequency, uint16_t channelWidth, double txPowerW,
+                                                             uint16_t guardBandwidth, double minInnerBandDbr = -20, double minOuterbandDbr = -28,
+                                                             double lowestPointDbr = -40, WifiSpectrumBand ru = WifiSpectrumBand (0, 0));
+
+  /**
+   * Set the maximum number of transmit power spectral densities kept by
+   * GetTxPowerSpectralDensity; the least recently used ones are evicted
+   * first. A size of zero disables the cache.
+   *
+   * \param size the maximum number of cached transmit power spectral densities
+   */
+  static void SetTxPowerSpectralDensityCacheSize (std::size_t size);
+
+  /**
+   * Drop all the transmit power spectral densities kept by GetTxPowerSpectralDensity
+   */
+  static void ClearTxPowerSpectralDensityCache (void);
+
   /**
    * Create a power spectral density corresponding to the noise
    *
@@ -183,6 +232,20 @@ public:
    */
   static Ptr<SpectrumValue> CreateRfFilter (uint32_t centerFrequency, uint16_t totalChannelWidth, uint32_t bandBandwidth, uint16_t guardBandwidth, WifiSpectrumBand band);
 
+  /**
+   * Calculate the power of a band, i.e. the integral of a power spectral density
+   * restricted to the sub-bands from the start index to the stop index (both included).
+   * This gives the same result as integrating the product of the power spectral density
+   * with the RF filter returned by CreateRfFilter for that band, without allocating the
+   * filter nor the filtered signal.
+   *
+   * \param psd the power spectral density (W/Hz)
+   * \param band the pair of start and stop indexes that defines the band
+   *
+   * \return the power of the band (W)
+   */
+  static double GetBandPowerW (Ptr<const SpectrumValue> psd, const WifiSpectrumBand &band);
+
   /**
    * Create a transmit power spectral density corresponding to OFDM
    * transmit spectrum mask requirements for 11a/11g/11n/11ac/11ax
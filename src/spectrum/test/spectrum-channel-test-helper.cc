@@ -0,0 +1,210 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 University of Washington
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Sébastien Deronne <sebastien.deronne@gmail.com>
+ */
+
+#include <ns3/simulator.h>
+#include <ns3/constant-position-mobility-model.h>
+#include <ns3/net-device.h>
+#include <ns3/antenna-model.h>
+#include <ns3/spectrum-signal-parameters.h>
+#include "spectrum-channel-test-helper.h"
+
+namespace ns3 {
+
+bool
+operator == (const ChannelTestReception &a, const ChannelTestReception &b)
+{
+  return a.time == b.time && a.rxId == b.rxId && a.powerW == b.powerW;
+}
+
+ChannelTestPhy::ChannelTestPhy (Ptr<const SpectrumModel> rxSpectrumModel, uint32_t id,
+                                std::vector<ChannelTestReception> *log, bool sharedPsdSupported)
+  : m_rxSpectrumModel (rxSpectrumModel),
+    m_id (id),
+    m_log (log),
+    m_sharedPsdSupported (sharedPsdSupported)
+{
+}
+
+void
+ChannelTestPhy::DoDispose (void)
+{
+  m_lastRxParams = 0;
+  m_mobility = 0;
+  m_rxSpectrumModel = 0;
+  SpectrumPhy::DoDispose ();
+}
+
+void
+ChannelTestPhy::SetDevice (Ptr<NetDevice> d)
+{
+}
+
+Ptr<NetDevice>
+ChannelTestPhy::GetDevice () const
+{
+  return 0;
+}
+
+void
+ChannelTestPhy::SetMobility (Ptr<MobilityModel> m)
+{
+  m_mobility = m;
+}
+
+Ptr<MobilityModel>
+ChannelTestPhy::GetMobility ()
+{
+  return m_mobility;
+}
+
+void
+ChannelTestPhy::SetChannel (Ptr<SpectrumChannel> c)
+{
+}
+
+Ptr<const SpectrumModel>
+ChannelTestPhy::GetRxSpectrumModel () const
+{
+  return m_rxSpectrumModel;
+}
+
+Ptr<AntennaModel>
+ChannelTestPhy::GetRxAntenna ()
+{
+  return 0;
+}
+
+void
+ChannelTestPhy::StartRx (Ptr<SpectrumSignalParameters> params)
+{
+  ChannelTestReception reception;
+  reception.time = Simulator::Now ();
+  reception.rxId = m_id;
+  reception.powerW = Integral (*params->psd) * params->psdGain;
+  m_log->push_back (reception);
+  m_lastRxParams = params;
+}
+
+bool
+ChannelTestPhy::IsSharedPsdSupported () const
+{
+  return m_sharedPsdSupported;
+}
+
+Ptr<SpectrumSignalParameters>
+ChannelTestPhy::GetLastRxParams (void) const
+{
+  return m_lastRxParams;
+}
+
+SpectrumChannelTestScenario::SpectrumChannelTestScenario (uint32_t nBands)
+{
+  std::vector<double> freqs;
+  for (uint32_t i = 0; i < nBands; i++)
+    {
+      freqs.push_back (5e9 + i * 1e6);
+    }
+  m_spectrumModel = Create<SpectrumModel> (freqs);
+  m_channel = CreateObject<MultiModelSpectrumChannel> ();
+}
+
+SpectrumChannelTestScenario::~SpectrumChannelTestScenario ()
+{
+  for (std::vector<Ptr<ChannelTestPhy> >::iterator it = m_phys.begin (); it != m_phys.end (); ++it)
+    {
+      (*it)->Dispose ();
+    }
+  m_channel->Dispose ();
+}
+
+Ptr<MultiModelSpectrumChannel>
+SpectrumChannelTestScenario::GetChannel (void) const
+{
+  return m_channel;
+}
+
+Ptr<const SpectrumModel>
+SpectrumChannelTestScenario::GetSpectrumModel (void) const
+{
+  return m_spectrumModel;
+}
+
+Ptr<ChannelTestPhy>
+SpectrumChannelTestScenario::AddPhy (Ptr<MobilityModel> mobility, bool sharedPsdSupported)
+{
+  Ptr<ChannelTestPhy> phy = CreateObject<ChannelTestPhy> (m_spectrumModel, m_phys.size (), &m_receptions, sharedPsdSupported);
+  phy->SetMobility (mobility);
+  m_channel->AddRx (phy);
+  m_phys.push_back (phy);
+  return phy;
+}
+
+Ptr<ChannelTestPhy>
+SpectrumChannelTestScenario::AddPhy (Vector position, bool sharedPsdSupported)
+{
+  Ptr<ConstantPositionMobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+  mobility->SetPosition (position);
+  return AddPhy (mobility, sharedPsdSupported);
+}
+
+void
+SpectrumChannelTestScenario::ScheduleTx (Time time, uint32_t txId, Ptr<SpectrumValue> psd)
+{
+  Ptr<SpectrumSignalParameters> txParams = Create<SpectrumSignalParameters> ();
+  txParams->psd = psd;
+  txParams->duration = MicroSeconds (10);
+  txParams->txPhy = m_phys.at (txId);
+  Simulator::Schedule (time, &MultiModelSpectrumChannel::StartTx, m_channel, txParams);
+}
+
+void
+SpectrumChannelTestScenario::ScheduleRounds (uint32_t nRounds)
+{
+  Ptr<SpectrumValue> txPsd = Create<SpectrumValue> (m_spectrumModel);
+  (*txPsd) = 1e-9;
+  for (uint32_t round = 0; round < nRounds; round++)
+    {
+      for (uint32_t i = 0; i < m_phys.size (); i++)
+        {
+          ScheduleTx (Seconds (round * 10 + i * 0.01), i, txPsd);
+        }
+    }
+}
+
+void
+SpectrumChannelTestScenario::ScheduleMove (Time time, uint32_t id, Vector position)
+{
+  Simulator::Schedule (time, &MobilityModel::SetPosition, m_phys.at (id)->GetMobility (), position);
+}
+
+void
+SpectrumChannelTestScenario::Run (void)
+{
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+const std::vector<ChannelTestReception> &
+SpectrumChannelTestScenario::GetReceptions (void) const
+{
+  return m_receptions;
+}
+
+} // namespace ns3
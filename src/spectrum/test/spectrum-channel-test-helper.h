@@ -0,0 +1,193 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 University of Washington
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Sébastien Deronne <sebastien.deronne@gmail.com>
+ */
+
+#ifndef SPECTRUM_CHANNEL_TEST_HELPER_H
+#define SPECTRUM_CHANNEL_TEST_HELPER_H
+
+#include <ns3/nstime.h>
+#include <ns3/vector.h>
+#include <ns3/spectrum-phy.h>
+#include <ns3/spectrum-value.h>
+#include <ns3/multi-model-spectrum-channel.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup spectrum-test
+ * \ingroup tests
+ *
+ * \brief A signal received by a ChannelTestPhy
+ */
+struct ChannelTestReception
+{
+  Time time;      ///< the time at which the signal has been received
+  uint32_t rxId;  ///< the identifier of the receiving PHY
+  double powerW;  ///< the received power (W)
+};
+
+/**
+ * \brief equality operator
+ *
+ * \param a the first reception
+ * \param b the second reception
+ * \returns true if the receptions are identical
+ */
+bool operator == (const ChannelTestReception &a, const ChannelTestReception &b);
+
+/**
+ * \ingroup spectrum-test
+ * \ingroup tests
+ *
+ * \brief Minimal SpectrumPhy logging the signals it receives and recording
+ * the last one
+ */
+class ChannelTestPhy : public SpectrumPhy
+{
+public:
+  /**
+   * Constructor
+   *
+   * \param rxSpectrumModel the receive SpectrumModel
+   * \param id the identifier of the PHY
+   * \param log the log of receptions shared by all the PHYs
+   * \param sharedPsdSupported whether shared PSDs are supported
+   */
+  ChannelTestPhy (Ptr<const SpectrumModel> rxSpectrumModel, uint32_t id,
+                  std::vector<ChannelTestReception> *log, bool sharedPsdSupported);
+
+  // inherited from SpectrumPhy
+  void SetDevice (Ptr<NetDevice> d);
+  Ptr<NetDevice> GetDevice () const;
+  void SetMobility (Ptr<MobilityModel> m);
+  Ptr<MobilityModel> GetMobility ();
+  void SetChannel (Ptr<SpectrumChannel> c);
+  Ptr<const SpectrumModel> GetRxSpectrumModel () const;
+  Ptr<AntennaModel> GetRxAntenna ();
+  void StartRx (Ptr<SpectrumSignalParameters> params);
+  bool IsSharedPsdSupported () const;
+
+  /**
+   * \return the parameters of the last received signal, 0 if none
+   */
+  Ptr<SpectrumSignalParameters> GetLastRxParams (void) const;
+
+private:
+  virtual void DoDispose (void);
+
+  Ptr<const SpectrumModel> m_rxSpectrumModel;    ///< the receive SpectrumModel
+  Ptr<MobilityModel> m_mobility;                 ///< the mobility model
+  uint32_t m_id;                                 ///< the identifier of the PHY
+  std::vector<ChannelTestReception> *m_log;      ///< the log of receptions
+  bool m_sharedPsdSupported;                     ///< whether shared PSDs are supported
+  Ptr<SpectrumSignalParameters> m_lastRxParams;  ///< the last received signal parameters
+};
+
+/**
+ * \ingroup spectrum-test
+ * \ingroup tests
+ *
+ * \brief Scenario of ChannelTestPhy instances attached to a
+ * MultiModelSpectrumChannel, whose bands are 1 MHz apart from 5 GHz. The
+ * simulator is destroyed when the scenario is run, and the PHYs and the
+ * channel are disposed of when the scenario is deleted.
+ */
+class SpectrumChannelTestScenario
+{
+public:
+  /**
+   * Constructor
+   *
+   * \param nBands the number of bands of the SpectrumModel
+   */
+  SpectrumChannelTestScenario (uint32_t nBands);
+  ~SpectrumChannelTestScenario ();
+
+  /**
+   * \return the channel, to be configured before the scenario is run
+   */
+  Ptr<MultiModelSpectrumChannel> GetChannel (void) const;
+  /**
+   * \return the SpectrumModel used by all the PHYs
+   */
+  Ptr<const SpectrumModel> GetSpectrumModel (void) const;
+
+  /**
+   * Add a PHY, whose identifier is the number of PHYs already added.
+   *
+   * \param mobility the mobility model of the PHY
+   * \param sharedPsdSupported whether the PHY supports shared PSDs
+   * \return the PHY
+   */
+  Ptr<ChannelTestPhy> AddPhy (Ptr<MobilityModel> mobility, bool sharedPsdSupported = false);
+  /**
+   * Add a PHY at a constant position, whose identifier is the number of
+   * PHYs already added.
+   *
+   * \param position the position of the PHY
+   * \param sharedPsdSupported whether the PHY supports shared PSDs
+   * \return the PHY
+   */
+  Ptr<ChannelTestPhy> AddPhy (Vector position, bool sharedPsdSupported = false);
+
+  /**
+   * Schedule a transmission.
+   *
+   * \param time the time of the transmission
+   * \param txId the identifier of the transmitting PHY
+   * \param psd the transmitted PSD
+   */
+  void ScheduleTx (Time time, uint32_t txId, Ptr<SpectrumValue> psd);
+  /**
+   * Schedule rounds of transmissions, 10 s apart, in which every PHY
+   * transmits in turn a PSD of 1e-9 W/Hz, 10 ms after the previous one.
+   *
+   * \param nRounds the number of rounds
+   */
+  void ScheduleRounds (uint32_t nRounds);
+  /**
+   * Schedule the move of a PHY.
+   *
+   * \param time the time of the move
+   * \param id the identifier of the PHY
+   * \param position the new position of the PHY
+   */
+  void ScheduleMove (Time time, uint32_t id, Vector position);
+
+  /**
+   * Run the simulation, then destroy the simulator.
+   */
+  void Run (void);
+
+  /**
+   * \return the receptions of all the PHYs, in the order of reception
+   */
+  const std::vector<ChannelTestReception> & GetReceptions (void) const;
+
+private:
+  Ptr<SpectrumModel> m_spectrumModel;             ///< the SpectrumModel used by all the PHYs
+  Ptr<MultiModelSpectrumChannel> m_channel;       ///< the channel
+  std::vector<Ptr<ChannelTestPhy> > m_phys;       ///< the PHYs, indexed by identifier
+  std::vector<ChannelTestReception> m_receptions; ///< the log of receptions
+};
+
+} // namespace ns3
+
+#endif /* SPECTRUM_CHANNEL_TEST_HELPER_H */
@@ -0,0 +1,186 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 University of Washington
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Sébastien Deronne <sebastien.deronne@gmail.com>
+ */
+
+#include <ns3/test.h>
+#include <ns3/log.h>
+#include <ns3/simulator.h>
+#include <ns3/boolean.h>
+#include <ns3/propagation-loss-model.h>
+#include <ns3/propagation-delay-model.h>
+#include "spectrum-channel-test-helper.h"
+#include <cmath>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("SpectrumPathCacheTest");
+
+/**
+ * \ingroup spectrum-test
+ * \ingroup tests
+ *
+ * \brief Log-distance loss model counting the number of losses it computes
+ */
+class CountingLossModel : public PropagationLossModel
+{
+public:
+  /**
+   * Constructor
+   *
+   * \param deterministic whether the model declares itself deterministic
+   */
+  CountingLossModel (bool deterministic);
+
+  uint32_t m_nComputations; ///< the number of losses computed
+
+private:
+  virtual double DoCalcRxPower (double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
+  virtual int64_t DoAssignStreams (int64_t stream);
+  virtual bool DoIsDeterministic (void) const;
+
+  bool m_deterministic; ///< whether the model declares itself deterministic
+};
+
+CountingLossModel::CountingLossModel (bool deterministic)
+  : m_nComputations (0),
+    m_deterministic (deterministic)
+{
+}
+
+double
+CountingLossModel::DoCalcRxPower (double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const
+{
+  const_cast<CountingLossModel *> (this)->m_nComputations++;
+  return txPowerDbm - 40 - 30 * std::log10 (a->GetDistanceFrom (b));
+}
+
+int64_t
+CountingLossModel::DoAssignStreams (int64_t stream)
+{
+  return 0;
+}
+
+bool
+CountingLossModel::DoIsDeterministic (void) const
+{
+  return m_deterministic;
+}
+
+/**
+ * \ingroup spectrum-test
+ * \ingroup tests
+ *
+ * \brief Check that the path cache of MultiModelSpectrumChannel does not
+ * change the receptions, including after a node has moved, and that it is
+ * only used with deterministic loss models.
+ */
+class SpectrumPathCacheTestCase : public TestCase
+{
+public:
+  SpectrumPathCacheTestCase ();
+  virtual ~SpectrumPathCacheTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Run a scenario where each node transmits three times in turn, one
+   * node being moved after the first round of transmissions.
+   *
+   * \param cachePaths the value of the CachePaths attribute
+   * \param deterministic whether the loss model declares itself deterministic
+   * \param log the log of receptions
+   * \return the number of losses computed by the loss model
+   */
+  uint32_t RunScenario (bool cachePaths, bool deterministic, std::vector<ChannelTestReception> &log);
+};
+
+SpectrumPathCacheTestCase::SpectrumPathCacheTestCase ()
+  : TestCase ("Check the path cache of MultiModelSpectrumChannel")
+{
+}
+
+SpectrumPathCacheTestCase::~SpectrumPathCacheTestCase ()
+{
+}
+
+uint32_t
+SpectrumPathCacheTestCase::RunScenario (bool cachePaths, bool deterministic, std::vector<ChannelTestReception> &log)
+{
+  const uint32_t nNodes = 5;
+
+  SpectrumChannelTestScenario scenario (4);
+  Ptr<MultiModelSpectrumChannel> channel = scenario.GetChannel ();
+  channel->SetAttribute ("CachePaths", BooleanValue (cachePaths));
+  Ptr<CountingLossModel> loss = CreateObject<CountingLossModel> (deterministic);
+  channel->AddPropagationLossModel (loss);
+  channel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+
+  for (uint32_t i = 0; i < nNodes; i++)
+    {
+      scenario.AddPhy (Vector (10.0 * i, 5.0 * (i % 2), 0));
+    }
+  scenario.ScheduleRounds (3);
+  scenario.ScheduleMove (Seconds (5), 2, Vector (100, 100, 0));
+  scenario.Run ();
+  log = scenario.GetReceptions ();
+  return loss->m_nComputations;
+}
+
+void
+SpectrumPathCacheTestCase::DoRun (void)
+{
+  const uint32_t nPaths = 5 * 4;
+
+  std::vector<ChannelTestReception> referenceLog;
+  uint32_t referenceComputations = RunScenario (false, true, referenceLog);
+  NS_TEST_ASSERT_MSG_EQ (referenceComputations, 3 * nPaths, "Unexpected number of loss computations without cache");
+
+  std::vector<ChannelTestReception> cachedLog;
+  uint32_t cachedComputations = RunScenario (true, true, cachedLog);
+  NS_TEST_ASSERT_MSG_EQ ((cachedLog == referenceLog), true, "The path cache changed the receptions");
+  // every path is computed in the first round, then the 8 paths to and
+  // from the node that moved are computed again in the second round
+  NS_TEST_ASSERT_MSG_EQ (cachedComputations, nPaths + 8, "Unexpected number of loss computations with cache");
+
+  std::vector<ChannelTestReception> stochasticLog;
+  uint32_t stochasticComputations = RunScenario (true, false, stochasticLog);
+  NS_TEST_ASSERT_MSG_EQ ((stochasticLog == referenceLog), true, "The path cache changed the receptions");
+  NS_TEST_ASSERT_MSG_EQ (stochasticComputations, referenceComputations, "A non-deterministic loss model should not be cached");
+}
+
+/**
+ * \ingroup spectrum-test
+ * \ingroup tests
+ *
+ * \brief Path cache test suite
+ */
+class SpectrumPathCacheTestSuite : public TestSuite
+{
+public:
+  SpectrumPathCacheTestSuite ();
+};
+
+SpectrumPathCacheTestSuite::SpectrumPathCacheTestSuite ()
+  : TestSuite ("spectrum-path-cache", UNIT)
+{
+  AddTestCase (new SpectrumPathCacheTestCase, TestCase::QUICK);
+}
+
+static SpectrumPathCacheTestSuite g_spectrumPathCacheTestSuite; ///< the test suite
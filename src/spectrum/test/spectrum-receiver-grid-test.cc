@@ -0,0 +1,185 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 University of Washington
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Sébastien Deronne <sebastien.deronne@gmail.com>
+ */
+
+#include <ns3/test.h>
+#include <ns3/log.h>
+#include <ns3/simulator.h>
+#include <ns3/double.h>
+#include <ns3/boolean.h>
+#include <ns3/pointer.h>
+#include <ns3/random-variable-stream.h>
+#include <ns3/constant-velocity-mobility-model.h>
+#include <ns3/propagation-loss-model.h>
+#include "spectrum-channel-test-helper.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("SpectrumReceiverGridTest");
+
+/**
+ * \ingroup spectrum-test
+ * \ingroup tests
+ *
+ * \brief Check that the spatial index of MultiModelSpectrumChannel delivers
+ * the signals to the same receivers, in the same order, as the exhaustive
+ * loop, including after receivers have moved, while computing the loss of
+ * fewer receivers, and that it does not cull any receiver when the range is
+ * not set and the propagation loss model is not deterministic.
+ */
+class SpectrumReceiverGridTestCase : public TestCase
+{
+public:
+  SpectrumReceiverGridTestCase ();
+  virtual ~SpectrumReceiverGridTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Run a scenario where each node transmits in turn, half of the nodes
+   * being moved before a second round of transmissions.
+   *
+   * \param spatialIndex whether to enable the spatial index
+   * \param maxRange the value of the MaxRange attribute
+   * \param deterministic whether the propagation loss model is deterministic
+   * \param log the log of receptions
+   * \return the number of receivers whose loss has been computed
+   */
+  uint32_t RunScenario (bool spatialIndex, double maxRange, bool deterministic, std::vector<ChannelTestReception> &log);
+
+  /**
+   * Called when the path loss between a transmitter and a receiver is computed
+   *
+   * \param txPhy the transmitter
+   * \param rxPhy the receiver
+   * \param lossDb the loss (dB)
+   */
+  void NotifyPathLoss (Ptr<const SpectrumPhy> txPhy, Ptr<const SpectrumPhy> rxPhy, double lossDb);
+
+  uint32_t m_nLossComputations; ///< the number of receivers whose loss has been computed
+};
+
+SpectrumReceiverGridTestCase::SpectrumReceiverGridTestCase ()
+  : TestCase ("Check the spatial culling of receivers in MultiModelSpectrumChannel")
+{
+}
+
+SpectrumReceiverGridTestCase::~SpectrumReceiverGridTestCase ()
+{
+}
+
+void
+SpectrumReceiverGridTestCase::NotifyPathLoss (Ptr<const SpectrumPhy> txPhy, Ptr<const SpectrumPhy> rxPhy, double lossDb)
+{
+  m_nLossComputations++;
+}
+
+uint32_t
+SpectrumReceiverGridTestCase::RunScenario (bool spatialIndex, double maxRange, bool deterministic, std::vector<ChannelTestReception> &log)
+{
+  const uint32_t nNodes = 40;
+  m_nLossComputations = 0;
+
+  SpectrumChannelTestScenario scenario (4);
+  Ptr<MultiModelSpectrumChannel> channel = scenario.GetChannel ();
+  channel->SetAttribute ("SpatialIndex", BooleanValue (spatialIndex));
+  channel->SetAttribute ("MaxRange", DoubleValue (maxRange));
+  channel->SetAttribute ("MaxLossDb", DoubleValue (120));
+  Ptr<LogDistancePropagationLossModel> loss = CreateObject<LogDistancePropagationLossModel> ();
+  if (!deterministic)
+    {
+      Ptr<UniformRandomVariable> fading = CreateObject<UniformRandomVariable> ();
+      fading->SetAttribute ("Max", DoubleValue (20));
+      Ptr<RandomPropagationLossModel> random = CreateObject<RandomPropagationLossModel> ();
+      random->SetAttribute ("Variable", PointerValue (fading));
+      random->AssignStreams (1);
+      loss->SetNext (random);
+    }
+  channel->AddPropagationLossModel (loss);
+  channel->TraceConnectWithoutContext ("PathLoss", MakeCallback (&SpectrumReceiverGridTestCase::NotifyPathLoss, this));
+
+  // scatter the nodes over a 1 km x 1 km area, the last one moving
+  for (uint32_t i = 0; i < nNodes - 1; i++)
+    {
+      scenario.AddPhy (Vector ((i * 373) % 1000, (i * 611) % 1000, 0));
+    }
+  Ptr<ConstantVelocityMobilityModel> moving = CreateObject<ConstantVelocityMobilityModel> ();
+  moving->SetPosition (Vector (((nNodes - 1) * 373) % 1000, ((nNodes - 1) * 611) % 1000, 0));
+  moving->SetVelocity (Vector (20, 0, 0));
+  scenario.AddPhy (moving);
+
+  scenario.ScheduleRounds (2);
+  // move half of the static nodes between the two rounds
+  for (uint32_t i = 0; i < nNodes - 1; i += 2)
+    {
+      scenario.ScheduleMove (Seconds (5), i, Vector ((i * 149) % 1000, (i * 257) % 1000, 0));
+    }
+  scenario.Run ();
+  log = scenario.GetReceptions ();
+  return m_nLossComputations;
+}
+
+void
+SpectrumReceiverGridTestCase::DoRun (void)
+{
+  std::vector<ChannelTestReception> referenceLog;
+  uint32_t referenceComputations = RunScenario (false, 0, true, referenceLog);
+  NS_TEST_ASSERT_MSG_GT (referenceLog.size (), 0, "Some signals should have been received");
+
+  // range derived from MaxLossDb and the propagation loss model
+  std::vector<ChannelTestReception> derivedLog;
+  uint32_t derivedComputations = RunScenario (true, 0, true, derivedLog);
+  NS_TEST_ASSERT_MSG_EQ ((derivedLog == referenceLog), true, "Culling with a derived range changed the receptions");
+  NS_TEST_ASSERT_MSG_LT (derivedComputations, referenceComputations, "Culling with a derived range did not skip any receiver");
+
+  // explicit range, smaller than the cell size initially used by the grid
+  std::vector<ChannelTestReception> explicitLog;
+  uint32_t explicitComputations = RunScenario (true, 350, true, explicitLog);
+  NS_TEST_ASSERT_MSG_EQ ((explicitLog == referenceLog), true, "Culling with an explicit range changed the receptions");
+  NS_TEST_ASSERT_MSG_LT (explicitComputations, referenceComputations, "Culling with an explicit range did not skip any receiver");
+
+  // no range can be derived from a random loss, so that no receiver is culled
+  std::vector<ChannelTestReception> randomReferenceLog;
+  uint32_t randomReferenceComputations = RunScenario (false, 0, false, randomReferenceLog);
+  std::vector<ChannelTestReception> randomLog;
+  uint32_t randomComputations = RunScenario (true, 0, false, randomLog);
+  NS_TEST_ASSERT_MSG_EQ ((randomLog == randomReferenceLog), true, "Culling with a random loss changed the receptions");
+  NS_TEST_ASSERT_MSG_EQ (randomComputations, randomReferenceComputations, "Culling with a random loss skipped some receivers");
+}
+
+/**
+ * \ingroup spectrum-test
+ * \ingroup tests
+ *
+ * \brief Spatial culling test suite
+ */
+class SpectrumReceiverGridTestSuite : public TestSuite
+{
+public:
+  SpectrumReceiverGridTestSuite ();
+};
+
+SpectrumReceiverGridTestSuite::SpectrumReceiverGridTestSuite ()
+  : TestSuite ("spectrum-receiver-grid", UNIT)
+{
+  AddTestCase (new SpectrumReceiverGridTestCase, TestCase::QUICK);
+}
+
+static SpectrumReceiverGridTestSuite g_spectrumReceiverGridTestSuite; ///< the test suite
@@ -0,0 +1,134 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 University of Washington
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Sébastien Deronne <sebastien.deronne@gmail.com>
+ */
+
+#include <ns3/test.h>
+#include <ns3/log.h>
+#include <ns3/simulator.h>
+#include <ns3/boolean.h>
+#include <ns3/propagation-loss-model.h>
+#include <ns3/spectrum-signal-parameters.h>
+#include "spectrum-channel-test-helper.h"
+#include <cmath>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("SpectrumSharedPsdTest");
+
+/**
+ * \ingroup spectrum-test
+ * \ingroup tests
+ *
+ * \brief Check that MultiModelSpectrumChannel only shares the transmitted
+ * PSD with the receivers supporting it, and that every receiver ends up
+ * with the same received power.
+ */
+class SpectrumSharedPsdTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor
+   *
+   * \param shareTxPsd the value of the ShareTxPsd attribute of the channel
+   */
+  SpectrumSharedPsdTestCase (bool shareTxPsd);
+  virtual ~SpectrumSharedPsdTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  bool m_shareTxPsd; ///< the value of the ShareTxPsd attribute of the channel
+};
+
+SpectrumSharedPsdTestCase::SpectrumSharedPsdTestCase (bool shareTxPsd)
+  : TestCase (std::string ("Check PSD sharing in MultiModelSpectrumChannel with ShareTxPsd=") + (shareTxPsd ? "true" : "false")),
+    m_shareTxPsd (shareTxPsd)
+{
+}
+
+SpectrumSharedPsdTestCase::~SpectrumSharedPsdTestCase ()
+{
+}
+
+void
+SpectrumSharedPsdTestCase::DoRun (void)
+{
+  const double rxPowerDbm = -60;
+  const double pathGain = std::pow (10.0, rxPowerDbm / 10.0);
+
+  SpectrumChannelTestScenario scenario (9);
+  Ptr<const SpectrumModel> model = scenario.GetSpectrumModel ();
+  Ptr<MultiModelSpectrumChannel> channel = scenario.GetChannel ();
+  channel->SetAttribute ("ShareTxPsd", BooleanValue (m_shareTxPsd));
+  Ptr<FixedRssLossModel> loss = CreateObject<FixedRssLossModel> ();
+  loss->SetRss (rxPowerDbm);
+  channel->AddPropagationLossModel (loss);
+
+  Ptr<ChannelTestPhy> txPhy = scenario.AddPhy (Vector (0, 0, 0), true);
+  Ptr<ChannelTestPhy> sharingPhy = scenario.AddPhy (Vector (10, 0, 0), true);
+  Ptr<ChannelTestPhy> copyingPhy = scenario.AddPhy (Vector (20, 0, 0), false);
+
+  Ptr<SpectrumValue> txPsd = Create<SpectrumValue> (model);
+  for (std::size_t i = 0; i < model->GetNumBands (); i++)
+    {
+      (*txPsd)[i] = 1e-8 * (i + 1);
+    }
+  Ptr<SpectrumValue> txPsdCopy = txPsd->Copy ();
+  scenario.ScheduleTx (Seconds (0), 0, txPsd);
+  scenario.Run ();
+
+  NS_TEST_ASSERT_MSG_EQ ((txPhy->GetLastRxParams () == 0), true, "The transmitter should not receive its own signal");
+  Ptr<SpectrumSignalParameters> shared = sharingPhy->GetLastRxParams ();
+  Ptr<SpectrumSignalParameters> copied = copyingPhy->GetLastRxParams ();
+  NS_TEST_ASSERT_MSG_EQ ((shared != 0 && copied != 0), true, "Both receivers should have received the signal");
+
+  NS_TEST_ASSERT_MSG_EQ ((shared->psd == txPsd), m_shareTxPsd, "Unexpected sharing of the transmitted PSD");
+  NS_TEST_ASSERT_MSG_EQ ((copied->psd == txPsd), false, "The PSD should have been copied for a receiver not supporting it");
+  NS_TEST_ASSERT_MSG_EQ_TOL (shared->psdGain, (m_shareTxPsd ? pathGain : 1), 1e-15, "Unexpected PSD gain");
+  NS_TEST_ASSERT_MSG_EQ (copied->psdGain, 1, "The gain should have been applied to the PSD");
+
+  double expectedPowerW = Integral (*txPsdCopy) * pathGain;
+  NS_TEST_ASSERT_MSG_EQ_TOL (Integral (*shared->psd) * shared->psdGain, expectedPowerW, 1e-9 * expectedPowerW, "Wrong received power");
+  NS_TEST_ASSERT_MSG_EQ_TOL (Integral (*copied->psd) * copied->psdGain, expectedPowerW, 1e-9 * expectedPowerW, "Wrong received power");
+  for (std::size_t i = 0; i < model->GetNumBands (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ ((*txPsd)[i], (*txPsdCopy)[i], "The transmitted PSD should not have been modified");
+    }
+}
+
+/**
+ * \ingroup spectrum-test
+ * \ingroup tests
+ *
+ * \brief Shared PSD test suite
+ */
+class SpectrumSharedPsdTestSuite : public TestSuite
+{
+public:
+  SpectrumSharedPsdTestSuite ();
+};
+
+SpectrumSharedPsdTestSuite::SpectrumSharedPsdTestSuite ()
+  : TestSuite ("spectrum-shared-psd", UNIT)
+{
+  AddTestCase (new SpectrumSharedPsdTestCase (true), TestCase::QUICK);
+  AddTestCase (new SpectrumSharedPsdTestCase (false), TestCase::QUICK);
+}
+
+static SpectrumSharedPsdTestSuite g_spectrumSharedPsdTestSuite; ///< the test suite
@@ -0,0 +1,274 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 University of Washington
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Sébastien Deronne <sebastien.deronne@gmail.com>
+ */
+
+#include <ns3/test.h>
+#include <ns3/log.h>
+#include <ns3/system-wall-clock-ms.h>
+#include <ns3/spectrum-value.h>
+#include <ns3/spectrum-value-kernels.h>
+#include <ns3/wifi-spectrum-value-helper.h>
+#include <iostream>
+#include <cmath>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("SpectrumValueKernelsTest");
+
+/**
+ * Fill an array with deterministic, non trivial values
+ *
+ * \param x the array to fill
+ * \param seed the seed used to generate different arrays
+ */
+static void
+FillArray (std::vector<double> &x, double seed)
+{
+  for (std::size_t i = 0; i < x.size (); i++)
+    {
+      x[i] = 1.5 + std::sin (seed + 0.37 * i);
+    }
+}
+
+/**
+ * \ingroup spectrum-test
+ * \ingroup tests
+ *
+ * \brief Check that every SIMD implementation of the SpectrumValue kernels
+ * produces the same results as the scalar implementation, including for
+ * array sizes and index ranges that are not multiple of the vector width.
+ */
+class SpectrumValueKernelsTestCase : public TestCase
+{
+public:
+  SpectrumValueKernelsTestCase ();
+  virtual ~SpectrumValueKernelsTestCase ();
+
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  /**
+   * Run all the kernels with the given instruction set and compare the
+   * results with those of the scalar implementation.
+   *
+   * \param isa the instruction set
+   * \param n the size of the arrays
+   */
+  void CheckKernels (SpectrumValueKernels::Isa isa, std::size_t n);
+
+  SpectrumValueKernels::Isa m_isa; ///< the instruction set in use before the test
+};
+
+SpectrumValueKernelsTestCase::SpectrumValueKernelsTestCase ()
+  : TestCase ("Check SIMD SpectrumValue kernels against the scalar implementation")
+{
+}
+
+SpectrumValueKernelsTestCase::~SpectrumValueKernelsTestCase ()
+{
+}
+
+void
+SpectrumValueKernelsTestCase::CheckKernels (SpectrumValueKernels::Isa isa, std::size_t n)
+{
+  std::vector<double> x (n);
+  std::vector<double> y (n);
+  FillArray (x, 1.0);
+  FillArray (y, 2.0);
+  std::vector<std::vector<double> > expected;
+  std::vector<double> expectedIntegrals;
+
+  for (int pass = 0; pass < 2; pass++)
+    {
+      SpectrumValueKernels::SetIsa (pass == 0 ? SpectrumValueKernels::SCALAR : isa);
+      std::vector<std::vector<double> > results;
+      std::vector<double> integrals;
+      std::vector<double> z = x;
+      SpectrumValueKernels::Scale (z.data (), n, 0.3);
+      results.push_back (z);
+      SpectrumValueKernels::DivideScalar (z.data (), n, 0.7);
+      results.push_back (z);
+      SpectrumValueKernels::AddScalar (z.data (), n, -0.2);
+      results.push_back (z);
+      SpectrumValueKernels::MaskedAdd (z.data (), y.data (), n / 3, n - n / 5);
+      results.push_back (z);
+      SpectrumValueKernels::Subtract (z.data (), y.data (), n);
+      results.push_back (z);
+      SpectrumValueKernels::Multiply (z.data (), y.data (), n);
+      results.push_back (z);
+      SpectrumValueKernels::Divide (z.data (), y.data (), n);
+      results.push_back (z);
+      integrals.push_back (SpectrumValueKernels::MultiplyIntegrate (x.data (), y.data (), 0, n));
+      integrals.push_back (SpectrumValueKernels::MultiplyIntegrate (x.data (), y.data (), n / 3, n - n / 5));
+      if (pass == 0)
+        {
+          expected = results;
+          expectedIntegrals = integrals;
+          continue;
+        }
+      for (std::size_t k = 0; k < results.size (); k++)
+        {
+          for (std::size_t i = 0; i < n; i++)
+            {
+              // element-wise kernels perform the same operation whatever the instruction set
+              NS_TEST_ASSERT_MSG_EQ (results[k][i], expected[k][i], "Kernel " << k << " ISA " << isa << " size " << n << " index " << i);
+            }
+        }
+      for (std::size_t k = 0; k < integrals.size (); k++)
+        {
+          NS_TEST_ASSERT_MSG_EQ_TOL (integrals[k], expectedIntegrals[k], 1e-12 * std::abs (expectedIntegrals[k]) + 1e-15,
+                                     "Integral " << k << " ISA " << isa << " size " << n);
+        }
+    }
+}
+
+void
+SpectrumValueKernelsTestCase::DoRun (void)
+{
+  m_isa = SpectrumValueKernels::GetIsa ();
+  const SpectrumValueKernels::Isa isas[] = {SpectrumValueKernels::SSE2, SpectrumValueKernels::AVX2};
+  const std::size_t sizes[] = {0, 1, 3, 7, 8, 9, 33, 2048};
+  for (std::size_t i = 0; i < sizeof (isas) / sizeof (isas[0]); i++)
+    {
+      if (!SpectrumValueKernels::IsSupported (isas[i]))
+        {
+          NS_LOG_INFO ("Instruction set " << isas[i] << " not supported, skipping");
+          continue;
+        }
+      for (std::size_t j = 0; j < sizeof (sizes) / sizeof (sizes[0]); j++)
+        {
+          CheckKernels (isas[i], sizes[j]);
+        }
+    }
+}
+
+void
+SpectrumValueKernelsTestCase::DoTeardown (void)
+{
+  SpectrumValueKernels::SetIsa (m_isa);
+}
+
+/**
+ * \ingroup spectrum-test
+ * \ingroup tests
+ *
+ * \brief Microbenchmark of the SpectrumValue operations implemented by the
+ * kernels on 160 MHz wide spectrum models with a 78.125 kHz resolution.
+ * The time taken by the scalar implementation and by the most efficient
+ * implementation supported by the CPU are printed on the standard output.
+ * The results of both implementations are checked to be consistent, but no
+ * assumption is made on the timings.
+ */
+class SpectrumValueKernelsBenchmarkTestCase : public TestCase
+{
+public:
+  SpectrumValueKernelsBenchmarkTestCase ();
+  virtual ~SpectrumValueKernelsBenchmarkTestCase ();
+
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  /**
+   * Run the benchmark with the given instruction set
+   *
+   * \param isa the instruction set
+   * \param elapsedMs the time taken by the benchmark, in milliseconds
+   * \return the sum of all the integrals computed by the benchmark
+   */
+  double Run (SpectrumValueKernels::Isa isa, int64_t &elapsedMs);
+
+  SpectrumValueKernels::Isa m_isa; ///< the instruction set in use before the test
+};
+
+SpectrumValueKernelsBenchmarkTestCase::SpectrumValueKernelsBenchmarkTestCase ()
+  : TestCase ("Benchmark SpectrumValue kernels on 160 MHz spectrum models")
+{
+}
+
+SpectrumValueKernelsBenchmarkTestCase::~SpectrumValueKernelsBenchmarkTestCase ()
+{
+}
+
+double
+SpectrumValueKernelsBenchmarkTestCase::Run (SpectrumValueKernels::Isa isa, int64_t &elapsedMs)
+{
+  const uint32_t iterations = 20000;
+  SpectrumValueKernels::SetIsa (isa);
+  Ptr<SpectrumValue> txPsd = WifiSpectrumValueHelper::CreateHeOfdmTxPowerSpectralDensity (5250, 160, 0.1, 80);
+  Ptr<SpectrumValue> noisePsd = WifiSpectrumValueHelper::CreateNoisePowerSpectralDensity (5250, 160, 78125, 7, 80);
+  Ptr<SpectrumValue> rxPsd = txPsd->Copy ();
+  std::size_t nBands = rxPsd->GetSpectrumModel ()->GetNumBands ();
+  WifiSpectrumBand band (nBands / 4, nBands / 2);
+  double sum = 0;
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (uint32_t i = 0; i < iterations; i++)
+    {
+      *rxPsd = *txPsd;
+      *rxPsd *= 1e-7;          // path gain scaling
+      *rxPsd += *noisePsd;     // interference accumulation
+      sum += Integral (*rxPsd);
+      sum += WifiSpectrumValueHelper::GetBandPowerW (rxPsd, band);
+    }
+  elapsedMs = clock.End ();
+  return sum;
+}
+
+void
+SpectrumValueKernelsBenchmarkTestCase::DoRun (void)
+{
+  m_isa = SpectrumValueKernels::GetIsa ();
+  SpectrumValueKernels::Isa bestIsa = SpectrumValueKernels::GetBestSupportedIsa ();
+  int64_t scalarMs = 0;
+  int64_t simdMs = 0;
+  double scalarSum = Run (SpectrumValueKernels::SCALAR, scalarMs);
+  double simdSum = Run (bestIsa, simdMs);
+  std::cout << "160 MHz / 78.125 kHz SpectrumValue kernels: scalar " << scalarMs << " ms, ISA " << bestIsa
+            << " " << simdMs << " ms, speedup " << (simdMs > 0 ? double (scalarMs) / simdMs : 0) << std::endl;
+  NS_TEST_ASSERT_MSG_EQ_TOL (simdSum, scalarSum, 1e-9 * scalarSum, "Inconsistent results between scalar and SIMD kernels");
+}
+
+void
+SpectrumValueKernelsBenchmarkTestCase::DoTeardown (void)
+{
+  SpectrumValueKernels::SetIsa (m_isa);
+}
+
+/**
+ * \ingroup spectrum-test
+ * \ingroup tests
+ *
+ * \brief SpectrumValue kernels test suite
+ */
+class SpectrumValueKernelsTestSuite : public TestSuite
+{
+public:
+  SpectrumValueKernelsTestSuite ();
+};
+
+SpectrumValueKernelsTestSuite::SpectrumValueKernelsTestSuite ()
+  : TestSuite ("spectrum-value-kernels", UNIT)
+{
+  AddTestCase (new SpectrumValueKernelsTestCase, TestCase::QUICK);
+  AddTestCase (new SpectrumValueKernelsBenchmarkTestCase, TestCase::EXTENSIVE);
+}
+
+static SpectrumValueKernelsTestSuite g_spectrumValueKernelsTestSuite; ///< the test suite
@@ -0,0 +1,121 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 University of Washington
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Sébastien Deronne <sebastien.deronne@gmail.com>
+ */
+
+// This program benchmarks the lookup of the remote stations known by the
+// WifiRemoteStationManager of an AP, for an increasing number of associated
+// stations. Every iteration looks up the state of a station and its
+// per-TID data for four TIDs, as done when frames are transmitted and
+// received. The cost per lookup should not depend on the number of stations.
+//
+// Sample usage:  ./waf --run 'wifi-remote-station-lookup-bench --nStas=256'
+
+#include <iostream>
+#include <iomanip>
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/yans-wifi-helper.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/wifi-remote-station-manager.h"
+#include "ns3/wifi-mac-header.h"
+#include "ns3/wifi-phy.h"
+#include "ns3/ssid.h"
+
+using namespace ns3;
+
+/**
+ * Look up the stations known by a WifiRemoteStationManager
+ *
+ * \param manager the WifiRemoteStationManager
+ * \param addresses the addresses of the known stations
+ * \param nLookups the number of lookups
+ * \return the duration of the lookups (ms)
+ */
+static int64_t
+RunLookups (Ptr<WifiRemoteStationManager> manager, const std::vector<Mac48Address> &addresses, uint32_t nLookups)
+{
+  WifiMacHeader header;
+  header.SetType (WIFI_MAC_QOSDATA);
+  RxSignalInfo rxSignalInfo;
+  rxSignalInfo.snr = 100;
+  rxSignalInfo.rssi = -50;
+  WifiMode mode = WifiPhy::GetHeMcs0 ();
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  uint32_t nAssociated = 0;
+  for (uint32_t i = 0; i < nLookups; i++)
+    {
+      //visit the stations with a stride to defeat the locality of a linear scan
+      const Mac48Address &address = addresses[(i * 97) % addresses.size ()];
+      nAssociated += manager->IsAssociated (address) ? 1 : 0;
+      header.SetQosTid (i % 4);
+      manager->ReportRxOk (address, &header, rxSignalInfo, mode);
+    }
+  int64_t elapsed = clock.End ();
+  if (nAssociated != nLookups)
+    {
+      std::cerr << "Unexpected number of associated stations" << std::endl;
+    }
+  return elapsed;
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t nStas = 256;
+  uint32_t nLookups = 1000000;
+
+  CommandLine cmd;
+  cmd.AddValue ("nStas", "Largest number of stations associated with the AP", nStas);
+  cmd.AddValue ("nLookups", "Number of lookups per run", nLookups);
+  cmd.Parse (argc, argv);
+
+  NodeContainer apNode;
+  apNode.Create (1);
+  YansWifiChannelHelper channel = YansWifiChannelHelper::Default ();
+  YansWifiPhyHelper phy = YansWifiPhyHelper::Default ();
+  phy.SetChannel (channel.Create ());
+  WifiHelper wifi;
+  wifi.SetStandard (WIFI_PHY_STANDARD_80211ax_5GHZ);
+  wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager");
+  WifiMacHelper mac;
+  mac.SetType ("ns3::ApWifiMac", "Ssid", SsidValue (Ssid ("bench")));
+  NetDeviceContainer apDevice = wifi.Install (phy, mac, apNode);
+  Ptr<WifiRemoteStationManager> manager = DynamicCast<WifiNetDevice> (apDevice.Get (0))->GetRemoteStationManager ();
+
+  std::cout << std::setw (8) << "nStas" << std::setw (16) << "ns/lookup" << std::endl;
+  std::vector<Mac48Address> addresses;
+  for (uint32_t n = 1; n <= nStas; n *= 2)
+    {
+      while (addresses.size () < n)
+        {
+          Mac48Address address = Mac48Address::Allocate ();
+          manager->RecordWaitAssocTxOk (address);
+          manager->RecordGotAssocTxOk (address);
+          addresses.push_back (address);
+        }
+      int64_t elapsedMs = RunLookups (manager, addresses, nLookups);
+      std::cout << std::setw (8) << n
+                << std::setw (16) << (elapsedMs * 1e6) / nLookups << std::endl;
+    }
+  return 0;
+}
@@ -0,0 +1,340 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 University of Washington
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Sébastien Deronne <sebastien.deronne@gmail.com>
+ */
+
+#include <fstream>
+#include <sstream>
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/string.h"
+#include "ns3/ssid.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/position-allocator.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/wifi-mac.h"
+#include "ns3/wifi-phy.h"
+#include "ns3/constant-threshold-channel-bonding-manager.h"
+#include "wifi-mac-helper.h"
+#include "channel-bonding-scenario-helper.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ChannelBondingScenarioHelper");
+
+ChannelBondingScenarioHelper::BssParameters::BssParameters ()
+  : apPosition (0, 0, 0),
+    nStations (1),
+    stationOffset (0, 0, 0),
+    stationRadius (0),
+    channelNumber (36),
+    primaryChannelNumber (36),
+    mcs ("IdealWifi"),
+    controlMode ("VhtMcs0"),
+    ccaEdThresholdPrimary (-62.0),
+    ccaEdThresholdSecondary (-62.0),
+    uplinkMbps (0),
+    downlinkMbps (0),
+    maxAmpduSize (65535)
+{
+}
+
+ChannelBondingScenarioHelper::ChannelBondingScenarioHelper ()
+  : m_maxMissedBeacons (10)
+{
+}
+
+void
+ChannelBondingScenarioHelper::AddBss (const BssParameters &bss)
+{
+  NS_LOG_FUNCTION (this << +bss.channelNumber << +bss.primaryChannelNumber << bss.nStations);
+  m_bssTable.push_back (bss);
+}
+
+/**
+ * Parse a field of a BSS table.
+ *
+ * \tparam T the type of the field
+ * \param token the text of the field
+ * \param value the parsed value
+ * \return true if the whole text has been parsed
+ */
+template <typename T>
+static bool
+ParseField (const std::string &token, T &value)
+{
+  std::istringstream iss (token);
+  return (iss >> value) && iss.eof ();
+}
+
+void
+ChannelBondingScenarioHelper::LoadBssTable (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  std::ifstream is (filename.c_str ());
+  NS_ABORT_MSG_IF (!is.is_open (), "Cannot open BSS table " << filename);
+  std::vector<std::string> columns;
+  std::string line;
+  uint32_t lineNumber = 0;
+  while (std::getline (is, line))
+    {
+      lineNumber++;
+      std::size_t comment = line.find ('#');
+      if (comment != std::string::npos)
+        {
+          line.erase (comment);
+        }
+      std::istringstream iss (line);
+      std::vector<std::string> tokens;
+      std::string token;
+      while (iss >> token)
+        {
+          tokens.push_back (token);
+        }
+      if (tokens.empty ())
+        {
+          continue;
+        }
+      if (columns.empty ())
+        {
+          columns = tokens;
+          continue;
+        }
+      NS_ABORT_MSG_IF (tokens.size () != columns.size (),
+                       filename << ":" << lineNumber << ": expected " << columns.size () << " fields");
+      BssParameters bss;
+      for (std::size_t i = 0; i < columns.size (); ++i)
+        {
+          const std::string &column = columns[i];
+          uint16_t channel = 0;
+          bool ok = true;
+          if (column == "apX")
+            {
+              ok = ParseField (tokens[i], bss.apPosition.x);
+            }
+          else if (column == "apY")
+            {
+              ok = ParseField (tokens[i], bss.apPosition.y);
+            }
+          else if (column == "apZ")
+            {
+              ok = ParseField (tokens[i], bss.apPosition.z);
+            }
+          else if (column == "nStations")
+            {
+              ok = ParseField (tokens[i], bss.nStations);
+            }
+          else if (column == "staX")
+            {
+              ok = ParseField (tokens[i], bss.stationOffset.x);
+            }
+          else if (column == "staY")
+            {
+              ok = ParseField (tokens[i], bss.stationOffset.y);
+            }
+          else if (column == "radius")
+            {
+              ok = ParseField (tokens[i], bss.stationRadius);
+            }
+          else if (column == "channel")
+            {
+              //parsing an uint8_t would read a character
+              ok = ParseField (tokens[i], channel) && channel <= 255;
+              bss.channelNumber = static_cast<uint8_t> (channel);
+            }
+          else if (column == "primaryChannel")
+            {
+              ok = ParseField (tokens[i], channel) && channel <= 255;
+              bss.primaryChannelNumber = static_cast<uint8_t> (channel);
+            }
+          else if (column == "mcs")
+            {
+              bss.mcs = tokens[i];
+            }
+          else if (column == "controlMode")
+            {
+              bss.controlMode = tokens[i];
+            }
+          else if (column == "ccaEdThresholdPrimary")
+            {
+              ok = ParseField (tokens[i], bss.ccaEdThresholdPrimary);
+            }
+          else if (column == "ccaEdThresholdSecondary")
+            {
+              ok = ParseField (tokens[i], bss.ccaEdThresholdSecondary);
+            }
+          else if (column == "uplink")
+            {
+              ok = ParseField (tokens[i], bss.uplinkMbps);
+            }
+          else if (column == "downlink")
+            {
+              ok = ParseField (tokens[i], bss.downlinkMbps);
+            }
+          else if (column == "maxAmpduSize")
+            {
+              ok = ParseField (tokens[i], bss.maxAmpduSize);
+            }
+          else
+            {
+              NS_ABORT_MSG (filename << ": unknown column " << column);
+            }
+          NS_ABORT_MSG_IF (!ok, filename << ":" << lineNumber << ": invalid " << column << " " << tokens[i]);
+        }
+      AddBss (bss);
+    }
+}
+
+std::size_t
+ChannelBondingScenarioHelper::GetNBss (void) const
+{
+  return m_bssTable.size ();
+}
+
+const ChannelBondingScenarioHelper::BssParameters &
+ChannelBondingScenarioHelper::GetBss (std::size_t bss) const
+{
+  NS_ASSERT (bss < m_bssTable.size ());
+  return m_bssTable[bss];
+}
+
+void
+ChannelBondingScenarioHelper::SetMaxMissedBeacons (uint32_t maxMissedBeacons)
+{
+  m_maxMissedBeacons = maxMissedBeacons;
+}
+
+void
+ChannelBondingScenarioHelper::ConfigureDevice (Ptr<NetDevice> device, const BssParameters &bss) const
+{
+  Ptr<WifiNetDevice> wifiDevice = DynamicCast<WifiNetDevice> (device);
+  NS_ASSERT (wifiDevice != 0);
+  Ptr<WifiPhy> phy = wifiDevice->GetPhy ();
+  phy->SetChannelNumber (bss.channelNumber);
+  phy->SetPrimaryChannelNumber (bss.primaryChannelNumber);
+  phy->SetCcaEdThreshold (bss.ccaEdThresholdPrimary);
+  Ptr<ConstantThresholdChannelBondingManager> manager =
+    DynamicCast<ConstantThresholdChannelBondingManager> (phy->GetChannelBondingManager ());
+  if (manager != 0)
+    {
+      manager->SetCcaEdThresholdSecondary (bss.ccaEdThresholdSecondary);
+    }
+  wifiDevice->GetMac ()->SetAttribute ("BE_MaxAmpduSize", UintegerValue (bss.maxAmpduSize));
+}
+
+NodeContainer
+ChannelBondingScenarioHelper::Install (const WifiPhyHelper &phy, WifiHelper wifi, int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_apNodes = NodeContainer ();
+  m_apNodes.Create (m_bssTable.size ());
+  m_staNodes.assign (m_bssTable.size (), NodeContainer ());
+  m_apDevices = NetDeviceContainer ();
+  m_staDevices.assign (m_bssTable.size (), NetDeviceContainer ());
+
+  NodeContainer allNodes = m_apNodes;
+  Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator> ();
+  for (std::size_t i = 0; i < m_bssTable.size (); ++i)
+    {
+      positionAlloc->Add (m_bssTable[i].apPosition);
+    }
+  for (std::size_t i = 0; i < m_bssTable.size (); ++i)
+    {
+      const BssParameters &bss = m_bssTable[i];
+      m_staNodes[i].Create (bss.nStations);
+      allNodes.Add (m_staNodes[i]);
+      Ptr<UniformDiscPositionAllocator> discAlloc = CreateObject<UniformDiscPositionAllocator> ();
+      discAlloc->AssignStreams (stream + i);
+      discAlloc->SetX (bss.apPosition.x + bss.stationOffset.x);
+      discAlloc->SetY (bss.apPosition.y + bss.stationOffset.y);
+      discAlloc->SetZ (bss.apPosition.z);
+      discAlloc->SetRho (bss.stationRadius);
+      for (uint16_t j = 0; j < bss.nStations; ++j)
+        {
+          positionAlloc->Add (discAlloc->GetNext ());
+        }
+    }
+  MobilityHelper mobility;
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.SetPositionAllocator (positionAlloc);
+  mobility.Install (allNodes);
+
+  WifiMacHelper mac;
+  for (std::size_t i = 0; i < m_bssTable.size (); ++i)
+    {
+      const BssParameters &bss = m_bssTable[i];
+      if (bss.mcs == "IdealWifi")
+        {
+          wifi.SetRemoteStationManager ("ns3::IdealWifiManager");
+        }
+      else
+        {
+          wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager",
+                                        "DataMode", StringValue (bss.mcs),
+                                        "ControlMode", StringValue (bss.controlMode));
+        }
+      Ssid ssid ("network-" + std::to_string (i));
+
+      mac.SetType ("ns3::StaWifiMac",
+                   "MaxMissedBeacons", UintegerValue (m_maxMissedBeacons),
+                   "Ssid", SsidValue (ssid));
+      m_staDevices[i] = wifi.Install (phy, mac, m_staNodes[i]);
+      for (NetDeviceContainer::Iterator it = m_staDevices[i].Begin (); it != m_staDevices[i].End (); ++it)
+        {
+          ConfigureDevice (*it, bss);
+        }
+
+      mac.SetType ("ns3::ApWifiMac",
+                   "Ssid", SsidValue (ssid),
+                   "EnableBeaconJitter", BooleanValue (true));
+      NetDeviceContainer apDevice = wifi.Install (phy, mac, m_apNodes.Get (i));
+      ConfigureDevice (apDevice.Get (0), bss);
+      m_apDevices.Add (apDevice);
+    }
+  return allNodes;
+}
+
+NodeContainer
+ChannelBondingScenarioHelper::GetApNodes (void) const
+{
+  return m_apNodes;
+}
+
+NodeContainer
+ChannelBondingScenarioHelper::GetStaNodes (std::size_t bss) const
+{
+  NS_ASSERT (bss < m_staNodes.size ());
+  return m_staNodes[bss];
+}
+
+NetDeviceContainer
+ChannelBondingScenarioHelper::GetApDevices (void) const
+{
+  return m_apDevices;
+}
+
+NetDeviceContainer
+ChannelBondingScenarioHelper::GetStaDevices (std::size_t bss) const
+{
+  NS_ASSERT (bss < m_staDevices.size ());
+  return m_staDevices[bss];
+}
+
+} //namespace ns3
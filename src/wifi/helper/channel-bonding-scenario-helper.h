@@ -0,0 +1,166 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 University of Washington
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Sébastien Deronne <sebastien.deronne@gmail.com>
+ */
+
+#ifndef CHANNEL_BONDING_SCENARIO_HELPER_H
+#define CHANNEL_BONDING_SCENARIO_HELPER_H
+
+#include <vector>
+#include "ns3/vector.h"
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "wifi-helper.h"
+
+namespace ns3 {
+
+/**
+ * \brief Build a topology made of any number of infrastructure BSSs, each
+ * with its own channel, primary channel, CCA thresholds and rate control.
+ *
+ * The BSSs are described by a table, either built with AddBss or loaded
+ * from a file with LoadBssTable. Install creates an AP and its stations per
+ * BSS, the APs being the first nodes, followed by the stations of every BSS
+ * in turn, places them and installs their devices. The PHY and MAC of every
+ * device are configured through the device itself, without looking up any
+ * configuration path, hence the cost of Install is linear in the number of
+ * nodes.
+ *
+ * The Internet stack and the applications are not installed, but the
+ * offered loads of every BSS are part of the table for use by the scenario.
+ */
+class ChannelBondingScenarioHelper
+{
+public:
+  /// The parameters of a BSS
+  struct BssParameters
+  {
+    BssParameters ();
+
+    Vector apPosition;                 //!< the position of the AP
+    uint16_t nStations;                //!< the number of stations
+    Vector stationOffset;              //!< the center of the disc in which the stations are placed, relative to the AP
+    double stationRadius;              //!< the radius (m) of the disc in which the stations are placed
+    uint8_t channelNumber;             //!< the operating channel
+    uint8_t primaryChannelNumber;      //!< the primary 20 MHz channel
+    std::string mcs;                   //!< the data mode, or IdealWifi for the ideal rate control
+    std::string controlMode;           //!< the control mode, unless the rate control is ideal
+    double ccaEdThresholdPrimary;      //!< the CCA energy detection threshold (dBm) on the primary channel
+    double ccaEdThresholdSecondary;    //!< the CCA energy detection threshold (dBm) on the secondary channels
+    double uplinkMbps;                 //!< the aggregate uplink load (Mbps)
+    double downlinkMbps;               //!< the aggregate downlink load (Mbps)
+    uint32_t maxAmpduSize;             //!< the maximum A-MPDU size (bytes) for AC_BE
+  };
+
+  ChannelBondingScenarioHelper ();
+
+  /**
+   * Add a BSS to the table.
+   *
+   * \param bss the parameters of the BSS
+   */
+  void AddBss (const BssParameters &bss);
+  /**
+   * Add the BSSs listed in a file to the table. The first line which is
+   * neither empty nor a comment (starting with #) lists the names of the
+   * columns, every following one describes a BSS:
+   *
+   * \code
+   *   # two BSSs sharing a 40 MHz channel, with different primary channels
+   *   apX apY nStations channel primaryChannel mcs uplink
+   *   0   0   10        38      36             VhtMcs5 100
+   *   20  0   10        38      40             VhtMcs5 100
+   * \endcode
+   *
+   * The columns are apX, apY, apZ, nStations, staX, staY, radius, channel,
+   * primaryChannel, mcs, controlMode, ccaEdThresholdPrimary,
+   * ccaEdThresholdSecondary, uplink, downlink and maxAmpduSize, named after
+   * the fields of BssParameters. Any of them can be omitted, in which case the
+   * default value of the field is used.
+   *
+   * \param filename the name of the file
+   */
+  void LoadBssTable (std::string filename);
+  /**
+   * \return the number of BSSs
+   */
+  std::size_t GetNBss (void) const;
+  /**
+   * \param bss the index of the BSS
+   * \return the parameters of the BSS
+   */
+  const BssParameters & GetBss (std::size_t bss) const;
+
+  /**
+   * \param maxMissedBeacons the number of missed beacons after which a station
+   *        disassociates
+   */
+  void SetMaxMissedBeacons (uint32_t maxMissedBeacons);
+
+  /**
+   * Create, place and configure the nodes of every BSS.
+   *
+   * \param phy the PHY helper, whose channel is shared by all the BSSs
+   * \param wifi the wifi helper setting the standard and the channel bonding
+   *        manager; its remote station manager is set for every BSS
+   * \param stream the first stream index used to place the stations, one
+   *        stream being used per BSS
+   * \return all the nodes, the APs first
+   */
+  NodeContainer Install (const WifiPhyHelper &phy, WifiHelper wifi, int64_t stream);
+
+  /**
+   * \return the AP of every BSS
+   */
+  NodeContainer GetApNodes (void) const;
+  /**
+   * \param bss the index of the BSS
+   * \return the stations of the BSS
+   */
+  NodeContainer GetStaNodes (std::size_t bss) const;
+  /**
+   * \return the device of the AP of every BSS
+   */
+  NetDeviceContainer GetApDevices (void) const;
+  /**
+   * \param bss the index of the BSS
+   * \return the devices of the stations of the BSS
+   */
+  NetDeviceContainer GetStaDevices (std::size_t bss) const;
+
+
+private:
+  /**
+   * Configure the PHY and the MAC of a device of a BSS.
+   *
+   * \param device the device
+   * \param bss the parameters of the BSS
+   */
+  void ConfigureDevice (Ptr<NetDevice> device, const BssParameters &bss) const;
+
+  std::vector<BssParameters> m_bssTable;       //!< the parameters of every BSS
+  uint32_t m_maxMissedBeacons;                 //!< the maximum number of missed beacons
+  NodeContainer m_apNodes;                     //!< the AP of every BSS
+  std::vector<NodeContainer> m_staNodes;       //!< the stations of every BSS
+  NetDeviceContainer m_apDevices;              //!< the device of the AP of every BSS
+  std::vector<NetDeviceContainer> m_staDevices; //!< the devices of the stations of every BSS
+};
+
+} //namespace ns3
+
+#endif /* CHANNEL_BONDING_SCENARIO_HELPER_H */
@@ -19,6 +19,7 @@
  */
 
 #include "ns3/log.h"
+#include "ns3/simulator.h"
 #include "channel-bonding-manager.h"
 #include "wifi-phy.h"
 
@@ -27,6 +28,15 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("ChannelBondingManager");
 NS_OBJECT_ENSURE_REGISTERED (ChannelBondingManager);
 
+ChannelBondingManager::ChannelBondingManager ()
+  : m_usableWidthsTime (Seconds (-1)),
+    m_usableWidthsStateVersion (0),
+    m_usableWidthsChannelWidth (0),
+    m_usableWidthsPifs (Seconds (0))
+{
+  NS_LOG_FUNCTION (this);
+}
+
 TypeId
 ChannelBondingManager::GetTypeId (void)
 {
@@ -44,6 +54,58 @@ ChannelBondingManager::SetPhy (const Ptr<WifiPhy> phy)
   m_phy = phy;
 }
 
+void
+ChannelBondingManager::NotifyBeaconRssi (double rssiDbm)
+{
+  NS_LOG_FUNCTION (this << rssiDbm);
+}
+
+uint16_t
+ChannelBondingManager::GetUsableChannelWidthForThreshold (double ccaThreshold)
+{
+  uint16_t channelWidth = m_phy->GetChannelWidth ();
+  if (channelWidth < 40)
+    {
+      return channelWidth;
+    }
+  Time now = Simulator::Now ();
+  uint64_t stateVersion = m_phy->GetStateVersion ();
+  Time pifs = m_phy->GetPifs ();
+  if (now != m_usableWidthsTime || stateVersion != m_usableWidthsStateVersion
+      || channelWidth != m_usableWidthsChannelWidth || pifs != m_usableWidthsPifs)
+    {
+      m_usableWidths.clear ();
+      m_usableWidthsTime = now;
+      m_usableWidthsStateVersion = stateVersion;
+      m_usableWidthsChannelWidth = channelWidth;
+      m_usableWidthsPifs = pifs;
+    }
+  auto it = m_usableWidths.find (ccaThreshold);
+  if (it != m_usableWidths.end ())
+    {
+      return it->second;
+    }
+  uint16_t usableChannelWidth = 20;
+  for (uint16_t width = channelWidth; width > 20; )
+    {
+      if (m_phy->GetDelaySinceChannelIsIdle (width, ccaThreshold) >= pifs)
+        {
+          usableChannelWidth = width;
+          break;
+        }
+      width /= 2;
+    }
+  stateVersion = m_phy->GetStateVersion ();
+  if (stateVersion != m_usableWidthsStateVersion)
+    {
+      //the CCA band groups have been updated while computing the usable width
+      m_usableWidths.clear ();
+      m_usableWidthsStateVersion = stateVersion;
+    }
+  m_usableWidths.insert ({ccaThreshold, usableChannelWidth});
+  return usableChannelWidth;
+}
+
 void
 ChannelBondingManager::DoDispose (void)
 {
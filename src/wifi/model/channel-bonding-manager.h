@@ -21,7 +21,9 @@
 #ifndef CHANNEL_BONDING_MANAGER_H
 #define CHANNEL_BONDING_MANAGER_H
 
+#include <map>
 #include "ns3/object.h"
+#include "ns3/nstime.h"
 
 namespace ns3 {
 
@@ -39,6 +41,8 @@ class WifiMode;
 class ChannelBondingManager : public Object
 {
 public:
+  ChannelBondingManager ();
+
   static TypeId GetTypeId (void);
 
   /**
@@ -57,11 +61,38 @@ public:
    */
   virtual uint16_t GetUsableChannelWidth (WifiMode mode) = 0;
 
+  /**
+   * Notify the RSSI of a beacon received from the AP the station is associated with.
+   * The default implementation does nothing.
+   *
+   * \param rssiDbm the RSSI (dBm) of the received beacon
+   */
+  virtual void NotifyBeaconRssi (double rssiDbm);
+
 
 protected:
   virtual void DoDispose (void);
 
+  /**
+   * Returns the largest channel width (in MHz) whose secondary channels have been
+   * idle for at least PIFS, using the given CCA threshold for the secondary channels.
+   * The result is memoized until either the time, the PHY state, the channel width
+   * or PIFS changes.
+   *
+   * \param ccaThreshold the CCA threshold (dBm) for the secondary channels
+   *
+   * \return the selected channel width in MHz
+   */
+  uint16_t GetUsableChannelWidthForThreshold (double ccaThreshold);
+
   Ptr<WifiPhy> m_phy; //!< Pointer to the WifiPhy
+
+private:
+  Time m_usableWidthsTime;       //!< time the memoized channel widths were computed at
+  uint64_t m_usableWidthsStateVersion; //!< PHY state version the memoized channel widths were computed for
+  uint16_t m_usableWidthsChannelWidth; //!< channel width (MHz) the memoized channel widths were computed for
+  Time m_usableWidthsPifs;       //!< PIFS the memoized channel widths were computed for
+  std::map<double, uint16_t> m_usableWidths; //!< memoized channel widths (MHz), per CCA threshold (dBm)
 };
 
 } //namespace ns3
@@ -46,7 +46,8 @@ ConstantThresholdChannelBondingManager::GetTypeId (void)
                    "this threshold (dbm) to allow the PHY layer to declare CCA BUSY state. "
                    "This check is performed on the secondary channel(s) only.",
                    DoubleValue (-72.0),
-                   MakeDoubleAccessor (&ConstantThresholdChannelBondingManager::SetCcaEdThresholdSecondary),
+                   MakeDoubleAccessor (&ConstantThresholdChannelBondingManager::SetCcaEdThresholdSecondary,
+                                       &ConstantThresholdChannelBondingManager::GetCcaEdThresholdSecondary),
                    MakeDoubleChecker<double> ())
   ;
   return tid;
@@ -63,6 +64,12 @@ ConstantThresholdChannelBondingManager::SetCcaEdThresholdSecondary (double thres
     }
 }
 
+double
+ConstantThresholdChannelBondingManager::GetCcaEdThresholdSecondary (void) const
+{
+  return m_ccaEdThresholdSecondaryDbm;
+}
+
 void
 ConstantThresholdChannelBondingManager::SetPhy (const Ptr<WifiPhy> phy)
 {
@@ -73,21 +80,7 @@ ConstantThresholdChannelBondingManager::SetPhy (const Ptr<WifiPhy> phy)
 uint16_t
 ConstantThresholdChannelBondingManager::GetUsableChannelWidth (WifiMode mode)
 {
-  if (m_phy->GetChannelWidth () < 40)
-    {
-      return m_phy->GetChannelWidth ();
-    }
-  uint16_t usableChannelWidth = 20;
-  for (uint16_t width = m_phy->GetChannelWidth (); width > 20; )
-    {
-      if (m_phy->GetDelaySinceChannelIsIdle (width, m_ccaEdThresholdSecondaryDbm) >= m_phy->GetPifs ())
-        {
-          usableChannelWidth = width;
-          break;
-        }
-      width /= 2;
-    }
-  return usableChannelWidth;
+  return GetUsableChannelWidthForThreshold (m_ccaEdThresholdSecondaryDbm);
 }
 
 } //namespace ns3
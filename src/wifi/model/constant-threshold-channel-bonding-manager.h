@@ -53,6 +53,12 @@ public:
    * \param threshold the CCA threshold in dBm for the secondary channels
    */
   void SetCcaEdThresholdSecondary (double threshold);
+  /**
+   * Return the CCA threshold (dBm) for the secondary channels.
+   *
+   * \return the CCA threshold in dBm for the secondary channels
+   */
+  double GetCcaEdThresholdSecondary (void) const;
 
   /**
    * Returns the selected channel width (in MHz).
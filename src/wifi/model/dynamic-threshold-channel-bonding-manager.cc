@@ -18,7 +18,11 @@
  * Author: Sébastien Deronne <sebastien.deronne@gmail.com>
  */
 
+#include <cmath>
+#include <algorithm>
 #include "ns3/log.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
 #include "dynamic-threshold-channel-bonding-manager.h"
 #include "wifi-phy.h"
 #include "wifi-utils.h"
@@ -27,12 +31,18 @@ namespace ns3 {
 
 ATTRIBUTE_CHECKER_IMPLEMENT_WITH_NAME (CcaThresholdPerWifiMode, "std::map<WifiMode, double>");
 ATTRIBUTE_VALUE_IMPLEMENT_WITH_NAME (CcaThresholdPerWifiModeMap, CcaThresholdPerWifiMode);
+ATTRIBUTE_CHECKER_IMPLEMENT_WITH_NAME (RequiredSinrPerMcs, "std::vector<double>");
+ATTRIBUTE_VALUE_IMPLEMENT_WITH_NAME (SinrPerMcsList, RequiredSinrPerMcs);
 
 NS_LOG_COMPONENT_DEFINE ("DynamicThresholdChannelBondingManager");
 NS_OBJECT_ENSURE_REGISTERED (DynamicThresholdChannelBondingManager);
 
+/// Thresholds (dBm) closer than this are the same threshold, up to dBm/W round-off
+static const double THRESHOLD_TOLERANCE_DB = 1e-9;
+
 DynamicThresholdChannelBondingManager::DynamicThresholdChannelBondingManager ()
-  : ChannelBondingManager ()
+  : ChannelBondingManager (),
+    m_beaconRssiSum (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -51,41 +61,133 @@ DynamicThresholdChannelBondingManager::GetTypeId (void)
                    CcaThresholdPerWifiModeValue (),
                    MakeCcaThresholdPerWifiModeAccessor (&DynamicThresholdChannelBondingManager::m_ccaEdThresholdsSecondaryDbm),
                    MakeCcaThresholdPerWifiModeChecker ())
+    .AddAttribute ("CcaEdThresholdSecondaryResolution",
+                   "The resolution (dB) the CCA thresholds for the secondary channel(s) "
+                   "are rounded to. Zero disables the rounding.",
+                   DoubleValue (0.5),
+                   MakeDoubleAccessor (&DynamicThresholdChannelBondingManager::m_thresholdResolution),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("MaxCcaEdThresholdsSecondary",
+                   "The maximum number of distinct CCA thresholds used for the secondary channel(s), "
+                   "including the default one of the PHY. When reached, a new threshold is replaced "
+                   "by the closest one in use.",
+                   UintegerValue (12),
+                   MakeUintegerAccessor (&DynamicThresholdChannelBondingManager::m_maxNThresholds),
+                   MakeUintegerChecker<uint8_t> (1))
+    .AddAttribute ("BeaconRssiWindowSize",
+                   "The number of received beacons the RSSI is averaged over "
+                   "to derive the CCA thresholds for the secondary channel(s).",
+                   UintegerValue (10),
+                   MakeUintegerAccessor (&DynamicThresholdChannelBondingManager::m_beaconRssiWindowSize),
+                   MakeUintegerChecker<uint16_t> (1))
+    .AddAttribute ("RequiredSinrPerMcs",
+                   "The SINR (dB) required by each MCS, indexed by MCS value. The CCA threshold "
+                   "for the secondary channel(s) of an MCS is the average beacon RSSI minus this SINR.",
+                   RequiredSinrPerMcsValue (SinrPerMcsList {0.7, 3.7, 6.2, 9.3, 12.6, 16.8, 18.2, 19.4, 23.5, 30, 35, 40}),
+                   MakeRequiredSinrPerMcsAccessor (&DynamicThresholdChannelBondingManager::m_requiredSinrPerMcs),
+                   MakeRequiredSinrPerMcsChecker ())
   ;
   return tid;
 }
 
+double
+DynamicThresholdChannelBondingManager::QuantizeThreshold (double threshold) const
+{
+  if (m_thresholdResolution <= 0)
+    {
+      return threshold;
+    }
+  return std::round (threshold / m_thresholdResolution) * m_thresholdResolution;
+}
+
+std::size_t
+DynamicThresholdChannelBondingManager::GetNModesUsingThreshold (double threshold) const
+{
+  return std::count_if (m_ccaEdThresholdsSecondaryDbm.begin (), m_ccaEdThresholdsSecondaryDbm.end (),
+                        [threshold] (const std::pair<WifiMode, double> &p) { return p.second == threshold; });
+}
+
+bool
+DynamicThresholdChannelBondingManager::IsDefaultThreshold (double threshold) const
+{
+  //the PHY keeps its default threshold in W, hence compare in dBm up to round-off
+  return std::abs (threshold - WToDbm (m_phy->GetDefaultCcaEdThresholdSecondary ())) < THRESHOLD_TOLERANCE_DB;
+}
+
+std::vector<double>
+DynamicThresholdChannelBondingManager::GetDistinctThresholds (void) const
+{
+  std::vector<double> thresholds;
+  for (auto const& ccaThreshold : m_ccaEdThresholdsSecondaryDbm)
+    {
+      thresholds.push_back (ccaThreshold.second);
+    }
+  if (m_phy)
+    {
+      thresholds.push_back (WToDbm (m_phy->GetDefaultCcaEdThresholdSecondary ()));
+    }
+  std::sort (thresholds.begin (), thresholds.end ());
+  thresholds.erase (std::unique (thresholds.begin (), thresholds.end (),
+                                 [] (double a, double b) { return b - a < THRESHOLD_TOLERANCE_DB; }),
+                    thresholds.end ());
+  return thresholds;
+}
+
 void
 DynamicThresholdChannelBondingManager::SetCcaEdThresholdSecondaryForMode (WifiMode mode, double threshold)
 {
   NS_LOG_FUNCTION (this << mode << threshold);
+  threshold = QuantizeThreshold (threshold);
   auto it = m_ccaEdThresholdsSecondaryDbm.find (mode);
-  if (it == m_ccaEdThresholdsSecondaryDbm.end ())
+  if (it != m_ccaEdThresholdsSecondaryDbm.end ())
     {
-      m_ccaEdThresholdsSecondaryDbm.insert ({mode, threshold});
+      if (it->second == threshold)
+        {
+          return;
+        }
+      double oldThreshold = it->second;
+      m_ccaEdThresholdsSecondaryDbm.erase (it);
+      if (m_phy && GetNModesUsingThreshold (oldThreshold) == 0 && !IsDefaultThreshold (oldThreshold))
+        {
+          m_phy->RemoveCcaEdThresholdSecondary (oldThreshold);
+        }
     }
-  else
+  std::vector<double> thresholds = GetDistinctThresholds ();
+  auto closest = std::lower_bound (thresholds.begin (), thresholds.end (), threshold - THRESHOLD_TOLERANCE_DB);
+  if (closest != thresholds.end () && *closest < threshold + THRESHOLD_TOLERANCE_DB)
     {
-      if (m_phy)
+      //use the very value of the threshold in use
+      threshold = *closest;
+    }
+  else if (thresholds.size () >= m_maxNThresholds)
+    {
+      //reuse the closest threshold in use
+      if (closest == thresholds.end ()
+          || (closest != thresholds.begin () && (threshold - *(closest - 1)) <= (*closest - threshold)))
         {
-          m_phy->RemoveCcaEdThresholdSecondary (it->second);
+          --closest;
         }
-      it->second = threshold;
+      NS_LOG_DEBUG ("Maximum number of thresholds reached: use " << *closest << " instead of " << threshold);
+      threshold = *closest;
     }
-  if (m_phy)
+  if (m_phy && GetNModesUsingThreshold (threshold) == 0 && !IsDefaultThreshold (threshold))
     {
       m_phy->AddCcaEdThresholdSecondary (threshold);
     }
+  m_ccaEdThresholdsSecondaryDbm.insert ({mode, threshold});
 }
 
 void
 DynamicThresholdChannelBondingManager::SetPhy (const Ptr<WifiPhy> phy)
 {
-  for (auto const& ccaThreshold : m_ccaEdThresholdsSecondaryDbm)
+  ChannelBondingManager::SetPhy (phy);
+  //the configured thresholds are rounded and capped like the ones set afterwards
+  CcaThresholdPerWifiModeMap thresholds;
+  thresholds.swap (m_ccaEdThresholdsSecondaryDbm);
+  for (auto const& ccaThreshold : thresholds)
     {
-      phy->AddCcaEdThresholdSecondary (ccaThreshold.second);
+      SetCcaEdThresholdSecondaryForMode (ccaThreshold.first, ccaThreshold.second);
     }
-  ChannelBondingManager::SetPhy (phy);
 }
 
 uint16_t
@@ -105,17 +207,34 @@ DynamicThresholdChannelBondingManager::GetUsableChannelWidth (WifiMode mode)
     {
       threshold = WToDbm (m_phy->GetDefaultCcaEdThresholdSecondary ());
     }
-  uint16_t usableChannelWidth = 20;
-  for (uint16_t width = m_phy->GetChannelWidth (); width > 20; )
+  return GetUsableChannelWidthForThreshold (threshold);
+}
+
+void
+DynamicThresholdChannelBondingManager::NotifyBeaconRssi (double rssiDbm)
+{
+  NS_LOG_FUNCTION (this << rssiDbm);
+  m_beaconRssis.push_back (rssiDbm);
+  m_beaconRssiSum += rssiDbm;
+  while (m_beaconRssis.size () > m_beaconRssiWindowSize)
     {
-      if (m_phy->GetDelaySinceChannelIsIdle (width, threshold) >= m_phy->GetPifs ())
+      m_beaconRssiSum -= m_beaconRssis.front ();
+      m_beaconRssis.pop_front ();
+    }
+  if (!m_phy)
+    {
+      return;
+    }
+  double averageRssi = m_beaconRssiSum / m_beaconRssis.size ();
+  for (uint8_t i = 0; i < m_phy->GetNMcs (); i++)
+    {
+      WifiMode mode = m_phy->GetMcs (i);
+      uint8_t mcs = mode.GetMcsValue ();
+      if (mcs < m_requiredSinrPerMcs.size ())
         {
-          usableChannelWidth = width;
-          break;
+          SetCcaEdThresholdSecondaryForMode (mode, averageRssi - m_requiredSinrPerMcs[mcs]);
         }
-      width /= 2;
     }
-  return usableChannelWidth;
 }
 
 std::ostream& operator<< (std::ostream& os, CcaThresholdPerWifiModeMap ccaThresholdPerWifiMode)
@@ -130,4 +249,37 @@ std::istream &operator>> (std::istream &is, CcaThresholdPerWifiModeMap &ccaThres
   return is;
 }
 
+std::ostream& operator<< (std::ostream& os, SinrPerMcsList sinrPerMcs)
+{
+  for (auto it = sinrPerMcs.begin (); it != sinrPerMcs.end (); ++it)
+    {
+      if (it != sinrPerMcs.begin ())
+        {
+          os << ",";
+        }
+      os << *it;
+    }
+  return os;
+}
+
+std::istream &operator>> (std::istream &is, SinrPerMcsList &sinrPerMcs)
+{
+  sinrPerMcs.clear ();
+  double sinr;
+  while (is >> sinr)
+    {
+      sinrPerMcs.push_back (sinr);
+      if (is.peek () == ',')
+        {
+          is.ignore ();
+        }
+    }
+  if (!sinrPerMcs.empty ())
+    {
+      //reaching the end of the list is not a failure
+      is.clear (std::ios::eofbit);
+    }
+  return is;
+}
+
 } //namespace ns3
@@ -21,6 +21,7 @@
 #ifndef DYNAMIC_THRESHOLD_CHANNEL_BONDING_MANAGER_H
 #define DYNAMIC_THRESHOLD_CHANNEL_BONDING_MANAGER_H
 
+#include <deque>
 #include "ns3/attribute-helper.h"
 #include "channel-bonding-manager.h"
 
@@ -32,6 +33,12 @@ ATTRIBUTE_VALUE_DEFINE_WITH_NAME (CcaThresholdPerWifiModeMap, CcaThresholdPerWif
 ATTRIBUTE_ACCESSOR_DEFINE (CcaThresholdPerWifiMode);
 ATTRIBUTE_CHECKER_DEFINE (CcaThresholdPerWifiMode);
 
+typedef std::vector<double> SinrPerMcsList;
+
+ATTRIBUTE_VALUE_DEFINE_WITH_NAME (SinrPerMcsList, RequiredSinrPerMcs);
+ATTRIBUTE_ACCESSOR_DEFINE (RequiredSinrPerMcs);
+ATTRIBUTE_CHECKER_DEFINE (RequiredSinrPerMcs);
+
 /**
  * \brief Dynamic Threshold Channel Bonding Manager
  * \ingroup wifi
@@ -60,6 +67,12 @@ public:
    * to a transmission, it will consider the threshold that is configured for the
    * WifiMode that is going to be used for the upcoming transmission.
    *
+   * The threshold is first rounded to the configured resolution. If the maximum
+   * number of distinct thresholds, including the default threshold of the PHY,
+   * is already in use, the closest one is reused.
+   * The PHY is only updated when the set of distinct thresholds changes.
+   *
+   * \param mode the WifiMode
    * \param threshold the CCA threshold in dBm for the secondary channels
    */
   void SetCcaEdThresholdSecondaryForMode (WifiMode mode, double threshold);
@@ -73,8 +86,44 @@ public:
    */
   uint16_t GetUsableChannelWidth (WifiMode mode) override;
 
+  /**
+   * Update the CCA thresholds for the secondary channels of every MCS supported
+   * by the PHY, based on the average RSSI of the last received beacons: the
+   * threshold of an MCS is the average RSSI minus the SINR required by that MCS.
+   *
+   * \param rssiDbm the RSSI (dBm) of the received beacon
+   */
+  void NotifyBeaconRssi (double rssiDbm) override;
+
 
 private:
+  /**
+   * \param threshold the CCA threshold (dBm)
+   * \return the threshold rounded to the configured resolution
+   */
+  double QuantizeThreshold (double threshold) const;
+  /**
+   * \param threshold the CCA threshold (dBm)
+   * \return the number of WifiModes using the given threshold
+   */
+  std::size_t GetNModesUsingThreshold (double threshold) const;
+  /**
+   * \param threshold the CCA threshold (dBm)
+   * \return whether the threshold is the default threshold of the PHY for the secondary channels
+   */
+  bool IsDefaultThreshold (double threshold) const;
+  /**
+   * \return the distinct thresholds in use, including the default threshold of
+   *         the PHY once it is set, sorted in increasing order
+   */
+  std::vector<double> GetDistinctThresholds (void) const;
+
+  double m_thresholdResolution;     //!< resolution (dB) of the CCA thresholds for secondary channel(s)
+  uint8_t m_maxNThresholds;         //!< maximum number of distinct CCA thresholds for secondary channel(s)
+  uint16_t m_beaconRssiWindowSize;  //!< number of beacons the RSSI is averaged over
+  SinrPerMcsList m_requiredSinrPerMcs; //!< SINR (dB) required by each MCS, indexed by MCS value
+  std::deque<double> m_beaconRssis; //!< RSSIs (dBm) of the last received beacons
+  double m_beaconRssiSum;           //!< sum of the RSSIs (dBm) held by m_beaconRssis
   CcaThresholdPerWifiModeMap m_ccaEdThresholdsSecondaryDbm; //!< Clear channel assessment (CCA) thresholds for secondary channel(s) in dBm, per WifiMode
 };
 
@@ -92,6 +141,20 @@ std::ostream& operator<< (std::ostream& os, CcaThresholdPerWifiModeMap ccaThresh
 */
 std::istream &operator>> (std::istream &is, CcaThresholdPerWifiModeMap &ccaThresholdPerWifiMode);
 
+/**
+ * \param os  output stream
+ * \param sinrPerMcs  comma-separated list of SINR (dB) per MCS to stringify
+ * \return output stream
+ */
+std::ostream& operator<< (std::ostream& os, SinrPerMcsList sinrPerMcs);
+
+/**
+* \param is input stream.
+* \param sinrPerMcs comma-separated list of SINR (dB) per MCS to set
+* \return input stream.
+*/
+std::istream &operator>> (std::istream &is, SinrPerMcsList &sinrPerMcs);
+
 
 } //namespace ns3
 
@@ -21,6 +21,8 @@
 
 #include <numeric>
 #include <algorithm>
+#include <cmath>
+#include <limits>
 #include "ns3/simulator.h"
 #include "ns3/log.h"
 #include "ns3/packet.h"
@@ -35,11 +37,242 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("InterferenceHelper");
 
+/// Maximum number of logged operations before all lazy bands get tracked
+static const std::size_t MAX_LAZY_BAND_OPERATIONS = 1000;
+
+/****************************************************************
+ *       Received power per band
+ ****************************************************************/
+
+RxPowerWattPerChannelBand::RxPowerWattPerChannelBand ()
+  : m_lazyRxPower (0)
+{
+}
+
+void
+RxPowerWattPerChannelBand::Add (WifiSpectrumBand band, double powerW)
+{
+  m_rxPowerW.push_back (std::make_pair (band, powerW));
+}
+
+void
+RxPowerWattPerChannelBand::SetPowerSpectralDensity (Ptr<const SpectrumValue> psd, double gain)
+{
+  //the lazy state may be shared with copies, hence build a new one
+  Ptr<LazyRxPower> lazyRxPower = Create<LazyRxPower> ();
+  if (m_lazyRxPower)
+    {
+      lazyRxPower->psds = m_lazyRxPower->psds;
+    }
+  lazyRxPower->psds.push_back (std::make_pair (psd, gain));
+  m_lazyRxPower = lazyRxPower;
+}
+
+const std::vector<std::pair<Ptr<const SpectrumValue>, double> > &
+RxPowerWattPerChannelBand::GetPowerSpectralDensities (void) const
+{
+  static const std::vector<std::pair<Ptr<const SpectrumValue>, double> > noPsds;
+  return m_lazyRxPower ? m_lazyRxPower->psds : noPsds;
+}
+
+double
+RxPowerWattPerChannelBand::GetRxPowerW (WifiSpectrumBand band) const
+{
+  auto it = std::find_if (m_rxPowerW.begin (), m_rxPowerW.end (),
+      [&band](const std::pair<WifiSpectrumBand, double>& element){ return element.first == band; } );
+  if (it != m_rxPowerW.end ())
+    {
+      return it->second;
+    }
+  NS_ASSERT_MSG (m_lazyRxPower, "No received power for band (" << band.first << "; " << band.second << ")");
+  auto memoIt = m_lazyRxPower->rxPowerW.find (band);
+  if (memoIt != m_lazyRxPower->rxPowerW.end ())
+    {
+      return memoIt->second;
+    }
+  double powerW = 0.0;
+  for (auto const& psd : m_lazyRxPower->psds)
+    {
+      powerW += WifiSpectrumValueHelper::GetBandPowerW (psd.first, band) * psd.second;
+    }
+  m_lazyRxPower->rxPowerW.insert ({band, powerW});
+  return powerW;
+}
+
+void
+RxPowerWattPerChannelBand::Accumulate (const RxPowerWattPerChannelBand &rxPower)
+{
+  NS_ASSERT (rxPower.m_rxPowerW.size () == m_rxPowerW.size ());
+  for (auto & currentRxPowerW : m_rxPowerW)
+    {
+      currentRxPowerW.second += rxPower.GetRxPowerW (currentRxPowerW.first);
+    }
+  if (rxPower.m_lazyRxPower)
+    {
+      //the lazy state may be shared with copies, hence build a new one
+      Ptr<LazyRxPower> lazyRxPower = Create<LazyRxPower> ();
+      if (m_lazyRxPower)
+        {
+          lazyRxPower->psds = m_lazyRxPower->psds;
+          for (auto const& memo : m_lazyRxPower->rxPowerW)
+            {
+              lazyRxPower->rxPowerW.insert ({memo.first, memo.second + rxPower.GetRxPowerW (memo.first)});
+            }
+        }
+      lazyRxPower->psds.insert (lazyRxPower->psds.end (), rxPower.m_lazyRxPower->psds.begin (), rxPower.m_lazyRxPower->psds.end ());
+      m_lazyRxPower = lazyRxPower;
+    }
+}
+
+std::size_t
+RxPowerWattPerChannelBand::GetNBands (void) const
+{
+  return m_rxPowerW.size ();
+}
+
+RxPowerWattPerChannelBand::const_iterator
+RxPowerWattPerChannelBand::begin (void) const
+{
+  return m_rxPowerW.begin ();
+}
+
+RxPowerWattPerChannelBand::const_iterator
+RxPowerWattPerChannelBand::end (void) const
+{
+  return m_rxPowerW.end ();
+}
+
+/****************************************************************
+ *       Band index
+ ****************************************************************/
+
+uint64_t
+WifiBandIndex::GetKey (WifiSpectrumBand band)
+{
+  return (static_cast<uint64_t> (band.first) << 32) | band.second;
+}
+
+std::size_t
+WifiBandIndex::Add (WifiSpectrumBand band)
+{
+  std::size_t bandId = m_bands.size ();
+  bool inserted = m_ids.insert ({GetKey (band), bandId}).second;
+  NS_ASSERT_MSG (inserted, "Band (" << band.first << "; " << band.second << ") already added");
+  m_bands.push_back (band);
+  return bandId;
+}
+
+std::size_t
+WifiBandIndex::GetId (WifiSpectrumBand band) const
+{
+  auto it = m_ids.find (GetKey (band));
+  NS_ASSERT_MSG (it != m_ids.end (), "Unknown band (" << band.first << "; " << band.second << ")");
+  return it->second;
+}
+
+WifiSpectrumBand
+WifiBandIndex::GetBand (std::size_t bandId) const
+{
+  NS_ASSERT (bandId < m_bands.size ());
+  return m_bands[bandId];
+}
+
+std::size_t
+WifiBandIndex::GetNBands (void) const
+{
+  return m_bands.size ();
+}
+
+/****************************************************************
+ *       Received power per band ID
+ ****************************************************************/
+
+RxPowerWattPerBandId::RxPowerWattPerBandId (const RxPowerWattPerChannelBand &rxPower, Ptr<const WifiBandIndex> bandIndex)
+  : m_bandIndex (bandIndex),
+    m_nBands (rxPower.GetNBands ()),
+    m_psds (rxPower.GetPowerSpectralDensities ())
+{
+  m_rxPowerW.reserve (m_nBands);
+  for (auto const& rxPowerPerBand : rxPower)
+    {
+      NS_ASSERT_MSG (m_bandIndex->GetId (rxPowerPerBand.first) == m_rxPowerW.size (),
+                     "The bands provided upfront must be the first bands of the index");
+      m_rxPowerW.push_back (rxPowerPerBand.second);
+    }
+}
+
+double
+RxPowerWattPerBandId::GetRxPowerW (std::size_t bandId) const
+{
+  if (bandId < m_rxPowerW.size () && !std::isnan (m_rxPowerW[bandId]))
+    {
+      return m_rxPowerW[bandId];
+    }
+  NS_ASSERT_MSG (!m_psds.empty (), "No received power for band " << bandId);
+  WifiSpectrumBand band = m_bandIndex->GetBand (bandId);
+  double powerW = 0.0;
+  for (auto const& psd : m_psds)
+    {
+      powerW += WifiSpectrumValueHelper::GetBandPowerW (psd.first, band) * psd.second;
+    }
+  if (bandId >= m_rxPowerW.size ())
+    {
+      m_rxPowerW.resize (bandId + 1, std::numeric_limits<double>::quiet_NaN ());
+    }
+  m_rxPowerW[bandId] = powerW;
+  return powerW;
+}
+
+std::size_t
+RxPowerWattPerBandId::GetNBands (void) const
+{
+  return m_nBands;
+}
+
+Ptr<const WifiBandIndex>
+RxPowerWattPerBandId::GetBandIndex (void) const
+{
+  return m_bandIndex;
+}
+
+RxPowerWattPerChannelBand
+RxPowerWattPerBandId::GetRxPowerWPerBand (void) const
+{
+  RxPowerWattPerChannelBand rxPower;
+  for (std::size_t bandId = 0; bandId < m_nBands; ++bandId)
+    {
+      rxPower.Add (m_bandIndex->GetBand (bandId), m_rxPowerW[bandId]);
+    }
+  for (auto const& psd : m_psds)
+    {
+      rxPower.SetPowerSpectralDensity (psd.first, psd.second);
+    }
+  return rxPower;
+}
+
+Ptr<RxPowerWattPerBandId>
+RxPowerWattPerBandId::Sum (const RxPowerWattPerBandId &rxPower) const
+{
+  NS_ASSERT (rxPower.m_bandIndex == m_bandIndex);
+  NS_ASSERT (rxPower.m_nBands == m_nBands);
+  Ptr<RxPowerWattPerBandId> sum = Create<RxPowerWattPerBandId> (*this);
+  for (std::size_t bandId = 0; bandId < sum->m_rxPowerW.size (); ++bandId)
+    {
+      //the bands that have not been computed yet will be computed from both PSDs
+      if (!std::isnan (sum->m_rxPowerW[bandId]))
+        {
+          sum->m_rxPowerW[bandId] += rxPower.GetRxPowerW (bandId);
+        }
+    }
+  sum->m_psds.insert (sum->m_psds.end (), rxPower.m_psds.begin (), rxPower.m_psds.end ());
+  return sum;
+}
+
 /****************************************************************
  *       Phy event class
  ****************************************************************/
 
-Event::Event (Ptr<const WifiPpdu> ppdu, WifiTxVector txVector, Time duration, RxPowerWattPerChannelBand rxPower)
+Event::Event (Ptr<const WifiPpdu> ppdu, WifiTxVector txVector, Time duration, Ptr<const RxPowerWattPerBandId> rxPower)
   : m_ppdu (ppdu),
     m_txVector (txVector),
     m_startTime (Simulator::Now ()),
@@ -79,11 +312,11 @@ Event::GetDuration (void) const
 double
 Event::GetRxPowerW (void) const
 {
-  NS_ASSERT (m_rxPowerW.size () > 0);
+  NS_ASSERT (m_rxPowerW->GetNBands () > 0);
   double power = 0.0;
-  for (auto const& rxPowerPerBand : m_rxPowerW)
+  for (std::size_t bandId = 0; bandId < m_rxPowerW->GetNBands (); ++bandId)
     {
-      power += rxPowerPerBand.second;
+      power += m_rxPowerW->GetRxPowerW (bandId);
     }
   return power;
 }
@@ -91,10 +324,13 @@ Event::GetRxPowerW (void) const
 double
 Event::GetRxPowerW (WifiSpectrumBand band) const
 {
-  auto it = std::find_if (m_rxPowerW.begin (), m_rxPowerW.end(),
-      [&band](const std::pair<WifiSpectrumBand, double>& element){ return element.first == band; } );
-  NS_ASSERT (it != m_rxPowerW.end ());
-  return it->second;
+  return m_rxPowerW->GetRxPowerW (m_rxPowerW->GetBandIndex ()->GetId (band));
+}
+
+double
+Event::GetRxPowerW (std::size_t bandId) const
+{
+  return m_rxPowerW->GetRxPowerW (bandId);
 }
 
 double
@@ -111,6 +347,12 @@ Event::GetRxPowerW (WifiSpectrumBands bands) const
 
 RxPowerWattPerChannelBand
 Event::GetRxPowerWPerBand (void) const
+{
+  return m_rxPowerW->GetRxPowerWPerBand ();
+}
+
+Ptr<const RxPowerWattPerBandId>
+Event::GetRxPowerWPerBandId (void) const
 {
   return m_rxPowerW;
 }
@@ -122,20 +364,12 @@ Event::GetTxVector (void) const
 }
 
 void
-Event::UpdateRxPowerW (RxPowerWattPerChannelBand rxPower)
+Event::UpdateRxPowerW (const RxPowerWattPerBandId &rxPower)
 {
-  NS_ASSERT (rxPower.size () == m_rxPowerW.size ());
-  //Update power band per band
-  for (auto & currentRxPowerW : m_rxPowerW)
-    {
-      auto band = currentRxPowerW.first;
-      auto it = std::find_if (m_rxPowerW.begin (), m_rxPowerW.end(),
-          [&band](const std::pair<WifiSpectrumBand, double>& element){ return element.first == band; } );
-      if (it != rxPower.end ())
-        {
-          currentRxPowerW.second += it->second;
-        }
-    }
+  NS_ASSERT (rxPower.GetNBands () == m_rxPowerW->GetNBands ());
+  //Update power band per band. The previous power may still be referenced by
+  //the operations logged for the lazy bands, hence it is not modified in place.
+  m_rxPowerW = m_rxPowerW->Sum (rxPower);
 }
 
 std::ostream & operator << (std::ostream &os, const Event &event)
@@ -184,7 +418,10 @@ InterferenceHelper::NiChange::GetEvent (void) const
 InterferenceHelper::InterferenceHelper ()
   : m_errorRateModel (0),
     m_numRxAntennas (1),
-    m_rxing (false)
+    m_bandIndex (Create<WifiBandIndex> ()),
+    m_rxing (false),
+    m_nLazyBands (0),
+    m_lazyBandOperationsEnd (Seconds (0))
 {
 }
 
@@ -197,7 +434,7 @@ InterferenceHelper::~InterferenceHelper ()
 Ptr<Event>
 InterferenceHelper::Add (Ptr<const WifiPpdu> ppdu, WifiTxVector txVector, Time duration, RxPowerWattPerChannelBand rxPowerW, bool isStartOfdmaRxing)
 {
-  Ptr<Event> event = Create<Event> (ppdu, txVector, duration, rxPowerW);
+  Ptr<Event> event = Create<Event> (ppdu, txVector, duration, Create<RxPowerWattPerBandId> (rxPowerW, m_bandIndex));
   AppendEvent (event, isStartOfdmaRxing);
   return event;
 }
@@ -216,21 +453,43 @@ InterferenceHelper::AddForeignSignal (Time duration, RxPowerWattPerChannelBand r
 void
 InterferenceHelper::RemoveBands(void)
 {
-  m_niChangesPerBand.clear();
-  m_firstPowerPerBand.clear();
+  m_timelines.clear ();
+  //events of the previous configuration keep referencing the previous index
+  m_bandIndex = Create<WifiBandIndex> ();
+  m_nLazyBands = 0;
+  m_trackedLazyBandIds.clear ();
+  m_lazyBandOperations.clear ();
+  m_lazyBandOperationsEnd = Seconds (0);
 }
 
 void
-InterferenceHelper::AddBand (WifiSpectrumBand band)
+InterferenceHelper::AddBand (WifiSpectrumBand band, bool lazy)
 {
-  NS_LOG_FUNCTION (this << band.first << band.second);
-  auto it = m_niChangesPerBand.find (band);
-  NS_ASSERT (it == m_niChangesPerBand.end ());
-  NiChanges niChanges;
-  m_niChangesPerBand.insert ({band, niChanges});
-  // Always have a zero power noise event in the list
-  AddNiChangeEvent (Time (0), NiChange (0.0, 0), band);
-  m_firstPowerPerBand.insert ({band, 0.0});
+  NS_LOG_FUNCTION (this << band.first << band.second << lazy);
+  NS_ASSERT_MSG (lazy || m_nLazyBands == 0, "Bands that are not lazy must be added first");
+  std::size_t bandId = m_bandIndex->Add (band);
+  NS_ASSERT (bandId == m_timelines.size ());
+  BandTimeline timeline;
+  timeline.band = band;
+  timeline.firstPower = 0.0;
+  timeline.lazy = lazy;
+  timeline.tracked = !lazy;
+  m_timelines.push_back (timeline);
+  if (lazy)
+    {
+      m_nLazyBands++;
+    }
+  else
+    {
+      // Always have a zero power noise event in the list
+      AddNiChangeEvent (Time (0), NiChange (0.0, 0), bandId);
+    }
+}
+
+std::size_t
+InterferenceHelper::GetBandId (WifiSpectrumBand band) const
+{
+  return m_bandIndex->GetId (band);
 }
 
 void
@@ -260,15 +519,16 @@ InterferenceHelper::SetNumberOfReceiveAntennas (uint8_t rx)
 Time
 InterferenceHelper::GetEnergyDuration (double energyW, WifiSpectrumBand band)
 {
+  std::size_t bandId = GetBandId (band);
+  MaterializeBand (bandId);
+  const NiChanges &niChanges = m_timelines[bandId].niChanges;
   Time now = Simulator::Now ();
-  auto i = GetPreviousPosition (now, band);
-  Time end = i->first;
-  auto ni_it = m_niChangesPerBand.find (band);
-  NS_ASSERT (ni_it != m_niChangesPerBand.end ());
-  for (; i != ni_it->second.end (); ++i)
+  std::size_t i = GetPreviousPosition (now, bandId);
+  Time end = niChanges[i].first;
+  for (; i < niChanges.size (); ++i)
     {
-      double noiseInterferenceW = i->second.GetPower ();
-      end = i->first;
+      double noiseInterferenceW = niChanges[i].second.GetPower ();
+      end = niChanges[i].first;
       if (noiseInterferenceW < energyW)
         {
           break;
@@ -277,39 +537,96 @@ InterferenceHelper::GetEnergyDuration (double energyW, WifiSpectrumBand band)
   return end > now ? end - now : MicroSeconds (0);
 }
 
+std::vector<Time>
+InterferenceHelper::GetEnergyDurations (const std::vector<double> &energiesW, WifiSpectrumBand band)
+{
+  std::size_t bandId = GetBandId (band);
+  MaterializeBand (bandId);
+  const NiChanges &niChanges = m_timelines[bandId].niChanges;
+  Time now = Simulator::Now ();
+  std::vector<Time> durations (energiesW.size (), MicroSeconds (0));
+  std::size_t k = 0;
+  std::size_t i = GetPreviousPosition (now, bandId);
+  Time end = niChanges[i].first;
+  for (; i < niChanges.size () && k < energiesW.size (); ++i)
+    {
+      double noiseInterferenceW = niChanges[i].second.GetPower ();
+      end = niChanges[i].first;
+      //the energy drops below the highest thresholds first
+      while (k < energiesW.size () && noiseInterferenceW < energiesW[k])
+        {
+          NS_ASSERT (k == 0 || energiesW[k] <= energiesW[k - 1]);
+          durations[k++] = end > now ? end - now : MicroSeconds (0);
+        }
+    }
+  for (; k < energiesW.size (); ++k)
+    {
+      durations[k] = end > now ? end - now : MicroSeconds (0);
+    }
+  return durations;
+}
+
 void
 InterferenceHelper::AppendEvent (Ptr<Event> event, bool isStartOfdmaRxing)
 {
   NS_LOG_FUNCTION (this << event << isStartOfdmaRxing);
-  RxPowerWattPerChannelBand rxPowerWattPerChannelBand = event->GetRxPowerWPerBand ();
-  for (auto const& it : rxPowerWattPerChannelBand)
+  if (!m_rxing && (m_lazyBandOperationsEnd <= event->GetStartTime ()))
     {
-      WifiSpectrumBand band = it.first;
-      auto ni_it = m_niChangesPerBand.find (band);
-      NS_ASSERT (ni_it != m_niChangesPerBand.end ());
-      double previousPowerStart = 0;
-      double previousPowerEnd = 0;
-      previousPowerStart = GetPreviousPosition (event->GetStartTime (), band)->second.GetPower ();
-      previousPowerEnd = GetPreviousPosition (event->GetEndTime (), band)->second.GetPower ();
-      if (!m_rxing)
-        {
-          m_firstPowerPerBand.find (band)->second = previousPowerStart;
-          // Always leave the first zero power noise event in the list
-          ni_it->second.erase (++(ni_it->second.begin ()), GetNextPosition (event->GetStartTime (), band));
-        }
-      else if (isStartOfdmaRxing)
-        {
-          //When the first UL-OFDMA payload is received, we need to set m_firstPowerPerBand
-          //so that it takes into account interferences that arrived between the start of the
-          //UL MU transmission and the start of UL-OFDMA payload.
-          m_firstPowerPerBand.find (band)->second = previousPowerStart;
-        }
-      auto first = AddNiChangeEvent (event->GetStartTime (), NiChange (previousPowerStart, event), band);
-      auto last = AddNiChangeEvent (event->GetEndTime (), NiChange (previousPowerEnd, event), band);
-      for (auto i = first; i != last; ++i)
-        {
-          i->second.AddPower (it.second);
-        }
+      //All the previous events are over, hence a lazy band looked at later on
+      //would only be left with the zero power noise event: no need to replay them.
+      ResetLazyBands ();
+    }
+  else if (!m_rxing && !m_lazyBandOperations.empty ())
+    {
+      TrimLazyBandOperations (event->GetStartTime ());
+    }
+  Ptr<const RxPowerWattPerBandId> rxPower = event->GetRxPowerWPerBandId ();
+  NS_ASSERT (rxPower->GetBandIndex () == m_bandIndex);
+  for (std::size_t bandId = 0; bandId < rxPower->GetNBands (); ++bandId)
+    {
+      AppendEvent (event, rxPower->GetRxPowerW (bandId), bandId, m_rxing, isStartOfdmaRxing);
+    }
+  for (auto const& bandId : m_trackedLazyBandIds)
+    {
+      AppendEvent (event, rxPower->GetRxPowerW (bandId), bandId, m_rxing, isStartOfdmaRxing);
+    }
+  LazyBandOperation operation;
+  operation.type = APPEND_EVENT;
+  operation.event = event;
+  operation.rxPower = rxPower;
+  operation.rxing = m_rxing;
+  operation.isStartOfdmaRxing = isStartOfdmaRxing;
+  LogLazyBandOperation (operation);
+  m_lazyBandOperationsEnd = Max (m_lazyBandOperationsEnd, event->GetEndTime ());
+}
+
+void
+InterferenceHelper::AppendEvent (Ptr<Event> event, double powerW, std::size_t bandId, bool rxing, bool isStartOfdmaRxing) const
+{
+  BandTimeline &timeline = m_timelines[bandId];
+  NS_ASSERT (timeline.tracked);
+  double previousPowerStart = timeline.niChanges[GetPreviousPosition (event->GetStartTime (), bandId)].second.GetPower ();
+  double previousPowerEnd = timeline.niChanges[GetPreviousPosition (event->GetEndTime (), bandId)].second.GetPower ();
+  if (!rxing)
+    {
+      timeline.firstPower = previousPowerStart;
+      // Always leave the first zero power noise event in the list
+      timeline.niChanges.erase (timeline.niChanges.begin () + 1,
+                                timeline.niChanges.begin () + GetNextPosition (event->GetStartTime (), bandId));
+    }
+  else if (isStartOfdmaRxing)
+    {
+      //When the first UL-OFDMA payload is received, we need to set the first power
+      //so that it takes into account interferences that arrived between the start of the
+      //UL MU transmission and the start of UL-OFDMA payload.
+      timeline.firstPower = previousPowerStart;
+    }
+  std::size_t first = AddNiChangeEvent (event->GetStartTime (), NiChange (previousPowerStart, event), bandId);
+  std::size_t last = AddNiChangeEvent (event->GetEndTime (), NiChange (previousPowerEnd, event), bandId);
+  //The power of the event is added in one pass over the contiguous range it spans
+  for (std::size_t i = first; i < last; ++i)
+    {
+      timeline.niChanges[i].second.AddPower (powerW);
     }
 }
 
@@ -318,19 +635,121 @@ InterferenceHelper::UpdateEvent (Ptr<Event> event, RxPowerWattPerChannelBand rxP
 {
   NS_LOG_FUNCTION (this << event);
   //This is called for UL MU events, in order to scale power as long as UL MU PPDUs arrive
-  for (auto const& it : rxPower)
+  Ptr<const RxPowerWattPerBandId> rxPowerPerBandId = Create<RxPowerWattPerBandId> (rxPower, m_bandIndex);
+  for (std::size_t bandId = 0; bandId < rxPowerPerBandId->GetNBands (); ++bandId)
+    {
+      UpdateEvent (event, rxPowerPerBandId->GetRxPowerW (bandId), bandId);
+    }
+  for (auto const& bandId : m_trackedLazyBandIds)
     {
-      WifiSpectrumBand band = it.first;
-      auto ni_it = m_niChangesPerBand.find (band);
-      NS_ASSERT (ni_it != m_niChangesPerBand.end ());
-      auto first = GetPreviousPosition (event->GetStartTime (), band);
-      auto last = GetPreviousPosition (event->GetEndTime (), band);
-      for (auto i = first; i != last; ++i)
+      UpdateEvent (event, rxPowerPerBandId->GetRxPowerW (bandId), bandId);
+    }
+  LazyBandOperation operation;
+  operation.type = UPDATE_EVENT;
+  operation.event = event;
+  operation.rxPower = rxPowerPerBandId;
+  operation.rxing = m_rxing;
+  operation.isStartOfdmaRxing = false;
+  LogLazyBandOperation (operation);
+  event->UpdateRxPowerW (*rxPowerPerBandId);
+}
+
+void
+InterferenceHelper::UpdateEvent (Ptr<const Event> event, double powerW, std::size_t bandId) const
+{
+  BandTimeline &timeline = m_timelines[bandId];
+  NS_ASSERT (timeline.tracked);
+  std::size_t first = GetPreviousPosition (event->GetStartTime (), bandId);
+  std::size_t last = GetPreviousPosition (event->GetEndTime (), bandId);
+  for (std::size_t i = first; i < last; ++i)
+    {
+      timeline.niChanges[i].second.AddPower (powerW);
+    }
+}
+
+void
+InterferenceHelper::MaterializeBand (std::size_t bandId) const
+{
+  BandTimeline &timeline = m_timelines[bandId];
+  if (timeline.tracked)
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this << timeline.band.first << timeline.band.second << m_lazyBandOperations.size ());
+  NS_ASSERT (timeline.lazy);
+  timeline.tracked = true;
+  m_trackedLazyBandIds.push_back (bandId);
+  timeline.niChanges.clear ();
+  // Always have a zero power noise event in the list
+  AddNiChangeEvent (Time (0), NiChange (0.0, 0), bandId);
+  timeline.firstPower = 0.0;
+  for (auto const& operation : m_lazyBandOperations)
+    {
+      switch (operation.type)
+        {
+        case APPEND_EVENT:
+          AppendEvent (operation.event, operation.rxPower->GetRxPowerW (bandId), bandId, operation.rxing, operation.isStartOfdmaRxing);
+          break;
+        case UPDATE_EVENT:
+          UpdateEvent (operation.event, operation.rxPower->GetRxPowerW (bandId), bandId);
+          break;
+        case NOTIFY_RX_END:
+          NotifyRxEnd (operation.endTime, bandId);
+          break;
+        default:
+          NS_FATAL_ERROR ("Unknown lazy band operation");
+          break;
+        }
+    }
+}
+
+void
+InterferenceHelper::LogLazyBandOperation (const LazyBandOperation &operation)
+{
+  if (m_trackedLazyBandIds.size () == m_nLazyBands)
+    {
+      //there is no band to replay the operation on
+      return;
+    }
+  m_lazyBandOperations.push_back (operation);
+  if (m_lazyBandOperations.size () > MAX_LAZY_BAND_OPERATIONS)
+    {
+      //The medium never gets idle: rather track all the lazy bands than keeping an ever-growing log
+      NS_LOG_DEBUG ("Too many logged operations, start tracking all lazy bands");
+      for (std::size_t bandId = 0; bandId < m_timelines.size (); ++bandId)
         {
-          i->second.AddPower (it.second);
+          MaterializeBand (bandId);
         }
+      m_lazyBandOperations.clear ();
+    }
+}
+
+void
+InterferenceHelper::ResetLazyBands (void)
+{
+  for (auto const& bandId : m_trackedLazyBandIds)
+    {
+      m_timelines[bandId].tracked = false;
+      m_timelines[bandId].niChanges.clear ();
     }
-    event->UpdateRxPowerW (rxPower);
+  m_trackedLazyBandIds.clear ();
+  m_lazyBandOperations.clear ();
+  m_lazyBandOperationsEnd = Seconds (0);
+}
+
+void
+InterferenceHelper::TrimLazyBandOperations (Time start)
+{
+  //The NI changes of the events that are over are erased when replaying the
+  //append of this event, and so is the first power set upon the end of the
+  //previous receptions: replaying the operations on these events is useless.
+  auto it = std::remove_if (m_lazyBandOperations.begin (), m_lazyBandOperations.end (),
+                            [start] (const LazyBandOperation &operation)
+                            {
+                              return operation.type == NOTIFY_RX_END || operation.event->GetEndTime () <= start;
+                            });
+  NS_LOG_DEBUG ("Dropping " << m_lazyBandOperations.end () - it << " logged operations out of " << m_lazyBandOperations.size ());
+  m_lazyBandOperations.erase (it, m_lazyBandOperations.end ());
 }
 
 double
@@ -419,15 +838,17 @@ double
 InterferenceHelper::CalculateNoiseInterferenceW (Ptr<const Event> event, NiChangesPerBand *nis, WifiSpectrumBand band) const
 {
   NS_LOG_FUNCTION (this << band.first << band.second);
-  auto firstPower_it = m_firstPowerPerBand.find (band);
-  NS_ASSERT (firstPower_it != m_firstPowerPerBand.end ());
-  double noiseInterferenceW = firstPower_it->second;
-  auto ni_it = m_niChangesPerBand.find (band);
-  NS_ASSERT (ni_it != m_niChangesPerBand.end ());
-  auto it = ni_it->second.find (event->GetStartTime ());
-  for (; it != ni_it->second.end () && it->first < Simulator::Now (); ++it)
+  std::size_t bandId = GetBandId (band);
+  MaterializeBand (bandId);
+  const BandTimeline &timeline = m_timelines[bandId];
+  double noiseInterferenceW = timeline.firstPower;
+  NS_ASSERT (event->GetRxPowerWPerBandId ()->GetBandIndex () == m_bandIndex);
+  double rxPowerW = event->GetRxPowerW (bandId);
+  Time now = Simulator::Now ();
+  for (std::size_t i = FindPosition (event->GetStartTime (), bandId);
+       i < timeline.niChanges.size () && timeline.niChanges[i].first < now; ++i)
     {
-      noiseInterferenceW = it->second.GetPower () - event->GetRxPowerW (band);
+      noiseInterferenceW = timeline.niChanges[i].second.GetPower () - rxPowerW;
     }
   WifiSpectrumBands bands;
   bands.push_back (band);
@@ -442,18 +863,19 @@ InterferenceHelper::CalculateNoiseInterferenceWPerBand (Ptr<const Event> event,
   NS_LOG_FUNCTION (this);
   for (auto const & band : bands)
     {
-      auto ni_it = m_niChangesPerBand.find (band);
-      NS_ASSERT (ni_it != m_niChangesPerBand.end ());
-      auto it = ni_it->second.find (event->GetStartTime ());
-      NS_ASSERT (it != ni_it->second.end ());
-      for (; it != ni_it->second.end () && it->second.GetEvent () != event; ++it);
+      std::size_t bandId = GetBandId (band);
+      MaterializeBand (bandId);
+      const NiChanges &niChanges = m_timelines[bandId].niChanges;
+      std::size_t i = FindPosition (event->GetStartTime (), bandId);
+      NS_ASSERT (i < niChanges.size ());
+      for (; i < niChanges.size () && niChanges[i].second.GetEvent () != event; ++i);
       NiChanges ni;
-      ni.emplace (event->GetStartTime (), NiChange (0, event));
-      while (++it != ni_it->second.end () && it->second.GetEvent () != event)
+      ni.push_back (std::make_pair (event->GetStartTime (), NiChange (0, event)));
+      while (++i < niChanges.size () && niChanges[i].second.GetEvent () != event)
         {
-          ni.insert (*it);
+          ni.push_back (niChanges[i]);
         }
-      ni.emplace (event->GetEndTime (), NiChange (0, event));
+      ni.push_back (std::make_pair (event->GetEndTime (), NiChange (0, event)));
       nis->insert ({band, ni});
     }
 }
@@ -502,7 +924,7 @@ InterferenceHelper::CalculatePayloadPer (Ptr<const Event> event, uint16_t channe
   NS_LOG_FUNCTION (this << staId << channelWidth << window.first << window.second);
   const WifiTxVector txVector = event->GetTxVector ();
   double psr = 1.0; /* Packet Success Rate */
-  auto ni_it = nis->find (bands.front ())->second;
+  const NiChanges &ni_it = nis->find (bands.front ())->second;
   auto j = ni_it.begin ();
   Time previous = j->first;
   WifiMode payloadMode = txVector.GetMode (staId);
@@ -525,10 +947,13 @@ InterferenceHelper::CalculatePayloadPer (Ptr<const Event> event, uint16_t channe
   //Keep power and noise+interference per band to compute effective SNR in case channel bonding is used
   std::map<WifiSpectrumBand, double> powerPerBandW;
   std::map<WifiSpectrumBand, double> noiseInterferencePerBandW;
+  std::vector<std::size_t> bandIds;
   for (auto const & band : bands)
     {
-      powerPerBandW.insert({band, event->GetRxPowerW (band)});
-      noiseInterferencePerBandW.insert({band, m_firstPowerPerBand.find (band)->second});
+      std::size_t bandId = GetBandId (band);
+      bandIds.push_back (bandId);
+      powerPerBandW.insert({band, event->GetRxPowerW (bandId)});
+      noiseInterferencePerBandW.insert({band, m_timelines[bandId].firstPower});
     }
   while (++j != ni_it.end ())
     {
@@ -550,14 +975,12 @@ InterferenceHelper::CalculatePayloadPer (Ptr<const Event> event, uint16_t channe
           NS_LOG_DEBUG ("previous is before windowed payload and current is in the windowed payload: mode=" << payloadMode << ", psr=" << psr);
         }
       auto iteratorDistance = std::distance(ni_it.begin (), j);
-      for (auto const & band : bands)
+      for (std::size_t k = 0; k < bands.size (); ++k)
         {
           //Update noise+interference for each band
-          auto it = nis->find (band)->second.begin();
-          std::advance (it, iteratorDistance);
-          //TODO: can we instead store an iterator per band instead of iterating for each NiChange?
+          auto it = nis->find (bands[k])->second.begin () + iteratorDistance;
           NS_ASSERT (it->first == current);
-          noiseInterferencePerBandW.find (band)->second = it->second.GetPower () - event->GetRxPowerW (band);
+          noiseInterferencePerBandW.find (bands[k])->second = it->second.GetPower () - event->GetRxPowerW (bandIds[k]);
         }
       previous = j->first;
       if (previous > windowEnd)
@@ -577,7 +1000,7 @@ InterferenceHelper::CalculateLegacyPhyHeaderPer (Ptr<const Event> event, NiChang
   const WifiTxVector txVector = event->GetTxVector ();
   uint16_t channelWidth = txVector.GetChannelWidth () >= 40 ? 20 : txVector.GetChannelWidth (); //calculate PER on the 20 MHz primary channel for L-SIG
   double psr = 1.0; /* Packet Success Rate */
-  auto ni_it = nis->find (band)->second;
+  const NiChanges &ni_it = nis->find (band)->second;
   auto j = ni_it.begin ();
   Time previous = j->first;
   WifiPreamble preamble = txVector.GetPreambleType ();
@@ -586,8 +1009,9 @@ InterferenceHelper::CalculateLegacyPhyHeaderPer (Ptr<const Event> event, NiChang
   Time plcpHsigHeaderStart = plcpHeaderStart + WifiPhy::GetPlcpHeaderDuration (txVector); //PPDU start time + preamble + L-SIG
   Time plcpTrainingSymbolsStart = plcpHsigHeaderStart + WifiPhy::GetPlcpHtSigHeaderDuration (preamble) + WifiPhy::GetPlcpSigA1Duration (preamble) + WifiPhy::GetPlcpSigA2Duration (preamble); //PPDU start time + preamble + L-SIG + HT-SIG or SIG-A
   Time plcpPayloadStart = plcpTrainingSymbolsStart + WifiPhy::GetPlcpTrainingSymbolDuration (txVector) + WifiPhy::GetPlcpSigBDuration (txVector); //PPDU start time + preamble + L-SIG + HT-SIG or SIG-A + Training + SIG-B
-  double noiseInterferenceW = m_firstPowerPerBand.find (band)->second;
-  double powerW = event->GetRxPowerW (band);
+  std::size_t bandId = GetBandId (band);
+  double noiseInterferenceW = m_timelines[bandId].firstPower;
+  double powerW = event->GetRxPowerW (bandId);
   while (++j != ni_it.end ())
     {
       Time current = j->first;
@@ -692,7 +1116,7 @@ InterferenceHelper::CalculateNonLegacyPhyHeaderPer (Ptr<const Event> event, NiCh
   const WifiTxVector txVector = event->GetTxVector ();
   uint16_t channelWidth = txVector.GetChannelWidth () >= 40 ? 20 : txVector.GetChannelWidth (); //calculate PER on the 20 MHz primary channel for PHY headers
   double psr = 1.0; /* Packet Success Rate */
-  auto ni_it = nis->find (band)->second;
+  const NiChanges &ni_it = nis->find (band)->second;
   auto j = ni_it.begin ();
   Time previous = j->first;
   WifiPreamble preamble = txVector.GetPreambleType ();
@@ -717,8 +1141,9 @@ InterferenceHelper::CalculateNonLegacyPhyHeaderPer (Ptr<const Event> event, NiCh
   Time plcpHsigHeaderStart = plcpHeaderStart + WifiPhy::GetPlcpHeaderDuration (txVector); //PPDU start time + preamble + L-SIG
   Time plcpTrainingSymbolsStart = plcpHsigHeaderStart + WifiPhy::GetPlcpHtSigHeaderDuration (preamble) + WifiPhy::GetPlcpSigA1Duration (preamble) + WifiPhy::GetPlcpSigA2Duration (preamble); //PPDU start time + preamble + L-SIG + HT-SIG or SIG-A
   Time plcpPayloadStart = plcpTrainingSymbolsStart + WifiPhy::GetPlcpTrainingSymbolDuration (txVector) + WifiPhy::GetPlcpSigBDuration (txVector); //PPDU start time + preamble + L-SIG + HT-SIG or SIG-A + Training + SIG-B
-  double noiseInterferenceW = m_firstPowerPerBand.find (band)->second;
-  double powerW = event->GetRxPowerW (band);
+  std::size_t bandId = GetBandId (band);
+  double noiseInterferenceW = m_timelines[bandId].firstPower;
+  double powerW = event->GetRxPowerW (bandId);
   while (++j != ni_it.end ())
     {
       Time current = j->first;
@@ -1073,40 +1498,59 @@ InterferenceHelper::CalculateNonLegacyPhyHeaderSnrPer (Ptr<Event> event, WifiSpe
 void
 InterferenceHelper::EraseEvents (void)
 {
-  for (auto it : m_niChangesPerBand)
+  ResetLazyBands ();
+  for (std::size_t bandId = 0; bandId < m_timelines.size (); ++bandId)
     {
-      it.second.clear ();
-      // Always have a zero power noise event in the list
-      AddNiChangeEvent (Time (0), NiChange (0.0, 0), it.first);
-      m_firstPowerPerBand.at (it.first) = 0.0;
+      if (m_timelines[bandId].tracked)
+        {
+          m_timelines[bandId].niChanges.clear ();
+          // Always have a zero power noise event in the list
+          AddNiChangeEvent (Time (0), NiChange (0.0, 0), bandId);
+          m_timelines[bandId].firstPower = 0.0;
+        }
     }
   m_rxing = false;
 }
 
-InterferenceHelper::NiChanges::iterator
-InterferenceHelper::GetNextPosition (Time moment, WifiSpectrumBand band)
+std::size_t
+InterferenceHelper::GetNextPosition (Time moment, std::size_t bandId) const
 {
-  auto it = m_niChangesPerBand.find (band);
-  NS_ASSERT (it != m_niChangesPerBand.end ());
-  return it->second.upper_bound (moment);
+  const NiChanges &niChanges = m_timelines[bandId].niChanges;
+  return std::upper_bound (niChanges.begin (), niChanges.end (), moment,
+                           [] (Time t, const std::pair<Time, NiChange> &niChange) { return t < niChange.first; })
+         - niChanges.begin ();
 }
 
-InterferenceHelper::NiChanges::iterator
-InterferenceHelper::GetPreviousPosition (Time moment, WifiSpectrumBand band)
+std::size_t
+InterferenceHelper::GetPreviousPosition (Time moment, std::size_t bandId) const
 {
-  auto it = GetNextPosition (moment, band);
+  std::size_t position = GetNextPosition (moment, bandId);
   // This is safe since there is always an NiChange at time 0,
   // before moment.
-  --it;
-  return it;
+  NS_ASSERT (position > 0);
+  return position - 1;
+}
+
+std::size_t
+InterferenceHelper::FindPosition (Time moment, std::size_t bandId) const
+{
+  const NiChanges &niChanges = m_timelines[bandId].niChanges;
+  auto it = std::lower_bound (niChanges.begin (), niChanges.end (), moment,
+                              [] (const std::pair<Time, NiChange> &niChange, Time t) { return niChange.first < t; });
+  if (it == niChanges.end () || it->first != moment)
+    {
+      return niChanges.size ();
+    }
+  return it - niChanges.begin ();
 }
 
-InterferenceHelper::NiChanges::iterator
-InterferenceHelper::AddNiChangeEvent (Time moment, NiChange change, WifiSpectrumBand band)
+std::size_t
+InterferenceHelper::AddNiChangeEvent (Time moment, NiChange change, std::size_t bandId) const
 {
-  auto it = m_niChangesPerBand.find (band);
-  NS_ASSERT (it != m_niChangesPerBand.end ());
-  return it->second.insert (GetNextPosition (moment, band), std::make_pair (moment, change));
+  std::size_t position = GetNextPosition (moment, bandId);
+  NiChanges &niChanges = m_timelines[bandId].niChanges;
+  niChanges.insert (niChanges.begin () + position, std::make_pair (moment, change));
+  return position;
 }
 
 void
@@ -1121,13 +1565,29 @@ InterferenceHelper::NotifyRxEnd (Time endTime)
 {
   NS_LOG_FUNCTION (this << endTime);
   m_rxing = false;
-  //Update m_firstPowerPerBand for frame capture
-  for (auto ni : m_niChangesPerBand)
+  //Update the first power of each band for frame capture
+  for (std::size_t bandId = 0; bandId < m_timelines.size (); ++bandId)
     {
-      auto it = ni.second.find (endTime);
-      it--;
-      m_firstPowerPerBand.find (ni.first)->second = it->second.GetPower ();
+      if (m_timelines[bandId].tracked)
+        {
+          NotifyRxEnd (endTime, bandId);
+        }
     }
+  LazyBandOperation operation;
+  operation.type = NOTIFY_RX_END;
+  operation.rxing = false;
+  operation.isStartOfdmaRxing = false;
+  operation.endTime = endTime;
+  LogLazyBandOperation (operation);
+}
+
+void
+InterferenceHelper::NotifyRxEnd (Time endTime, std::size_t bandId) const
+{
+  BandTimeline &timeline = m_timelines[bandId];
+  std::size_t position = FindPosition (endTime, bandId);
+  NS_ASSERT (position > 0);
+  timeline.firstPower = timeline.niChanges[position - 1].second.GetPower ();
 }
 
 } //namespace ns3
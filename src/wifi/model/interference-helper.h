@@ -34,9 +34,185 @@ class WifiPsdu;
 class ErrorRateModel;
 
 /**
- * A vector of the received power (Watts) for each band
+ * \ingroup wifi
+ * \brief the received power (Watts) for each band
+ *
+ * The power of the bands that are always looked at (i.e. the 20 MHz channel
+ * bands) is provided upfront. The power of any other band (e.g. the HE RU
+ * bands) is only integrated from the received PSD the first time it is
+ * requested, and is then memoized. Copies share the memoized values.
  */
-typedef std::vector <std::pair <WifiSpectrumBand, double> > RxPowerWattPerChannelBand;
+class RxPowerWattPerChannelBand
+{
+public:
+  /**
+   * Const iterator over the bands whose power has been provided upfront
+   */
+  typedef std::vector <std::pair <WifiSpectrumBand, double> >::const_iterator const_iterator;
+
+  RxPowerWattPerChannelBand ();
+
+  /**
+   * Add the received power (W) of a band.
+   *
+   * \param band the band
+   * \param powerW the received power (W) in that band
+   */
+  void Add (WifiSpectrumBand band, double powerW);
+  /**
+   * Add a received PSD from which the power of the bands that have not been
+   * added upfront is computed upon first access. The power of such a band is
+   * the sum of the power integrated from each of the added PSDs.
+   *
+   * \param psd the received power spectral density
+   * \param gain the linear gain to apply to the integrated power
+   */
+  void SetPowerSpectralDensity (Ptr<const SpectrumValue> psd, double gain);
+  /**
+   * \return the received PSDs, along with their linear gain, from which the
+   *         power of the bands that have not been added upfront is computed
+   */
+  const std::vector<std::pair<Ptr<const SpectrumValue>, double> > & GetPowerSpectralDensities (void) const;
+  /**
+   * Return the received power (W) for a given band.
+   *
+   * \param band the band for which the power should be returned
+   * \return the received power (W) for a given band
+   */
+  double GetRxPowerW (WifiSpectrumBand band) const;
+  /**
+   * Add up the received power of another signal to the received power, for each band.
+   *
+   * \param rxPower the received power (W) to add up
+   */
+  void Accumulate (const RxPowerWattPerChannelBand &rxPower);
+  /**
+   * \return the number of bands whose power has been provided upfront
+   */
+  std::size_t GetNBands (void) const;
+  /**
+   * \return a const iterator to the first band whose power has been provided upfront
+   */
+  const_iterator begin (void) const;
+  /**
+   * \return a const iterator past the last band whose power has been provided upfront
+   */
+  const_iterator end (void) const;
+
+
+private:
+  /**
+   * The state needed to compute the power of the other bands on demand
+   */
+  struct LazyRxPower : public SimpleRefCount<LazyRxPower>
+  {
+    std::vector<std::pair<Ptr<const SpectrumValue>, double> > psds; //!< received PSDs along with their linear gain
+    std::map<WifiSpectrumBand, double> rxPowerW;                      //!< memoized received power (W) per band
+  };
+
+  std::vector <std::pair <WifiSpectrumBand, double> > m_rxPowerW; //!< received power (W) of the bands provided upfront
+  Ptr<LazyRxPower> m_lazyRxPower;                                  //!< state to compute the power of the other bands
+};
+
+/**
+ * \ingroup wifi
+ * \brief the dense integer IDs of the bands of a receiver
+ *
+ * Bands are interned upon addition: the ID of a band is the number of bands
+ * added before it. A new index is used whenever the bands of the receiver
+ * are reconfigured, so that the IDs of an index never change.
+ */
+class WifiBandIndex : public SimpleRefCount<WifiBandIndex>
+{
+public:
+  /**
+   * Add a band to the index.
+   *
+   * \param band the band, which must not have been added yet
+   * \return the ID of the band
+   */
+  std::size_t Add (WifiSpectrumBand band);
+  /**
+   * \param band the band, which must have been added
+   * \return the ID of the band
+   */
+  std::size_t GetId (WifiSpectrumBand band) const;
+  /**
+   * \param bandId the ID of the band
+   * \return the band
+   */
+  WifiSpectrumBand GetBand (std::size_t bandId) const;
+  /**
+   * \return the number of bands in the index
+   */
+  std::size_t GetNBands (void) const;
+
+
+private:
+  /**
+   * \param band the band
+   * \return the key of the band in the map of IDs
+   */
+  static uint64_t GetKey (WifiSpectrumBand band);
+
+  std::vector<WifiSpectrumBand> m_bands;          //!< the bands, indexed by ID
+  std::unordered_map<uint64_t, std::size_t> m_ids; //!< the ID of each band, indexed by GetKey
+};
+
+/**
+ * \ingroup wifi
+ * \brief the received power (Watts) of a signal for each band, indexed by band ID
+ *
+ * The bands whose power is provided upfront must be the first bands of the
+ * index, in the same order. The power of the other bands is integrated from
+ * the received PSDs the first time it is requested, and is then memoized in
+ * the same flat array.
+ */
+class RxPowerWattPerBandId : public SimpleRefCount<RxPowerWattPerBandId>
+{
+public:
+  /**
+   * Constructor
+   *
+   * \param rxPower the received power (W) per band
+   * \param bandIndex the index of the bands of the receiver
+   */
+  RxPowerWattPerBandId (const RxPowerWattPerChannelBand &rxPower, Ptr<const WifiBandIndex> bandIndex);
+
+  /**
+   * Return the received power (W) for a given band.
+   *
+   * \param bandId the ID of the band for which the power should be returned
+   * \return the received power (W) for a given band
+   */
+  double GetRxPowerW (std::size_t bandId) const;
+  /**
+   * \return the number of bands whose power has been provided upfront
+   */
+  std::size_t GetNBands (void) const;
+  /**
+   * \return the index of the bands of the receiver
+   */
+  Ptr<const WifiBandIndex> GetBandIndex (void) const;
+  /**
+   * \return the received power (W) per band
+   */
+  RxPowerWattPerChannelBand GetRxPowerWPerBand (void) const;
+  /**
+   * Add up the received power of another signal to the received power, for each band.
+   *
+   * \param rxPower the received power (W) to add up
+   * \return the sum of both received powers
+   */
+  Ptr<RxPowerWattPerBandId> Sum (const RxPowerWattPerBandId &rxPower) const;
+
+
+private:
+  Ptr<const WifiBandIndex> m_bandIndex;                                  //!< the index of the bands
+  std::size_t m_nBands;                                                  //!< the number of bands whose power has been provided upfront
+  mutable std::vector<double> m_rxPowerW;                                //!< received power (W) indexed by band ID, NaN if not computed yet
+  std::vector<std::pair<Ptr<const SpectrumValue>, double> > m_psds;     //!< received PSDs along with their linear gain
+};
 
 /**
  * \ingroup wifi
@@ -54,7 +230,7 @@ public:
    * \param duration duration of the PPDU
    * \param rxPower the received power per band (W)
    */
-  Event (Ptr<const WifiPpdu> ppdu, WifiTxVector txVector, Time duration, RxPowerWattPerChannelBand rxPower);
+  Event (Ptr<const WifiPpdu> ppdu, WifiTxVector txVector, Time duration, Ptr<const RxPowerWattPerBandId> rxPower);
   ~Event ();
 
   /**
@@ -82,7 +258,8 @@ public:
    */
   Time GetDuration (void) const;
   /**
-   * Return the total received power (W).
+   * Return the total received power (W), i.e. the sum over the bands whose
+   * power has been provided upfront.
    *
    * \return the total received power (W)
    */
@@ -94,6 +271,13 @@ public:
    * \return the received power (W) for a given band
    */
   double GetRxPowerW (WifiSpectrumBand band) const;
+  /**
+   * Return the received power (W) for a given band.
+   *
+   * \param bandId the ID of the band for which the power should be returned
+   * \return the received power (W) for a given band
+   */
+  double GetRxPowerW (std::size_t bandId) const;
   /**
    * Return the total received power (W) for given bands.
    *
@@ -107,6 +291,12 @@ public:
    * \return the received power (W) for all bands.
    */
   RxPowerWattPerChannelBand GetRxPowerWPerBand (void) const;
+  /**
+   * Return the received power (W) for all bands, indexed by band ID.
+   *
+   * \return the received power (W) for all bands.
+   */
+  Ptr<const RxPowerWattPerBandId> GetRxPowerWPerBandId (void) const;
   /**
    * Return the TXVECTOR of the PPDU.
    *
@@ -117,9 +307,9 @@ public:
    * Update the received power (W) for all bands, i.e. add up the received power
    * to the current received power, for each band.
    *
-   * \param the received power (W) for all bands.
+   * \param rxPower the received power (W) for all bands.
    */
-  void UpdateRxPowerW (RxPowerWattPerChannelBand rxPower);
+  void UpdateRxPowerW (const RxPowerWattPerBandId &rxPower);
 
 
 private:
@@ -127,7 +317,7 @@ private:
   WifiTxVector m_txVector;              //!< TXVECTOR
   Time m_startTime;                     //!< start time
   Time m_endTime;                       //!< end time
-  RxPowerWattPerChannelBand m_rxPowerW; //!< received power in watts per band
+  Ptr<const RxPowerWattPerBandId> m_rxPowerW; //!< received power in watts per band
 };
 
 /**
@@ -167,8 +357,13 @@ public:
    * Add a frequency band.
    *
    * \param band the band to be created
+   * \param lazy whether the NI changes of the band are only tracked once the band
+   *        is looked at for the first time (e.g. for HE RU bands)
+   *
+   * The bands that are not lazy must be added first, in the order in which
+   * their received power is provided.
    */
-  void AddBand (WifiSpectrumBand band);
+  void AddBand (WifiSpectrumBand band, bool lazy = false);
 
   /**
    * Remove the frequency bands.
@@ -211,6 +406,17 @@ public:
    *          be higher than the requested threshold.
    */
   Time GetEnergyDuration (double energyW, WifiSpectrumBand band);
+  /**
+   * Equivalent to calling GetEnergyDuration for each of the given energies,
+   * but with a single walk of the band timeline.
+   *
+   * \param energiesW the minimum energies (W) requested, sorted in decreasing order
+   * \param band identify the requested band
+   *
+   * \returns the expected amount of time the observed energy on the medium
+   *          for a given band will be higher than each of the requested thresholds.
+   */
+  std::vector<Time> GetEnergyDurations (const std::vector<double> &energiesW, WifiSpectrumBand band);
 
   /**
    * Add the PPDU-related signal to interference helper.
@@ -363,15 +569,52 @@ private:
   };
 
   /**
-   * typedef for a multimap of NiChange
+   * Vector of NiChange sorted by time, NiChanges occurring at the same time
+   * being kept in insertion order
    */
-  typedef std::multimap<Time, NiChange> NiChanges;
+  typedef std::vector<std::pair<Time, NiChange> > NiChanges;
 
   /**
    * Map of NiChanges per band
    */
   typedef std::map <WifiSpectrumBand, NiChanges> NiChangesPerBand;
 
+  /**
+   * The NI changes timeline of a band
+   */
+  struct BandTimeline
+  {
+    WifiSpectrumBand band; //!< the band
+    NiChanges niChanges;   //!< the NI changes of the band
+    double firstPower;     //!< first power of the band
+    bool lazy;             //!< whether the NI changes are only tracked once the band is looked at
+    bool tracked;          //!< whether the NI changes are currently tracked
+  };
+
+  /**
+   * Type of the operations to replay on a lazy band
+   */
+  enum LazyBandOperationType
+  {
+    APPEND_EVENT,
+    UPDATE_EVENT,
+    NOTIFY_RX_END
+  };
+
+  /**
+   * An operation applied to the tracked bands, which has to be replayed
+   * on a lazy band when it is looked at for the first time.
+   */
+  struct LazyBandOperation
+  {
+    LazyBandOperationType type;              //!< the type of operation
+    Ptr<Event> event;                        //!< the appended or updated event
+    Ptr<const RxPowerWattPerBandId> rxPower; //!< the received power (W) per band appended or added up
+    bool rxing;                              //!< the receiving state when the event was appended
+    bool isStartOfdmaRxing;                  //!< whether the appended event corresponds to the start of the OFDMA payload reception
+    Time endTime;                            //!< the end time of the reception that ended
+  };
+
   /**
    * Append the given Event.
    *
@@ -379,6 +622,63 @@ private:
    * \param isStartOfdmaRxing flag whether event corresponds to the start of the OFDMA payload reception (only used for UL-OFDMA)
    */
   void AppendEvent (Ptr<Event> event, bool isStartOfdmaRxing);
+  /**
+   * Append the given Event to the NI changes of a given band.
+   *
+   * \param event the event to be appended
+   * \param powerW the received power (W) of the event in the band
+   * \param bandId the ID of the band
+   * \param rxing the receiving state when the event is appended
+   * \param isStartOfdmaRxing flag whether event corresponds to the start of the OFDMA payload reception (only used for UL-OFDMA)
+   */
+  void AppendEvent (Ptr<Event> event, double powerW, std::size_t bandId, bool rxing, bool isStartOfdmaRxing) const;
+  /**
+   * Add up power to the NI changes of a given band during a given event.
+   *
+   * \param event the event to be updated
+   * \param powerW the received power (W) to be added in the band
+   * \param bandId the ID of the band
+   */
+  void UpdateEvent (Ptr<const Event> event, double powerW, std::size_t bandId) const;
+  /**
+   * Update the first power of a given band upon the end of a reception.
+   *
+   * \param endTime the end time of the signal
+   * \param bandId the ID of the band
+   */
+  void NotifyRxEnd (Time endTime, std::size_t bandId) const;
+  /**
+   * Start tracking the NI changes of a lazy band, if not done yet, by replaying
+   * the operations logged since the lazy bands were last reset.
+   *
+   * \param bandId the ID of the band that is looked at
+   */
+  void MaterializeBand (std::size_t bandId) const;
+  /**
+   * Return the ID of a band, i.e. its index in the vector of timelines.
+   *
+   * \param band the band
+   * \return the ID of the band
+   */
+  std::size_t GetBandId (WifiSpectrumBand band) const;
+  /**
+   * Log an operation to be replayed on the lazy bands that are not tracked yet.
+   *
+   * \param operation the operation
+   */
+  void LogLazyBandOperation (const LazyBandOperation &operation);
+  /**
+   * Stop tracking the NI changes of the lazy bands and clear the operation log.
+   */
+  void ResetLazyBands (void);
+  /**
+   * Drop the logged operations that no longer matter once an event starting at
+   * the given time is appended while not receiving, since the NI changes of the
+   * events that are over by then are erased.
+   *
+   * \param start the start time of the appended event
+   */
+  void TrimLazyBandOperations (Time start);
 
   /**
    * Calculate noise and interference power in W.
@@ -489,37 +789,55 @@ private:
   double m_noiseFigure;                                    //!< noise figure (linear)
   Ptr<ErrorRateModel> m_errorRateModel;                    //!< error rate model
   uint8_t m_numRxAntennas;                                 //!< the number of RX antennas in the corresponding receiver
-  NiChangesPerBand m_niChangesPerBand;                     //!< NI Changes for each band
-  std::map <WifiSpectrumBand, double> m_firstPowerPerBand; //!< first power of each band
+  /**
+   * NI changes timeline of each band, indexed by band ID. The timeline of a
+   * lazy band is a memo built when the band is first looked at, possibly by a
+   * const method, hence the timelines are mutable.
+   */
+  mutable std::vector<BandTimeline> m_timelines;
+  Ptr<WifiBandIndex> m_bandIndex;                          //!< ID of each band
   bool m_rxing;                                            //!< flag whether it is in receiving state
+  std::size_t m_nLazyBands;                                //!< number of bands whose NI changes are only tracked once looked at
+  mutable std::vector<std::size_t> m_trackedLazyBandIds;   //!< IDs of the lazy bands whose NI changes are currently tracked
+  std::vector<LazyBandOperation> m_lazyBandOperations;     //!< operations to replay on the lazy bands that are not tracked yet
+  Time m_lazyBandOperationsEnd;                            //!< latest end time of the events appended since the lazy bands were reset
 
   /**
-   * Returns an iterator to the first nichange that is later than moment
+   * Returns the position of the first nichange that is later than moment
    *
    * \param moment time to check from
-   * \param band identify the band to check
-   * \returns an iterator to the list of NiChanges
+   * \param bandId identify the band to check
+   * \returns the position in the NiChanges of the band
    */
-  NiChanges::iterator GetNextPosition (Time moment, WifiSpectrumBand band);
+  std::size_t GetNextPosition (Time moment, std::size_t bandId) const;
   /**
-   * Returns an iterator to the last nichange that is before than moment
+   * Returns the position of the last nichange that is before than moment
    *
    * \param moment time to check from
-   * \param band identify the band to check
-   * \returns an iterator to the list of NiChanges
+   * \param bandId identify the band to check
+   * \returns the position in the NiChanges of the band
    */
-  NiChanges::iterator GetPreviousPosition (Time moment, WifiSpectrumBand band);
+  std::size_t GetPreviousPosition (Time moment, std::size_t bandId) const;
+  /**
+   * Returns the position of the first nichange that occurs at moment
+   *
+   * \param moment time to look for
+   * \param bandId identify the band to check
+   * \returns the position in the NiChanges of the band, or the number of
+   *          NiChanges if there is none at moment
+   */
+  std::size_t FindPosition (Time moment, std::size_t bandId) const;
 
   /**
    * Add NiChange to the list at the appropriate position and
-   * return the iterator of the new event.
+   * return the position of the new event.
    *
    * \param moment
    * \param change
-   * \param band
-   * \returns the iterator of the new event
+   * \param bandId
+   * \returns the position of the new event
    */
-  NiChanges::iterator AddNiChangeEvent (Time moment, NiChange change, WifiSpectrumBand band);
+  std::size_t AddNiChangeEvent (Time moment, NiChange change, std::size_t bandId) const;
 };
 
 } //namespace ns3
@@ -21,7 +21,6 @@
  *          Stefano Avallone <stavallo@unina.it>
  */
 
-#include <numeric>
 #include "ns3/simulator.h"
 #include "ns3/log.h"
 #include "ns3/pointer.h"
@@ -45,8 +44,9 @@
 #include "ap-wifi-mac.h"
 #include "sta-wifi-mac.h"
 #include <algorithm>
+#include <limits>
 #include "wifi-ack-policy-selector.h"
-#include "dynamic-threshold-channel-bonding-manager.h"
+#include "channel-bonding-manager.h"
 
 #undef NS_LOG_APPEND_CONTEXT
 #define NS_LOG_APPEND_CONTEXT std::clog << "[mac=" << m_self << "] "
@@ -133,7 +133,8 @@ MacLow::MacLow ()
     m_promisc (false),
     m_phyMacLowListener (0),
     m_ctsToSelfSupported (false),
-    m_cfAckInfo ()
+    m_cfAckInfo (),
+    m_psduSizeBoundary ({0, 0, Seconds (0), 0, 0, 0})
 {
   NS_LOG_FUNCTION (this);
 }
@@ -709,10 +710,15 @@ MacLow::IsWithinSizeAndTimeLimits (uint32_t mpduSize, Mac48Address receiver, uin
   // Get the maximum PPDU Duration based on the preamble type
   Time maxPpduDuration = GetPpduMaxTime (txVector.GetPreambleType ());
 
-  Time txTime = m_phy->CalculateTxDuration (ppduPayloadSize, txVector, m_phy->GetFrequency ());
+  // the PPDU duration is bounded by the smallest strictly positive limit, if any
+  Time durationLimit = maxPpduDuration;
+  if (ppduDurationLimit.IsStrictlyPositive ()
+      && (!durationLimit.IsStrictlyPositive () || ppduDurationLimit < durationLimit))
+    {
+      durationLimit = ppduDurationLimit;
+    }
 
-  if ((ppduDurationLimit.IsStrictlyPositive () && txTime > ppduDurationLimit)
-      || (maxPpduDuration.IsStrictlyPositive () && txTime > maxPpduDuration))
+  if (durationLimit.IsStrictlyPositive () && !IsWithinTimeLimit (ppduPayloadSize, txVector, durationLimit))
     {
       NS_LOG_DEBUG ("the frame does not meet the constraint on max PPDU duration");
       return false;
@@ -721,6 +727,83 @@ MacLow::IsWithinSizeAndTimeLimits (uint32_t mpduSize, Mac48Address receiver, uin
   return true;
 }
 
+uint64_t
+MacLow::GetTxVectorKey (WifiTxVector txVector)
+{
+  return (static_cast<uint64_t> (txVector.GetMode ().GetUid ()) << 48)
+         | (static_cast<uint64_t> (txVector.GetPreambleType ()) << 40)
+         | (static_cast<uint64_t> (txVector.GetChannelWidth ()) << 24)
+         | (static_cast<uint64_t> (txVector.GetGuardInterval ()) << 8)
+         | (static_cast<uint64_t> (txVector.GetNss ()) << 4)
+         | (static_cast<uint64_t> (txVector.GetNess ()) << 1)
+         | (txVector.IsStbc () ? 1 : 0);
+}
+
+bool
+MacLow::IsWithinTimeLimit (uint32_t psduSize, WifiTxVector txVector, Time durationLimit)
+{
+  NS_LOG_FUNCTION (this << psduSize << txVector << durationLimit);
+  NS_ASSERT (durationLimit.IsStrictlyPositive ());
+
+  uint16_t frequency = m_phy->GetFrequency ();
+  if (txVector.IsMu ())
+    {
+      return m_phy->CalculateTxDuration (psduSize, txVector, frequency) <= durationLimit;
+    }
+
+  PsduSizeBoundary &boundary = m_psduSizeBoundary;
+  uint64_t txVectorKey = GetTxVectorKey (txVector);
+  if (boundary.txVectorKey != txVectorKey || boundary.frequency != frequency
+      || boundary.durationLimit != durationLimit)
+    {
+      boundary.txVectorKey = txVectorKey;
+      boundary.frequency = frequency;
+      boundary.durationLimit = durationLimit;
+      boundary.maxFitting = 0;
+      boundary.minExceeding = std::numeric_limits<uint32_t>::max ();
+      boundary.nComputations = 0;
+    }
+
+  if (psduSize > boundary.maxFitting && psduSize < boundary.minExceeding)
+    {
+      UpdatePsduSizeBoundary (psduSize, txVector);
+      if (boundary.nComputations >= 2)
+        {
+          // the limit is being queried repeatedly: the transmission time does
+          // not decrease with the PSDU size, hence search the largest PSDU
+          // size meeting the limit, first by doubling and then by bisection
+          const uint32_t maxPsduSize = 1 << 26;
+          while (boundary.minExceeding == std::numeric_limits<uint32_t>::max ()
+                 && boundary.maxFitting < maxPsduSize)
+            {
+              UpdatePsduSizeBoundary (std::max<uint32_t> (2 * boundary.maxFitting, 1), txVector);
+            }
+          while (boundary.minExceeding - boundary.maxFitting > 1
+                 && boundary.minExceeding != std::numeric_limits<uint32_t>::max ())
+            {
+              UpdatePsduSizeBoundary (boundary.maxFitting + (boundary.minExceeding - boundary.maxFitting) / 2,
+                                      txVector);
+            }
+        }
+    }
+  return (psduSize <= boundary.maxFitting);
+}
+
+void
+MacLow::UpdatePsduSizeBoundary (uint32_t psduSize, WifiTxVector txVector)
+{
+  PsduSizeBoundary &boundary = m_psduSizeBoundary;
+  boundary.nComputations++;
+  if (m_phy->CalculateTxDuration (psduSize, txVector, boundary.frequency) <= boundary.durationLimit)
+    {
+      boundary.maxFitting = std::max (boundary.maxFitting, psduSize);
+    }
+  else
+    {
+      boundary.minExceeding = std::min (boundary.minExceeding, psduSize);
+    }
+}
+
 void
 MacLow::RxStartIndication (WifiTxVector txVector, Time psduDuration)
 {
@@ -1157,28 +1240,11 @@ MacLow::ReceiveOk (Ptr<WifiMacQueueItem> mpdu, RxSignalInfo rxSignalInfo, WifiTx
               NS_LOG_DEBUG ("rx group from=" << hdr.GetAddr2 ());
               if (hdr.IsBeacon ())
                 {
-                  PointerValue ptr;
-                  m_phy->GetAttribute ("ChannelBondingManager", ptr);
-                  Ptr<DynamicThresholdChannelBondingManager> bondingManager = DynamicCast <DynamicThresholdChannelBondingManager> (ptr.Get<DynamicThresholdChannelBondingManager> ());
+                  Ptr<ChannelBondingManager> bondingManager = m_phy->GetChannelBondingManager ();
                   Ptr<StaWifiMac> staMac = DynamicCast<StaWifiMac> (m_mac);
-                  //Update threshold for DT-DCB
                   if (bondingManager != 0 && staMac != 0 && staMac->IsAssociated ())
                     {
-                      double rxRssi = rxSignalInfo.rssi;
-                      rxBeaconRssiList.push_back (rxRssi);
-                      if (rxBeaconRssiList.size () > 0)
-                        {
-                          rxBeaconRssiList.pop_front ();
-                          double averageRxRssi = (static_cast<double> (std::accumulate (rxBeaconRssiList.begin (), rxBeaconRssiList.end(), 0)) / rxBeaconRssiList.size ());
-                          double reqSinrPerMcs[12] = {0.7, 3.7, 6.2, 9.3, 12.6, 16.8, 18.2, 19.4, 23.5, 30, 35, 40};
-                          for (uint8_t i = 0; i < m_phy->GetNMcs (); i++)
-                            {
-                              WifiMode mode = m_phy->GetMcs (i);
-                              uint8_t mcs = mode.GetMcsValue ();
-                              double dcbThreshold = averageRxRssi - reqSinrPerMcs[mcs];
-                              bondingManager->SetCcaEdThresholdSecondaryForMode (mode, dcbThreshold);
-                            }
-                        }
+                      bondingManager->NotifyBeaconRssi (rxSignalInfo.rssi);
                     }
                   // Apply SNR tag for beacon quality measurements
                   SnrTag tag;
@@ -627,6 +627,33 @@ private:
    * \return control answer mode
    */
   WifiMode GetControlAnswerMode (WifiMode reqMode) const;
+  /**
+   * Check whether the transmission time of a PSDU of the given size does not
+   * exceed the given PPDU duration limit. When queried again with the same
+   * TXVECTOR and limit (e.g., while building an A-MSDU or an A-MPDU), the
+   * largest PSDU size meeting the limit is searched and cached, so that the
+   * subsequent queries do not compute any transmission time.
+   *
+   * \param psduSize the PSDU size
+   * \param txVector the TX vector used to transmit the PSDU
+   * \param durationLimit the (strictly positive) limit on the PPDU duration
+   * \return true if the transmission time does not exceed the limit
+   */
+  bool IsWithinTimeLimit (uint32_t psduSize, WifiTxVector txVector, Time durationLimit);
+  /**
+   * Update the boundary between the PSDU sizes meeting and exceeding the
+   * current PPDU duration limit with the transmission time of a PSDU.
+   *
+   * \param psduSize the PSDU size
+   * \param txVector the TX vector used to transmit the PSDU
+   */
+  void UpdatePsduSizeBoundary (uint32_t psduSize, WifiTxVector txVector);
+  /**
+   * \param txVector a non-MU TX vector
+   * \return a key identifying the parameters of the TX vector that determine
+   *         the transmission time of a PSDU
+   */
+  static uint64_t GetTxVectorKey (WifiTxVector txVector);
   /**
    * Return the time required to transmit the CTS (including preamble and FCS).
    *
@@ -1014,7 +1041,17 @@ private:
 
   CfAckInfo m_cfAckInfo; //!< Info about piggyback ACKs used in PCF
 
-  std::list<double> rxBeaconRssiList; //!< Hold list of RSSIs of the received beacons (only used for dynamic threshold - dynamic channel bonding)
+  /// The PSDU sizes known to meet or exceed a PPDU duration limit
+  struct PsduSizeBoundary
+  {
+    uint64_t txVectorKey;   //!< the key of the TX vector (see GetTxVectorKey)
+    uint16_t frequency;     //!< the operating frequency (MHz)
+    Time durationLimit;     //!< the PPDU duration limit
+    uint32_t maxFitting;    //!< the largest size known to meet the limit
+    uint32_t minExceeding;  //!< the smallest size known to exceed the limit
+    uint8_t nComputations;  //!< the number of transmission times computed for the limit
+  };
+  PsduSizeBoundary m_psduSizeBoundary; //!< the boundary for the latest TX vector and PPDU duration limit
 };
 
 } //namespace ns3
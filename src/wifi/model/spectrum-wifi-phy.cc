@@ -78,6 +78,8 @@ SpectrumWifiPhy::GetTypeId (void)
 }
 
 SpectrumWifiPhy::SpectrumWifiPhy ()
+  : m_filterBankChannelWidth (0),
+    m_filterBankStandard (WIFI_PHY_STANDARD_UNSPECIFIED)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -132,6 +134,7 @@ SpectrumWifiPhy::GetRxSpectrumModel ()
           uint16_t channelWidth = GetChannelWidth ();
           NS_LOG_DEBUG ("Creating spectrum model from frequency/width pair of (" << GetFrequency () << ", " << channelWidth << ")");
           m_rxSpectrumModel = WifiSpectrumValueHelper::GetSpectrumModel (GetFrequency (), channelWidth, GetBandBandwidth (), GetGuardBandwidth (channelWidth));
+          UpdateRfFilterBank ();
           UpdateInterferenceHelperBands ();
         }
     }
@@ -142,19 +145,36 @@ void
 SpectrumWifiPhy::UpdateInterferenceHelperBands (void)
 {
   NS_LOG_FUNCTION (this);
-  uint16_t channelWidth = GetChannelWidth ();
   m_interference.RemoveBands ();
-  if (channelWidth < 20)
+  for (auto const& band : m_channelFilterBands)
     {
-      WifiSpectrumBand band = GetBand (channelWidth);
       m_interference.AddBand (band);
     }
+  for (auto const& band : m_ruFilterBands)
+    {
+      //the power of RU bands is only looked at upon OFDMA receptions
+      m_interference.AddBand (band, true);
+    }
+}
+
+void
+SpectrumWifiPhy::UpdateRfFilterBank (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint16_t channelWidth = GetChannelWidth ();
+  m_filterBankChannelWidth = channelWidth;
+  m_filterBankStandard = GetStandard ();
+  m_channelFilterBands.clear ();
+  m_ruFilterBands.clear ();
+  if (channelWidth < 20)
+    {
+      m_channelFilterBands.push_back (GetBand (channelWidth));
+    }
   else
     {
       for (uint8_t i = 0; i < (channelWidth / 20); i++)
         {
-          WifiSpectrumBand band = GetBand (20, i);
-          m_interference.AddBand (band);
+          m_channelFilterBands.push_back (GetBand (20, i));
         }
     }
   if ((GetStandard () == WIFI_PHY_STANDARD_80211ax_2_4GHZ) || (GetStandard () == WIFI_PHY_STANDARD_80211ax_5GHZ))
@@ -166,11 +186,12 @@ SpectrumWifiPhy::UpdateInterferenceHelperBands (void)
             {
               HeRu::SubcarrierGroup group = HeRu::GetSubcarrierGroup (channelWidth, ruType, index);
               HeRu::SubcarrierRange range = std::make_pair (group.front ().first, group.back ().second);
-              WifiSpectrumBand band = ConvertHeRuSubcarriers (channelWidth, range);
-              m_interference.AddBand (band);
+              m_ruFilterBands.push_back (ConvertHeRuSubcarriers (channelWidth, range));
             }
         }
     }
+  NS_LOG_DEBUG ("RF filter bank for frequency/width pair of (" << GetFrequency () << ", " << channelWidth << ") has "
+                << m_channelFilterBands.size () << " channel bands and " << m_ruFilterBands.size () << " RU bands");
 }
 
 Ptr<Channel>
@@ -196,6 +217,7 @@ SpectrumWifiPhy::ResetSpectrumModel (void)
   // on the SpectrumChannel to provide this new spectrum model to it
   m_rxSpectrumModel = WifiSpectrumValueHelper::GetSpectrumModel (GetFrequency (), channelWidth, GetBandBandwidth (), GetGuardBandwidth (channelWidth));
   m_channel->AddRx (m_wifiSpectrumPhyInterface);
+  UpdateRfFilterBank ();
   UpdateInterferenceHelperBands ();
 }
 
@@ -249,67 +271,45 @@ SpectrumWifiPhy::StartRx (Ptr<SpectrumSignalParameters> rxParams)
   NS_LOG_FUNCTION (this << rxParams);
   Time rxDuration = rxParams->duration;
   Ptr<SpectrumValue> receivedSignalPsd = rxParams->psd;
-  NS_LOG_DEBUG ("Received signal with PSD " << *receivedSignalPsd << " and duration " << rxDuration.As (Time::NS));
+  // the PSD may be shared with other receivers: it is never modified and the
+  // path gain conveyed separately is applied along with the receive gain
+  double psdGain = rxParams->psdGain;
+  NS_LOG_DEBUG ("Received signal with PSD " << *receivedSignalPsd << " (gain " << psdGain << ") and duration " << rxDuration.As (Time::NS));
   uint32_t senderNodeId = 0;
   if (rxParams->txPhy && rxParams->txPhy->GetDevice ())
     {
       senderNodeId = rxParams->txPhy->GetDevice ()->GetNode ()->GetId ();
     }
-  NS_LOG_DEBUG ("Received signal from " << senderNodeId << " with unfiltered power " << WToDbm (Integral (*receivedSignalPsd)) << " dBm");
+  NS_LOG_DEBUG ("Received signal from " << senderNodeId << " with unfiltered power " << WToDbm (Integral (*receivedSignalPsd) * psdGain) << " dBm");
 
   // Integrate over our receive bandwidth (i.e., all that the receive
   // spectral mask representing our filtering allows) to find the
   // total energy apparent to the "demodulator".
-  // This is done per 20 MHz channel band.
-  uint16_t channelWidth = GetChannelWidth ();
+  // This is done per 20 MHz channel band, using the RF filter bank that is
+  // only rebuilt when the receive spectrum model changes.
+  GetRxSpectrumModel (); //builds the RF filter bank upon first reception
+  if ((m_filterBankChannelWidth != GetChannelWidth ()) || (m_filterBankStandard != GetStandard ()))
+    {
+      //the PHY may be reconfigured before it is initialized, in which case the bank has not been rebuilt yet
+      UpdateRfFilterBank ();
+    }
+  double rxGainRatio = DbToRatio (GetRxGain ()) * psdGain;
   double totalRxPowerW = 0;
   RxPowerWattPerChannelBand rxPowerW;
 
-  // Since we are using an unordered_map, the order the power is inserted should be respected
-  // (i.e. legacy band followed by 11n/ac/ax 20 MHz bands followed by 802.11ax RU bands).
+  // The order the power is inserted should be respected (i.e. legacy band followed by 11n/ac/ax 20 MHz bands).
   // This way, we can compute the total RX power by doing a sum over the bands, starting from the first one.
-  if ((channelWidth == 5) || (channelWidth == 10))
-    {
-      WifiSpectrumBand filteredBand = GetBand (channelWidth);
-      Ptr<SpectrumValue> filter = WifiSpectrumValueHelper::CreateRfFilter (GetFrequency (), channelWidth, GetBandBandwidth (), GetGuardBandwidth (channelWidth), filteredBand);
-      SpectrumValue filteredSignal = (*filter) * (*receivedSignalPsd);
-      NS_LOG_DEBUG ("Signal power received (watts) before antenna gain: " << Integral (filteredSignal));
-      double rxPowerPerBandW = Integral (filteredSignal) * DbToRatio (GetRxGain ());
-      totalRxPowerW += rxPowerPerBandW;
-      rxPowerW.push_back (std::make_pair (filteredBand, rxPowerPerBandW));
-      NS_LOG_DEBUG ("Signal power received after antenna gain for " << channelWidth << " MHz channel: " << rxPowerPerBandW << " W (" << WToDbm (rxPowerPerBandW) << " dBm)");
-    }
-
-  for (uint8_t i = 0; i < (channelWidth / 20); i++)
+  for (auto const& band : m_channelFilterBands)
     {
-      WifiSpectrumBand filteredBand = GetBand (20, i);
-      Ptr<SpectrumValue> filter = WifiSpectrumValueHelper::CreateRfFilter (GetFrequency (), channelWidth, GetBandBandwidth (), GetGuardBandwidth (channelWidth), filteredBand);
-      SpectrumValue filteredSignal = (*filter) * (*receivedSignalPsd);
-      NS_LOG_DEBUG ("Signal power received (watts) before antenna gain for 20 MHz channel band " << +i << ": " << Integral (filteredSignal));
-      double rxPowerPerBandW = Integral (filteredSignal) * DbToRatio (GetRxGain ());
+      double rxPowerPerBandW = WifiSpectrumValueHelper::GetBandPowerW (receivedSignalPsd, band) * rxGainRatio;
       totalRxPowerW += rxPowerPerBandW;
-      rxPowerW.push_back (std::make_pair (filteredBand, rxPowerPerBandW));
-      NS_LOG_DEBUG ("Signal power received after antenna gain for 20 MHz channel band " << +i << ": " << rxPowerPerBandW << " W (" << WToDbm (rxPowerPerBandW) << " dBm)");
+      rxPowerW.Add (band, rxPowerPerBandW);
+      NS_LOG_DEBUG ("Signal power received after antenna gain for channel band (" << band.first << "; " << band.second << "): " << rxPowerPerBandW << " W (" << WToDbm (rxPowerPerBandW) << " dBm)");
     }
-  
-  if ((GetStandard () == WIFI_PHY_STANDARD_80211ax_2_4GHZ) || (GetStandard () == WIFI_PHY_STANDARD_80211ax_5GHZ))
+  if (!m_ruFilterBands.empty ())
     {
-      for (unsigned int type = 0; type < 7; type++)
-        {
-          HeRu::RuType ruType = static_cast <HeRu::RuType> (type);
-          for (std::size_t index = 1; index <= HeRu::GetNRus (channelWidth, ruType); index++)
-            {
-              HeRu::SubcarrierGroup group = HeRu::GetSubcarrierGroup (channelWidth, ruType, index);
-              HeRu::SubcarrierRange range = std::make_pair (group.front ().first, group.back ().second);
-              WifiSpectrumBand band = ConvertHeRuSubcarriers (channelWidth, range);
-              Ptr<SpectrumValue> filter = WifiSpectrumValueHelper::CreateRfFilter (GetFrequency (), channelWidth, GetBandBandwidth (), GetGuardBandwidth (channelWidth), band);
-              SpectrumValue filteredSignal = (*filter) * (*receivedSignalPsd);
-              NS_LOG_DEBUG ("Signal power received (watts) before antenna gain for RU with type " << ruType << " and range (" << range.first << "; " << range.second << ") -> (" << band.first << "; " << band.second <<  "): " << Integral (filteredSignal));
-              double rxPowerPerBandW = Integral (filteredSignal) * DbToRatio (GetRxGain ());
-              NS_LOG_DEBUG ("Signal power received after antenna gain for RU with type " << ruType << " and range (" << range.first << "; " << range.second << ") -> (" << band.first << "; " << band.second <<  "): " << rxPowerPerBandW << " W (" << WToDbm (rxPowerPerBandW) << " dBm)");
-              rxPowerW.push_back (std::make_pair (band, rxPowerPerBandW));
-            }
-        }
+      // The power of the 802.11ax RU bands is only integrated if an OFDMA reception looks at it
+      rxPowerW.SetPowerSpectralDensity (receivedSignalPsd, rxGainRatio);
     }
 
   NS_LOG_DEBUG ("Total signal power received after antenna gain: " << totalRxPowerW << " W (" << WToDbm (totalRxPowerW) << " dBm)");
@@ -342,7 +342,8 @@ SpectrumWifiPhy::StartRx (Ptr<SpectrumSignalParameters> rxParams)
     }
 
   NS_LOG_INFO ("Received Wi-Fi signal");
-  Ptr<WifiPpdu> ppdu = Copy (wifiRxParams->ppdu);
+  // the PPDU is not modified upon reception, hence it is shared by all the receivers
+  Ptr<const WifiPpdu> ppdu = wifiRxParams->ppdu;
   if ((ppdu->GetTxVector ().GetPreambleType () == WIFI_PREAMBLE_HE_TB))
     {
       bool isOfdma = (rxDuration == (ppdu->GetTxDuration () - CalculatePlcpPreambleAndHeaderDuration (ppdu->GetTxVector ())));
@@ -407,7 +408,7 @@ SpectrumWifiPhy::GetTxPowerSpectralDensity (double txPowerW, Ptr<WifiPpdu> ppdu,
   uint16_t centerFrequency = GetCenterFrequencyForChannelWidth (txVector.GetChannelWidth ());
   uint16_t channelWidth = txVector.GetChannelWidth ();
   NS_LOG_FUNCTION (centerFrequency << channelWidth << txPowerW);
-  Ptr<SpectrumValue> v;
+  Ptr<const SpectrumValue> v;
   switch (ppdu->GetModulation ())
     {
     case WIFI_MOD_CLASS_OFDM:
@@ -415,39 +416,42 @@ SpectrumWifiPhy::GetTxPowerSpectralDensity (double txPowerW, Ptr<WifiPpdu> ppdu,
       if (channelWidth >= 40)
         {
             NS_LOG_INFO ("non-HT duplicate");
-            v = WifiSpectrumValueHelper::CreateHtOfdmTxPowerSpectralDensity (centerFrequency, channelWidth, txPowerW, GetGuardBandwidth (channelWidth), m_txMaskInnerBandMinimumRejection, m_txMaskOuterBandMinimumRejection, m_txMaskOuterBandMaximumRejection);
+            v = WifiSpectrumValueHelper::GetTxPowerSpectralDensity (WifiSpectrumValueHelper::TX_PSD_HT_OFDM, centerFrequency, channelWidth, txPowerW, GetGuardBandwidth (channelWidth), m_txMaskInnerBandMinimumRejection, m_txMaskOuterBandMinimumRejection, m_txMaskOuterBandMaximumRejection);
             //TODO: Create a CreateDuplicateOfdmTxPowerSpectralDensity function?
         }
       else
         {
-            v = WifiSpectrumValueHelper::CreateOfdmTxPowerSpectralDensity (centerFrequency, channelWidth, txPowerW, GetGuardBandwidth (channelWidth), m_txMaskInnerBandMinimumRejection, m_txMaskOuterBandMinimumRejection, m_txMaskOuterBandMaximumRejection);
+            v = WifiSpectrumValueHelper::GetTxPowerSpectralDensity (WifiSpectrumValueHelper::TX_PSD_OFDM, centerFrequency, channelWidth, txPowerW, GetGuardBandwidth (channelWidth), m_txMaskInnerBandMinimumRejection, m_txMaskOuterBandMinimumRejection, m_txMaskOuterBandMaximumRejection);
         }
       break;
     case WIFI_MOD_CLASS_DSSS:
     case WIFI_MOD_CLASS_HR_DSSS:
       NS_ABORT_MSG_IF (channelWidth != 22, "Invalid channel width for DSSS");
-      v = WifiSpectrumValueHelper::CreateDsssTxPowerSpectralDensity (centerFrequency, txPowerW, GetGuardBandwidth (channelWidth));
+      v = WifiSpectrumValueHelper::GetTxPowerSpectralDensity (WifiSpectrumValueHelper::TX_PSD_DSSS, centerFrequency, channelWidth, txPowerW, GetGuardBandwidth (channelWidth));
       break;
     case WIFI_MOD_CLASS_HT:
     case WIFI_MOD_CLASS_VHT:
-      v = WifiSpectrumValueHelper::CreateHtOfdmTxPowerSpectralDensity (centerFrequency, channelWidth, txPowerW, GetGuardBandwidth (channelWidth), m_txMaskInnerBandMinimumRejection, m_txMaskOuterBandMinimumRejection, m_txMaskOuterBandMaximumRejection);
+      v = WifiSpectrumValueHelper::GetTxPowerSpectralDensity (WifiSpectrumValueHelper::TX_PSD_HT_OFDM, centerFrequency, channelWidth, txPowerW, GetGuardBandwidth (channelWidth), m_txMaskInnerBandMinimumRejection, m_txMaskOuterBandMinimumRejection, m_txMaskOuterBandMaximumRejection);
       break;
     case WIFI_MOD_CLASS_HE:
       if (isOfdma)
         {
           WifiSpectrumBand band = GetRuBand (txVector, GetStaId (ppdu));
-          v = WifiSpectrumValueHelper::CreateHeMuOfdmTxPowerSpectralDensity (centerFrequency, channelWidth, txPowerW, GetGuardBandwidth (channelWidth), band);
+          v = WifiSpectrumValueHelper::GetTxPowerSpectralDensity (WifiSpectrumValueHelper::TX_PSD_HE_MU_OFDM, centerFrequency, channelWidth, txPowerW, GetGuardBandwidth (channelWidth),
+                                                                 m_txMaskInnerBandMinimumRejection, m_txMaskOuterBandMinimumRejection, m_txMaskOuterBandMaximumRejection, band);
         }
       else
         {
-          v = WifiSpectrumValueHelper::CreateHeOfdmTxPowerSpectralDensity (centerFrequency, channelWidth, txPowerW, GetGuardBandwidth (channelWidth), m_txMaskInnerBandMinimumRejection, m_txMaskOuterBandMinimumRejection, m_txMaskOuterBandMaximumRejection);
+          v = WifiSpectrumValueHelper::GetTxPowerSpectralDensity (WifiSpectrumValueHelper::TX_PSD_HE_OFDM, centerFrequency, channelWidth, txPowerW, GetGuardBandwidth (channelWidth), m_txMaskInnerBandMinimumRejection, m_txMaskOuterBandMinimumRejection, m_txMaskOuterBandMaximumRejection);
         }
       break;
     default:
       NS_FATAL_ERROR ("modulation class unknown");
       break;
     }
-  return v;
+  // the PSD is shared with other transmissions: this is safe since channels
+  // copy the transmitted PSD before applying any gain to it
+  return ConstCast<SpectrumValue> (v);
 }
 
 void
@@ -188,7 +188,16 @@ protected:
    */
   void UpdateInterferenceHelperBands (void);
 
+  /**
+   * This function is called to rebuild the RF filter bank, i.e. the receive bands
+   * over which the received power is integrated, whenever the receive spectrum
+   * model changes.
+   */
+  void UpdateRfFilterBank (void);
+
   mutable Ptr<const SpectrumModel> m_rxSpectrumModel;       //!< receive spectrum model
+  WifiSpectrumBands m_channelFilterBands;                   //!< RF filter bank for the 20 MHz bands (or the whole channel if narrower than 20 MHz)
+  WifiSpectrumBands m_ruFilterBands;                        //!< RF filter bank for the HE RU bands (only for 802.11ax)
 
 
 private:
@@ -199,7 +208,9 @@ private:
    * \return Ptr to SpectrumValue
    *
    * This is a helper function to create the right Tx PSD corresponding
-   * to the standard in use.
+   * to the standard in use. The returned PSD may be shared with other
+   * transmissions (see WifiSpectrumValueHelper::GetTxPowerSpectralDensity),
+   * hence it must not be modified.
    */
   Ptr<SpectrumValue> GetTxPowerSpectralDensity (double txPowerW, Ptr<WifiPpdu> ppdu, bool isOfdma = false);
 
@@ -237,6 +248,9 @@ private:
   double m_txMaskInnerBandMinimumRejection; //!< The minimum rejection (in dBr) for the inner band of the transmit spectrum mask
   double m_txMaskOuterBandMinimumRejection; //!< The minimum rejection (in dBr) for the outer band of the transmit spectrum mask
   double m_txMaskOuterBandMaximumRejection; //!< The maximum rejection (in dBr) for the outer band of the transmit spectrum mask
+
+  uint16_t m_filterBankChannelWidth;       //!< channel width (in MHz) the RF filter bank has been built for
+  WifiPhyStandard m_filterBankStandard;    //!< standard the RF filter bank has been built for
 };
 
 } //namespace ns3
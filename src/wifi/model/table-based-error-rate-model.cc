@@ -0,0 +1,411 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 University of Washington
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Sébastien Deronne <sebastien.deronne@gmail.com>
+ */
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <fstream>
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/double.h"
+#include "ns3/object-factory.h"
+#include "table-based-error-rate-model.h"
+#include "nist-error-rate-model.h"
+#include "wifi-tx-vector.h"
+#include "wifi-utils.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TableBasedErrorRateModel");
+
+NS_OBJECT_ENSURE_REGISTERED (TableBasedErrorRateModel);
+
+/// The string identifying a file of tables saved by TableBasedErrorRateModel
+static const std::string TABLE_FILE_MAGIC = "ns3-wifi-error-rate-tables-v1";
+
+const std::vector<uint64_t> TableBasedErrorRateModel::m_chunkSizes = {1, 8, 64, 512, 4096, 32768, 262144};
+
+std::map<TableBasedErrorRateModel::TablesKey, TableBasedErrorRateModel::Tables> TableBasedErrorRateModel::m_sharedTables;
+
+TypeId
+TableBasedErrorRateModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TableBasedErrorRateModel")
+    .SetParent<ErrorRateModel> ()
+    .SetGroupName ("Wifi")
+    .AddConstructor<TableBasedErrorRateModel> ()
+    .AddAttribute ("ErrorRateModel",
+                   "The type of the error rate model whose success rates are tabulated.",
+                   TypeIdValue (NistErrorRateModel::GetTypeId ()),
+                   MakeTypeIdAccessor (&TableBasedErrorRateModel::SetErrorRateModelType,
+                                       &TableBasedErrorRateModel::GetErrorRateModelType),
+                   MakeTypeIdChecker ())
+    .AddAttribute ("MinSnr",
+                   "The smallest tabulated SNR (dB). The success rates of smaller SNRs "
+                   "are computed by the tabulated error rate model.",
+                   DoubleValue (-10),
+                   MakeDoubleAccessor (&TableBasedErrorRateModel::SetMinSnr,
+                                       &TableBasedErrorRateModel::GetMinSnr),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("MaxSnr",
+                   "The largest tabulated SNR (dB). The success rates of larger SNRs "
+                   "are computed by the tabulated error rate model.",
+                   DoubleValue (60),
+                   MakeDoubleAccessor (&TableBasedErrorRateModel::SetMaxSnr,
+                                       &TableBasedErrorRateModel::GetMaxSnr),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("SnrStep",
+                   "The step between two tabulated SNRs (dB).",
+                   DoubleValue (0.1),
+                   MakeDoubleAccessor (&TableBasedErrorRateModel::SetSnrStep,
+                                       &TableBasedErrorRateModel::GetSnrStep),
+                   MakeDoubleChecker<double> (0.001))
+  ;
+  return tid;
+}
+
+TableBasedErrorRateModel::TableBasedErrorRateModel ()
+  : m_minSnrDb (-10),
+    m_maxSnrDb (60),
+    m_snrStepDb (0.1),
+    m_tables (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TableBasedErrorRateModel::~TableBasedErrorRateModel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+TableBasedErrorRateModel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  Reset ();
+  ErrorRateModel::DoDispose ();
+}
+
+void
+TableBasedErrorRateModel::Reset (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_errorRateModel = 0;
+  m_tables = 0;
+}
+
+void
+TableBasedErrorRateModel::SetErrorRateModelType (TypeId type)
+{
+  NS_LOG_FUNCTION (this << type);
+  m_errorRateModelType = type;
+  Reset ();
+}
+
+TypeId
+TableBasedErrorRateModel::GetErrorRateModelType (void) const
+{
+  return m_errorRateModelType;
+}
+
+void
+TableBasedErrorRateModel::SetMinSnr (double snrDb)
+{
+  NS_LOG_FUNCTION (this << snrDb);
+  m_minSnrDb = snrDb;
+  Reset ();
+}
+
+double
+TableBasedErrorRateModel::GetMinSnr (void) const
+{
+  return m_minSnrDb;
+}
+
+void
+TableBasedErrorRateModel::SetMaxSnr (double snrDb)
+{
+  NS_LOG_FUNCTION (this << snrDb);
+  m_maxSnrDb = snrDb;
+  Reset ();
+}
+
+double
+TableBasedErrorRateModel::GetMaxSnr (void) const
+{
+  return m_maxSnrDb;
+}
+
+void
+TableBasedErrorRateModel::SetSnrStep (double stepDb)
+{
+  NS_LOG_FUNCTION (this << stepDb);
+  m_snrStepDb = stepDb;
+  Reset ();
+}
+
+double
+TableBasedErrorRateModel::GetSnrStep (void) const
+{
+  return m_snrStepDb;
+}
+
+std::size_t
+TableBasedErrorRateModel::GetNTables (void) const
+{
+  return GetTables ().size ();
+}
+
+void
+TableBasedErrorRateModel::ClearTables (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  //the maps are emptied rather than erased, since instances point to them
+  for (std::map<TablesKey, Tables>::iterator it = m_sharedTables.begin (); it != m_sharedTables.end (); ++it)
+    {
+      it->second.clear ();
+    }
+}
+
+TableBasedErrorRateModel::Tables &
+TableBasedErrorRateModel::GetTables (void) const
+{
+  if (m_tables == 0)
+    {
+      m_tables = &m_sharedTables[std::make_tuple (m_errorRateModelType, m_minSnrDb, m_maxSnrDb, m_snrStepDb)];
+    }
+  return *m_tables;
+}
+
+std::size_t
+TableBasedErrorRateModel::GetNSnrs (void) const
+{
+  return static_cast<std::size_t> (std::floor ((m_maxSnrDb - m_minSnrDb) / m_snrStepDb + 1e-9)) + 1;
+}
+
+Ptr<ErrorRateModel>
+TableBasedErrorRateModel::GetErrorRateModel (void) const
+{
+  if (m_errorRateModel == 0)
+    {
+      NS_ABORT_MSG_IF (m_errorRateModelType == TableBasedErrorRateModel::GetTypeId (),
+                       "A TableBasedErrorRateModel cannot tabulate itself");
+      ObjectFactory factory;
+      factory.SetTypeId (m_errorRateModelType);
+      m_errorRateModel = factory.Create<ErrorRateModel> ();
+    }
+  return m_errorRateModel;
+}
+
+uint64_t
+TableBasedErrorRateModel::GetTableKey (WifiMode mode, uint16_t channelWidth, uint16_t guardInterval, uint8_t nss)
+{
+  return (static_cast<uint64_t> (mode.GetUid ()) << 40)
+         | (static_cast<uint64_t> (channelWidth) << 24)
+         | (static_cast<uint64_t> (guardInterval) << 8)
+         | nss;
+}
+
+const TableBasedErrorRateModel::Table &
+TableBasedErrorRateModel::GetTable (WifiMode mode, const WifiTxVector &txVector) const
+{
+  uint64_t key = GetTableKey (mode, txVector.GetChannelWidth (), txVector.GetGuardInterval (), txVector.GetNssMax ());
+  Tables &tables = GetTables ();
+  Tables::const_iterator it = tables.find (key);
+  if (it != tables.end ())
+    {
+      return it->second;
+    }
+
+  NS_LOG_DEBUG ("Tabulating the success rates of " << mode << " with " << txVector);
+  Ptr<ErrorRateModel> model = GetErrorRateModel ();
+  Table table;
+  table.mode = mode;
+  table.channelWidth = txVector.GetChannelWidth ();
+  table.guardInterval = txVector.GetGuardInterval ();
+  table.nss = txVector.GetNssMax ();
+  std::size_t nSnrs = GetNSnrs ();
+  table.logErrorExponents.reserve (nSnrs * m_chunkSizes.size ());
+  for (std::size_t i = 0; i < nSnrs; i++)
+    {
+      double snr = DbToRatio (m_minSnrDb + i * m_snrStepDb);
+      for (std::vector<uint64_t>::const_iterator size = m_chunkSizes.begin (); size != m_chunkSizes.end (); ++size)
+        {
+          double successRate = model->GetChunkSuccessRate (mode, txVector, snr, *size);
+          //the error exponent (i.e., minus the logarithm of the success rate) is
+          //bounded to remain finite when the success rate is 1 or underflows
+          double errorExponent = -std::log (std::max (successRate, DBL_MIN));
+          table.logErrorExponents.push_back (std::log (std::max (errorExponent, DBL_MIN)));
+        }
+    }
+  return tables.insert (std::make_pair (key, table)).first->second;
+}
+
+double
+TableBasedErrorRateModel::GetChunkSuccessRate (WifiMode mode, WifiTxVector txVector, double snr, uint64_t nbits) const
+{
+  NS_LOG_FUNCTION (this << mode << snr << nbits);
+  if (nbits == 0)
+    {
+      return 1.0;
+    }
+  std::size_t nSnrs = GetNSnrs ();
+  double snrDb = (snr > 0) ? RatioToDb (snr) : -DBL_MAX;
+  if (snrDb < m_minSnrDb || snrDb > m_maxSnrDb || nSnrs < 2)
+    {
+      return GetErrorRateModel ()->GetChunkSuccessRate (mode, txVector, snr, nbits);
+    }
+  const Table &table = GetTable (mode, txVector);
+
+  //the tabulated SNRs surrounding the SNR of the chunk
+  double snrPosition = (snrDb - m_minSnrDb) / m_snrStepDb;
+  std::size_t snrIndex = std::min (static_cast<std::size_t> (snrPosition), nSnrs - 2);
+  double snrWeight = snrPosition - snrIndex;
+
+  //the tabulated chunk sizes surrounding the size of the chunk (the last two
+  //sizes are used to extrapolate the success rates of larger chunks)
+  std::size_t sizeIndex = 0;
+  while (sizeIndex + 2 < m_chunkSizes.size () && m_chunkSizes[sizeIndex + 1] <= nbits)
+    {
+      sizeIndex++;
+    }
+  double sizeWeight = std::log (static_cast<double> (nbits) / m_chunkSizes[sizeIndex])
+    / std::log (static_cast<double> (m_chunkSizes[sizeIndex + 1]) / m_chunkSizes[sizeIndex]);
+
+  const double *low = &table.logErrorExponents[snrIndex * m_chunkSizes.size () + sizeIndex];
+  const double *high = low + m_chunkSizes.size ();
+  double logLow = low[0] + sizeWeight * (low[1] - low[0]);
+  double logHigh = high[0] + sizeWeight * (high[1] - high[0]);
+  double logErrorExponent = logLow + snrWeight * (logHigh - logLow);
+  return std::exp (-std::exp (logErrorExponent));
+}
+
+bool
+TableBasedErrorRateModel::Save (std::string filename) const
+{
+  NS_LOG_FUNCTION (this << filename);
+  std::ofstream file (filename.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!file.is_open ())
+    {
+      NS_LOG_WARN ("Unable to open " << filename);
+      return false;
+    }
+  std::string typeName = m_errorRateModelType.GetName ();
+  uint32_t length = typeName.size ();
+  const Tables &tables = GetTables ();
+  uint32_t nTables = tables.size ();
+  file.write (TABLE_FILE_MAGIC.c_str (), TABLE_FILE_MAGIC.size ());
+  file.write (reinterpret_cast<const char *> (&length), sizeof (length));
+  file.write (typeName.c_str (), length);
+  file.write (reinterpret_cast<const char *> (&m_minSnrDb), sizeof (m_minSnrDb));
+  file.write (reinterpret_cast<const char *> (&m_maxSnrDb), sizeof (m_maxSnrDb));
+  file.write (reinterpret_cast<const char *> (&m_snrStepDb), sizeof (m_snrStepDb));
+  file.write (reinterpret_cast<const char *> (&nTables), sizeof (nTables));
+  for (Tables::const_iterator it = tables.begin (); it != tables.end (); ++it)
+    {
+      const Table &table = it->second;
+      std::string modeName = table.mode.GetUniqueName ();
+      length = modeName.size ();
+      uint32_t nValues = table.logErrorExponents.size ();
+      file.write (reinterpret_cast<const char *> (&length), sizeof (length));
+      file.write (modeName.c_str (), length);
+      file.write (reinterpret_cast<const char *> (&table.channelWidth), sizeof (table.channelWidth));
+      file.write (reinterpret_cast<const char *> (&table.guardInterval), sizeof (table.guardInterval));
+      file.write (reinterpret_cast<const char *> (&table.nss), sizeof (table.nss));
+      file.write (reinterpret_cast<const char *> (&nValues), sizeof (nValues));
+      file.write (reinterpret_cast<const char *> (table.logErrorExponents.data ()), nValues * sizeof (double));
+    }
+  return file.good ();
+}
+
+bool
+TableBasedErrorRateModel::Load (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  std::ifstream file (filename.c_str (), std::ios::in | std::ios::binary);
+  if (!file.is_open ())
+    {
+      NS_LOG_WARN ("Unable to open " << filename);
+      return false;
+    }
+  std::string magic (TABLE_FILE_MAGIC.size (), '\0');
+  file.read (&magic[0], magic.size ());
+  if (!file.good () || magic != TABLE_FILE_MAGIC)
+    {
+      NS_LOG_WARN (filename << " is not a file of error rate tables");
+      return false;
+    }
+  uint32_t length = 0;
+  file.read (reinterpret_cast<char *> (&length), sizeof (length));
+  std::string typeName (file.good () ? length : 0, '\0');
+  file.read (&typeName[0], typeName.size ());
+  double minSnrDb = 0;
+  double maxSnrDb = 0;
+  double snrStepDb = 0;
+  uint32_t nTables = 0;
+  file.read (reinterpret_cast<char *> (&minSnrDb), sizeof (minSnrDb));
+  file.read (reinterpret_cast<char *> (&maxSnrDb), sizeof (maxSnrDb));
+  file.read (reinterpret_cast<char *> (&snrStepDb), sizeof (snrStepDb));
+  file.read (reinterpret_cast<char *> (&nTables), sizeof (nTables));
+  if (!file.good () || typeName != m_errorRateModelType.GetName ()
+      || minSnrDb != m_minSnrDb || maxSnrDb != m_maxSnrDb || snrStepDb != m_snrStepDb)
+    {
+      NS_LOG_WARN ("The tables of " << filename << " do not match the configuration of the model");
+      return false;
+    }
+
+  std::size_t nValues = GetNSnrs () * m_chunkSizes.size ();
+  std::vector<Table> tables;
+  for (uint32_t i = 0; i < nTables; i++)
+    {
+      file.read (reinterpret_cast<char *> (&length), sizeof (length));
+      std::string modeName (file.good () ? length : 0, '\0');
+      file.read (&modeName[0], modeName.size ());
+      Table table;
+      uint32_t nSavedValues = 0;
+      file.read (reinterpret_cast<char *> (&table.channelWidth), sizeof (table.channelWidth));
+      file.read (reinterpret_cast<char *> (&table.guardInterval), sizeof (table.guardInterval));
+      file.read (reinterpret_cast<char *> (&table.nss), sizeof (table.nss));
+      file.read (reinterpret_cast<char *> (&nSavedValues), sizeof (nSavedValues));
+      if (!file.good () || nSavedValues != nValues)
+        {
+          NS_LOG_WARN (filename << " is truncated or corrupted");
+          return false;
+        }
+      table.mode = WifiMode (modeName);
+      table.logErrorExponents.resize (nValues);
+      file.read (reinterpret_cast<char *> (table.logErrorExponents.data ()), nValues * sizeof (double));
+      if (!file.good ())
+        {
+          NS_LOG_WARN (filename << " is truncated or corrupted");
+          return false;
+        }
+      tables.push_back (table);
+    }
+  Tables &sharedTables = GetTables ();
+  for (std::vector<Table>::const_iterator it = tables.begin (); it != tables.end (); ++it)
+    {
+      sharedTables[GetTableKey (it->mode, it->channelWidth, it->guardInterval, it->nss)] = *it;
+    }
+  NS_LOG_DEBUG ("Loaded " << tables.size () << " tables from " << filename);
+  return true;
+}
+
+} //namespace ns3
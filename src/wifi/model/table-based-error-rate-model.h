@@ -0,0 +1,207 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019 University of Washington
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Sébastien Deronne <sebastien.deronne@gmail.com>
+ */
+
+#ifndef TABLE_BASED_ERROR_RATE_MODEL_H
+#define TABLE_BASED_ERROR_RATE_MODEL_H
+
+#include <map>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+#include "ns3/type-id.h"
+#include "error-rate-model.h"
+#include "wifi-mode.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup wifi
+ *
+ * An error rate model answering the chunk success rate queries by
+ * interpolating in tables of the success rates computed by another error
+ * rate model (e.g., NistErrorRateModel, YansErrorRateModel).
+ *
+ * A table is built upon the first query for a given combination of mode,
+ * channel width, guard interval and number of spatial streams. For every
+ * SNR between MinSnr and MaxSnr with a step of SnrStep, and for chunks of
+ * 1, 8, 64, ..., 8^6 bits, it holds the logarithm of the error exponent
+ * (i.e., of minus the logarithm of the success rate) computed by the
+ * tabulated model. Queries are answered by linear interpolation of this
+ * value in the SNR (in dB) and in the logarithm of the number of bits; the
+ * latter is exact for models assuming independent bit errors. Queries for
+ * an SNR outside of the tabulated range are forwarded to the tabulated
+ * model.
+ *
+ * The tables are shared by all the instances tabulating the same error
+ * rate model with the same SNR range and step, so that every table is
+ * computed once per process rather than once per PHY.
+ *
+ * The tables can be saved to and loaded from a binary file, to avoid
+ * computing them again in subsequent simulations.
+ */
+class TableBasedErrorRateModel : public ErrorRateModel
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  TableBasedErrorRateModel ();
+  virtual ~TableBasedErrorRateModel ();
+
+  virtual double GetChunkSuccessRate (WifiMode mode, WifiTxVector txVector, double snr, uint64_t nbits) const;
+
+  /**
+   * Set the type of the tabulated error rate model.
+   *
+   * \param type the TypeId of the tabulated error rate model
+   */
+  void SetErrorRateModelType (TypeId type);
+  /**
+   * \return the TypeId of the tabulated error rate model
+   */
+  TypeId GetErrorRateModelType (void) const;
+  /**
+   * Set the smallest tabulated SNR.
+   *
+   * \param snrDb the smallest tabulated SNR (dB)
+   */
+  void SetMinSnr (double snrDb);
+  /**
+   * \return the smallest tabulated SNR (dB)
+   */
+  double GetMinSnr (void) const;
+  /**
+   * Set the largest tabulated SNR.
+   *
+   * \param snrDb the largest tabulated SNR (dB)
+   */
+  void SetMaxSnr (double snrDb);
+  /**
+   * \return the largest tabulated SNR (dB)
+   */
+  double GetMaxSnr (void) const;
+  /**
+   * Set the step between two tabulated SNRs.
+   *
+   * \param stepDb the step between two tabulated SNRs (dB)
+   */
+  void SetSnrStep (double stepDb);
+  /**
+   * \return the step between two tabulated SNRs (dB)
+   */
+  double GetSnrStep (void) const;
+
+  /**
+   * Save the tables computed so far for the parameters of this model, by
+   * any instance, to a binary file.
+   *
+   * \param filename the name of the file
+   * \return true if the tables have been saved
+   */
+  bool Save (std::string filename) const;
+  /**
+   * Load the tables saved in a binary file by a model tabulating the same
+   * error rate model with the same SNR range and step. The loaded tables
+   * replace the tables computed so far for the same parameters, and are
+   * used by all the instances sharing these parameters.
+   *
+   * \param filename the name of the file
+   * \return true if the tables have been loaded
+   */
+  bool Load (std::string filename);
+
+  /**
+   * \return the number of tables computed or loaded so far for the
+   *         parameters of this model
+   */
+  std::size_t GetNTables (void) const;
+  /**
+   * Discard the tables computed or loaded so far by all the instances.
+   */
+  static void ClearTables (void);
+
+
+private:
+  virtual void DoDispose (void);
+
+  /// The logarithms of the error exponents of the chunks sent with given parameters
+  struct Table
+  {
+    WifiMode mode;                      ///< the mode of the chunks
+    uint16_t channelWidth;              ///< the channel width of the TXVECTOR (MHz)
+    uint16_t guardInterval;             ///< the guard interval of the TXVECTOR (ns)
+    uint8_t nss;                        ///< the number of spatial streams of the TXVECTOR
+    std::vector<double> logErrorExponents; ///< the logarithms of the error exponents, indexed by SNR then by chunk size
+  };
+
+  /// The tables computed with given parameters, indexed by GetTableKey
+  typedef std::unordered_map<uint64_t, Table> Tables;
+  /// The parameters of the tables: tabulated model, smallest and largest SNRs, SNR step
+  typedef std::tuple<TypeId, double, double, double> TablesKey;
+
+  /**
+   * \param mode the mode of the chunk
+   * \param channelWidth the channel width of the TXVECTOR (MHz)
+   * \param guardInterval the guard interval of the TXVECTOR (ns)
+   * \param nss the number of spatial streams of the TXVECTOR
+   * \return the key of the table for the given parameters
+   */
+  static uint64_t GetTableKey (WifiMode mode, uint16_t channelWidth, uint16_t guardInterval, uint8_t nss);
+  /**
+   * \param mode the mode of the chunk
+   * \param txVector the TXVECTOR of the transmission
+   * \return the table for the given parameters, computed if needed
+   */
+  const Table & GetTable (WifiMode mode, const WifiTxVector &txVector) const;
+  /**
+   * \return the tables shared by the instances with the parameters of this model
+   */
+  Tables & GetTables (void) const;
+  /**
+   * \return the tabulated error rate model, created if needed
+   */
+  Ptr<ErrorRateModel> GetErrorRateModel (void) const;
+  /**
+   * \return the number of tabulated SNRs
+   */
+  std::size_t GetNSnrs (void) const;
+  /**
+   * Forget the tabulated model and the tables looked up with the previous
+   * parameters.
+   */
+  void Reset (void);
+
+  static const std::vector<uint64_t> m_chunkSizes;     //!< the tabulated chunk sizes (bits)
+  static std::map<TablesKey, Tables> m_sharedTables;   //!< the tables of all the instances, indexed by their parameters
+
+  TypeId m_errorRateModelType;                         //!< the type of the tabulated model
+  double m_minSnrDb;                                   //!< the smallest tabulated SNR (dB)
+  double m_maxSnrDb;                                   //!< the largest tabulated SNR (dB)
+  double m_snrStepDb;                                  //!< the step between two tabulated SNRs (dB)
+  mutable Ptr<ErrorRateModel> m_errorRateModel;        //!< the tabulated model
+  mutable Tables *m_tables;                            //!< the shared tables with the parameters of this model, 0 if not looked up yet
+};
+
+} //namespace ns3
+
+#endif /* TABLE_BASED_ERROR_RATE_MODEL_H */
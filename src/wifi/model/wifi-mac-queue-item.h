@@ -24,6 +24,8 @@
 #ifndef WIFI_MAC_QUEUE_ITEM_H
 #define WIFI_MAC_QUEUE_ITEM_H
 
+#include <list>
+#include <map>
 #include "ns3/nstime.h"
 #include "wifi-mac-header.h"
 #include "msdu-aggregator.h"
@@ -146,6 +148,17 @@ private:
   WifiMacHeader m_header;                       //!< Wifi MAC header associated with the packet
   Time m_tstamp;                                //!< timestamp when the packet arrived at the queue
   MsduAggregator::DeaggregatedMsdus m_msduList; //!< The list of aggregated MSDUs included in this MPDU
+
+  friend class WifiMacQueue;
+  /// The position of an item in a WifiMacQueue
+  typedef std::list<Ptr<WifiMacQueueItem> >::const_iterator QueuePosition;
+  /// The positions in a WifiMacQueue of the QoS Data frames having the same TID and receiver
+  typedef std::list<QueuePosition> FlowQueue;
+  /// The positions of the items of a WifiMacQueue, sorted by timestamp
+  typedef std::multimap<Time, QueuePosition> ExpiryIndex;
+  FlowQueue *m_flowQueue;                       //!< The flow queue of this item in the WifiMacQueue storing it, if any
+  FlowQueue::iterator m_flowQueueIt;            //!< The position of this item in its flow queue
+  ExpiryIndex::iterator m_expiryIt;             //!< The position of this item in the expiry index of the WifiMacQueue storing it
 };
 
 /**
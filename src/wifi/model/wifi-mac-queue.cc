@@ -61,14 +61,17 @@ WifiMacQueue::GetTypeId (void)
 }
 
 WifiMacQueue::WifiMacQueue ()
-  : m_expiredPacketsPresent (false),
-    NS_LOG_TEMPLATE_DEFINE ("WifiMacQueue")
+  : NS_LOG_TEMPLATE_DEFINE ("WifiMacQueue")
 {
 }
 
 WifiMacQueue::~WifiMacQueue ()
 {
   NS_LOG_FUNCTION_NOARGS ();
+  for (ConstIterator it = begin (); it != end (); it++)
+    {
+      (*it)->m_flowQueue = nullptr;
+    }
 }
 
 const WifiMacQueue::ConstIterator WifiMacQueue::EMPTY = std::list<Ptr<WifiMacQueueItem>> ().end ();
@@ -99,6 +102,111 @@ WifiMacQueue::GetMaxDelay (void) const
   return m_maxDelay;
 }
 
+uint64_t
+WifiMacQueue::GetFlowKey (uint8_t tid, Mac48Address address)
+{
+  uint8_t buffer[6];
+  address.CopyTo (buffer);
+  uint64_t key = tid;
+  for (uint8_t i = 0; i < 6; i++)
+    {
+      key = (key << 8) | buffer[i];
+    }
+  return key;
+}
+
+WifiMacQueue::FlowQueue *
+WifiMacQueue::FindFlowQueue (uint8_t tid, Mac48Address address) const
+{
+  auto it = m_flowQueues.find (GetFlowKey (tid, address));
+  if (it == m_flowQueues.end ())
+    {
+      return nullptr;
+    }
+  return &it->second;
+}
+
+bool
+WifiMacQueue::DoEnqueue (ConstIterator pos, Ptr<WifiMacQueueItem> item)
+{
+  NS_LOG_FUNCTION (this << *item);
+
+  if (!Queue<WifiMacQueueItem>::DoEnqueue (pos, item))
+    {
+      return false;
+    }
+
+  // items are mostly enqueued with increasing timestamps, in which case
+  // inserting them before the hint takes constant time
+  item->m_expiryIt = m_expiryIndex.insert (m_expiryIndex.end (),
+                                           std::make_pair (item->GetTimeStamp (), std::prev (pos)));
+
+  item->m_flowQueue = nullptr;
+  const WifiMacHeader &hdr = item->GetHeader ();
+  if (!hdr.IsQosData ())
+    {
+      return true;
+    }
+
+  // FlowQueue objects are never erased, hence pointers to them stay valid
+  FlowQueue *flowQueue = &m_flowQueues[GetFlowKey (hdr.GetQosTid (), hdr.GetAddr1 ())];
+  // the item must be inserted in its flow queue before the first item of the
+  // flow that follows it in the queue
+  FlowQueue::iterator flowPos = flowQueue->end ();
+  if (!flowQueue->empty () && pos != end ())
+    {
+      if (std::prev (pos) == begin ())
+        {
+          flowPos = flowQueue->begin ();
+        }
+      else
+        {
+          for (ConstIterator it = pos; it != end (); it++)
+            {
+              if ((*it)->m_flowQueue == flowQueue)
+                {
+                  flowPos = (*it)->m_flowQueueIt;
+                  break;
+                }
+            }
+        }
+    }
+  item->m_flowQueue = flowQueue;
+  item->m_flowQueueIt = flowQueue->insert (flowPos, std::prev (pos));
+  return true;
+}
+
+Ptr<WifiMacQueueItem>
+WifiMacQueue::DoDequeue (ConstIterator pos)
+{
+  NS_LOG_FUNCTION (this);
+  RemoveFromIndexes (pos);
+  return Queue<WifiMacQueueItem>::DoDequeue (pos);
+}
+
+Ptr<WifiMacQueueItem>
+WifiMacQueue::DoRemove (ConstIterator pos)
+{
+  NS_LOG_FUNCTION (this);
+  RemoveFromIndexes (pos);
+  return Queue<WifiMacQueueItem>::DoRemove (pos);
+}
+
+void
+WifiMacQueue::RemoveFromIndexes (ConstIterator pos)
+{
+  if (pos == end ())
+    {
+      return;
+    }
+  m_expiryIndex.erase ((*pos)->m_expiryIt);
+  if ((*pos)->m_flowQueue != nullptr)
+    {
+      (*pos)->m_flowQueue->erase ((*pos)->m_flowQueueIt);
+      (*pos)->m_flowQueue = nullptr;
+    }
+}
+
 bool
 WifiMacQueue::TtlExceeded (ConstIterator &it)
 {
@@ -116,6 +224,25 @@ WifiMacQueue::TtlExceeded (ConstIterator &it)
   return false;
 }
 
+void
+WifiMacQueue::RemoveExpired (ConstIterator *pos)
+{
+  NS_LOG_FUNCTION (this);
+
+  // the items in the expiry index are sorted by timestamp, hence only the
+  // expired items are visited
+  while (!m_expiryIndex.empty ()
+         && Simulator::Now () > m_expiryIndex.begin ()->first + m_maxDelay)
+    {
+      ConstIterator it = m_expiryIndex.begin ()->second;
+      if (pos != nullptr && *pos == it)
+        {
+          (*pos)++;
+        }
+      TtlExceeded (it);
+    }
+}
+
 bool
 WifiMacQueue::Enqueue (Ptr<WifiMacQueueItem> item)
 {
@@ -147,25 +274,21 @@ WifiMacQueue::Insert (ConstIterator pos, Ptr<WifiMacQueueItem> item)
       return DoEnqueue (pos, item);
     }
 
-  // the queue is full; scan the list in the attempt to remove stale packets
-  ConstIterator it = begin ();
-  while (it != end ())
+  // the queue is full; remove stale packets
+  RemoveExpired (&pos);
+  if (QueueBase::GetNPackets () < GetMaxSize ().GetValue ())
     {
-      if (it == pos && TtlExceeded (it))
-        {
-          return DoEnqueue (it, item);
-        }
-      if (TtlExceeded (it))
-        {
-          return DoEnqueue (pos, item);
-        }
-      it++;
+      return DoEnqueue (pos, item);
     }
 
   // the queue is still full, remove the oldest item if the policy is drop oldest
   if (m_dropPolicy == DROP_OLDEST)
     {
       NS_LOG_DEBUG ("Remove the oldest item in the queue");
+      if (pos == begin ())
+        {
+          pos++;
+        }
       DoRemove (begin ());
     }
 
@@ -176,12 +299,10 @@ Ptr<WifiMacQueueItem>
 WifiMacQueue::Dequeue (void)
 {
   NS_LOG_FUNCTION (this);
-  for (ConstIterator it = begin (); it != end (); )
+  RemoveExpired ();
+  if (begin () != end ())
     {
-      if (!TtlExceeded (it))
-        {
-          return DoDequeue (it);
-        }
+      return DoDequeue (begin ());
     }
   NS_LOG_DEBUG ("The queue is empty");
   return 0;
@@ -244,38 +365,14 @@ WifiMacQueue::Dequeue (ConstIterator pos)
 {
   NS_LOG_FUNCTION (this);
 
-  if (!m_expiredPacketsPresent)
-    {
-      if (TtlExceeded (pos))
-        {
-          NS_LOG_DEBUG ("Packet lifetime expired");
-          return 0;
-        }
-      return DoDequeue (pos);
-    }
-
-  // remove stale items queued before the given position
-  ConstIterator it = begin ();
-  while (it != end ())
+  if (TtlExceeded (pos))
     {
-      if (it == pos)
-        {
-          // reset the flag signaling the presence of expired packets before returning
-          m_expiredPacketsPresent = false;
-
-          if (TtlExceeded (it))
-            {
-              return 0;
-            }
-          return DoDequeue (it);
-        }
-      else if (!TtlExceeded (it))
-        {
-          it++;
-        }
+      NS_LOG_DEBUG ("Packet lifetime expired");
+      return 0;
     }
-  NS_LOG_DEBUG ("Invalid iterator");
-  return 0;
+  // the item at the given position has not expired, hence it is not removed
+  RemoveExpired ();
+  return DoDequeue (pos);
 }
 
 Ptr<const WifiMacQueueItem>
@@ -290,8 +387,6 @@ WifiMacQueue::Peek (void) const
         {
           return DoPeek (it);
         }
-      // signal the presence of expired packets
-      m_expiredPacketsPresent = true;
     }
   NS_LOG_DEBUG ("The queue is empty");
   return 0;
@@ -314,11 +409,6 @@ WifiMacQueue::PeekByAddress (Mac48Address dest, ConstIterator pos) const
               return it;
             }
         }
-      else
-        {
-          // signal the presence of expired packets
-          m_expiredPacketsPresent = true;
-        }
       it++;
     }
   NS_LOG_DEBUG ("The queue is empty");
@@ -341,11 +431,6 @@ WifiMacQueue::PeekByTid (uint8_t tid, ConstIterator pos) const
               return it;
             }
         }
-      else
-        {
-          // signal the presence of expired packets
-          m_expiredPacketsPresent = true;
-        }
       it++;
     }
   NS_LOG_DEBUG ("The queue is empty");
@@ -356,25 +441,53 @@ WifiMacQueue::ConstIterator
 WifiMacQueue::PeekByTidAndAddress (uint8_t tid, Mac48Address dest, ConstIterator pos) const
 {
   NS_LOG_FUNCTION (this << +tid << dest);
-  ConstIterator it = (pos != EMPTY ? pos : begin ());
-  while (it != end ())
+  FlowQueue *flowQueue = FindFlowQueue (tid, dest);
+  if (flowQueue == nullptr || flowQueue->empty ())
     {
-      // skip packets that stayed in the queue for too long. They will be
-      // actually removed from the queue by the next call to a non-const method
-      if (Simulator::Now () <= (*it)->GetTimeStamp () + m_maxDelay)
+      NS_LOG_DEBUG ("The queue is empty");
+      return end ();
+    }
+
+  // find the first item of the flow that is not queued before the given position
+  FlowQueue::iterator flowIt = flowQueue->begin ();
+  if (pos != EMPTY && pos != begin ())
+    {
+      if (pos == end ())
+        {
+          flowIt = flowQueue->end ();
+        }
+      else if ((*pos)->m_flowQueue == flowQueue)
+        {
+          flowIt = (*pos)->m_flowQueueIt;
+        }
+      else if ((*std::prev (pos))->m_flowQueue == flowQueue)
         {
-          if ((*it)->GetHeader ().IsQosData () && (*it)->GetDestinationAddress () == dest
-              && (*it)->GetHeader ().GetQosTid () == tid)
+          // typical when searching for the item following a peeked item
+          flowIt = std::next ((*std::prev (pos))->m_flowQueueIt);
+        }
+      else
+        {
+          flowIt = flowQueue->end ();
+          for (ConstIterator it = pos; it != end (); it++)
             {
-              return it;
+              if ((*it)->m_flowQueue == flowQueue)
+                {
+                  flowIt = (*it)->m_flowQueueIt;
+                  break;
+                }
             }
         }
-      else
+    }
+
+  while (flowIt != flowQueue->end ())
+    {
+      // skip packets that stayed in the queue for too long. They will be
+      // actually removed from the queue by the next call to a non-const method
+      if (Simulator::Now () <= (**flowIt)->GetTimeStamp () + m_maxDelay)
         {
-          // signal the presence of expired packets
-          m_expiredPacketsPresent = true;
+          return *flowIt;
         }
-      it++;
+      flowIt++;
     }
   NS_LOG_DEBUG ("The queue is empty");
   return end ();
@@ -397,11 +510,6 @@ WifiMacQueue::PeekFirstAvailable (const Ptr<QosBlockedDestinations> blockedPacke
               return it;
             }
         }
-      else
-        {
-          // signal the presence of expired packets
-          m_expiredPacketsPresent = true;
-        }
       it++;
     }
   NS_LOG_DEBUG ("The queue is empty");
@@ -412,13 +520,10 @@ Ptr<WifiMacQueueItem>
 WifiMacQueue::Remove (void)
 {
   NS_LOG_FUNCTION (this);
-
-  for (ConstIterator it = begin (); it != end (); )
+  RemoveExpired ();
+  if (begin () != end ())
     {
-      if (!TtlExceeded (it))
-        {
-          return DoRemove (it);
-        }
+      return DoRemove (begin ());
     }
   NS_LOG_DEBUG ("The queue is empty");
   return 0;
@@ -428,17 +533,13 @@ bool
 WifiMacQueue::Remove (Ptr<const Packet> packet)
 {
   NS_LOG_FUNCTION (this << packet);
-  for (ConstIterator it = begin (); it != end (); )
+  RemoveExpired ();
+  for (ConstIterator it = begin (); it != end (); it++)
     {
-      if (!TtlExceeded (it))
+      if ((*it)->GetPacket () == packet)
         {
-          if ((*it)->GetPacket () == packet)
-            {
-              DoRemove (it);
-              return true;
-            }
-
-          it++;
+          DoRemove (it);
+          return true;
         }
     }
   NS_LOG_DEBUG ("Packet " << packet << " not found in the queue");
@@ -450,33 +551,13 @@ WifiMacQueue::Remove (ConstIterator pos, bool removeExpired)
 {
   NS_LOG_FUNCTION (this);
 
-  if (!removeExpired)
+  ConstIterator curr = pos++;
+  DoRemove (curr);
+  if (removeExpired)
     {
-      ConstIterator curr = pos++;
-      DoRemove (curr);
-      return pos;
+      RemoveExpired (&pos);
     }
-
-  // remove stale items queued before the given position
-  ConstIterator it = begin ();
-  while (it != end ())
-    {
-      if (it == pos)
-        {
-          // reset the flag signaling the presence of expired packets before returning
-          m_expiredPacketsPresent = false;
-
-          ConstIterator curr = pos++;
-          DoRemove (curr);
-          return pos;
-        }
-      else if (!TtlExceeded (it))
-        {
-          it++;
-        }
-    }
-  NS_LOG_DEBUG ("Invalid iterator");
-  return end ();
+  return pos;
 }
 
 uint32_t
@@ -484,18 +565,13 @@ WifiMacQueue::GetNPacketsByAddress (Mac48Address dest)
 {
   NS_LOG_FUNCTION (this << dest);
 
+  RemoveExpired ();
   uint32_t nPackets = 0;
-
-  for (ConstIterator it = begin (); it != end (); )
+  for (ConstIterator it = begin (); it != end (); it++)
     {
-      if (!TtlExceeded (it))
+      if ((*it)->GetHeader ().IsData () && (*it)->GetDestinationAddress () == dest)
         {
-          if ((*it)->GetHeader ().IsData () && (*it)->GetDestinationAddress () == dest)
-            {
-              nPackets++;
-            }
-
-          it++;
+          nPackets++;
         }
     }
   NS_LOG_DEBUG ("returns " << nPackets);
@@ -506,20 +582,9 @@ uint32_t
 WifiMacQueue::GetNPacketsByTidAndAddress (uint8_t tid, Mac48Address dest)
 {
   NS_LOG_FUNCTION (this << dest);
-  uint32_t nPackets = 0;
-  for (ConstIterator it = begin (); it != end (); )
-    {
-      if (!TtlExceeded (it))
-        {
-          if ((*it)->GetHeader ().IsQosData () && (*it)->GetDestinationAddress () == dest
-              && (*it)->GetHeader ().GetQosTid () == tid)
-            {
-              nPackets++;
-            }
-
-          it++;
-        }
-    }
+  RemoveExpired ();
+  FlowQueue *flowQueue = FindFlowQueue (tid, dest);
+  uint32_t nPackets = (flowQueue != nullptr ? flowQueue->size () : 0);
   NS_LOG_DEBUG ("returns " << nPackets);
   return nPackets;
 }
@@ -528,16 +593,10 @@ bool
 WifiMacQueue::IsEmpty (void)
 {
   NS_LOG_FUNCTION (this);
-  for (ConstIterator it = begin (); it != end (); )
-    {
-      if (!TtlExceeded (it))
-        {
-          NS_LOG_DEBUG ("returns false");
-          return false;
-        }
-    }
-  NS_LOG_DEBUG ("returns true");
-  return true;
+  RemoveExpired ();
+  bool isEmpty = (begin () == end ());
+  NS_LOG_DEBUG ("returns " << isEmpty);
+  return isEmpty;
 }
 
 uint32_t
@@ -545,13 +604,7 @@ WifiMacQueue::GetNPackets (void)
 {
   NS_LOG_FUNCTION (this);
   // remove packets that stayed in the queue for too long
-  for (ConstIterator it = begin (); it != end (); )
-    {
-      if (!TtlExceeded (it))
-        {
-          it++;
-        }
-    }
+  RemoveExpired ();
   return QueueBase::GetNPackets ();
 }
 
@@ -560,13 +613,7 @@ WifiMacQueue::GetNBytes (void)
 {
   NS_LOG_FUNCTION (this);
   // remove packets that stayed in the queue for too long
-  for (ConstIterator it = begin (); it != end (); )
-    {
-      if (!TtlExceeded (it))
-        {
-          it++;
-        }
-    }
+  RemoveExpired ();
   return QueueBase::GetNBytes ();
 }
 
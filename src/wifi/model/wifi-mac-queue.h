@@ -24,6 +24,7 @@
 #ifndef WIFI_MAC_QUEUE_H
 #define WIFI_MAC_QUEUE_H
 
+#include <unordered_map>
 #include "wifi-mac-queue-item.h"
 #include "ns3/queue.h"
 
@@ -53,6 +54,17 @@ extern template class Queue<WifiMacQueueItem>;
  * to verify whether or not it should be dropped. If
  * dot11EDCATableMSDULifetime has elapsed, it is dropped.
  * Otherwise, it is returned to the caller.
+ *
+ * The items are indexed by timestamp, so that the non-const methods drop
+ * all the expired items in bulk at a cost that does not depend on the
+ * number of items that have not expired. Since items are mostly enqueued
+ * with increasing timestamps, indexing an item takes constant time in
+ * the common case.
+ *
+ * In addition to the global FIFO order, the QoS Data frames are linked in
+ * per-(TID, receiver) flow queues, so that the frames of a given flow can be
+ * peeked, counted and removed without scanning the frames of other flows.
+ * A WifiMacQueueItem can be stored in at most one WifiMacQueue at a time.
  */
 class WifiMacQueue : public Queue<WifiMacQueueItem>
 {
@@ -262,8 +274,7 @@ public:
   /**
    * Remove the item at position <i>pos</i> in the queue and return an iterator
    * pointing to the item following the removed one. If <i>removeExpired</i> is
-   * true, all the items in the queue from the head to the given position are
-   * removed if their lifetime expired.
+   * true, all the items in the queue whose lifetime expired are removed.
    *
    * \param pos the position of the item to be removed
    * \param removeExpired true to remove expired items
@@ -323,11 +334,73 @@ private:
    * \return true if the item is removed, false otherwise
    */
   bool TtlExceeded (ConstIterator &it);
+  /**
+   * Remove all the items that have been in the queue for too long.
+   *
+   * \param pos if not null and the item it points to is removed, the
+   *            iterator is updated to point to the item that followed it
+   */
+  void RemoveExpired (ConstIterator *pos = nullptr);
+
+  /**
+   * Insert the given item before the given position in the queue, in the
+   * expiry index and, if it is a QoS Data frame, in the corresponding flow
+   * queue. Hides the homonymous method of the base class.
+   *
+   * \param pos the position before which the item is to be inserted
+   * \param item the item to insert
+   * \return true if success, false if the packet has been dropped
+   */
+  bool DoEnqueue (ConstIterator pos, Ptr<WifiMacQueueItem> item);
+  /**
+   * Dequeue the item at the given position in the queue and in the indexes.
+   * Hides the homonymous method of the base class.
+   *
+   * \param pos the position of the item to dequeue
+   * \return the dequeued item
+   */
+  Ptr<WifiMacQueueItem> DoDequeue (ConstIterator pos);
+  /**
+   * Remove (and drop) the item at the given position in the queue and in the
+   * indexes. Hides the homonymous method of the base class.
+   *
+   * \param pos the position of the item to remove
+   * \return the removed item
+   */
+  Ptr<WifiMacQueueItem> DoRemove (ConstIterator pos);
+  /**
+   * Remove the item at the given position from the expiry index and from its
+   * flow queue, if any.
+   *
+   * \param pos the position of the item
+   */
+  void RemoveFromIndexes (ConstIterator pos);
+
+  /// Typedef for the list of the positions of the frames of a flow
+  typedef WifiMacQueueItem::FlowQueue FlowQueue;
+  /// Typedef for the positions of the items sorted by timestamp
+  typedef WifiMacQueueItem::ExpiryIndex ExpiryIndex;
+
+  /**
+   * \param tid the TID of the flow
+   * \param address the receiver address of the flow
+   * \return the key of the flow queue in m_flowQueues
+   */
+  static uint64_t GetFlowKey (uint8_t tid, Mac48Address address);
+  /**
+   * \param tid the TID of the flow
+   * \param address the receiver address of the flow
+   * \return a pointer to the flow queue, or a null pointer if no frame of the
+   *         flow has ever been stored in this queue
+   */
+  FlowQueue * FindFlowQueue (uint8_t tid, Mac48Address address) const;
 
   QueueSize m_maxSize;                      //!< max queue size
   Time m_maxDelay;                          //!< Time to live for packets in the queue
   DropPolicy m_dropPolicy;                  //!< Drop behavior of queue
-  mutable bool m_expiredPacketsPresent;     //!> True if expired packets are in the queue
+  ExpiryIndex m_expiryIndex;                //!< The positions of the items sorted by timestamp
+  /// The flow queues, indexed by GetFlowKey
+  mutable std::unordered_map<uint64_t, FlowQueue> m_flowQueues;
 
   /// Traced callback: fired when a packet is dropped due to lifetime expiration
   TracedCallback<Ptr<const WifiMacQueueItem> > m_traceExpired;
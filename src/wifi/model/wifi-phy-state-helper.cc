@@ -34,6 +34,24 @@ NS_LOG_COMPONENT_DEFINE ("WifiPhyStateHelper");
 
 NS_OBJECT_ENSURE_REGISTERED (WifiPhyStateHelper);
 
+/**
+ * CCA thresholds closer than this (in dB) are considered to be the same
+ * threshold, so that values that went through a dBm/W conversion are still
+ * matched with the original dBm value.
+ */
+static const double CCA_THRESHOLD_TOLERANCE_DB = 1e-9;
+
+/**
+ * \param a a CCA threshold (dBm)
+ * \param b a CCA threshold (dBm)
+ * \return true if a is higher than b by more than the tolerance
+ */
+static bool
+IsHigherCcaThreshold (double a, double b)
+{
+  return a > b + CCA_THRESHOLD_TOLERANCE_DB;
+}
+
 TypeId
 WifiPhyStateHelper::GetTypeId (void)
 {
@@ -70,7 +88,8 @@ WifiPhyStateHelper::WifiPhyStateHelper ()
     m_startRx (Seconds (0)),
     m_startSwitching (Seconds (0)),
     m_startSleep (Seconds (0)),
-    m_previousStateChangeTime (Seconds (0))
+    m_previousStateChangeTime (Seconds (0)),
+    m_stateVersion (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -84,16 +103,18 @@ void
 WifiPhyStateHelper::DoInitialize (void)
 {
   NS_LOG_FUNCTION (this);
-  m_startCcaBusy.clear ();
-  m_endCcaBusy.clear ();
+  m_ccaThresholds.clear ();
+  m_ccaBusyPeriods.clear ();
+  m_groupEndCcaBusy.clear ();
 }
 
 void
 WifiPhyStateHelper::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
-  m_startCcaBusy.clear ();
-  m_endCcaBusy.clear ();
+  m_ccaThresholds.clear ();
+  m_ccaBusyPeriods.clear ();
+  m_groupEndCcaBusy.clear ();
 }
 
 void
@@ -179,12 +200,8 @@ WifiPhyStateHelper::GetDelayUntilIdle (WifiSpectrumBand band, double ccaThreshol
       retval = m_endTx - Simulator::Now ();
       break;
     case WifiPhyState::CCA_BUSY:
-    {
-      auto it = m_endCcaBusy.find (std::make_pair (band, ccaThreshold));
-      NS_ASSERT (it != m_endCcaBusy.end ());
-      retval = it->second - Simulator::Now ();
+      retval = GetEndCcaBusy (band, ccaThreshold) - Simulator::Now ();
       break;
-    }
     case WifiPhyState::SWITCHING:
       retval = m_endSwitching - Simulator::Now ();
       break;
@@ -211,27 +228,200 @@ WifiPhyStateHelper::GetDelayUntilIdle (WifiSpectrumBand band, double ccaThreshol
 Time
 WifiPhyStateHelper::GetDelaySinceIdle (WifiSpectrumBand band, double ccaThreshold) const
 {
-  auto it = m_endCcaBusy.find (std::make_pair (band, ccaThreshold));
   Time idleStart = Max (m_endTx, m_endRx);
   idleStart = Max (idleStart, m_endSwitching);
-  if (it != m_endCcaBusy.end ())
+  idleStart = Max (idleStart, GetEndCcaBusy (band, ccaThreshold));
+  return Simulator::Now () - idleStart;
+}
+
+void
+WifiPhyStateHelper::RemoveCcaThreshold (double ccaThreshold)
+{
+  NS_LOG_FUNCTION (this << ccaThreshold);
+  std::size_t thresholdIndex = FindCcaThreshold (ccaThreshold);
+  if (thresholdIndex == m_ccaThresholds.size ())
+    {
+      return;
+    }
+  m_stateVersion++;
+  m_ccaThresholds.erase (m_ccaThresholds.begin () + thresholdIndex);
+  for (auto & periods : m_ccaBusyPeriods)
+    {
+      periods.startCcaBusy.erase (periods.startCcaBusy.begin () + thresholdIndex);
+      periods.endCcaBusy.erase (periods.endCcaBusy.begin () + thresholdIndex);
+    }
+  for (auto & groupEndCcaBusy : m_groupEndCcaBusy)
     {
-      idleStart = Max (idleStart, it->second);
+      groupEndCcaBusy.erase (groupEndCcaBusy.begin () + thresholdIndex);
+    }
+}
+
+Time
+WifiPhyStateHelper::GetDelaySinceIdle (std::size_t groupIndex, double ccaThreshold) const
+{
+  NS_ASSERT (groupIndex < m_groupEndCcaBusy.size ());
+  Time idleStart = Max (m_endTx, m_endRx);
+  idleStart = Max (idleStart, m_endSwitching);
+  std::size_t thresholdIndex = FindCcaThreshold (ccaThreshold);
+  if (thresholdIndex < m_ccaThresholds.size ())
+    {
+      idleStart = Max (idleStart, m_groupEndCcaBusy[groupIndex][thresholdIndex]);
     }
   return Simulator::Now () - idleStart;
 }
 
+void
+WifiPhyStateHelper::SetCcaBandGroups (const std::vector<std::vector<WifiSpectrumBand> > &groups)
+{
+  NS_LOG_FUNCTION (this << groups.size ());
+  m_stateVersion++;
+  for (auto & periods : m_ccaBusyPeriods)
+    {
+      periods.groups.clear ();
+    }
+  m_groupEndCcaBusy.assign (groups.size (), std::vector<Time> (m_ccaThresholds.size (), Seconds (0)));
+  for (std::size_t groupIndex = 0; groupIndex < groups.size (); groupIndex++)
+    {
+      for (auto const& band : groups[groupIndex])
+        {
+          CcaBusyPeriods &periods = m_ccaBusyPeriods[AddCcaBand (band)];
+          periods.groups.push_back (groupIndex);
+          for (std::size_t thresholdIndex = 0; thresholdIndex < m_ccaThresholds.size (); thresholdIndex++)
+            {
+              Time &groupEndCcaBusy = m_groupEndCcaBusy[groupIndex][thresholdIndex];
+              groupEndCcaBusy = std::max (groupEndCcaBusy, periods.endCcaBusy[thresholdIndex]);
+            }
+        }
+    }
+}
+
+std::size_t
+WifiPhyStateHelper::GetNCcaBandGroups (void) const
+{
+  return m_groupEndCcaBusy.size ();
+}
+
+uint64_t
+WifiPhyStateHelper::GetStateVersion (void) const
+{
+  return m_stateVersion;
+}
+
 Time
 WifiPhyStateHelper::GetLastRxStartTime (void) const
 {
   return m_startRx;
 }
 
+std::size_t
+WifiPhyStateHelper::FindCcaThreshold (double ccaThreshold) const
+{
+  auto it = std::lower_bound (m_ccaThresholds.begin (), m_ccaThresholds.end (), ccaThreshold, IsHigherCcaThreshold);
+  if (it != m_ccaThresholds.end () && !IsHigherCcaThreshold (ccaThreshold, *it))
+    {
+      return it - m_ccaThresholds.begin ();
+    }
+  return m_ccaThresholds.size ();
+}
+
+std::size_t
+WifiPhyStateHelper::FindCcaBand (WifiSpectrumBand band) const
+{
+  //there are at most 8 bands (one per 20 MHz channel)
+  std::size_t bandIndex = 0;
+  while (bandIndex < m_ccaBusyPeriods.size () && m_ccaBusyPeriods[bandIndex].band != band)
+    {
+      bandIndex++;
+    }
+  return bandIndex;
+}
+
+std::size_t
+WifiPhyStateHelper::AddCcaThreshold (double ccaThreshold)
+{
+  auto it = std::lower_bound (m_ccaThresholds.begin (), m_ccaThresholds.end (), ccaThreshold, IsHigherCcaThreshold);
+  std::size_t thresholdIndex = it - m_ccaThresholds.begin ();
+  if (it == m_ccaThresholds.end () || IsHigherCcaThreshold (ccaThreshold, *it))
+    {
+      m_ccaThresholds.insert (it, ccaThreshold);
+      for (auto & periods : m_ccaBusyPeriods)
+        {
+          periods.startCcaBusy.insert (periods.startCcaBusy.begin () + thresholdIndex, Seconds (0));
+          periods.endCcaBusy.insert (periods.endCcaBusy.begin () + thresholdIndex, Seconds (0));
+        }
+      for (auto & groupEndCcaBusy : m_groupEndCcaBusy)
+        {
+          groupEndCcaBusy.insert (groupEndCcaBusy.begin () + thresholdIndex, Seconds (0));
+        }
+    }
+  return thresholdIndex;
+}
+
+void
+WifiPhyStateHelper::ExtendCcaBusy (std::size_t bandIndex, std::size_t thresholdIndex, Time endCcaBusy)
+{
+  CcaBusyPeriods &periods = m_ccaBusyPeriods[bandIndex];
+  if (endCcaBusy <= periods.endCcaBusy[thresholdIndex])
+    {
+      return;
+    }
+  periods.endCcaBusy[thresholdIndex] = endCcaBusy;
+  for (auto const& groupIndex : periods.groups)
+    {
+      Time &groupEndCcaBusy = m_groupEndCcaBusy[groupIndex][thresholdIndex];
+      groupEndCcaBusy = std::max (groupEndCcaBusy, endCcaBusy);
+    }
+}
+
+std::size_t
+WifiPhyStateHelper::AddCcaBand (WifiSpectrumBand band)
+{
+  std::size_t bandIndex = FindCcaBand (band);
+  if (bandIndex == m_ccaBusyPeriods.size ())
+    {
+      CcaBusyPeriods periods;
+      periods.band = band;
+      periods.startCcaBusy.resize (m_ccaThresholds.size (), Seconds (0));
+      periods.endCcaBusy.resize (m_ccaThresholds.size (), Seconds (0));
+      m_ccaBusyPeriods.push_back (periods);
+    }
+  return bandIndex;
+}
+
+Time
+WifiPhyStateHelper::GetStartCcaBusy (WifiSpectrumBand band, double ccaThreshold) const
+{
+  std::size_t bandIndex = FindCcaBand (band);
+  std::size_t thresholdIndex = FindCcaThreshold (ccaThreshold);
+  if (bandIndex == m_ccaBusyPeriods.size () || thresholdIndex == m_ccaThresholds.size ())
+    {
+      return Seconds (0);
+    }
+  return m_ccaBusyPeriods[bandIndex].startCcaBusy[thresholdIndex];
+}
+
+Time
+WifiPhyStateHelper::GetEndCcaBusy (WifiSpectrumBand band, double ccaThreshold) const
+{
+  std::size_t bandIndex = FindCcaBand (band);
+  std::size_t thresholdIndex = FindCcaThreshold (ccaThreshold);
+  if (bandIndex == m_ccaBusyPeriods.size () || thresholdIndex == m_ccaThresholds.size ())
+    {
+      return Seconds (0);
+    }
+  return m_ccaBusyPeriods[bandIndex].endCcaBusy[thresholdIndex];
+}
+
 WifiPhyState
 WifiPhyStateHelper::GetState (WifiSpectrumBand band, double ccaThreshold) const
+{
+  return DoGetState (GetEndCcaBusy (band, ccaThreshold));
+}
+
+WifiPhyState
+WifiPhyStateHelper::DoGetState (Time endCcaBusy) const
 {
   Time now = Simulator::Now ();
-  auto it = m_endCcaBusy.find (std::make_pair (band, ccaThreshold));
   if (m_isOff)
     {
       return WifiPhyState::OFF;
@@ -252,7 +442,7 @@ WifiPhyStateHelper::GetState (WifiSpectrumBand band, double ccaThreshold) const
     {
       return WifiPhyState::SWITCHING;
     }
-  else if ((it != m_endCcaBusy.end ()) && (it->second > now))
+  else if (endCcaBusy > now)
     {
       return WifiPhyState::CCA_BUSY;
     }
@@ -367,12 +557,7 @@ WifiPhyStateHelper::LogPreviousIdleAndCcaBusyStates (WifiSpectrumBand primaryBan
 {
   NS_LOG_FUNCTION (this);
   Time now = Simulator::Now ();
-  Time endCcaBusy = Seconds (0);
-  auto itEndCca = m_endCcaBusy.find (std::make_pair(primaryBand, primaryCcaThreshold));
-  if (itEndCca != m_endCcaBusy.end ())
-    {
-      endCcaBusy = itEndCca->second;
-    }
+  Time endCcaBusy = GetEndCcaBusy (primaryBand, primaryCcaThreshold);
   Time idleStart = Max (endCcaBusy, m_endRx);
   idleStart = Max (idleStart, m_endTx);
   idleStart = Max (idleStart, m_endSwitching);
@@ -382,11 +567,7 @@ WifiPhyStateHelper::LogPreviousIdleAndCcaBusyStates (WifiSpectrumBand primaryBan
       && endCcaBusy > m_endTx)
     {
       Time ccaBusyStart = Max (m_endTx, m_endRx);
-      auto itStartCca = m_startCcaBusy.find (std::make_pair(primaryBand, primaryCcaThreshold));
-        if (itStartCca != m_startCcaBusy.end ())
-          {
-            ccaBusyStart = Max (ccaBusyStart, itStartCca->second);
-          }
+      ccaBusyStart = Max (ccaBusyStart, GetStartCcaBusy (primaryBand, primaryCcaThreshold));
       ccaBusyStart = Max (ccaBusyStart, m_endSwitching);
       m_stateLogger (ccaBusyStart, idleStart - ccaBusyStart, WifiPhyState::CCA_BUSY);
     }
@@ -414,11 +595,7 @@ WifiPhyStateHelper::SwitchToTx (Time txDuration, WifiPsduMap psdus, double txPow
     case WifiPhyState::CCA_BUSY:
       {
         Time ccaStart = Max (m_endRx, m_endTx);
-        auto it = m_startCcaBusy.find (std::make_pair (primaryBand, primaryCcaThreshold));
-        if (it != m_startCcaBusy.end ())
-          {
-            ccaStart = Max (ccaStart, it->second);
-          }
+        ccaStart = Max (ccaStart, GetStartCcaBusy (primaryBand, primaryCcaThreshold));
         ccaStart = Max (ccaStart, m_endSwitching);
         m_stateLogger (ccaStart, now - ccaStart, WifiPhyState::CCA_BUSY);
       } break;
@@ -433,24 +610,22 @@ WifiPhyStateHelper::SwitchToTx (Time txDuration, WifiPsduMap psdus, double txPow
   m_previousStateChangeTime = now;
   m_endTx = now + txDuration;
   m_startTx = now;
-  for (auto & startCcaBusy : m_startCcaBusy)
+  m_stateVersion++;
+  for (std::size_t bandIndex = 0; bandIndex < m_ccaBusyPeriods.size (); bandIndex++)
     {
-      if (startCcaBusy.first.first == primaryBand)
+      CcaBusyPeriods &periods = m_ccaBusyPeriods[bandIndex];
+      if (periods.band == primaryBand)
         {
           continue;
         }
-      if (now < startCcaBusy.second)
+      for (auto & startCcaBusy : periods.startCcaBusy)
         {
-          startCcaBusy.second = now;
+          startCcaBusy = std::min (startCcaBusy, now);
         }
-    }
-  for (auto & endCcaBusy : m_endCcaBusy)
-    {
-      if (endCcaBusy.first.first == primaryBand)
+      for (std::size_t thresholdIndex = 0; thresholdIndex < m_ccaThresholds.size (); thresholdIndex++)
         {
-          continue;
+          ExtendCcaBusy (bandIndex, thresholdIndex, now + txDuration);
         }
-      endCcaBusy.second = std::max (endCcaBusy.second, now + txDuration);
     }
   NotifyTxStart (txDuration, txPowerDbm);
 }
@@ -468,11 +643,7 @@ WifiPhyStateHelper::SwitchToRx (Time rxDuration, WifiSpectrumBand primaryBand, d
     case WifiPhyState::CCA_BUSY:
       {
         Time ccaStart = Max (m_endRx, m_endTx);
-        auto it = m_startCcaBusy.find (std::make_pair (primaryBand, primaryCcaThreshold));
-        if (it != m_startCcaBusy.end ())
-          {
-            ccaStart = Max (ccaStart, it->second);
-          }
+        ccaStart = Max (ccaStart, GetStartCcaBusy (primaryBand, primaryCcaThreshold));
         ccaStart = Max (ccaStart, m_endSwitching);
         m_stateLogger (ccaStart, now - ccaStart, WifiPhyState::CCA_BUSY);
       }
@@ -484,24 +655,22 @@ WifiPhyStateHelper::SwitchToRx (Time rxDuration, WifiSpectrumBand primaryBand, d
   m_previousStateChangeTime = now;
   m_startRx = now;
   m_endRx = now + rxDuration;
-  for (auto & startCcaBusy : m_startCcaBusy)
+  m_stateVersion++;
+  for (std::size_t bandIndex = 0; bandIndex < m_ccaBusyPeriods.size (); bandIndex++)
     {
-      if (startCcaBusy.first.first == primaryBand)
+      CcaBusyPeriods &periods = m_ccaBusyPeriods[bandIndex];
+      if (periods.band == primaryBand)
         {
           continue;
         }
-      if (now < startCcaBusy.second)
+      for (auto & startCcaBusy : periods.startCcaBusy)
         {
-          startCcaBusy.second = now;
+          startCcaBusy = std::min (startCcaBusy, now);
         }
-    }
-  for (auto & endCcaBusy : m_endCcaBusy)
-    {
-      if (endCcaBusy.first.first == primaryBand)
+      for (std::size_t thresholdIndex = 0; thresholdIndex < m_ccaThresholds.size (); thresholdIndex++)
         {
-          continue;
+          ExtendCcaBusy (bandIndex, thresholdIndex, now + rxDuration);
         }
-      endCcaBusy.second = std::max (endCcaBusy.second, now + rxDuration);
     }
   NotifyRxStart (rxDuration);
   NS_ASSERT (IsStateRx (primaryBand, primaryCcaThreshold));
@@ -524,11 +693,7 @@ WifiPhyStateHelper::SwitchToChannelSwitching (Time switchingDuration, WifiSpectr
     case WifiPhyState::CCA_BUSY:
       {
         Time ccaStart = Max (m_endRx, m_endTx);
-        auto it = m_startCcaBusy.find (std::make_pair (primaryBand, primaryCcaThreshold));
-        if (it != m_startCcaBusy.end ())
-          {
-            ccaStart = Max (ccaStart, it->second);
-          }
+        ccaStart = Max (ccaStart, GetStartCcaBusy (primaryBand, primaryCcaThreshold));
         ccaStart = Max (ccaStart, m_endSwitching);
         m_stateLogger (ccaStart, now - ccaStart, WifiPhyState::CCA_BUSY);
       } break;
@@ -540,11 +705,19 @@ WifiPhyStateHelper::SwitchToChannelSwitching (Time switchingDuration, WifiSpectr
       break;
     }
 
-  for (auto & endCcaBusy : m_endCcaBusy)
+  m_stateVersion++;
+  for (auto & periods : m_ccaBusyPeriods)
+    {
+      for (auto & endCcaBusy : periods.endCcaBusy)
+        {
+          endCcaBusy = std::min (endCcaBusy, now);
+        }
+    }
+  for (auto & groupEndCcaBusy : m_groupEndCcaBusy)
     {
-      if (now < endCcaBusy.second)
+      for (auto & endCcaBusy : groupEndCcaBusy)
         {
-          endCcaBusy.second = now;
+          endCcaBusy = std::min (endCcaBusy, now);
         }
     }
 
@@ -608,32 +781,63 @@ WifiPhyStateHelper::DoSwitchFromRx (void)
   m_stateLogger (m_startRx, now - m_startRx, WifiPhyState::RX);
   m_previousStateChangeTime = now;
   m_endRx = Simulator::Now ();
+  m_stateVersion++;
 }
 
 void
 WifiPhyStateHelper::SwitchMaybeToCcaBusy (Time duration, WifiSpectrumBand band, bool isPrimaryChannel, double ccaThreshold)
 {
   NS_LOG_FUNCTION (this << duration << band.first << band.second << isPrimaryChannel << ccaThreshold);
-  Time now = Simulator::Now ();
   if (isPrimaryChannel && GetState (band, ccaThreshold) != WifiPhyState::RX)
     {
       NotifyMaybeCcaBusyStart (duration);
     }
-  auto itEndCca = m_endCcaBusy.find (std::make_pair (band, ccaThreshold));
-  if (itEndCca == m_endCcaBusy.end ())
-    {
-      m_endCcaBusy.insert ({std::make_pair (band, ccaThreshold), now + duration});
-    }
-  else
+  std::size_t thresholdIndex = AddCcaThreshold (ccaThreshold);
+  std::size_t bandIndex = AddCcaBand (band);
+  DoSwitchMaybeToCcaBusy (duration, bandIndex, thresholdIndex, isPrimaryChannel);
+}
+
+void
+WifiPhyStateHelper::SwitchMaybeToCcaBusy (const std::vector<Time> &durations, WifiSpectrumBand band,
+                                          const std::vector<double> &ccaThresholds)
+{
+  NS_LOG_FUNCTION (this << band.first << band.second << ccaThresholds.size ());
+  NS_ASSERT (durations.size () == ccaThresholds.size ());
+  std::size_t bandIndex = AddCcaBand (band);
+  std::size_t thresholdIndex = 0;
+  for (std::size_t i = 0; i < ccaThresholds.size (); i++)
     {
-      itEndCca->second = std::max (itEndCca->second, now + duration);
+      if (durations[i].IsZero ())
+        {
+          continue;
+        }
+      //both lists of thresholds are sorted in decreasing order, hence they can be walked together
+      while (thresholdIndex < m_ccaThresholds.size () && IsHigherCcaThreshold (m_ccaThresholds[thresholdIndex], ccaThresholds[i]))
+        {
+          thresholdIndex++;
+        }
+      if (thresholdIndex == m_ccaThresholds.size () || IsHigherCcaThreshold (ccaThresholds[i], m_ccaThresholds[thresholdIndex]))
+        {
+          thresholdIndex = AddCcaThreshold (ccaThresholds[i]);
+        }
+      DoSwitchMaybeToCcaBusy (durations[i], bandIndex, thresholdIndex, false);
     }
-  switch (GetState (band, ccaThreshold))
+}
+
+void
+WifiPhyStateHelper::DoSwitchMaybeToCcaBusy (Time duration, std::size_t bandIndex, std::size_t thresholdIndex, bool isPrimaryChannel)
+{
+  Time now = Simulator::Now ();
+  m_stateVersion++;
+  ExtendCcaBusy (bandIndex, thresholdIndex, now + duration);
+  CcaBusyPeriods &periods = m_ccaBusyPeriods[bandIndex];
+  WifiPhyState state = DoGetState (periods.endCcaBusy[thresholdIndex]);
+  switch (state)
     {
     case WifiPhyState::IDLE:
       if (isPrimaryChannel)
         {
-          LogPreviousIdleAndCcaBusyStates (band, ccaThreshold);
+          LogPreviousIdleAndCcaBusyStates (periods.band, m_ccaThresholds[thresholdIndex]);
         }
       break;
     case WifiPhyState::RX:
@@ -641,17 +845,9 @@ WifiPhyStateHelper::SwitchMaybeToCcaBusy (Time duration, WifiSpectrumBand band,
     default:
       break;
     }
-  if (GetState (band, ccaThreshold) != WifiPhyState::CCA_BUSY)
+  if (state != WifiPhyState::CCA_BUSY)
     {
-      auto itStartCca = m_startCcaBusy.find (std::make_pair (band, ccaThreshold));
-      if (itStartCca == m_startCcaBusy.end ())
-        {
-          m_startCcaBusy.insert ({std::make_pair (band, ccaThreshold), now});
-        }
-      else
-        {
-          itStartCca->second = now;
-        }
+      periods.startCcaBusy[thresholdIndex] = now;
     }
   if (isPrimaryChannel)
     {
@@ -672,11 +868,7 @@ WifiPhyStateHelper::SwitchToSleep (WifiSpectrumBand primaryBand, double primaryC
     case WifiPhyState::CCA_BUSY:
       {
         Time ccaStart = Max (m_endRx, m_endTx);
-        auto it = m_startCcaBusy.find (std::make_pair (primaryBand, primaryCcaThreshold));
-        if (it != m_startCcaBusy.end ())
-          {
-            ccaStart = Max (ccaStart, it->second);
-          }
+        ccaStart = Max (ccaStart, GetStartCcaBusy (primaryBand, primaryCcaThreshold));
         ccaStart = Max (ccaStart, m_endSwitching);
         m_stateLogger (ccaStart, now - ccaStart, WifiPhyState::CCA_BUSY);
       } break;
@@ -687,6 +879,7 @@ WifiPhyStateHelper::SwitchToSleep (WifiSpectrumBand primaryBand, double primaryC
   m_previousStateChangeTime = now;
   m_sleeping = true;
   m_startSleep = now;
+  m_stateVersion++;
   NotifySleep ();
   NS_ASSERT (IsStateSleep (primaryBand, primaryCcaThreshold));
 }
@@ -698,6 +891,7 @@ WifiPhyStateHelper::SwitchFromSleep (Time duration, WifiSpectrumBand band, bool
   NS_ASSERT (IsStateSleep (band, ccaThreshold));
   Time now = Simulator::Now ();
   m_sleeping = false;
+  m_stateVersion++;
   if (isPrimaryChannel)
     {
       m_stateLogger (m_startSleep, now - m_startSleep, WifiPhyState::SLEEP);
@@ -705,18 +899,10 @@ WifiPhyStateHelper::SwitchFromSleep (Time duration, WifiSpectrumBand band, bool
       NotifyWakeup ();
     }
   //update endCcaBusy after the sleep period
-  auto it = m_endCcaBusy.find (std::make_pair (band, ccaThreshold));
-  Time endCca;
-  if (it == m_endCcaBusy.end ())
-    {
-      endCca = now + duration;
-      m_endCcaBusy.insert ({std::make_pair (band, ccaThreshold), endCca});
-    }
-  else
-    {
-      endCca = std::max (it->second, now + duration);
-      it->second = endCca;
-    }
+  std::size_t thresholdIndex = AddCcaThreshold (ccaThreshold);
+  std::size_t bandIndex = AddCcaBand (band);
+  ExtendCcaBusy (bandIndex, thresholdIndex, now + duration);
+  Time endCca = m_ccaBusyPeriods[bandIndex].endCcaBusy[thresholdIndex];
   if (isPrimaryChannel && (endCca > now))
     {
       NotifyMaybeCcaBusyStart (endCca - now);
@@ -767,11 +953,7 @@ WifiPhyStateHelper::SwitchToOff (WifiSpectrumBand primaryBand, double primaryCca
     case WifiPhyState::CCA_BUSY:
       {
         Time ccaStart = Max (m_endRx, m_endTx);
-        auto it = m_startCcaBusy.find (std::make_pair (primaryBand, primaryCcaThreshold));
-        if (it != m_startCcaBusy.end ())
-          {
-            ccaStart = Max (ccaStart, it->second);
-          }
+        ccaStart = Max (ccaStart, GetStartCcaBusy (primaryBand, primaryCcaThreshold));
         ccaStart = Max (ccaStart, m_endSwitching);
         m_stateLogger (ccaStart, now - ccaStart, WifiPhyState::CCA_BUSY);
       } break;
@@ -781,6 +963,7 @@ WifiPhyStateHelper::SwitchToOff (WifiSpectrumBand primaryBand, double primaryCca
     }
   m_previousStateChangeTime = now;
   m_isOff = true;
+  m_stateVersion++;
   NotifyOff ();
   NS_ASSERT (IsStateOff (primaryBand, primaryCcaThreshold));
 }
@@ -792,24 +975,17 @@ WifiPhyStateHelper::SwitchFromOff (Time duration, WifiSpectrumBand band, bool is
   NS_ASSERT (IsStateOff (band, ccaThreshold));
   Time now = Simulator::Now ();
   m_isOff = false;
+  m_stateVersion++;
   if (isPrimaryChannel)
     {
       m_previousStateChangeTime = now;
       NotifyWakeup ();
     }
   //update endCcaBusy after the off period
-  auto it = m_endCcaBusy.find (std::make_pair (band, ccaThreshold));
-  Time endCca;
-  if (it == m_endCcaBusy.end ())
-    {
-      endCca = now + duration;
-      m_endCcaBusy.insert ({std::make_pair (band, ccaThreshold), endCca});
-    }
-  else
-    {
-      endCca = std::max (it->second, now + duration);
-      it->second = endCca;
-    }
+  std::size_t thresholdIndex = AddCcaThreshold (ccaThreshold);
+  std::size_t bandIndex = AddCcaBand (band);
+  ExtendCcaBusy (bandIndex, thresholdIndex, now + duration);
+  Time endCca = m_ccaBusyPeriods[bandIndex].endCcaBusy[thresholdIndex];
   if (isPrimaryChannel && (endCca > now))
     {
       NotifyMaybeCcaBusyStart (endCca - now);
@@ -186,6 +186,40 @@ public:
    * \return the delay since the secondary channel is determined idle
    */
   Time GetDelaySinceIdle (WifiSpectrumBand band, double ccaThreshold) const;
+  /**
+   * Return the time since all the bands of a group are determined idle.
+   * This only involves a lookup of the latest CCA busy end of the group,
+   * which is kept up to date whenever the CCA busy period of a band changes.
+   *
+   * \param groupIndex the index of the group as passed to SetCcaBandGroups
+   * \param ccaThreshold the threshold used to determine whether the bands are CCA_BUSY
+   *
+   * \return the delay since all the bands of the group are determined idle
+   */
+  Time GetDelaySinceIdle (std::size_t groupIndex, double ccaThreshold) const;
+  /**
+   * Set the groups of bands whose CCA busy periods are also tracked as a whole,
+   * e.g. the 40, 80 and 160 MHz channels that contain the primary channel.
+   *
+   * \param groups the bands of each group
+   */
+  void SetCcaBandGroups (const std::vector<std::vector<WifiSpectrumBand> > &groups);
+  /**
+   * \return the number of groups of bands set by SetCcaBandGroups
+   */
+  std::size_t GetNCcaBandGroups (void) const;
+  /**
+   * \return a counter that is incremented whenever the state or a CCA busy
+   *         period changes, hence whenever GetDelaySinceIdle may change for a given time
+   */
+  uint64_t GetStateVersion (void) const;
+  /**
+   * Stop tracking the CCA busy periods for the given threshold, e.g. because
+   * it is no longer used to determine the state of any band.
+   *
+   * \param ccaThreshold the CCA threshold (dBm)
+   */
+  void RemoveCcaThreshold (double ccaThreshold);
   /**
    * Return the time the last RX start.
    *
@@ -255,6 +289,17 @@ public:
    * \param ccaThreshold the threshold used to determine the channel is in CCA busy state
    */
   void SwitchMaybeToCcaBusy (Time duration, WifiSpectrumBand band, bool isPrimaryChannel, double ccaThreshold);
+  /**
+   * Switch a secondary channel to CCA busy for several CCA thresholds at once.
+   * Thresholds for which the duration is zero are left untouched.
+   *
+   * \param durations the duration of CCA busy state for each threshold
+   * \param band the band (not the primary channel) for which the CCA busy state is triggered
+   * \param ccaThresholds the thresholds used to determine the channel is in CCA busy state,
+   *        sorted in decreasing order
+   */
+  void SwitchMaybeToCcaBusy (const std::vector<Time> &durations, WifiSpectrumBand band,
+                             const std::vector<double> &ccaThresholds);
   /**
    * Switch to sleep mode.
    *
@@ -353,6 +398,72 @@ private:
    */
   void LogPreviousIdleAndCcaBusyStates (WifiSpectrumBand primaryBand, double primaryCcaThreshold);
 
+  /**
+   * Return the current state of WifiPhy given the end of the CCA busy period
+   * of the band and threshold of interest.
+   *
+   * \param endCcaBusy the end of the CCA busy period
+   *
+   * \return the current state of WifiPhy
+   */
+  WifiPhyState DoGetState (Time endCcaBusy) const;
+  /**
+   * Extend the CCA busy period of the given band and threshold.
+   *
+   * \param duration the duration of CCA busy state
+   * \param bandIndex the index of the band in m_ccaBusyPeriods
+   * \param thresholdIndex the index of the threshold in m_ccaThresholds
+   * \param isPrimaryChannel flag whether the band corresponds to the primary channel
+   */
+  void DoSwitchMaybeToCcaBusy (Time duration, std::size_t bandIndex, std::size_t thresholdIndex, bool isPrimaryChannel);
+  /**
+   * \param ccaThreshold the CCA threshold to look for
+   * \return the index of the threshold in m_ccaThresholds or the size of
+   *         m_ccaThresholds if the threshold is not tracked
+   */
+  std::size_t FindCcaThreshold (double ccaThreshold) const;
+  /**
+   * \param band the band to look for
+   * \return the index of the band in m_ccaBusyPeriods or the size of
+   *         m_ccaBusyPeriods if the band is not tracked
+   */
+  std::size_t FindCcaBand (WifiSpectrumBand band) const;
+  /**
+   * Start tracking the CCA busy periods for the given threshold, if not yet done.
+   *
+   * \param ccaThreshold the CCA threshold
+   * \return the index of the threshold in m_ccaThresholds
+   */
+  std::size_t AddCcaThreshold (double ccaThreshold);
+  /**
+   * Start tracking the CCA busy periods for the given band, if not yet done.
+   *
+   * \param band the band
+   * \return the index of the band in m_ccaBusyPeriods
+   */
+  std::size_t AddCcaBand (WifiSpectrumBand band);
+  /**
+   * Extend the end of the CCA busy period of the given band and threshold,
+   * as well as that of the groups the band belongs to.
+   *
+   * \param bandIndex the index of the band in m_ccaBusyPeriods
+   * \param thresholdIndex the index of the threshold in m_ccaThresholds
+   * \param endCcaBusy the new end of the CCA busy period
+   */
+  void ExtendCcaBusy (std::size_t bandIndex, std::size_t thresholdIndex, Time endCcaBusy);
+  /**
+   * \param band the band
+   * \param ccaThreshold the CCA threshold
+   * \return the start of the last CCA busy period of the band for the threshold
+   */
+  Time GetStartCcaBusy (WifiSpectrumBand band, double ccaThreshold) const;
+  /**
+   * \param band the band
+   * \param ccaThreshold the CCA threshold
+   * \return the end of the last CCA busy period of the band for the threshold
+   */
+  Time GetEndCcaBusy (WifiSpectrumBand band, double ccaThreshold) const;
+
   /**
    * Notify all WifiPhyListener that the transmission has started for the given duration.
    *
@@ -424,9 +535,21 @@ private:
   Time m_startSleep; ///< start sleep
   Time m_previousStateChangeTime; ///< previous state change time
 
-  std::map<std::pair <WifiSpectrumBand, int /* threshold */>, Time> m_startCcaBusy; ///< start CCA busy per channel
-  std::map<std::pair <WifiSpectrumBand, int /* threshold */>, Time> m_endCcaBusy; ///< end CCA busy per channel
-  //FIXME: thresholds should be double, but we need to implement std::find differently, so OK to round to int for now
+  /**
+   * CCA busy periods of a band, indexed like m_ccaThresholds
+   */
+  struct CcaBusyPeriods
+  {
+    WifiSpectrumBand band;          ///< the band
+    std::vector<Time> startCcaBusy; ///< start CCA busy per threshold
+    std::vector<Time> endCcaBusy;   ///< end CCA busy per threshold
+    std::vector<std::size_t> groups; ///< indices of the groups the band belongs to
+  };
+
+  std::vector<double> m_ccaThresholds; ///< CCA thresholds (dBm) in use, sorted in decreasing order
+  std::vector<CcaBusyPeriods> m_ccaBusyPeriods; ///< CCA busy periods per channel
+  std::vector<std::vector<Time> > m_groupEndCcaBusy; ///< latest end CCA busy per threshold, for each group of bands
+  uint64_t m_stateVersion; ///< incremented whenever the state or a CCA busy period changes
 
   Listeners m_listeners; ///< listeners
   TracedCallback<Ptr<const Packet>, double, WifiMode, WifiPreamble> m_rxOkTrace; ///< receive OK trace callback
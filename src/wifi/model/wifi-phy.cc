@@ -20,6 +20,8 @@
  */
 
 #include <algorithm>
+#include <functional>
+#include <unordered_map>
 #include "ns3/simulator.h"
 #include "ns3/log.h"
 #include "ns3/pointer.h"
@@ -420,6 +422,9 @@ WifiPhy::WifiPhy ()
     m_initialChannelNumber (0),
     m_wifiRadioEnergyModel (0),
     m_timeLastPreambleDetected (Seconds (0)),
+    m_ccaBandGroupsChannelWidth (0),
+    m_ccaBandGroupsFrequency (0),
+    m_ccaBandGroupsPrimaryChannel (0),
     m_ofdmaStarted (false)
 {
   NS_LOG_FUNCTION (this);
@@ -577,6 +582,12 @@ WifiPhy::AddCcaEdThresholdSecondary (double threshold)
   if (it == m_ccaEdThresholdsSecondaryW.end ())
     {
       m_ccaEdThresholdsSecondaryW.push_back (DbmToW (threshold));
+      auto sortedIt = std::lower_bound (m_sortedCcaEdThresholdsSecondaryW.begin (), m_sortedCcaEdThresholdsSecondaryW.end (),
+                                        DbmToW (threshold), std::greater<double> ());
+      std::size_t index = sortedIt - m_sortedCcaEdThresholdsSecondaryW.begin ();
+      m_sortedCcaEdThresholdsSecondaryW.insert (sortedIt, DbmToW (threshold));
+      //the state helper tracks thresholds by their dBm value as returned by WToDbm
+      m_sortedCcaEdThresholdsSecondaryDbm.insert (m_sortedCcaEdThresholdsSecondaryDbm.begin () + index, WToDbm (DbmToW (threshold)));
     }
 }
 
@@ -588,6 +599,16 @@ WifiPhy::RemoveCcaEdThresholdSecondary (double threshold)
   if (it != m_ccaEdThresholdsSecondaryW.end ())
     {
       m_ccaEdThresholdsSecondaryW.erase (it);
+      auto sortedIt = std::lower_bound (m_sortedCcaEdThresholdsSecondaryW.begin (), m_sortedCcaEdThresholdsSecondaryW.end (),
+                                        DbmToW (threshold), std::greater<double> ());
+      NS_ASSERT (sortedIt != m_sortedCcaEdThresholdsSecondaryW.end ());
+      m_sortedCcaEdThresholdsSecondaryDbm.erase (m_sortedCcaEdThresholdsSecondaryDbm.begin () + (sortedIt - m_sortedCcaEdThresholdsSecondaryW.begin ()));
+      m_sortedCcaEdThresholdsSecondaryW.erase (sortedIt);
+      if (DbmToW (threshold) != m_ccaEdThresholdW)
+        {
+          //reclaim the CCA state kept for this threshold, unless it is shared with the primary channel
+          m_state->RemoveCcaThreshold (WToDbm (DbmToW (threshold)));
+        }
     }
 }
 
@@ -859,6 +880,12 @@ WifiPhy::SetChannelBondingManager (const Ptr<ChannelBondingManager> manager)
   m_channelBondingManager->SetPhy (this);
 }
 
+Ptr<ChannelBondingManager>
+WifiPhy::GetChannelBondingManager (void) const
+{
+  return m_channelBondingManager;
+}
+
 void
 WifiPhy::SetPifs (Time pifs)
 {
@@ -1925,10 +1952,10 @@ WifiPhy::ResumeFromSleep (void)
               }
             else
               {
-                for (auto const& ccaEdThresholdSecondaryW : m_ccaEdThresholdsSecondaryW)
+                std::vector<Time> delaysUntilCcaEnd = m_interference.GetEnergyDurations (m_sortedCcaEdThresholdsSecondaryW, band);
+                for (std::size_t j = 0; j < delaysUntilCcaEnd.size (); j++)
                   {
-                    Time delayUntilCcaEnd = m_interference.GetEnergyDuration (ccaEdThresholdSecondaryW, band);
-                    m_state->SwitchFromSleep (delayUntilCcaEnd, band, isPrimary, WToDbm (ccaEdThresholdSecondaryW));
+                    m_state->SwitchFromSleep (delaysUntilCcaEnd[j], band, isPrimary, m_sortedCcaEdThresholdsSecondaryDbm[j]);
                   }
               }
           }
@@ -1974,10 +2001,10 @@ WifiPhy::ResumeFromOff (void)
               }
             else
               {
-                for (auto const& ccaEdThresholdSecondaryW : m_ccaEdThresholdsSecondaryW)
+                std::vector<Time> delaysUntilCcaEnd = m_interference.GetEnergyDurations (m_sortedCcaEdThresholdsSecondaryW, band);
+                for (std::size_t j = 0; j < delaysUntilCcaEnd.size (); j++)
                   {
-                    Time delayUntilCcaEnd = m_interference.GetEnergyDuration (ccaEdThresholdSecondaryW, band);
-                    m_state->SwitchFromOff (delayUntilCcaEnd, band, isPrimary, WToDbm (ccaEdThresholdSecondaryW));
+                    m_state->SwitchFromOff (delaysUntilCcaEnd[j], band, isPrimary, m_sortedCcaEdThresholdsSecondaryDbm[j]);
                   }
               }
           }
@@ -2423,13 +2450,62 @@ WifiPhy::GetPayloadDuration (uint32_t size, WifiTxVector txVector, uint16_t freq
   return GetPayloadDuration (size, txVector, frequency, mpdutype, false, totalAmpduSize, totalAmpduNumSymbols, staId);
 }
 
-Time
-WifiPhy::GetPayloadDuration (uint32_t size, WifiTxVector txVector, uint16_t frequency, MpduType mpdutype,
-                             bool incFlag, uint32_t &totalAmpduSize, double &totalAmpduNumSymbols,
-                             uint16_t staId)
+/**
+ * Parameters of the data field of a PPDU that only depend on the TXVECTOR
+ * (and not on the size of the PSDU)
+ */
+struct WifiPayloadParameters
+{
+  WifiModulationClass modClass; ///< the modulation class of the payload
+  double stbc;                  ///< 2 if STBC is used, 1 otherwise
+  double nes;                   ///< the number of BCC encoders
+  Time symbolDuration;          ///< the duration of an OFDM symbol
+  double numDataBitsPerSymbol;  ///< the number of data bits per OFDM symbol
+};
+
+/**
+ * Memoized payload parameters, indexed by the key computed by
+ * GetPayloadParametersKey. Since the TX duration functions of WifiPhy are
+ * static, the table is shared by all the PHYs of the simulation.
+ */
+static std::unordered_map<uint64_t, WifiPayloadParameters> g_wifiPayloadParametersMap;
+
+/**
+ * \param txVector the TXVECTOR
+ * \param staId the STA-ID of the PSDU
+ * \return a key identifying all the fields of the TXVECTOR the payload
+ *         parameters depend on
+ */
+static uint64_t
+GetPayloadParametersKey (const WifiTxVector &txVector, uint16_t staId)
+{
+  WifiMode payloadMode = txVector.GetMode (staId);
+  uint16_t rateWidth = txVector.GetChannelWidth ();
+  if (txVector.IsMu ())
+    {
+      rateWidth = HeRu::GetBandwidth (txVector.GetRu (staId).ruType);
+    }
+  NS_ASSERT (payloadMode.GetUid () < (1 << 16));
+  NS_ASSERT (txVector.GetChannelWidth () < (1 << 12) && rateWidth < (1 << 12));
+  return (static_cast<uint64_t> (payloadMode.GetUid ()) << 48)
+         | (static_cast<uint64_t> (txVector.GetChannelWidth ()) << 36)
+         | (static_cast<uint64_t> (rateWidth) << 24)
+         | (static_cast<uint64_t> (txVector.GetGuardInterval ()) << 8)
+         | (static_cast<uint64_t> (txVector.GetNss (staId) & 0x7f) << 1)
+         | (txVector.IsStbc () ? 1 : 0);
+}
+
+/**
+ * Compute the parameters of the data field of a PPDU from first principles.
+ *
+ * \param txVector the TXVECTOR
+ * \param staId the STA-ID of the PSDU
+ * \return the payload parameters
+ */
+static WifiPayloadParameters
+ComputePayloadParameters (const WifiTxVector &txVector, uint16_t staId)
 {
   WifiMode payloadMode = txVector.GetMode (staId);
-  NS_LOG_FUNCTION (size << payloadMode);
 
   double stbc = 1;
   if (txVector.IsStbc ()
@@ -2442,13 +2518,13 @@ WifiPhy::GetPayloadDuration (uint32_t size, WifiTxVector txVector, uint16_t freq
   double Nes = 1;
   //todo: improve logic to reduce the number of if cases
   //todo: extend to NSS > 4 for VHT rates
-  if (payloadMode == GetHtMcs21 ()
-      || payloadMode == GetHtMcs22 ()
-      || payloadMode == GetHtMcs23 ()
-      || payloadMode == GetHtMcs28 ()
-      || payloadMode == GetHtMcs29 ()
-      || payloadMode == GetHtMcs30 ()
-      || payloadMode == GetHtMcs31 ())
+  if (payloadMode == WifiPhy::GetHtMcs21 ()
+      || payloadMode == WifiPhy::GetHtMcs22 ()
+      || payloadMode == WifiPhy::GetHtMcs23 ()
+      || payloadMode == WifiPhy::GetHtMcs28 ()
+      || payloadMode == WifiPhy::GetHtMcs29 ()
+      || payloadMode == WifiPhy::GetHtMcs30 ()
+      || payloadMode == WifiPhy::GetHtMcs31 ())
     {
       Nes = 2;
     }
@@ -2597,7 +2673,46 @@ WifiPhy::GetPayloadDuration (uint32_t size, WifiTxVector txVector, uint16_t freq
       break;
     }
 
-  double numDataBitsPerSymbol = payloadMode.GetDataRate (txVector, staId) * symbolDuration.GetNanoSeconds () / 1e9;
+  WifiPayloadParameters params;
+  params.modClass = payloadMode.GetModulationClass ();
+  params.stbc = stbc;
+  params.nes = Nes;
+  params.symbolDuration = symbolDuration;
+  params.numDataBitsPerSymbol = payloadMode.GetDataRate (txVector, staId) * symbolDuration.GetNanoSeconds () / 1e9;
+  return params;
+}
+
+/**
+ * \param txVector the TXVECTOR
+ * \param staId the STA-ID of the PSDU
+ * \return the parameters of the data field, computed upon the first call
+ *         for a given combination of mode, widths, GI, NSS and STBC
+ */
+static const WifiPayloadParameters &
+GetPayloadParameters (const WifiTxVector &txVector, uint16_t staId)
+{
+  uint64_t key = GetPayloadParametersKey (txVector, staId);
+  std::unordered_map<uint64_t, WifiPayloadParameters>::const_iterator it = g_wifiPayloadParametersMap.find (key);
+  if (it == g_wifiPayloadParametersMap.end ())
+    {
+      it = g_wifiPayloadParametersMap.insert (std::make_pair (key, ComputePayloadParameters (txVector, staId))).first;
+    }
+  return it->second;
+}
+
+Time
+WifiPhy::GetPayloadDuration (uint32_t size, WifiTxVector txVector, uint16_t frequency, MpduType mpdutype,
+                             bool incFlag, uint32_t &totalAmpduSize, double &totalAmpduNumSymbols,
+                             uint16_t staId)
+{
+  WifiMode payloadMode = txVector.GetMode (staId);
+  NS_LOG_FUNCTION (size << payloadMode);
+
+  const WifiPayloadParameters &params = GetPayloadParameters (txVector, staId);
+  double stbc = params.stbc;
+  double Nes = params.nes;
+  Time symbolDuration = params.symbolDuration;
+  double numDataBitsPerSymbol = params.numDataBitsPerSymbol;
 
   double numSymbols = 0;
   if (mpdutype == FIRST_MPDU_IN_AGGREGATE)
@@ -2645,13 +2760,13 @@ WifiPhy::GetPayloadDuration (uint32_t size, WifiTxVector txVector, uint16_t freq
       NS_FATAL_ERROR ("Unknown MPDU type");
     }
 
-  switch (payloadMode.GetModulationClass ())
+  switch (params.modClass)
     {
     case WIFI_MOD_CLASS_OFDM:
     case WIFI_MOD_CLASS_ERP_OFDM:
       {
         //Add signal extension for ERP PHY
-        if (payloadMode.GetModulationClass () == WIFI_MOD_CLASS_ERP_OFDM)
+        if (params.modClass == WIFI_MOD_CLASS_ERP_OFDM)
           {
             return FemtoSeconds (static_cast<uint64_t> (numSymbols * symbolDuration.GetFemtoSeconds ())) + MicroSeconds (6);
           }
@@ -2663,7 +2778,7 @@ WifiPhy::GetPayloadDuration (uint32_t size, WifiTxVector txVector, uint16_t freq
     case WIFI_MOD_CLASS_HT:
     case WIFI_MOD_CLASS_VHT:
       {
-        if (payloadMode.GetModulationClass () == WIFI_MOD_CLASS_HT && Is2_4Ghz (frequency)
+        if (params.modClass == WIFI_MOD_CLASS_HT && Is2_4Ghz (frequency)
             && (mpdutype == NORMAL_MPDU || mpdutype == SINGLE_MPDU || mpdutype == LAST_MPDU_IN_AGGREGATE)) //at 2.4 GHz
           {
             return FemtoSeconds (static_cast<uint64_t> (numSymbols * symbolDuration.GetFemtoSeconds ())) + MicroSeconds (6);
@@ -2694,9 +2809,45 @@ WifiPhy::GetPayloadDuration (uint32_t size, WifiTxVector txVector, uint16_t freq
     }
 }
 
+/**
+ * Memoized durations of the PHY preamble and header of SU PPDUs, indexed
+ * by the key computed by GetPreambleAndHeaderKey.
+ */
+static std::unordered_map<uint64_t, Time> g_wifiPreambleAndHeaderDurationMap;
+
+/**
+ * \param txVector the TXVECTOR of an SU PPDU
+ * \return a key identifying all the fields of the TXVECTOR the duration of
+ *         the PHY preamble and header depends on
+ */
+static uint64_t
+GetPreambleAndHeaderKey (const WifiTxVector &txVector)
+{
+  NS_ASSERT (!txVector.IsMu ());
+  NS_ASSERT (txVector.GetMode ().GetUid () < (1 << 16));
+  NS_ASSERT (txVector.GetChannelWidth () < (1 << 12));
+  return (static_cast<uint64_t> (txVector.GetPreambleType ()) << 48)
+         | (static_cast<uint64_t> (txVector.GetMode ().GetUid ()) << 32)
+         | (static_cast<uint64_t> (txVector.GetChannelWidth ()) << 16)
+         | (static_cast<uint64_t> (txVector.GetNssMax ()) << 8)
+         | txVector.GetNess ();
+}
+
 Time
 WifiPhy::CalculatePlcpPreambleAndHeaderDuration (WifiTxVector txVector)
 {
+  //the duration of the HE-SIG-B field of MU PPDUs depends on the RU allocation,
+  //hence only the durations of SU PPDUs are memoized
+  uint64_t key = 0;
+  if (!txVector.IsMu ())
+    {
+      key = GetPreambleAndHeaderKey (txVector);
+      std::unordered_map<uint64_t, Time>::const_iterator it = g_wifiPreambleAndHeaderDurationMap.find (key);
+      if (it != g_wifiPreambleAndHeaderDurationMap.end ())
+        {
+          return it->second;
+        }
+    }
   WifiPreamble preamble = txVector.GetPreambleType ();
   Time duration = GetPlcpPreambleDuration (txVector)
     + GetPlcpHeaderDuration (txVector)
@@ -2705,9 +2856,21 @@ WifiPhy::CalculatePlcpPreambleAndHeaderDuration (WifiTxVector txVector)
     + GetPlcpSigA2Duration (preamble)
     + GetPlcpTrainingSymbolDuration (txVector)
     + GetPlcpSigBDuration (txVector);
+  if (!txVector.IsMu ())
+    {
+      g_wifiPreambleAndHeaderDurationMap.insert (std::make_pair (key, duration));
+    }
   return duration;
 }
 
+void
+WifiPhy::ClearTxDurationCache (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  g_wifiPayloadParametersMap.clear ();
+  g_wifiPreambleAndHeaderDurationMap.clear ();
+}
+
 Time
 WifiPhy::CalculateTxDuration (uint32_t size, WifiTxVector txVector, uint16_t frequency, uint16_t staId)
 {
@@ -3136,7 +3299,7 @@ WifiPhy::ContinueReceiveHeader (Ptr<Event> event)
 }
 
 void
-WifiPhy::StartReceivePreamble (Ptr<WifiPpdu> ppdu, RxPowerWattPerChannelBand rxPowersW)
+WifiPhy::StartReceivePreamble (Ptr<const WifiPpdu> ppdu, RxPowerWattPerChannelBand rxPowersW)
 {
   WifiTxVector txVector = ppdu->GetTxVector ();
   //The total RX power corresponds to the sum of the power in each involved 20 MHz band
@@ -3358,21 +3521,16 @@ WifiPhy::MaybeCcaBusy ()
         }
       else
         {
-          for (auto const& ccaEdThresholdSecondaryW : m_ccaEdThresholdsSecondaryW)
-            {
-              Time delayUntilCcaEnd = GetDelayUntilCcaEnd (ccaEdThresholdSecondaryW, band);
-              if (!delayUntilCcaEnd.IsZero ())
-                {
-                  NS_LOG_DEBUG ("Calling SwitchMaybeToCcaBusy for channel band " << +i << " for " << delayUntilCcaEnd.As (Time::S) << " using threshold " << WToDbm (ccaEdThresholdSecondaryW));
-                  m_state->SwitchMaybeToCcaBusy (delayUntilCcaEnd, band, isPrimary, WToDbm (ccaEdThresholdSecondaryW));
-                }
-            }
+          //a single walk of the band timeline gives the delays for all the thresholds
+          std::vector<Time> delaysUntilCcaEnd = m_interference.GetEnergyDurations (m_sortedCcaEdThresholdsSecondaryW, band);
+          NS_LOG_DEBUG ("Calling SwitchMaybeToCcaBusy for channel band " << +i << " using " << delaysUntilCcaEnd.size () << " thresholds");
+          m_state->SwitchMaybeToCcaBusy (delaysUntilCcaEnd, band, m_sortedCcaEdThresholdsSecondaryDbm);
         }
     }
 }
 
 void
-WifiPhy::StartReceiveOfdmaPayload (Ptr<WifiPpdu> ppdu, RxPowerWattPerChannelBand rxPowersW)
+WifiPhy::StartReceiveOfdmaPayload (Ptr<const WifiPpdu> ppdu, RxPowerWattPerChannelBand rxPowersW)
 {
   //The total RX power corresponds to the maximum over all the bands
   auto it = std::max_element (rxPowersW.begin (), rxPowersW.end (),
@@ -5119,10 +5277,58 @@ WifiPhy::GetLastRxStartTime (void) const
   return m_state->GetLastRxStartTime ();
 }
 
+void
+WifiPhy::UpdateCcaBandGroups (void)
+{
+  uint16_t channelWidth = GetChannelWidth ();
+  if (m_state->GetNCcaBandGroups () > 0
+      && channelWidth == m_ccaBandGroupsChannelWidth
+      && GetFrequency () == m_ccaBandGroupsFrequency
+      && GetPrimaryChannelNumber () == m_ccaBandGroupsPrimaryChannel)
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this);
+  std::vector<std::vector<WifiSpectrumBand> > groups;
+  uint8_t primaryIndex = GetPrimaryBandIndex (20);
+  for (uint16_t width = 40; width <= channelWidth; width *= 2)
+    {
+      uint8_t nBands = width / 20;
+      uint8_t startIndex = (primaryIndex / nBands) * nBands;
+      std::vector<WifiSpectrumBand> bands;
+      for (uint8_t i = startIndex; i < startIndex + nBands; i++)
+        {
+          bands.push_back (GetBand (20, i));
+        }
+      groups.push_back (bands);
+    }
+  m_state->SetCcaBandGroups (groups);
+  m_ccaBandGroupsChannelWidth = channelWidth;
+  m_ccaBandGroupsFrequency = GetFrequency ();
+  m_ccaBandGroupsPrimaryChannel = GetPrimaryChannelNumber ();
+}
+
+uint64_t
+WifiPhy::GetStateVersion (void) const
+{
+  return m_state->GetStateVersion ();
+}
+
 Time
 WifiPhy::GetDelaySinceChannelIsIdle (uint16_t channelWidth, double ccaThreshold)
 {
   NS_ASSERT (channelWidth <= GetChannelWidth ());
+  if (channelWidth >= 40)
+    {
+      //the state helper keeps track of the latest CCA busy end of the 40, 80 and 160 MHz channels
+      UpdateCcaBandGroups ();
+      std::size_t groupIndex = 0;
+      for (uint16_t width = 40; width < channelWidth; width *= 2)
+        {
+          groupIndex++;
+        }
+      return m_state->GetDelaySinceIdle (groupIndex, ccaThreshold);
+    }
   Time delaySinceIdle = Simulator::Now ();
   uint8_t nBands = channelWidth / 20;
   uint8_t index = (GetPrimaryBandIndex (20) / nBands);
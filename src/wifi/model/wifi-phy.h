@@ -161,7 +161,7 @@ public:
    * \param ppdu the arriving PPDU
    * \param rxPowersW the receive power in W per band
    */
-  void StartReceivePreamble (Ptr<WifiPpdu> ppdu, RxPowerWattPerChannelBand rxPowersW);
+  void StartReceivePreamble (Ptr<const WifiPpdu> ppdu, RxPowerWattPerChannelBand rxPowersW);
 
   /**
    * Start receiving the PHY header of a PPDU (i.e. after the end of receiving the preamble).
@@ -191,7 +191,7 @@ public:
    * \param ppdu the arriving PPDU
    * \param rxPowersW the receive power in W per band
    */
-  void StartReceiveOfdmaPayload (Ptr<WifiPpdu> ppdu, RxPowerWattPerChannelBand rxPowersW);
+  void StartReceiveOfdmaPayload (Ptr<const WifiPpdu> ppdu, RxPowerWattPerChannelBand rxPowersW);
 
   /**
    * The last symbol of the PPDU has arrived.
@@ -303,6 +303,12 @@ public:
    * \return the minimum delay among the bonded channels since they are in WifiPhy::IDLE.
    */
   Time GetDelaySinceChannelIsIdle (uint16_t channelWidth, double threshold);
+  /**
+   * \return a counter that is incremented whenever the PHY state or a CCA busy
+   *         period changes, hence whenever GetDelaySinceChannelIsIdle may change
+   *         for a given time
+   */
+  uint64_t GetStateVersion (void) const;
 
   /**
    * Return the start time of the last received packet.
@@ -350,8 +356,17 @@ public:
    * \param txVector the transmission parameters used for this packet
    *
    * \return the total amount of time this PHY will stay busy for the transmission of the PLCP preamble and PLCP header.
+   *
+   * The durations of SU PPDUs are memoized upon the first call for a given
+   * combination of preamble, mode, channel width, NSS and NESS.
    */
   static Time CalculatePlcpPreambleAndHeaderDuration (WifiTxVector txVector);
+  /**
+   * Discard the parameters memoized by CalculateTxDuration, GetPayloadDuration
+   * and CalculatePlcpPreambleAndHeaderDuration. The memoized parameters only
+   * depend on the TXVECTOR, hence this is only useful to tests.
+   */
+  static void ClearTxDurationCache (void);
   /**
    *
    * \return the preamble detection duration, which is the time correletion needs to detect the start of an incoming frame.
@@ -1698,6 +1713,12 @@ public:
    * \param channelBondingManager the channel bonding manager
    */
   void SetChannelBondingManager (const Ptr<ChannelBondingManager> channelBondingManager);
+  /**
+   * Return the channel bonding manager.
+   *
+   * \return the channel bonding manager, if any
+   */
+  Ptr<ChannelBondingManager> GetChannelBondingManager (void) const;
   /**
    * Sets the wifi radio energy model.
    *
@@ -1786,6 +1807,11 @@ protected:
    * class is higher than the CcaEdThreshold
    */
   void MaybeCcaBusy (void);
+  /**
+   * Make sure the state helper tracks the 40, 80 and 160 MHz channels that
+   * contain the primary channel for the current channel configuration.
+   */
+  void UpdateCcaBandGroups (void);
 
   /*
    * Reset data upon end of TX or RX
@@ -2198,6 +2224,8 @@ private:
   double   m_ccaEdThresholdW;          //!< Clear channel assessment (CCA) threshold for primary channel in watts
 
   std::vector<double> m_ccaEdThresholdsSecondaryW; //!< Clear channel assessment (CCA) thresholds for secondary channel(s) in watts
+  std::vector<double> m_sortedCcaEdThresholdsSecondaryW;   //!< Secondary CCA thresholds in watts, sorted in decreasing order
+  std::vector<double> m_sortedCcaEdThresholdsSecondaryDbm; //!< Secondary CCA thresholds in dBm, sorted in decreasing order
 
   double   m_txGainDb;       //!< Transmission gain (dB)
   double   m_rxGainDb;       //!< Reception gain (dB)
@@ -2241,6 +2269,10 @@ private:
   Time m_timeLastPreambleDetected; //!< Record the time the last preamble was detected
   Time m_pifs; //!< PCF Interframe Space (PIFS) duration
 
+  uint16_t m_ccaBandGroupsChannelWidth; //!< channel width (MHz) the groups of bands tracked by the state helper were computed for
+  uint16_t m_ccaBandGroupsFrequency;    //!< frequency (MHz) the groups of bands tracked by the state helper were computed for
+  uint8_t m_ccaBandGroupsPrimaryChannel; //!< primary channel number the groups of bands tracked by the state helper were computed for
+
   /**
    * A pair of a UID and STA_ID
    */
@@ -1116,11 +1116,12 @@ WifiRemoteStationManager::GetMostRecentRssi (Mac48Address address) const
 {
   double rssi = 0.0;
   Time mostRecentUpdateTime = NanoSeconds (0);
-  for (const auto & station : m_stations)
+  StationIndex::const_iterator it = m_stationIndex.find (address);
+  if (it != m_stationIndex.end ())
     {
-      if (station->m_state->m_address == address) //get most recent RSSI irrespective of TID
+      for (const auto & station : it->second.stations) //get most recent RSSI irrespective of TID
         {
-          if (station->m_rssiAndUpdateTimePair.second >= mostRecentUpdateTime)
+          if (station != 0 && station->m_rssiAndUpdateTimePair.second >= mostRecentUpdateTime)
             {
               rssi = station->m_rssiAndUpdateTimePair.first;
               mostRecentUpdateTime = station->m_rssiAndUpdateTimePair.second;
@@ -1131,17 +1132,28 @@ WifiRemoteStationManager::GetMostRecentRssi (Mac48Address address) const
   return rssi;
 }
 
+std::size_t
+WifiRemoteStationManager::Mac48AddressHash::operator() (const Mac48Address &address) const
+{
+  uint8_t buffer[6];
+  address.CopyTo (buffer);
+  uint64_t value = 0;
+  for (uint8_t i = 0; i < 6; i++)
+    {
+      value = (value << 8) | buffer[i];
+    }
+  return std::hash<uint64_t> () (value);
+}
+
 WifiRemoteStationState *
 WifiRemoteStationManager::LookupState (Mac48Address address) const
 {
   NS_LOG_FUNCTION (this << address);
-  for (StationStates::const_iterator i = m_states.begin (); i != m_states.end (); i++)
+  StationIndex::const_iterator it = m_stationIndex.find (address);
+  if (it != m_stationIndex.end ())
     {
-      if ((*i)->m_address == address)
-        {
-          NS_LOG_DEBUG ("WifiRemoteStationManager::LookupState returning existing state");
-          return (*i);
-        }
+      NS_LOG_DEBUG ("WifiRemoteStationManager::LookupState returning existing state");
+      return it->second.state;
     }
   WifiRemoteStationState *state = new WifiRemoteStationState ();
   state->m_state = WifiRemoteStationState::BRAND_NEW;
@@ -1157,6 +1169,10 @@ WifiRemoteStationManager::LookupState (Mac48Address address) const
   state->m_aggregation = false;
   state->m_qosSupported = false;
   const_cast<WifiRemoteStationManager *> (this)->m_states.push_back (state);
+  StationIndexEntry entry;
+  entry.state = state;
+  entry.stations.fill (0);
+  m_stationIndex.insert (std::make_pair (address, entry));
   NS_LOG_DEBUG ("WifiRemoteStationManager::LookupState returning new state");
   return state;
 }
@@ -1180,13 +1196,11 @@ WifiRemoteStation *
 WifiRemoteStationManager::Lookup (Mac48Address address, uint8_t tid) const
 {
   NS_LOG_FUNCTION (this << address << +tid);
-  for (Stations::const_iterator i = m_stations.begin (); i != m_stations.end (); i++)
+  NS_ASSERT (tid < 16);
+  StationIndex::iterator it = m_stationIndex.find (address);
+  if (it != m_stationIndex.end () && it->second.stations[tid] != 0)
     {
-      if ((*i)->m_tid == tid
-          && (*i)->m_state->m_address == address)
-        {
-          return (*i);
-        }
+      return it->second.stations[tid];
     }
   WifiRemoteStationState *state = LookupState (address);
 
@@ -1197,6 +1211,7 @@ WifiRemoteStationManager::Lookup (Mac48Address address, uint8_t tid) const
   station->m_slrc = 0;
   station->m_rssiAndUpdateTimePair = std::make_pair (0, Seconds (0));
   const_cast<WifiRemoteStationManager *> (this)->m_stations.push_back (station);
+  m_stationIndex.find (address)->second.stations[tid] = station;
   return station;
 }
 
@@ -1386,6 +1401,7 @@ WifiRemoteStationManager::Reset (void)
       delete (*i);
     }
   m_stations.clear ();
+  m_stationIndex.clear ();
   m_bssBasicRateSet.clear ();
   m_bssBasicMcsSet.clear ();
 }
@@ -21,6 +21,8 @@
 #ifndef WIFI_REMOTE_STATION_MANAGER_H
 #define WIFI_REMOTE_STATION_MANAGER_H
 
+#include <array>
+#include <unordered_map>
 #include "ns3/traced-callback.h"
 #include "ns3/object.h"
 #include "ns3/data-rate.h"
@@ -1332,8 +1334,29 @@ private:
   WifiModeList m_bssBasicRateSet; //!< basic rate set
   WifiModeList m_bssBasicMcsSet; //!< basic MCS set
 
+  /// Hash function of a Mac48Address
+  struct Mac48AddressHash
+  {
+    /**
+     * \param address the MAC address
+     * \return the hash of the MAC address
+     */
+    std::size_t operator() (const Mac48Address &address) const;
+  };
+
+  /// The state and the stations of each TID of a known remote station
+  struct StationIndexEntry
+  {
+    WifiRemoteStationState *state;                 //!< the state of the remote station
+    std::array<WifiRemoteStation *, 16> stations;  //!< the station of each TID, or 0 if not created yet
+  };
+
+  /// Typedef: remote station address, StationIndexEntry
+  typedef std::unordered_map<Mac48Address, StationIndexEntry, Mac48AddressHash> StationIndex;
+
   StationStates m_states;  //!< States of known stations
   Stations m_stations;     //!< Information for each known stations
+  mutable StationIndex m_stationIndex; //!< Index of m_states and m_stations by address
 
   WifiMode m_defaultTxMode; //!< The default transmission mode
   WifiMode m_defaultTxMcs;   //!< The default transmission modulation-coding scheme (MCS)
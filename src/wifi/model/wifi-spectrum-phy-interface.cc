@@ -109,4 +109,10 @@ WifiSpectrumPhyInterface::StartRx (Ptr<SpectrumSignalParameters> params)
   m_spectrumWifiPhy->StartRx (params);
 }
 
+bool
+WifiSpectrumPhyInterface::IsSharedPsdSupported () const
+{
+  return true;
+}
+
 } //namespace ns3
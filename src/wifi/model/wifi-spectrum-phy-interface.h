@@ -62,6 +62,7 @@ public:
   Ptr<const SpectrumModel> GetRxSpectrumModel () const;
   Ptr<AntennaModel> GetRxAntenna ();
   void StartRx (Ptr<SpectrumSignalParameters> params);
+  bool IsSharedPsdSupported () const;
 
 
 private:
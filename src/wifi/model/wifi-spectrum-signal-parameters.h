@@ -52,9 +52,10 @@ struct WifiSpectrumSignalParameters : public SpectrumSignalParameters
   WifiSpectrumSignalParameters (const WifiSpectrumSignalParameters& p);
 
   /**
-   * The PPDU being transmitted
+   * The PPDU being transmitted. It is shared by all the receivers of the
+   * signal, hence it must not be modified once transmitted.
    */
-  Ptr<WifiPpdu> ppdu;
+  Ptr<const WifiPpdu> ppdu;
 };
 
 }  // namespace ns3
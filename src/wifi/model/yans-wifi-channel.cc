@@ -21,6 +21,7 @@
 #include "ns3/simulator.h"
 #include "ns3/log.h"
 #include "ns3/pointer.h"
+#include "ns3/boolean.h"
 #include "ns3/net-device.h"
 #include "ns3/node.h"
 #include "ns3/propagation-loss-model.h"
@@ -53,11 +54,20 @@ YansWifiChannel::GetTypeId (void)
                    PointerValue (),
                    MakePointerAccessor (&YansWifiChannel::m_delay),
                    MakePointerChecker<PropagationDelayModel> ())
+    .AddAttribute ("CachePaths",
+                   "If true and the propagation loss and delay models are deterministic, "
+                   "the receive power and delay between a sender and a receiver are "
+                   "cached until either of them changes course. The models must not be "
+                   "reconfigured during the simulation.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&YansWifiChannel::m_cachePaths),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
 
 YansWifiChannel::YansWifiChannel ()
+  : m_cachePaths (false)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -66,6 +76,7 @@ YansWifiChannel::~YansWifiChannel ()
 {
   NS_LOG_FUNCTION (this);
   m_phyList.clear ();
+  m_pathCache.Clear ();
 }
 
 void
@@ -88,6 +99,7 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const WifiPpdu> ppdu, double
   NS_LOG_FUNCTION (this << sender << ppdu << txPowerDbm);
   Ptr<MobilityModel> senderMobility = sender->GetMobility ();
   NS_ASSERT (senderMobility != 0);
+  bool usePathCache = CheckPathCache ();
   for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++)
     {
       if (sender != (*i))
@@ -99,11 +111,33 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const WifiPpdu> ppdu, double
             }
 
           Ptr<MobilityModel> receiverMobility = (*i)->GetMobility ()->GetObject<MobilityModel> ();
-          Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
-          double rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
+          Time delay;
+          double rxPowerDbm;
+          PathData *path = 0;
+          if (usePathCache)
+            {
+              path = m_pathCache.Lookup (PeekPointer (sender), PeekPointer (*i), senderMobility, receiverMobility);
+            }
+          if (path != 0 && path->txPowerDbm == txPowerDbm)
+            {
+              delay = path->delay;
+              rxPowerDbm = path->rxPowerDbm;
+            }
+          else
+            {
+              delay = m_delay->GetDelay (senderMobility, receiverMobility);
+              rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
+              if (usePathCache)
+                {
+                  PathData computedPath;
+                  computedPath.txPowerDbm = txPowerDbm;
+                  computedPath.rxPowerDbm = rxPowerDbm;
+                  computedPath.delay = delay;
+                  m_pathCache.Add (PeekPointer (sender), PeekPointer (*i), senderMobility, receiverMobility, computedPath);
+                }
+            }
           NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
                         "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
-          Ptr<WifiPpdu> copy = Copy (ppdu);
           Ptr<NetDevice> dstNetDevice = (*i)->GetDevice ();
           uint32_t dstNode;
           if (dstNetDevice == 0)
@@ -117,13 +151,29 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const WifiPpdu> ppdu, double
 
           Simulator::ScheduleWithContext (dstNode,
                                           delay, &YansWifiChannel::Receive,
-                                          (*i), copy, rxPowerDbm);
+                                          (*i), ppdu, rxPowerDbm);
         }
     }
 }
 
+bool
+YansWifiChannel::CheckPathCache (void) const
+{
+  if (!m_cachePaths || !m_loss->IsDeterministic () || !m_delay->IsDeterministic ())
+    {
+      return false;
+    }
+  if (m_pathCacheLossModel != m_loss || m_pathCacheDelayModel != m_delay)
+    {
+      m_pathCache.Clear ();
+      m_pathCacheLossModel = m_loss;
+      m_pathCacheDelayModel = m_delay;
+    }
+  return true;
+}
+
 void
-YansWifiChannel::Receive (Ptr<YansWifiPhy> phy, Ptr<WifiPpdu> ppdu, double rxPowerDbm)
+YansWifiChannel::Receive (Ptr<YansWifiPhy> phy, Ptr<const WifiPpdu> ppdu, double rxPowerDbm)
 {
   NS_LOG_FUNCTION (phy << ppdu << rxPowerDbm);
   // Do no further processing if signal is too weak
@@ -134,7 +184,7 @@ YansWifiChannel::Receive (Ptr<YansWifiPhy> phy, Ptr<WifiPpdu> ppdu, double rxPow
       return;
     }
   RxPowerWattPerChannelBand rxPowerW;
-  rxPowerW.push_back (std::make_pair (std::make_pair (0, 0), (DbmToW (rxPowerDbm + phy->GetRxGain ())))); //dummy band for YANS
+  rxPowerW.Add (std::make_pair (0, 0), (DbmToW (rxPowerDbm + phy->GetRxGain ()))); //dummy band for YANS
   phy->StartReceivePreamble (ppdu, rxPowerW);
 }
 
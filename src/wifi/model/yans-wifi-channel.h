@@ -22,6 +22,8 @@
 #define YANS_WIFI_CHANNEL_H
 
 #include "ns3/channel.h"
+#include "ns3/nstime.h"
+#include "ns3/propagation-path-cache.h"
 
 namespace ns3 {
 
@@ -30,7 +32,6 @@ class PropagationLossModel;
 class PropagationDelayModel;
 class YansWifiPhy;
 class Packet;
-class Time;
 class WifiPpdu;
 
 /**
@@ -41,6 +42,11 @@ class WifiPpdu;
  * class and supports an ns3::PropagationLossModel and an
  * ns3::PropagationDelayModel.  By default, no propagation models are set;
  * it is the caller's responsibility to set them before using the channel.
+ *
+ * If the CachePaths attribute is enabled and both models are deterministic
+ * (see PropagationLossModel::IsDeterministic), the receive power and delay
+ * of each path are computed once per transmit power and reused until
+ * either end point changes course.
  */
 class YansWifiChannel : public Channel
 {
@@ -113,11 +119,32 @@ private:
    * \param ppdu the PPDU being sent
    * \param txPowerDbm the tx power associated to the packet being sent (dBm)
    */
-  static void Receive (Ptr<YansWifiPhy> receiver, Ptr<WifiPpdu> ppdu, double txPowerDbm);
+  static void Receive (Ptr<YansWifiPhy> receiver, Ptr<const WifiPpdu> ppdu, double txPowerDbm);
+
+  /// The receive power and delay of the path between a sender and a receiver
+  struct PathData
+  {
+    double txPowerDbm; //!< the transmit power (dBm) the receive power was computed for
+    double rxPowerDbm; //!< the receive power (dBm)
+    Time delay;        //!< the propagation delay
+  };
+
+  /**
+   * Check whether paths can be cached, and drop the cached paths if the
+   * models they were computed with have changed.
+   *
+   * \return true if the path cache can be used
+   */
+  bool CheckPathCache (void) const;
 
   PhyList m_phyList;                   //!< List of YansWifiPhys connected to this YansWifiChannel
   Ptr<PropagationLossModel> m_loss;    //!< Propagation loss model
   Ptr<PropagationDelayModel> m_delay;  //!< Propagation delay model
+
+  bool m_cachePaths;                                          //!< whether the receive power and delay of static paths are cached
+  mutable PropagationPathCache<PathData> m_pathCache;         //!< the cached paths
+  mutable Ptr<PropagationLossModel> m_pathCacheLossModel;     //!< the propagation loss model the cached paths were computed with
+  mutable Ptr<PropagationDelayModel> m_pathCacheDelayModel;   //!< the propagation delay model the cached paths were computed with
 };
 
 } //namespace ns3
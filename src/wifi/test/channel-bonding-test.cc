@@ -19,6 +19,8 @@
  */
 
 #include <algorithm>
+#include <fstream>
+#include <set>
 #include "ns3/log.h"
 #include "ns3/test.h"
 #include "ns3/uinteger.h"
@@ -41,6 +43,10 @@
 #include "ns3/non-communicating-net-device.h"
 #include "ns3/mobility-helper.h"
 #include "ns3/wifi-net-device.h"
+#include "ns3/wifi-mac.h"
+#include "ns3/ssid.h"
+#include "ns3/mobility-model.h"
+#include "ns3/channel-bonding-scenario-helper.h"
 
 using namespace ns3;
 
@@ -1769,6 +1775,159 @@ TestDynamicThresholdDynamicChannelBonding::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Dynamic threshold channel bonding thresholds set test
+ *
+ * This test checks that the CCA thresholds for the secondary channels set by the
+ * dynamic threshold channel bonding manager are rounded to the configured resolution
+ * and that the number of distinct thresholds, including the default one of the PHY,
+ * does not exceed the configured maximum, be they set before or after the PHY.
+ * It also checks that the CCA state of the default threshold is kept and that the
+ * thresholds are derived from the average RSSI of the last received beacons.
+ */
+class TestDynamicThresholdSet : public TestCase
+{
+public:
+  TestDynamicThresholdSet ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Check the CCA threshold used for a given mode
+   * \param manager the dynamic threshold channel bonding manager
+   * \param mode the WifiMode
+   * \param expectedThreshold the expected CCA threshold in dBm
+   */
+  void CheckThreshold (Ptr<DynamicThresholdChannelBondingManager> manager, WifiMode mode, double expectedThreshold);
+  /**
+   * Check the number of distinct CCA thresholds in use, including the default one of the PHY
+   * \param manager the dynamic threshold channel bonding manager
+   * \param phy the PHY
+   * \param maxThresholds the maximum number of distinct CCA thresholds
+   */
+  void CheckNThresholds (Ptr<DynamicThresholdChannelBondingManager> manager, Ptr<WifiPhy> phy, std::size_t maxThresholds);
+};
+
+TestDynamicThresholdSet::TestDynamicThresholdSet ()
+  : TestCase ("dynamic threshold channel bonding thresholds set test")
+{
+}
+
+void
+TestDynamicThresholdSet::CheckThreshold (Ptr<DynamicThresholdChannelBondingManager> manager, WifiMode mode, double expectedThreshold)
+{
+  CcaThresholdPerWifiModeValue value;
+  manager->GetAttribute ("CcaEdThresholdSecondaryMap", value);
+  CcaThresholdPerWifiModeMap thresholds = value.Get ();
+  auto it = thresholds.find (mode);
+  NS_TEST_ASSERT_MSG_EQ ((it != thresholds.end ()), true, "no CCA threshold set for " << mode);
+  NS_TEST_ASSERT_MSG_EQ_TOL (it->second, expectedThreshold, 1e-9, "unexpected CCA threshold for " << mode);
+}
+
+void
+TestDynamicThresholdSet::CheckNThresholds (Ptr<DynamicThresholdChannelBondingManager> manager, Ptr<WifiPhy> phy, std::size_t maxThresholds)
+{
+  CcaThresholdPerWifiModeValue value;
+  manager->GetAttribute ("CcaEdThresholdSecondaryMap", value);
+  std::set<double> thresholds;
+  thresholds.insert (std::round (WToDbm (phy->GetDefaultCcaEdThresholdSecondary ()) * 1e6) / 1e6);
+  for (auto const& threshold : value.Get ())
+    {
+      thresholds.insert (std::round (threshold.second * 1e6) / 1e6);
+    }
+  NS_TEST_ASSERT_MSG_LT_OR_EQ (thresholds.size (), maxThresholds, "too many distinct CCA thresholds");
+}
+
+void
+TestDynamicThresholdSet::DoRun (void)
+{
+  Ptr<SpectrumWifiPhy> phy = CreateObject<SpectrumWifiPhy> ();
+  phy->ConfigureStandard (WIFI_PHY_STANDARD_80211ac);
+  Ptr<DynamicThresholdChannelBondingManager> manager = CreateObject<DynamicThresholdChannelBondingManager> ();
+  manager->SetAttribute ("CcaEdThresholdSecondaryResolution", DoubleValue (0.5));
+  manager->SetAttribute ("MaxCcaEdThresholdsSecondary", UintegerValue (3));
+  phy->SetChannelBondingManager (manager);
+  //the PHY has tracked a CCA busy period for its default threshold
+  WifiSpectrumBand band = std::make_pair (0, 63);
+  phy->GetState ()->SwitchMaybeToCcaBusy (Seconds (1), band, false, WToDbm (DbmToW (-72.0)));
+
+  //thresholds are rounded to the resolution
+  manager->SetCcaEdThresholdSecondaryForMode (WifiPhy::GetVhtMcs0 (), -72.3);
+  CheckThreshold (manager, WifiPhy::GetVhtMcs0 (), -72.5);
+  manager->SetCcaEdThresholdSecondaryForMode (WifiPhy::GetVhtMcs1 (), -72.2);
+  CheckThreshold (manager, WifiPhy::GetVhtMcs1 (), -72.0);
+  manager->SetCcaEdThresholdSecondaryForMode (WifiPhy::GetVhtMcs2 (), -80.1);
+  CheckThreshold (manager, WifiPhy::GetVhtMcs2 (), -80.0);
+
+  //the maximum number of thresholds, counting the default one, is reached: the closest one is reused
+  manager->SetCcaEdThresholdSecondaryForMode (WifiPhy::GetVhtMcs3 (), -60);
+  CheckThreshold (manager, WifiPhy::GetVhtMcs3 (), -72.0);
+  manager->SetCcaEdThresholdSecondaryForMode (WifiPhy::GetVhtMcs4 (), -79);
+  CheckThreshold (manager, WifiPhy::GetVhtMcs4 (), -80.0);
+  manager->SetCcaEdThresholdSecondaryForMode (WifiPhy::GetVhtMcs5 (), -85);
+  CheckThreshold (manager, WifiPhy::GetVhtMcs5 (), -80.0);
+  CheckNThresholds (manager, phy, 3);
+
+  //the threshold that is no longer used frees a slot
+  manager->SetCcaEdThresholdSecondaryForMode (WifiPhy::GetVhtMcs0 (), -90.2);
+  CheckThreshold (manager, WifiPhy::GetVhtMcs0 (), -90.0);
+
+  CheckNThresholds (manager, phy, 3);
+
+  //the modes using the default threshold move away from it: its CCA state is kept
+  manager->SetCcaEdThresholdSecondaryForMode (WifiPhy::GetVhtMcs1 (), -90);
+  manager->SetCcaEdThresholdSecondaryForMode (WifiPhy::GetVhtMcs3 (), -90);
+  CheckThreshold (manager, WifiPhy::GetVhtMcs1 (), -90.0);
+  NS_TEST_ASSERT_MSG_EQ (phy->GetState ()->GetDelayUntilIdle (band, -72.0), Seconds (1),
+                         "the CCA state of the default threshold should not have been removed");
+
+  //the thresholds configured before the PHY is set are capped as well
+  Ptr<SpectrumWifiPhy> otherPhy = CreateObject<SpectrumWifiPhy> ();
+  otherPhy->ConfigureStandard (WIFI_PHY_STANDARD_80211ac);
+  Ptr<DynamicThresholdChannelBondingManager> otherManager = CreateObject<DynamicThresholdChannelBondingManager> ();
+  otherManager->SetAttribute ("MaxCcaEdThresholdsSecondary", UintegerValue (3));
+  CcaThresholdPerWifiModeMap configuredThresholds;
+  configuredThresholds[WifiPhy::GetVhtMcs0 ()] = -62;
+  configuredThresholds[WifiPhy::GetVhtMcs1 ()] = -66;
+  configuredThresholds[WifiPhy::GetVhtMcs2 ()] = -82;
+  configuredThresholds[WifiPhy::GetVhtMcs3 ()] = -86;
+  otherManager->SetAttribute ("CcaEdThresholdSecondaryMap", CcaThresholdPerWifiModeValue (configuredThresholds));
+  otherPhy->SetChannelBondingManager (otherManager);
+  CheckNThresholds (otherManager, otherPhy, 3);
+  CheckThreshold (otherManager, WifiPhy::GetVhtMcs0 (), -62.0);
+  CheckThreshold (otherManager, WifiPhy::GetVhtMcs1 (), -66.0);
+  CheckThreshold (otherManager, WifiPhy::GetVhtMcs2 (), -72.0);
+  CheckThreshold (otherManager, WifiPhy::GetVhtMcs3 (), -72.0);
+
+  //thresholds follow the RSSI of the beacons, averaged over the last two beacons
+  Ptr<SpectrumWifiPhy> staPhy = CreateObject<SpectrumWifiPhy> ();
+  staPhy->ConfigureStandard (WIFI_PHY_STANDARD_80211ac);
+  Ptr<DynamicThresholdChannelBondingManager> staManager = CreateObject<DynamicThresholdChannelBondingManager> ();
+  staManager->SetAttribute ("BeaconRssiWindowSize", UintegerValue (2));
+  staManager->SetAttribute ("RequiredSinrPerMcs", StringValue ("0,10.5"));
+  staPhy->SetChannelBondingManager (staManager);
+  staManager->NotifyBeaconRssi (-50);
+  CheckThreshold (staManager, WifiPhy::GetVhtMcs0 (), -50.0);
+  CheckThreshold (staManager, WifiPhy::GetVhtMcs1 (), -60.5);
+  staManager->NotifyBeaconRssi (-60);
+  CheckThreshold (staManager, WifiPhy::GetVhtMcs0 (), -55.0);
+  CheckThreshold (staManager, WifiPhy::GetVhtMcs1 (), -65.5);
+  staManager->NotifyBeaconRssi (-70);
+  CheckThreshold (staManager, WifiPhy::GetVhtMcs0 (), -65.0);
+  CheckThreshold (staManager, WifiPhy::GetVhtMcs1 (), -75.5);
+
+  phy->Dispose ();
+  manager->Dispose ();
+  otherPhy->Dispose ();
+  otherManager->Dispose ();
+  staPhy->Dispose ();
+  staManager->Dispose ();
+}
+
 /**
  * \ingroup wifi-test
  * \ingroup tests
@@ -2967,6 +3126,371 @@ TestStaticChannelBondingChannelAccess::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Channel bonding scenario helper test
+ *
+ * This test loads a table of three BSSs from a file, installs them with the
+ * ChannelBondingScenarioHelper and checks the configuration of every node.
+ */
+class TestChannelBondingScenarioHelper : public TestCase
+{
+public:
+  TestChannelBondingScenarioHelper ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Check the configuration of a device
+   * \param device the device
+   * \param bss the parameters of the BSS of the device
+   * \param ssid the expected SSID
+   */
+  void CheckDevice (Ptr<NetDevice> device, const ChannelBondingScenarioHelper::BssParameters &bss, Ssid ssid);
+};
+
+TestChannelBondingScenarioHelper::TestChannelBondingScenarioHelper ()
+  : TestCase ("channel bonding scenario helper test")
+{
+}
+
+void
+TestChannelBondingScenarioHelper::CheckDevice (Ptr<NetDevice> device, const ChannelBondingScenarioHelper::BssParameters &bss, Ssid ssid)
+{
+  Ptr<WifiNetDevice> wifiDevice = DynamicCast<WifiNetDevice> (device);
+  Ptr<WifiPhy> phy = wifiDevice->GetPhy ();
+  NS_TEST_EXPECT_MSG_EQ (+phy->GetChannelNumber (), +bss.channelNumber, "unexpected channel");
+  NS_TEST_EXPECT_MSG_EQ (+phy->GetPrimaryChannelNumber (), +bss.primaryChannelNumber, "unexpected primary channel");
+  NS_TEST_EXPECT_MSG_EQ_TOL (phy->GetCcaEdThreshold (), bss.ccaEdThresholdPrimary, 1e-9, "unexpected CCA threshold on the primary channel");
+  Ptr<ConstantThresholdChannelBondingManager> manager =
+    DynamicCast<ConstantThresholdChannelBondingManager> (phy->GetChannelBondingManager ());
+  NS_TEST_EXPECT_MSG_EQ_TOL (manager->GetCcaEdThresholdSecondary (), bss.ccaEdThresholdSecondary, 1e-9, "unexpected CCA threshold on the secondary channels");
+  UintegerValue maxAmpduSize;
+  wifiDevice->GetMac ()->GetAttribute ("BE_MaxAmpduSize", maxAmpduSize);
+  NS_TEST_EXPECT_MSG_EQ (maxAmpduSize.Get (), bss.maxAmpduSize, "unexpected maximum A-MPDU size");
+  NS_TEST_EXPECT_MSG_EQ (wifiDevice->GetMac ()->GetSsid (), ssid, "unexpected SSID");
+}
+
+void
+TestChannelBondingScenarioHelper::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("bss-table.txt");
+  std::ofstream os (filename.c_str ());
+  os << "# three BSSs, the last one with the default MCS and CCA thresholds" << std::endl
+     << "apX apY nStations staX staY radius channel primaryChannel mcs    ccaEdThresholdPrimary ccaEdThresholdSecondary uplink maxAmpduSize" << std::endl
+     << "0   0   2         0    5    0      38      36             VhtMcs3 -62                   -72                     10     131071" << std::endl
+     << std::endl
+     << "20  0   3         0    0    4      38      40             VhtMcs5 -70                   -75                     20     65535" << std::endl
+     << "0   20  1         0    0    0      42      44             IdealWifi -62                 -62                     0      0" << std::endl;
+  os.close ();
+
+  ChannelBondingScenarioHelper scenario;
+  scenario.LoadBssTable (filename);
+  NS_TEST_ASSERT_MSG_EQ (scenario.GetNBss (), 3, "unexpected number of BSSs");
+  NS_TEST_EXPECT_MSG_EQ (scenario.GetBss (1).uplinkMbps, 20, "unexpected uplink load");
+  NS_TEST_EXPECT_MSG_EQ (scenario.GetBss (1).downlinkMbps, 0, "unexpected default downlink load");
+
+  SpectrumWifiPhyHelper phy = SpectrumWifiPhyHelper::Default ();
+  phy.SetChannel (CreateObject<MultiModelSpectrumChannel> ());
+  WifiHelper wifi;
+  wifi.SetStandard (WIFI_PHY_STANDARD_80211ac);
+  wifi.SetChannelBondingManager ("ns3::ConstantThresholdChannelBondingManager");
+  NodeContainer nodes = scenario.Install (phy, wifi, 100);
+  NS_TEST_ASSERT_MSG_EQ (nodes.GetN (), 9, "unexpected number of nodes");
+  NS_TEST_ASSERT_MSG_EQ (scenario.GetApDevices ().GetN (), 3, "unexpected number of APs");
+
+  //the APs come first, followed by the stations of every BSS in turn
+  uint32_t nodeIndex = 3;
+  for (std::size_t i = 0; i < scenario.GetNBss (); ++i)
+    {
+      const ChannelBondingScenarioHelper::BssParameters &bss = scenario.GetBss (i);
+      Ssid ssid ("network-" + std::to_string (i));
+      NS_TEST_EXPECT_MSG_EQ (nodes.Get (i), scenario.GetApNodes ().Get (i), "unexpected AP node");
+      CheckDevice (scenario.GetApDevices ().Get (i), bss, ssid);
+      Vector apPosition = nodes.Get (i)->GetObject<MobilityModel> ()->GetPosition ();
+      NS_TEST_EXPECT_MSG_EQ_TOL (CalculateDistance (apPosition, bss.apPosition), 0, 1e-9, "unexpected AP position");
+
+      NetDeviceContainer staDevices = scenario.GetStaDevices (i);
+      NS_TEST_ASSERT_MSG_EQ (staDevices.GetN (), bss.nStations, "unexpected number of stations");
+      for (uint16_t j = 0; j < bss.nStations; ++j, ++nodeIndex)
+        {
+          NS_TEST_EXPECT_MSG_EQ (nodes.Get (nodeIndex), scenario.GetStaNodes (i).Get (j), "unexpected station node");
+          CheckDevice (staDevices.Get (j), bss, ssid);
+          Vector center = bss.apPosition + bss.stationOffset;
+          double distance = CalculateDistance (nodes.Get (nodeIndex)->GetObject<MobilityModel> ()->GetPosition (), center);
+          NS_TEST_EXPECT_MSG_LT_OR_EQ (distance, bss.stationRadius + 1e-9, "station out of its disc");
+        }
+    }
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Usable channel width memoization test
+ *
+ * This test checks that the channel width selected by a channel bonding manager,
+ * which is memoized as long as neither the time nor the PHY state changes, follows
+ * the changes of the channel width, of PIFS and of the CCA thresholds tracked by the
+ * PHY state helper occurring at the same time.
+ */
+class TestUsableChannelWidthMemo : public TestCase
+{
+public:
+  TestUsableChannelWidthMemo ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Mark the secondary 40 MHz channel of the 80 MHz channel as CCA busy
+   */
+  void SetSecondary40Busy (void);
+  /**
+   * Check the channel width selected by the channel bonding manager, after
+   * optionally reconfiguring the PHY
+   * \param channelWidth the channel width (MHz) to configure, zero to keep the current one
+   * \param pifs PIFS to configure, zero to keep the current one
+   * \param removeThreshold whether to remove the CCA threshold of the secondary channels from the PHY state helper
+   * \param expectedWidth the expected channel width (MHz)
+   */
+  void CheckUsableWidth (uint16_t channelWidth, Time pifs, bool removeThreshold, uint16_t expectedWidth);
+
+  Ptr<BondingTestSpectrumWifiPhy> m_phy;                ///< the PHY
+  Ptr<ConstantThresholdChannelBondingManager> m_manager; ///< the channel bonding manager
+};
+
+TestUsableChannelWidthMemo::TestUsableChannelWidthMemo ()
+  : TestCase ("usable channel width memoization test")
+{
+}
+
+void
+TestUsableChannelWidthMemo::SetSecondary40Busy (void)
+{
+  for (uint8_t i = 2; i < 4; i++)
+    {
+      m_phy->GetState ()->SwitchMaybeToCcaBusy (MicroSeconds (10), m_phy->GetBand (20, i), false, -72.0);
+    }
+}
+
+void
+TestUsableChannelWidthMemo::CheckUsableWidth (uint16_t channelWidth, Time pifs, bool removeThreshold, uint16_t expectedWidth)
+{
+  if (channelWidth > 0)
+    {
+      m_phy->SetChannelWidth (channelWidth);
+    }
+  if (pifs.IsStrictlyPositive ())
+    {
+      m_phy->SetPifs (pifs);
+    }
+  if (removeThreshold)
+    {
+      m_phy->GetState ()->RemoveCcaThreshold (-72.0);
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_manager->GetUsableChannelWidth (WifiPhy::GetVhtMcs0 ()), expectedWidth,
+                         "unexpected usable channel width at " << Simulator::Now ().As (Time::US));
+}
+
+void
+TestUsableChannelWidthMemo::DoRun (void)
+{
+  m_phy = CreateObject<BondingTestSpectrumWifiPhy> ();
+  m_phy->ConfigureStandard (WIFI_PHY_STANDARD_80211ac);
+  m_phy->CreateWifiSpectrumPhyInterface (nullptr);
+  m_phy->SetChannel (CreateObject<MultiModelSpectrumChannel> ());
+  m_phy->SetErrorRateModel (CreateObject<NistErrorRateModel> ());
+  m_phy->SetChannelWidth (80);
+  m_phy->SetChannelNumber (42);
+  m_phy->SetPrimaryChannelNumber (36);
+  m_phy->SetFrequency (5210);
+  m_phy->SetPifs (MicroSeconds (25));
+  m_phy->Initialize ();
+  m_manager = CreateObject<ConstantThresholdChannelBondingManager> ();
+  m_manager->SetAttribute ("CcaEdThresholdSecondary", DoubleValue (-72.0));
+  m_phy->SetChannelBondingManager (m_manager);
+
+  //the secondary 40 MHz channel has been idle for 30 us when the widths are checked
+  Simulator::Schedule (Seconds (1), &TestUsableChannelWidthMemo::SetSecondary40Busy, this);
+  Time check = Seconds (1) + MicroSeconds (40);
+  //idle for more than PIFS: the whole channel is usable
+  Simulator::Schedule (check, &TestUsableChannelWidthMemo::CheckUsableWidth, this, 0, Seconds (0), false, 80);
+  //narrower channel
+  Simulator::Schedule (check, &TestUsableChannelWidthMemo::CheckUsableWidth, this, 40, Seconds (0), false, 40);
+  Simulator::Schedule (check, &TestUsableChannelWidthMemo::CheckUsableWidth, this, 80, Seconds (0), false, 80);
+  //idle for less than PIFS: only the primary 40 MHz channel is usable
+  Simulator::Schedule (check, &TestUsableChannelWidthMemo::CheckUsableWidth, this, 0, MicroSeconds (35), false, 40);
+  //the CCA state of the threshold is no longer tracked: the whole channel is usable
+  Simulator::Schedule (check, &TestUsableChannelWidthMemo::CheckUsableWidth, this, 0, Seconds (0), true, 80);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  m_phy->Dispose ();
+  m_manager->Dispose ();
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief CCA busy state per band and threshold
+ *
+ * This test checks that the CCA busy periods tracked by the PHY state helper
+ * for each band and CCA threshold do not depend on how the thresholds are
+ * registered. A first state helper is given the CCA busy durations one threshold
+ * at a time, in no particular order, as WifiPhy does for the primary channel.
+ * A second state helper is given them for all the thresholds of a band at once,
+ * sorted in decreasing order, as WifiPhy does for the secondary channels, once
+ * some of the thresholds have already been registered out of order. Both are
+ * checked against the end of the CCA busy periods tracked per band and threshold,
+ * as was done before the thresholds were sorted.
+ */
+class TestCcaThresholdsPerBand : public TestCase
+{
+public:
+  TestCcaThresholdsPerBand ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Report CCA busy durations for a band to both state helpers.
+   *
+   * \param band the band
+   * \param durations the CCA busy durations along with their CCA threshold (dBm), in no particular order
+   */
+  void SwitchMaybeToCcaBusy (WifiSpectrumBand band, std::vector<std::pair<double, Time> > durations);
+  /**
+   * Report a CCA busy duration for a single threshold to both state helpers.
+   *
+   * \param threshold the CCA threshold (dBm)
+   */
+  void RegisterCcaThreshold (double threshold);
+  /**
+   * Check the state of both state helpers for every band and threshold.
+   */
+  void CheckCcaBusy (void);
+
+  Ptr<WifiPhyStateHelper> m_oneByOne;                 ///< state helper given one threshold at a time
+  Ptr<WifiPhyStateHelper> m_batch;                    ///< state helper given all the thresholds at once
+  WifiSpectrumBands m_bands;                          ///< the bands
+  std::vector<double> m_thresholds;                   ///< the CCA thresholds (dBm)
+  std::map<std::pair<WifiSpectrumBand, double>, Time> m_endCcaBusy; ///< expected end of the CCA busy period per band and threshold
+};
+
+TestCcaThresholdsPerBand::TestCcaThresholdsPerBand ()
+  : TestCase ("CCA busy state per band and threshold test")
+{
+}
+
+void
+TestCcaThresholdsPerBand::SwitchMaybeToCcaBusy (WifiSpectrumBand band, std::vector<std::pair<double, Time> > durations)
+{
+  for (auto const& duration : durations)
+    {
+      if (duration.second.IsStrictlyPositive ())
+        {
+          m_oneByOne->SwitchMaybeToCcaBusy (duration.second, band, false, duration.first);
+          Time &endCcaBusy = m_endCcaBusy[std::make_pair (band, duration.first)];
+          endCcaBusy = Max (endCcaBusy, Simulator::Now () + duration.second);
+        }
+    }
+  std::sort (durations.begin (), durations.end (),
+             [] (const std::pair<double, Time> &a, const std::pair<double, Time> &b) { return a.first > b.first; });
+  std::vector<double> thresholds;
+  std::vector<Time> delays;
+  for (auto const& duration : durations)
+    {
+      //thresholds converted back and forth between dBm and W are the same thresholds
+      thresholds.push_back (WToDbm (DbmToW (duration.first)));
+      delays.push_back (duration.second);
+    }
+  m_batch->SwitchMaybeToCcaBusy (delays, band, thresholds);
+}
+
+void
+TestCcaThresholdsPerBand::RegisterCcaThreshold (double threshold)
+{
+  Time duration = MicroSeconds (2);
+  m_oneByOne->SwitchMaybeToCcaBusy (duration, m_bands[2], false, threshold);
+  m_batch->SwitchMaybeToCcaBusy (duration, m_bands[2], false, threshold);
+  m_endCcaBusy[std::make_pair (m_bands[2], threshold)] = Simulator::Now () + duration;
+}
+
+void
+TestCcaThresholdsPerBand::CheckCcaBusy (void)
+{
+  Time now = Simulator::Now ();
+  for (auto const& band : m_bands)
+    {
+      for (auto const& threshold : m_thresholds)
+        {
+          Time endCcaBusy = m_endCcaBusy[std::make_pair (band, threshold)];
+          Time expectedDelayUntilIdle = Max (endCcaBusy - now, Seconds (0));
+          Time expectedDelaySinceIdle = now - endCcaBusy;
+          WifiPhyState expectedState = (endCcaBusy > now) ? WifiPhyState::CCA_BUSY : WifiPhyState::IDLE;
+          for (auto const& helper : {m_oneByOne, m_batch})
+            {
+              std::string name = (helper == m_oneByOne) ? "one by one" : "batch";
+              NS_TEST_EXPECT_MSG_EQ (helper->GetDelayUntilIdle (band, threshold), expectedDelayUntilIdle,
+                                     "Unexpected delay until idle (" << name << ") at " << now << " for band ("
+                                     << band.first << "; " << band.second << ") and threshold " << threshold);
+              NS_TEST_EXPECT_MSG_EQ (helper->GetDelaySinceIdle (band, threshold), expectedDelaySinceIdle,
+                                     "Unexpected delay since idle (" << name << ") at " << now << " for band ("
+                                     << band.first << "; " << band.second << ") and threshold " << threshold);
+              NS_TEST_EXPECT_MSG_EQ (helper->GetState (band, threshold), expectedState,
+                                     "Unexpected state (" << name << ") at " << now << " for band ("
+                                     << band.first << "; " << band.second << ") and threshold " << threshold);
+            }
+        }
+    }
+}
+
+void
+TestCcaThresholdsPerBand::DoRun (void)
+{
+  m_oneByOne = CreateObject<WifiPhyStateHelper> ();
+  m_batch = CreateObject<WifiPhyStateHelper> ();
+  m_bands = {std::make_pair (0, 63), std::make_pair (64, 127), std::make_pair (128, 191)};
+  //two of the thresholds are close to one another
+  m_thresholds = {-62, -82, -72, -65.5, -90, -72.5};
+
+  //some thresholds are registered out of order before the first batch
+  for (auto const& threshold : {-72.0, -90.0, -62.0})
+    {
+      Simulator::Schedule (MicroSeconds (1), &TestCcaThresholdsPerBand::RegisterCcaThreshold, this, threshold);
+    }
+
+  for (uint32_t step = 0; step < 30; step++)
+    {
+      std::vector<std::pair<double, Time> > durations;
+      for (std::size_t i = 0; i < m_thresholds.size (); i++)
+        {
+          //rotate the thresholds so that they are reported in a different order at each step,
+          //some of them being not busy
+          double threshold = m_thresholds[(i + step) % m_thresholds.size ()];
+          uint32_t duration = (step * 13 + i * 7) % 25;
+          durations.push_back (std::make_pair (threshold, MicroSeconds (duration % 5 == 0 ? 0 : duration)));
+        }
+      Time start = MicroSeconds (5 + step * 6);
+      Simulator::Schedule (start, &TestCcaThresholdsPerBand::SwitchMaybeToCcaBusy, this, m_bands[step % m_bands.size ()], durations);
+      Simulator::Schedule (start, &TestCcaThresholdsPerBand::CheckCcaBusy, this);
+      Simulator::Schedule (start + MicroSeconds (3), &TestCcaThresholdsPerBand::CheckCcaBusy, this);
+    }
+  Simulator::Schedule (MicroSeconds (2), &TestCcaThresholdsPerBand::CheckCcaBusy, this);
+  Simulator::Schedule (MicroSeconds (200), &TestCcaThresholdsPerBand::CheckCcaBusy, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  m_oneByOne->Dispose ();
+  m_batch->Dispose ();
+}
+
 /**
  * \ingroup wifi-test
  * \ingroup tests
@@ -2986,7 +3510,11 @@ WifiChannelBondingTestSuite::WifiChannelBondingTestSuite ()
   AddTestCase (new TestStaticChannelBondingChannelAccess, TestCase::QUICK);
   AddTestCase (new TestConstantThresholdDynamicChannelBonding, TestCase::QUICK);
   AddTestCase (new TestDynamicThresholdDynamicChannelBonding, TestCase::QUICK);
+  AddTestCase (new TestDynamicThresholdSet, TestCase::QUICK);
+  AddTestCase (new TestCcaThresholdsPerBand, TestCase::QUICK);
+  AddTestCase (new TestUsableChannelWidthMemo, TestCase::QUICK);
   AddTestCase (new TestEffectiveSnrCalculations, TestCase::QUICK);
+  AddTestCase (new TestChannelBondingScenarioHelper, TestCase::QUICK);
 }
 
 static WifiChannelBondingTestSuite wifiChannelBondingTestSuite; ///< the test suite
@@ -32,6 +32,7 @@
 #include "ns3/wifi-psdu.h"
 #include "ns3/wifi-ppdu.h"
 #include "ns3/wifi-utils.h"
+#include "ns3/interference-helper.h"
 
 using namespace ns3;
 
@@ -47,6 +48,14 @@ class ExtSpectrumWifiPhy : public SpectrumWifiPhy
 public:
   using SpectrumWifiPhy::SpectrumWifiPhy;
   using SpectrumWifiPhy::GetBand;
+
+  /**
+   * \return the HE RU bands of the RF filter bank
+   */
+  const WifiSpectrumBands & GetRuBands (void) const
+  {
+    return m_ruFilterBands;
+  }
 };
 
 /**
@@ -408,7 +417,9 @@ SpectrumWifiPhyFilterTest::RxCallback (Ptr<const Packet> p, RxPowerWattPerChanne
       NS_LOG_INFO ("band: (" << pair.first.first << ";" << pair.first.second << ") -> powerW=" << pair.second << " (" << WToDbm (pair.second) << " dBm)");
     }
 
-  size_t numBands = rxPowersW.size ();
+  //The power of the RU bands is only computed upon access, hence only the 20 MHz bands are provided upfront
+  NS_TEST_ASSERT_MSG_EQ (rxPowersW.GetNBands (), static_cast<std::size_t> (std::max (1, (m_rxChannelWidth / 20))), "Number of bands provided upfront is incorrect");
+  size_t numBands = rxPowersW.GetNBands () + m_rxPhy->GetRuBands ().size ();
   size_t expectedNumBands = std::max (1, (m_rxChannelWidth / 20));
   if (m_rxChannelWidth == 20)
     {
@@ -440,6 +451,21 @@ SpectrumWifiPhyFilterTest::RxCallback (Ptr<const Packet> p, RxPowerWattPerChanne
     }
   NS_TEST_ASSERT_MSG_EQ (numBands, expectedNumBands, "Total number of bands handled by the receiver is incorrect");
 
+  //The power computed upon access for an RU band must match the power obtained by filtering the received PSDs upfront
+  uint16_t rxChannelWidth = m_rxPhy->GetChannelWidth ();
+  for (auto const& ruBand : m_rxPhy->GetRuBands ())
+    {
+      Ptr<SpectrumValue> filter = WifiSpectrumValueHelper::CreateRfFilter (m_rxPhy->GetFrequency (), rxChannelWidth, m_rxPhy->GetBandBandwidth (),
+                                                                           m_rxPhy->GetGuardBandwidth (rxChannelWidth), ruBand);
+      double expectedPowerW = 0.0;
+      for (auto const& psd : rxPowersW.GetPowerSpectralDensities ())
+        {
+          expectedPowerW += Integral ((*filter) * (*psd.first)) * psd.second;
+        }
+      NS_TEST_ASSERT_MSG_EQ_TOL (rxPowersW.GetRxPowerW (ruBand), expectedPowerW, expectedPowerW * 1e-12,
+                                 "Incorrect power for RU band (" << ruBand.first << "; " << ruBand.second << ")");
+    }
+
   uint16_t channelWidth = std::min (m_txChannelWidth, m_rxChannelWidth);
   double totalPowerW = 0.0;
   WifiSpectrumBand band;
@@ -660,6 +686,478 @@ SpectrumWifiPhyFilterTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Spectrum Wifi Phy Band Power Test
+ *
+ * Check that the power integrated over a band by WifiSpectrumValueHelper::GetBandPowerW
+ * matches the integral of the power spectral density filtered by the RF filter of that band.
+ */
+class SpectrumWifiPhyBandPowerTest : public TestCase
+{
+public:
+  SpectrumWifiPhyBandPowerTest ();
+
+private:
+  virtual void DoRun (void);
+};
+
+SpectrumWifiPhyBandPowerTest::SpectrumWifiPhyBandPowerTest ()
+  : TestCase ("SpectrumWifiPhy test band power integration")
+{
+}
+
+void
+SpectrumWifiPhyBandPowerTest::DoRun (void)
+{
+  uint32_t centerFrequency = 5570;
+  uint16_t channelWidth = 160;
+  uint32_t bandBandwidth = 78125;
+  uint16_t guardBandwidth = channelWidth;
+  Ptr<SpectrumValue> psd = WifiSpectrumValueHelper::CreateHeOfdmTxPowerSpectralDensity (centerFrequency, channelWidth, 0.1, guardBandwidth);
+  uint32_t numBands = psd->GetSpectrumModel ()->GetNumBands ();
+  uint32_t numBandsPer20MHz = static_cast<uint32_t> (20e6 / bandBandwidth);
+
+  WifiSpectrumBands bands;
+  for (uint32_t start = 0; start + numBandsPer20MHz <= numBands; start += numBandsPer20MHz)
+    {
+      bands.push_back (std::make_pair (start, start + numBandsPer20MHz - 1));
+    }
+  bands.push_back (std::make_pair (0, 0));
+  bands.push_back (std::make_pair (numBands / 2, numBands / 2));
+  bands.push_back (std::make_pair (numBands - 1, numBands - 1));
+  bands.push_back (std::make_pair (0, numBands - 1));
+
+  for (auto const& band : bands)
+    {
+      Ptr<SpectrumValue> filter = WifiSpectrumValueHelper::CreateRfFilter (centerFrequency, channelWidth, bandBandwidth, guardBandwidth, band);
+      double expectedPowerW = Integral ((*filter) * (*psd));
+      double powerW = WifiSpectrumValueHelper::GetBandPowerW (psd, band);
+      NS_TEST_ASSERT_MSG_EQ_TOL (powerW, expectedPowerW, expectedPowerW * 1e-12, "Incorrect power for band (" << band.first << "; " << band.second << ")");
+    }
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Spectrum Wifi Phy Band Id Power Test
+ *
+ * Check that the received power looked up by band ID matches the received
+ * power looked up by band, for the bands provided upfront as well as for the
+ * bands integrated from the received PSDs, including once the power of
+ * another signal has been added up.
+ */
+class SpectrumWifiPhyBandIdPowerTest : public TestCase
+{
+public:
+  SpectrumWifiPhyBandIdPowerTest ();
+
+private:
+  virtual void DoRun (void);
+};
+
+SpectrumWifiPhyBandIdPowerTest::SpectrumWifiPhyBandIdPowerTest ()
+  : TestCase ("SpectrumWifiPhy test received power lookup by band ID")
+{
+}
+
+void
+SpectrumWifiPhyBandIdPowerTest::DoRun (void)
+{
+  uint32_t centerFrequency = 5570;
+  uint16_t channelWidth = 160;
+  uint32_t bandBandwidth = 78125;
+  uint16_t guardBandwidth = channelWidth;
+  Ptr<SpectrumValue> psd1 = WifiSpectrumValueHelper::CreateHeOfdmTxPowerSpectralDensity (centerFrequency, channelWidth, 0.1, guardBandwidth);
+  Ptr<SpectrumValue> psd2 = WifiSpectrumValueHelper::CreateHeOfdmTxPowerSpectralDensity (centerFrequency, channelWidth, 0.02, guardBandwidth);
+  uint32_t numBands = psd1->GetSpectrumModel ()->GetNumBands ();
+  uint32_t numBandsPer20MHz = static_cast<uint32_t> (20e6 / bandBandwidth);
+
+  Ptr<WifiBandIndex> bandIndex = Create<WifiBandIndex> ();
+  RxPowerWattPerChannelBand rxPower1;
+  RxPowerWattPerChannelBand rxPower2;
+  for (uint32_t start = 0; start + numBandsPer20MHz <= numBands; start += numBandsPer20MHz)
+    {
+      WifiSpectrumBand band = std::make_pair (start, start + numBandsPer20MHz - 1);
+      NS_TEST_ASSERT_MSG_EQ (bandIndex->Add (band), rxPower1.GetNBands (), "Unexpected band ID");
+      rxPower1.Add (band, WifiSpectrumValueHelper::GetBandPowerW (psd1, band));
+      rxPower2.Add (band, WifiSpectrumValueHelper::GetBandPowerW (psd2, band));
+    }
+  rxPower1.SetPowerSpectralDensity (psd1, 1.0);
+  rxPower2.SetPowerSpectralDensity (psd2, 1.0);
+  for (uint32_t start = 0; start + 26 <= numBands; start += 26)
+    {
+      bandIndex->Add (std::make_pair (start, start + 25));
+    }
+
+  Ptr<RxPowerWattPerBandId> rxPowerPerBandId1 = Create<RxPowerWattPerBandId> (rxPower1, bandIndex);
+  Ptr<RxPowerWattPerBandId> rxPowerPerBandId2 = Create<RxPowerWattPerBandId> (rxPower2, bandIndex);
+  NS_TEST_ASSERT_MSG_EQ (rxPowerPerBandId1->GetNBands (), rxPower1.GetNBands (), "Unexpected number of bands provided upfront");
+  // look up one band out of two before adding up the powers, so that both
+  // memoized and not yet computed bands are added up
+  for (std::size_t bandId = 0; bandId < bandIndex->GetNBands (); bandId += 2)
+    {
+      WifiSpectrumBand band = bandIndex->GetBand (bandId);
+      NS_TEST_ASSERT_MSG_EQ (bandIndex->GetId (band), bandId, "Unexpected band ID");
+      NS_TEST_ASSERT_MSG_EQ_TOL (rxPowerPerBandId1->GetRxPowerW (bandId), rxPower1.GetRxPowerW (band), 1e-15,
+                                 "Incorrect power for band (" << band.first << "; " << band.second << ")");
+    }
+  Ptr<RxPowerWattPerBandId> sum = rxPowerPerBandId1->Sum (*rxPowerPerBandId2);
+  for (std::size_t bandId = 0; bandId < bandIndex->GetNBands (); ++bandId)
+    {
+      WifiSpectrumBand band = bandIndex->GetBand (bandId);
+      double expectedPowerW = rxPower1.GetRxPowerW (band) + rxPower2.GetRxPowerW (band);
+      NS_TEST_ASSERT_MSG_EQ_TOL (sum->GetRxPowerW (bandId), expectedPowerW, 1e-15,
+                                 "Incorrect summed power for band (" << band.first << "; " << band.second << ")");
+      NS_TEST_ASSERT_MSG_EQ_TOL (rxPowerPerBandId1->GetRxPowerW (bandId), rxPower1.GetRxPowerW (band), 1e-15,
+                                 "Adding up powers should not modify the terms");
+    }
+
+  RxPowerWattPerChannelBand rxPowerPerBand = sum->GetRxPowerWPerBand ();
+  NS_TEST_ASSERT_MSG_EQ (rxPowerPerBand.GetNBands (), rxPower1.GetNBands (), "Unexpected number of bands provided upfront");
+  for (std::size_t bandId = 0; bandId < bandIndex->GetNBands (); ++bandId)
+    {
+      WifiSpectrumBand band = bandIndex->GetBand (bandId);
+      NS_TEST_ASSERT_MSG_EQ_TOL (rxPowerPerBand.GetRxPowerW (band), sum->GetRxPowerW (bandId), 1e-15,
+                                 "Incorrect power per band for band (" << band.first << "; " << band.second << ")");
+    }
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Spectrum Wifi Phy Lazy Band Test
+ *
+ * Check that the SNR computed by an InterferenceHelper whose RU bands are lazy
+ * matches the one computed by an InterferenceHelper tracking all bands from
+ * the start, when the medium never gets idle for long enough for the lazy
+ * bands to be reset. Some lazy bands are only looked at once the operations
+ * logged for them have been trimmed, when the receiver is not receiving, or
+ * once more operations than the interference helper logs have occurred, when
+ * the receiver keeps receiving.
+ */
+class SpectrumWifiPhyLazyBandTest : public TestCase
+{
+public:
+  /**
+   * Constructor
+   *
+   * \param receiving whether the receiver keeps receiving until most signals have been added
+   */
+  SpectrumWifiPhyLazyBandTest (bool receiving);
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Add the k-th signal to both interference helpers.
+   *
+   * \param k the index of the signal
+   */
+  void AddSignal (uint32_t k);
+  /**
+   * Notify both interference helpers of the end of a reception.
+   */
+  void NotifyRxEnd (void);
+  /**
+   * Check that both interference helpers yield the same SNR for the given
+   * bands, for the last signal that has been added.
+   *
+   * \param bands the bands to check
+   */
+  void CheckSnr (WifiSpectrumBands bands);
+
+  bool m_receiving;                          ///< whether the receiver keeps receiving until most signals have been added
+  InterferenceHelper m_lazy;                 ///< interference helper with lazy RU bands
+  InterferenceHelper m_eager;                ///< interference helper tracking all bands
+  WifiSpectrumBand m_channelBand;            ///< the band covering the whole channel
+  WifiSpectrumBands m_ruBands;               ///< the RU bands
+  std::vector<Ptr<Event> > m_lazyEvents;     ///< events added to the interference helper with lazy RU bands
+  std::vector<Ptr<Event> > m_eagerEvents;    ///< events added to the interference helper tracking all bands
+};
+
+SpectrumWifiPhyLazyBandTest::SpectrumWifiPhyLazyBandTest (bool receiving)
+  : TestCase (std::string ("SpectrumWifiPhy test lazy RU bands against eager RU bands") + (receiving ? " while receiving" : "")),
+    m_receiving (receiving)
+{
+}
+
+void
+SpectrumWifiPhyLazyBandTest::AddSignal (uint32_t k)
+{
+  Time duration = MicroSeconds (200);
+  Ptr<const SpectrumValue> psd = WifiSpectrumValueHelper::CreateHeOfdmTxPowerSpectralDensity (FREQUENCY, CHANNEL_WIDTH, 0.01 * (1 + k % 7), GUARD_WIDTH);
+  RxPowerWattPerChannelBand lazyRxPower;
+  RxPowerWattPerChannelBand eagerRxPower;
+  lazyRxPower.Add (m_channelBand, WifiSpectrumValueHelper::GetBandPowerW (psd, m_channelBand));
+  lazyRxPower.SetPowerSpectralDensity (psd, 1.0);
+  eagerRxPower.Add (m_channelBand, WifiSpectrumValueHelper::GetBandPowerW (psd, m_channelBand));
+  for (auto const& band : m_ruBands)
+    {
+      eagerRxPower.Add (band, WifiSpectrumValueHelper::GetBandPowerW (psd, band));
+    }
+  Ptr<WifiPpdu> ppdu = Create<WifiPpdu> (Create<WifiPsdu> (Create<Packet> (0), WifiMacHeader ()),
+                                         WifiTxVector (), duration, 0, UINT64_MAX);
+  m_lazyEvents.push_back (m_lazy.Add (ppdu, WifiTxVector (), duration, lazyRxPower));
+  m_eagerEvents.push_back (m_eager.Add (ppdu, WifiTxVector (), duration, eagerRxPower));
+
+  if (k % 7 == 3)
+    {
+      //scale the power of the signal up, as is done for UL MU PPDUs
+      m_lazy.UpdateEvent (m_lazyEvents.back (), lazyRxPower);
+      m_eager.UpdateEvent (m_eagerEvents.back (), eagerRxPower);
+    }
+  if (m_receiving ? (k == 0) : (k % 300 == 0))
+    {
+      m_lazy.NotifyRxStart ();
+      m_eager.NotifyRxStart ();
+    }
+  if (m_receiving ? (k == 900) : (k % 300 == 0))
+    {
+      Simulator::Schedule (duration, &SpectrumWifiPhyLazyBandTest::NotifyRxEnd, this);
+    }
+}
+
+void
+SpectrumWifiPhyLazyBandTest::NotifyRxEnd (void)
+{
+  m_lazy.NotifyRxEnd (Simulator::Now ());
+  m_eager.NotifyRxEnd (Simulator::Now ());
+}
+
+void
+SpectrumWifiPhyLazyBandTest::CheckSnr (WifiSpectrumBands bands)
+{
+  for (auto const& band : bands)
+    {
+      double expectedSnr = m_eager.CalculateSnr (m_eagerEvents.back (), CHANNEL_WIDTH, band);
+      double snr = m_lazy.CalculateSnr (m_lazyEvents.back (), CHANNEL_WIDTH, band);
+      NS_TEST_EXPECT_MSG_EQ_TOL (snr, expectedSnr, expectedSnr * 1e-9,
+                                 "Incorrect SNR at " << Simulator::Now ().As (Time::US)
+                                 << " in band (" << band.first << "; " << band.second << ")");
+    }
+}
+
+void
+SpectrumWifiPhyLazyBandTest::DoRun (void)
+{
+  Ptr<const SpectrumValue> psd = WifiSpectrumValueHelper::CreateHeOfdmTxPowerSpectralDensity (FREQUENCY, CHANNEL_WIDTH, 0.01, GUARD_WIDTH);
+  uint32_t numBands = psd->GetSpectrumModel ()->GetNumBands ();
+  m_channelBand = std::make_pair (0, numBands - 1);
+  m_ruBands.clear ();
+  for (uint32_t start = numBands / 4; start + 26 <= 3 * numBands / 4; start += 26)
+    {
+      m_ruBands.push_back (std::make_pair (start, start + 25));
+    }
+  NS_ASSERT (m_ruBands.size () > 3);
+  m_lazy.AddBand (m_channelBand);
+  m_eager.AddBand (m_channelBand);
+  for (auto const& band : m_ruBands)
+    {
+      m_lazy.AddBand (band, true);
+      m_eager.AddBand (band);
+    }
+
+  //the signals overlap one another, hence the lazy bands are never reset
+  uint32_t numSignals = 1200;
+  for (uint32_t k = 0; k < numSignals; ++k)
+    {
+      Simulator::Schedule (MicroSeconds (k), &SpectrumWifiPhyLazyBandTest::AddSignal, this, k);
+    }
+  //only the first RU band is looked at early on...
+  WifiSpectrumBands firstBand (m_ruBands.begin (), m_ruBands.begin () + 1);
+  Simulator::Schedule (MicroSeconds (400) + NanoSeconds (1), &SpectrumWifiPhyLazyBandTest::CheckSnr, this, firstBand);
+  Simulator::Schedule (MicroSeconds (800) + NanoSeconds (1), &SpectrumWifiPhyLazyBandTest::CheckSnr, this, firstBand);
+  //...along with two others, each while the signals are added outside of a reception...
+  Simulator::Schedule (MicroSeconds (250) + NanoSeconds (1), &SpectrumWifiPhyLazyBandTest::CheckSnr, this, WifiSpectrumBands (1, m_ruBands[1]));
+  Simulator::Schedule (MicroSeconds (550) + NanoSeconds (1), &SpectrumWifiPhyLazyBandTest::CheckSnr, this, WifiSpectrumBands (1, m_ruBands[2]));
+  //...the others are materialized once the log has been trimmed or, when receiving,
+  //once it is full, while the signals whose operations have been logged last are still on
+  Simulator::Schedule (MicroSeconds (1000) + NanoSeconds (1), &SpectrumWifiPhyLazyBandTest::CheckSnr, this, m_ruBands);
+  Simulator::Schedule (MicroSeconds (numSignals - 1) + NanoSeconds (1), &SpectrumWifiPhyLazyBandTest::CheckSnr, this, m_ruBands);
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Spectrum Wifi Phy Event Power Test
+ *
+ * Check the received power of an event of the InterferenceHelper when RU bands
+ * overlap the 20 MHz bands: the total power only adds up the 20 MHz bands,
+ * updating the event adds up the power of the update, and erasing the events
+ * leaves no energy on the medium.
+ */
+class SpectrumWifiPhyEventPowerTest : public TestCase
+{
+public:
+  SpectrumWifiPhyEventPowerTest ();
+
+private:
+  virtual void DoRun (void);
+};
+
+SpectrumWifiPhyEventPowerTest::SpectrumWifiPhyEventPowerTest ()
+  : TestCase ("SpectrumWifiPhy test received power of interference events")
+{
+}
+
+void
+SpectrumWifiPhyEventPowerTest::DoRun (void)
+{
+  uint32_t centerFrequency = 5190;
+  uint16_t channelWidth = 40;
+  Ptr<const SpectrumValue> psd1 = WifiSpectrumValueHelper::CreateHeOfdmTxPowerSpectralDensity (centerFrequency, channelWidth, 0.1, channelWidth);
+  Ptr<const SpectrumValue> psd2 = WifiSpectrumValueHelper::CreateHeOfdmTxPowerSpectralDensity (centerFrequency, channelWidth, 0.02, channelWidth);
+  uint32_t numBands = psd1->GetSpectrumModel ()->GetNumBands ();
+  uint32_t numBandsPer20MHz = static_cast<uint32_t> (20e6 / 78125);
+  uint32_t start = (numBands - 2 * numBandsPer20MHz) / 2;
+  WifiSpectrumBands channelBands;
+  channelBands.push_back (std::make_pair (start, start + numBandsPer20MHz - 1));
+  channelBands.push_back (std::make_pair (start + numBandsPer20MHz, start + 2 * numBandsPer20MHz - 1));
+  //RU bands overlapping both 20 MHz bands
+  WifiSpectrumBands ruBands;
+  ruBands.push_back (std::make_pair (start + 10, start + 35));
+  ruBands.push_back (std::make_pair (start, start + 2 * numBandsPer20MHz - 1));
+
+  InterferenceHelper interference;
+  for (auto const& band : channelBands)
+    {
+      interference.AddBand (band);
+    }
+  for (auto const& band : ruBands)
+    {
+      interference.AddBand (band, true);
+    }
+  RxPowerWattPerChannelBand rxPower1;
+  RxPowerWattPerChannelBand rxPower2;
+  for (auto const& band : channelBands)
+    {
+      rxPower1.Add (band, WifiSpectrumValueHelper::GetBandPowerW (psd1, band));
+      rxPower2.Add (band, WifiSpectrumValueHelper::GetBandPowerW (psd2, band));
+    }
+  rxPower1.SetPowerSpectralDensity (psd1, 1.0);
+  rxPower2.SetPowerSpectralDensity (psd2, 1.0);
+  Time duration = MicroSeconds (100);
+  Ptr<WifiPpdu> ppdu = Create<WifiPpdu> (Create<WifiPsdu> (Create<Packet> (0), WifiMacHeader ()),
+                                         WifiTxVector (), duration, 0, UINT64_MAX);
+  Ptr<Event> event = interference.Add (ppdu, WifiTxVector (), duration, rxPower1);
+
+  //the RU bands overlap the 20 MHz bands, hence their power is not added up,
+  //even once they have been computed
+  double expectedPowerW = rxPower1.GetRxPowerW (channelBands[0]) + rxPower1.GetRxPowerW (channelBands[1]);
+  for (auto const& band : ruBands)
+    {
+      NS_TEST_ASSERT_MSG_EQ_TOL (event->GetRxPowerW (band), rxPower1.GetRxPowerW (band), 1e-15,
+                                 "Incorrect power for band (" << band.first << "; " << band.second << ")");
+    }
+  NS_TEST_ASSERT_MSG_EQ_TOL (event->GetRxPowerW (), expectedPowerW, expectedPowerW * 1e-12, "The total power should only add up the 20 MHz bands");
+
+  //updating the event adds up the power of the update in every band, rather than doubling the previous power
+  interference.UpdateEvent (event, rxPower2);
+  for (auto const& band : channelBands)
+    {
+      double expectedBandPowerW = rxPower1.GetRxPowerW (band) + rxPower2.GetRxPowerW (band);
+      NS_TEST_ASSERT_MSG_EQ_TOL (event->GetRxPowerW (band), expectedBandPowerW, expectedBandPowerW * 1e-12,
+                                 "Incorrect updated power for band (" << band.first << "; " << band.second << ")");
+    }
+  for (auto const& band : ruBands)
+    {
+      double expectedBandPowerW = rxPower1.GetRxPowerW (band) + rxPower2.GetRxPowerW (band);
+      NS_TEST_ASSERT_MSG_EQ_TOL (event->GetRxPowerW (band), expectedBandPowerW, expectedBandPowerW * 1e-12,
+                                 "Incorrect updated power for RU band (" << band.first << "; " << band.second << ")");
+    }
+  expectedPowerW += rxPower2.GetRxPowerW (channelBands[0]) + rxPower2.GetRxPowerW (channelBands[1]);
+  NS_TEST_ASSERT_MSG_EQ_TOL (event->GetRxPowerW (), expectedPowerW, expectedPowerW * 1e-12, "Incorrect updated total power");
+
+  //erasing the events leaves no energy on the medium, be the bands lazy or not
+  NS_TEST_ASSERT_MSG_EQ (interference.GetEnergyDuration (DbmToW (-62), channelBands[0]), duration, "Energy should be detected until the end of the event");
+  interference.EraseEvents ();
+  for (auto const& band : channelBands)
+    {
+      NS_TEST_ASSERT_MSG_EQ (interference.GetEnergyDuration (DbmToW (-62), band), MicroSeconds (0),
+                             "No energy should be left in band (" << band.first << "; " << band.second << ")");
+    }
+  for (auto const& band : ruBands)
+    {
+      NS_TEST_ASSERT_MSG_EQ (interference.GetEnergyDuration (DbmToW (-62), band), MicroSeconds (0),
+                             "No energy should be left in RU band (" << band.first << "; " << band.second << ")");
+    }
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Spectrum Wifi Phy Tx PSD Cache Test
+ *
+ * Check that WifiSpectrumValueHelper::GetTxPowerSpectralDensity shares the
+ * transmit PSDs built for identical parameters, that they match the ones
+ * built by the Create functions, and that the least recently used PSDs are
+ * evicted first.
+ */
+class SpectrumWifiPhyTxPsdCacheTest : public TestCase
+{
+public:
+  SpectrumWifiPhyTxPsdCacheTest ();
+
+private:
+  virtual void DoRun (void);
+};
+
+SpectrumWifiPhyTxPsdCacheTest::SpectrumWifiPhyTxPsdCacheTest ()
+  : TestCase ("SpectrumWifiPhy test transmit PSD cache")
+{
+}
+
+void
+SpectrumWifiPhyTxPsdCacheTest::DoRun (void)
+{
+  WifiSpectrumValueHelper::ClearTxPowerSpectralDensityCache ();
+
+  Ptr<const SpectrumValue> psd = WifiSpectrumValueHelper::GetTxPowerSpectralDensity (WifiSpectrumValueHelper::TX_PSD_HE_OFDM, FREQUENCY, CHANNEL_WIDTH, 0.1, GUARD_WIDTH);
+  Ptr<SpectrumValue> expected = WifiSpectrumValueHelper::CreateHeOfdmTxPowerSpectralDensity (FREQUENCY, CHANNEL_WIDTH, 0.1, GUARD_WIDTH);
+  NS_TEST_ASSERT_MSG_EQ (psd->GetSpectrumModelUid (), expected->GetSpectrumModelUid (), "Unexpected spectrum model");
+  NS_TEST_ASSERT_MSG_EQ (std::equal (psd->ConstValuesBegin (), psd->ConstValuesEnd (), expected->ConstValuesBegin ()), true, "Cached PSD differs from the created one");
+  NS_TEST_ASSERT_MSG_EQ (WifiSpectrumValueHelper::GetTxPowerSpectralDensity (WifiSpectrumValueHelper::TX_PSD_HE_OFDM, FREQUENCY, CHANNEL_WIDTH, 0.1, GUARD_WIDTH),
+                         psd, "The PSD should have been reused");
+
+  // changing the transmit mask yields another PSD
+  Ptr<const SpectrumValue> otherMask = WifiSpectrumValueHelper::GetTxPowerSpectralDensity (WifiSpectrumValueHelper::TX_PSD_HE_OFDM, FREQUENCY, CHANNEL_WIDTH, 0.1, GUARD_WIDTH, -30, -38, -50);
+  expected = WifiSpectrumValueHelper::CreateHeOfdmTxPowerSpectralDensity (FREQUENCY, CHANNEL_WIDTH, 0.1, GUARD_WIDTH, -30, -38, -50);
+  NS_TEST_ASSERT_MSG_NE (otherMask, psd, "A PSD with another transmit mask should not be reused");
+  NS_TEST_ASSERT_MSG_EQ (std::equal (otherMask->ConstValuesBegin (), otherMask->ConstValuesEnd (), expected->ConstValuesBegin ()), true, "Cached PSD differs from the created one");
+
+  // the mask is ignored for DSSS
+  Ptr<const SpectrumValue> dsss = WifiSpectrumValueHelper::GetTxPowerSpectralDensity (WifiSpectrumValueHelper::TX_PSD_DSSS, 2412, 22, 0.1, 20);
+  NS_TEST_ASSERT_MSG_EQ (WifiSpectrumValueHelper::GetTxPowerSpectralDensity (WifiSpectrumValueHelper::TX_PSD_DSSS, 2412, 22, 0.1, 20, -30, -38, -50),
+                         dsss, "The PSD should have been reused");
+
+  // with room for two PSDs, otherMask is evicted first, then dsss
+  WifiSpectrumValueHelper::GetTxPowerSpectralDensity (WifiSpectrumValueHelper::TX_PSD_HE_OFDM, FREQUENCY, CHANNEL_WIDTH, 0.1, GUARD_WIDTH);
+  WifiSpectrumValueHelper::SetTxPowerSpectralDensityCacheSize (2);
+  WifiSpectrumValueHelper::GetTxPowerSpectralDensity (WifiSpectrumValueHelper::TX_PSD_HE_OFDM, FREQUENCY, CHANNEL_WIDTH, 0.2, GUARD_WIDTH);
+  NS_TEST_ASSERT_MSG_EQ (WifiSpectrumValueHelper::GetTxPowerSpectralDensity (WifiSpectrumValueHelper::TX_PSD_HE_OFDM, FREQUENCY, CHANNEL_WIDTH, 0.1, GUARD_WIDTH),
+                         psd, "The most recently used PSD should have been kept");
+  NS_TEST_ASSERT_MSG_NE (WifiSpectrumValueHelper::GetTxPowerSpectralDensity (WifiSpectrumValueHelper::TX_PSD_DSSS, 2412, 22, 0.1, 20),
+                         dsss, "The least recently used PSD should have been evicted");
+  NS_TEST_ASSERT_MSG_NE (WifiSpectrumValueHelper::GetTxPowerSpectralDensity (WifiSpectrumValueHelper::TX_PSD_HE_OFDM, FREQUENCY, CHANNEL_WIDTH, 0.1, GUARD_WIDTH, -30, -38, -50),
+                         otherMask, "The least recently used PSD should have been evicted");
+
+  WifiSpectrumValueHelper::SetTxPowerSpectralDensityCacheSize (0);
+  NS_TEST_ASSERT_MSG_NE (WifiSpectrumValueHelper::GetTxPowerSpectralDensity (WifiSpectrumValueHelper::TX_PSD_HE_OFDM, FREQUENCY, CHANNEL_WIDTH, 0.1, GUARD_WIDTH),
+                         psd, "No PSD should be reused when the cache is disabled");
+
+  WifiSpectrumValueHelper::SetTxPowerSpectralDensityCacheSize (64);
+}
+
 /**
  * \ingroup wifi-test
  * \ingroup tests
@@ -678,6 +1176,12 @@ SpectrumWifiPhyTestSuite::SpectrumWifiPhyTestSuite ()
   AddTestCase (new SpectrumWifiPhyBasicTest, TestCase::QUICK);
   AddTestCase (new SpectrumWifiPhyListenerTest, TestCase::QUICK);
   AddTestCase (new SpectrumWifiPhyFilterTest, TestCase::QUICK);
+  AddTestCase (new SpectrumWifiPhyBandPowerTest, TestCase::QUICK);
+  AddTestCase (new SpectrumWifiPhyBandIdPowerTest, TestCase::QUICK);
+  AddTestCase (new SpectrumWifiPhyLazyBandTest (false), TestCase::QUICK);
+  AddTestCase (new SpectrumWifiPhyLazyBandTest (true), TestCase::QUICK);
+  AddTestCase (new SpectrumWifiPhyEventPowerTest, TestCase::QUICK);
+  AddTestCase (new SpectrumWifiPhyTxPsdCacheTest, TestCase::QUICK);
 }
 
 static SpectrumWifiPhyTestSuite spectrumWifiPhyTestSuite; ///< the test suite
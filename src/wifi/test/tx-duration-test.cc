@@ -679,6 +679,166 @@ HeSigBDurationTest::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (WifiPhy::GetPlcpSigBDuration (txVector), MicroSeconds (20), "HE-SIG-B should last five OFDM symbols");
 }
 
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief TX duration memoization test
+ *
+ * The parameters WifiPhy derives from a TXVECTOR to compute a TX duration are
+ * memoized upon the first call. This test computes the TX durations of a
+ * large number of TXVECTORs, first with an empty cache for each TXVECTOR,
+ * then with the parameters of all the TXVECTORs memoized, and checks that
+ * the results are the same (they would not be if two TXVECTORs shared the
+ * same memoized parameters).
+ */
+class TxDurationMemoizationTest : public TestCase
+{
+public:
+  TxDurationMemoizationTest ();
+  virtual ~TxDurationMemoizationTest ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Add a TXVECTOR to the list of tested TXVECTORs if it is valid
+   *
+   * \param mode the mode
+   * \param preamble the preamble type
+   * \param channelWidth the channel width (MHz)
+   * \param guardInterval the guard interval (ns)
+   * \param nss the number of spatial streams
+   * \param stbc whether STBC is used
+   */
+  void AddTxVector (WifiMode mode, WifiPreamble preamble, uint16_t channelWidth, uint16_t guardInterval, uint8_t nss, bool stbc);
+  /**
+   * \param txVector the TXVECTOR
+   * \return the TX durations of PSDUs of various sizes and of the MPDUs of
+   *         an A-MPDU, at 2.4 GHz and 5 GHz
+   */
+  std::vector<Time> GetDurations (WifiTxVector txVector);
+
+  std::vector<WifiTxVector> m_txVectors; ///< the tested TXVECTORs
+};
+
+TxDurationMemoizationTest::TxDurationMemoizationTest ()
+  : TestCase ("Check the memoization of TX durations")
+{
+}
+
+TxDurationMemoizationTest::~TxDurationMemoizationTest ()
+{
+}
+
+void
+TxDurationMemoizationTest::AddTxVector (WifiMode mode, WifiPreamble preamble, uint16_t channelWidth,
+                                         uint16_t guardInterval, uint8_t nss, bool stbc)
+{
+  WifiTxVector txVector;
+  txVector.SetMode (mode);
+  txVector.SetPreambleType (preamble);
+  txVector.SetChannelWidth (channelWidth);
+  txVector.SetGuardInterval (guardInterval);
+  txVector.SetNss (nss);
+  txVector.SetNess (0);
+  txVector.SetStbc (stbc);
+  if (txVector.IsValid ())
+    {
+      m_txVectors.push_back (txVector);
+    }
+}
+
+std::vector<Time>
+TxDurationMemoizationTest::GetDurations (WifiTxVector txVector)
+{
+  std::vector<Time> durations;
+  for (uint16_t frequency : {CHANNEL_1_MHZ, CHANNEL_36_MHZ})
+    {
+      for (uint32_t size : {14, 1536, 65535})
+        {
+          durations.push_back (WifiPhy::CalculateTxDuration (size, txVector, frequency));
+        }
+      if (txVector.GetMode ().GetModulationClass () >= WIFI_MOD_CLASS_HT)
+        {
+          for (MpduType mpdutype : {FIRST_MPDU_IN_AGGREGATE, MIDDLE_MPDU_IN_AGGREGATE, LAST_MPDU_IN_AGGREGATE})
+            {
+              durations.push_back (WifiPhy::GetPayloadDuration (1500, txVector, frequency, mpdutype));
+            }
+        }
+    }
+  return durations;
+}
+
+void
+TxDurationMemoizationTest::DoRun (void)
+{
+  for (uint16_t channelWidth : {5, 10, 20})
+    {
+      AddTxVector (WifiPhy::GetOfdmRate6Mbps (), WIFI_PREAMBLE_LONG, channelWidth, 800, 1, false);
+      AddTxVector (WifiPhy::GetOfdmRate54Mbps (), WIFI_PREAMBLE_LONG, channelWidth, 800, 1, false);
+    }
+  AddTxVector (WifiPhy::GetErpOfdmRate6Mbps (), WIFI_PREAMBLE_LONG, 20, 800, 1, false);
+  AddTxVector (WifiPhy::GetDsssRate1Mbps (), WIFI_PREAMBLE_LONG, 22, 800, 1, false);
+  AddTxVector (WifiPhy::GetDsssRate11Mbps (), WIFI_PREAMBLE_SHORT, 22, 800, 1, false);
+  for (uint8_t mcs = 0; mcs < 32; mcs++)
+    {
+      for (uint16_t channelWidth : {20, 40})
+        {
+          for (uint16_t guardInterval : {400, 800})
+            {
+              for (bool stbc : {false, true})
+                {
+                  AddTxVector (WifiPhy::GetHtMcs (mcs), WIFI_PREAMBLE_HT_MF, channelWidth, guardInterval, mcs / 8 + 1, stbc);
+                }
+            }
+        }
+    }
+  for (uint8_t mcs = 0; mcs < 10; mcs++)
+    {
+      for (uint16_t channelWidth : {20, 40, 80, 160})
+        {
+          for (uint16_t guardInterval : {400, 800})
+            {
+              for (uint8_t nss = 1; nss <= 4; nss++)
+                {
+                  AddTxVector (WifiPhy::GetVhtMcs (mcs), WIFI_PREAMBLE_VHT_SU, channelWidth, guardInterval, nss, false);
+                }
+            }
+        }
+    }
+  for (uint8_t mcs = 0; mcs < 12; mcs++)
+    {
+      for (uint16_t channelWidth : {20, 40, 80, 160})
+        {
+          for (uint16_t guardInterval : {800, 1600, 3200})
+            {
+              for (uint8_t nss = 1; nss <= 4; nss++)
+                {
+                  AddTxVector (WifiPhy::GetHeMcs (mcs), WIFI_PREAMBLE_HE_SU, channelWidth, guardInterval, nss, false);
+                }
+            }
+        }
+    }
+
+  //reference durations, computed while only the parameters of the TXVECTOR are memoized
+  std::vector<std::vector<Time> > isolated;
+  for (std::vector<WifiTxVector>::const_iterator it = m_txVectors.begin (); it != m_txVectors.end (); ++it)
+    {
+      WifiPhy::ClearTxDurationCache ();
+      isolated.push_back (GetDurations (*it));
+    }
+  //durations computed while the parameters of all the TXVECTORs are memoized
+  std::vector<std::vector<Time> > shared (m_txVectors.size ());
+  for (std::size_t i = m_txVectors.size (); i > 0; i--)
+    {
+      shared[i - 1] = GetDurations (m_txVectors[i - 1]);
+    }
+  for (std::size_t i = 0; i < m_txVectors.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ ((shared[i] == isolated[i]), true, "TX durations of " << m_txVectors[i] << " depend on the other memoized TXVECTORs");
+    }
+}
+
 /**
  * \ingroup wifi-test
  * \ingroup tests
@@ -696,6 +856,7 @@ TxDurationTestSuite::TxDurationTestSuite ()
 {
   AddTestCase (new HeSigBDurationTest, TestCase::QUICK);
   AddTestCase (new TxDurationTest, TestCase::QUICK);
+  AddTestCase (new TxDurationMemoizationTest, TestCase::QUICK);
 }
 
 static TxDurationTestSuite g_txDurationTestSuite; ///< the test suite
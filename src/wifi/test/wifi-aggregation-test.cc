@@ -446,6 +446,19 @@ TwoLevelAggregationTest::DoRun (void)
   Ptr<WifiPsdu> psdu = Create<WifiPsdu> (mpduList);
   NS_TEST_EXPECT_MSG_EQ (psdu->GetSize (), 7162, "Unexpected size of the A-MPDU");
 
+  /*
+   * The duration limit check must not depend on the order of the queried sizes,
+   * although MacLow caches the largest size meeting the limit.
+   */
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      uint32_t size = 1 + (i * 7919) % 12000;
+      bool expected = (m_phy->CalculateTxDuration (size, txVector, m_phy->GetFrequency ()) <= txopLimit);
+      NS_TEST_EXPECT_MSG_EQ (m_mac->GetVIQueue ()->GetLow ()->IsWithinSizeAndTimeLimits (size, hdr.GetAddr1 (), tid,
+                                                                                        txVector, 0, txopLimit),
+                             expected, "Unexpected duration limit check for a PSDU of " << size << " bytes");
+    }
+
   Simulator::Destroy ();
 
   m_device->Dispose ();
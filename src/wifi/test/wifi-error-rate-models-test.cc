@@ -21,8 +21,13 @@
 #include <cmath>
 #include "ns3/test.h"
 #include "ns3/nist-error-rate-model.h"
+#include "ns3/yans-error-rate-model.h"
 #include "ns3/dsss-error-rate-model.h"
+#include "ns3/table-based-error-rate-model.h"
 #include "ns3/wifi-tx-vector.h"
+#include "ns3/wifi-phy.h"
+#include "ns3/double.h"
+#include "ns3/object-factory.h"
 
 using namespace ns3;
 
@@ -291,6 +296,140 @@ WifiErrorRateModelsTestCaseNist::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ_TOL (ps, 0.999, 0.001, "Not equal within tolerance");
 }
 
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Check that TableBasedErrorRateModel stays close to the models it
+ * tabulates, that its tables are shared by the instances with the same
+ * parameters, and that they can be saved and loaded.
+ */
+class TableBasedErrorRateModelTestCase : public TestCase
+{
+public:
+  TableBasedErrorRateModelTestCase ();
+  virtual ~TableBasedErrorRateModelTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \param model the model
+   * \param sizes the sizes of the chunks (bits)
+   * \return the success rates computed by the model over a range of modes
+   *         and SNRs
+   */
+  std::vector<double> GetSuccessRates (Ptr<ErrorRateModel> model, std::vector<uint64_t> sizes);
+  /**
+   * \param model the first model
+   * \param other the second model
+   * \param sizes the sizes of the chunks (bits)
+   * \return the largest difference between the success rates computed by
+   *         the two models over a range of modes and SNRs
+   */
+  double GetMaxError (Ptr<ErrorRateModel> model, Ptr<ErrorRateModel> other, std::vector<uint64_t> sizes);
+};
+
+TableBasedErrorRateModelTestCase::TableBasedErrorRateModelTestCase ()
+  : TestCase ("WifiErrorRateModel test case table-based")
+{
+}
+
+TableBasedErrorRateModelTestCase::~TableBasedErrorRateModelTestCase ()
+{
+}
+
+std::vector<double>
+TableBasedErrorRateModelTestCase::GetSuccessRates (Ptr<ErrorRateModel> model, std::vector<uint64_t> sizes)
+{
+  std::vector<WifiMode> modes = {WifiPhy::GetDsssRate1Mbps (), WifiPhy::GetDsssRate11Mbps (),
+                                 WifiPhy::GetOfdmRate6Mbps (), WifiPhy::GetOfdmRate18Mbps (),
+                                 WifiPhy::GetOfdmRate54Mbps (), WifiPhy::GetHtMcs3 (),
+                                 WifiPhy::GetVhtMcs8 (), WifiPhy::GetHeMcs11 ()};
+  std::vector<double> successRates;
+  for (std::vector<WifiMode>::const_iterator mode = modes.begin (); mode != modes.end (); ++mode)
+    {
+      WifiTxVector txVector;
+      txVector.SetMode (*mode);
+      txVector.SetChannelWidth (mode->GetModulationClass () == WIFI_MOD_CLASS_DSSS
+                                || mode->GetModulationClass () == WIFI_MOD_CLASS_HR_DSSS ? 22 : 20);
+      //SNRs that are not tabulated, covering the tabulated range and beyond
+      for (double snrDb = -12.03; snrDb < 65; snrDb += 0.37)
+        {
+          for (uint64_t nbits : sizes)
+            {
+              double snr = std::pow (10.0, snrDb / 10.0);
+              successRates.push_back (model->GetChunkSuccessRate (*mode, txVector, snr, nbits));
+            }
+        }
+    }
+  return successRates;
+}
+
+double
+TableBasedErrorRateModelTestCase::GetMaxError (Ptr<ErrorRateModel> model, Ptr<ErrorRateModel> other, std::vector<uint64_t> sizes)
+{
+  std::vector<double> successRates = GetSuccessRates (model, sizes);
+  std::vector<double> otherSuccessRates = GetSuccessRates (other, sizes);
+  double maxError = 0;
+  for (std::size_t i = 0; i < successRates.size (); i++)
+    {
+      maxError = std::max (maxError, std::abs (successRates[i] - otherSuccessRates[i]));
+    }
+  return maxError;
+}
+
+void
+TableBasedErrorRateModelTestCase::DoRun (void)
+{
+  for (TypeId type : {NistErrorRateModel::GetTypeId (), YansErrorRateModel::GetTypeId ()})
+    {
+      ObjectFactory factory;
+      factory.SetTypeId (type);
+      Ptr<ErrorRateModel> analytical = factory.Create<ErrorRateModel> ();
+      Ptr<TableBasedErrorRateModel> table = CreateObject<TableBasedErrorRateModel> ();
+      table->SetAttribute ("ErrorRateModel", TypeIdValue (type));
+      //the success rate of a single bit is the most sensitive to the kinks of
+      //the analytical models (e.g., where the bit error rate is capped)
+      double maxError = GetMaxError (table, analytical, {1});
+      NS_TEST_EXPECT_MSG_LT (maxError, 0.02, "Table-based success rates of bits too far from " << type.GetName ());
+      maxError = GetMaxError (table, analytical, {100, 12000, 524280});
+      NS_TEST_EXPECT_MSG_LT (maxError, 0.002, "Table-based success rates of chunks too far from " << type.GetName ());
+    }
+
+  TableBasedErrorRateModel::ClearTables ();
+  Ptr<TableBasedErrorRateModel> table = CreateObject<TableBasedErrorRateModel> ();
+  Ptr<TableBasedErrorRateModel> other = CreateObject<TableBasedErrorRateModel> ();
+  Ptr<TableBasedErrorRateModel> coarse = CreateObject<TableBasedErrorRateModel> ();
+  coarse->SetAttribute ("SnrStep", DoubleValue (0.2));
+  std::vector<uint64_t> sizes = {1, 100, 12000, 524280};
+  std::vector<double> successRates = GetSuccessRates (table, sizes);
+  std::size_t nTables = table->GetNTables ();
+  NS_TEST_ASSERT_MSG_GT (nTables, 0, "No table has been computed");
+  NS_TEST_EXPECT_MSG_EQ (other->GetNTables (), nTables, "The tables should be shared by the instances with the same parameters");
+  NS_TEST_EXPECT_MSG_EQ (coarse->GetNTables (), 0, "The tables should not be shared by instances with different parameters");
+  NS_TEST_EXPECT_MSG_EQ ((GetSuccessRates (other, sizes) == successRates), true, "The instances with the same parameters differ");
+  NS_TEST_EXPECT_MSG_EQ (other->GetNTables (), nTables, "No table should have been computed");
+
+  std::string filename = CreateTempDirFilename ("error-rate-tables.bin");
+  NS_TEST_ASSERT_MSG_EQ (table->Save (filename), true, "Unable to save the tables");
+  TableBasedErrorRateModel::ClearTables ();
+  NS_TEST_EXPECT_MSG_EQ (table->GetNTables (), 0, "The tables have not been cleared");
+
+  Ptr<TableBasedErrorRateModel> loaded = CreateObject<TableBasedErrorRateModel> ();
+  NS_TEST_ASSERT_MSG_EQ (loaded->Load (filename), true, "Unable to load the tables");
+  NS_TEST_EXPECT_MSG_EQ (table->GetNTables (), nTables, "Not all the tables have been loaded for all the instances");
+  NS_TEST_EXPECT_MSG_EQ ((GetSuccessRates (loaded, sizes) == successRates), true, "The loaded tables differ from the saved tables");
+  NS_TEST_EXPECT_MSG_EQ (loaded->GetNTables (), nTables, "No table should have been computed");
+
+  Ptr<TableBasedErrorRateModel> mismatch = CreateObject<TableBasedErrorRateModel> ();
+  mismatch->SetAttribute ("SnrStep", DoubleValue (0.2));
+  NS_TEST_EXPECT_MSG_EQ (mismatch->Load (filename), false, "Tables with a different SNR step should not be loaded");
+  mismatch->SetAttribute ("SnrStep", DoubleValue (0.1));
+  mismatch->SetAttribute ("ErrorRateModel", TypeIdValue (YansErrorRateModel::GetTypeId ()));
+  NS_TEST_EXPECT_MSG_EQ (mismatch->Load (filename), false, "Tables of a different model should not be loaded");
+}
+
 /**
  * \ingroup wifi-test
  * \ingroup tests
@@ -308,6 +447,7 @@ WifiErrorRateModelsTestSuite::WifiErrorRateModelsTestSuite ()
 {
   AddTestCase (new WifiErrorRateModelsTestCaseDsss, TestCase::QUICK);
   AddTestCase (new WifiErrorRateModelsTestCaseNist, TestCase::QUICK);
+  AddTestCase (new TableBasedErrorRateModelTestCase, TestCase::QUICK);
 }
 
 static WifiErrorRateModelsTestSuite wifiErrorRateModelsTestSuite; ///< the test suite
@@ -47,6 +47,9 @@
 #include "ns3/wifi-ppdu.h"
 #include "ns3/wifi-psdu.h"
 #include "ns3/static-channel-bonding-manager.h"
+#include "ns3/wifi-mac-queue.h"
+#include "ns3/boolean.h"
+#include "ns3/propagation-delay-model.h"
 
 using namespace ns3;
 
@@ -2167,6 +2170,228 @@ Bug2470TestCase::DoRun (void)
   // but before it does not enter RESET state. More tests should be written to verify all possible scenarios.
 }
 
+//-----------------------------------------------------------------------------
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Check that the per-(TID, receiver) flow queues of the WifiMacQueue
+ * return the same frames as a scan of the whole queue, after enqueuing frames
+ * at arbitrary positions, removing frames and expiring frames, and that
+ * expired frames are removed in bulk.
+ */
+class WifiMacQueueFlowTest : public TestCase
+{
+public:
+  WifiMacQueueFlowTest ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Check the frames returned for every flow against a scan of the whole queue.
+   */
+  void CheckFlows (void);
+  /**
+   * Enqueue frames of different flows, the oldest ones expiring at 100 ms.
+   */
+  void EnqueueForExpiry (void);
+  /**
+   * Check that the expired frames are not returned anymore.
+   */
+  void CheckExpiry (void);
+  /**
+   * Check that the expired frames are removed when enqueuing in a full queue.
+   */
+  void CheckExpiryWhenFull (void);
+  /**
+   * Count the expired frames.
+   * \param item the expired frame
+   */
+  void NotifyExpired (Ptr<const WifiMacQueueItem> item);
+
+  Ptr<WifiMacQueue> m_queue;          ///< the queue under test
+  std::vector<Mac48Address> m_addresses; ///< the receiver addresses
+  uint32_t m_nExpired;                 ///< the number of expired frames
+};
+
+WifiMacQueueFlowTest::WifiMacQueueFlowTest ()
+  : TestCase ("Check the per-(TID, receiver) flow queues of WifiMacQueue"),
+    m_nExpired (0)
+{
+}
+
+void
+WifiMacQueueFlowTest::NotifyExpired (Ptr<const WifiMacQueueItem> item)
+{
+  m_nExpired++;
+}
+
+void
+WifiMacQueueFlowTest::CheckFlows (void)
+{
+  for (uint8_t tid = 0; tid < 2; tid++)
+    {
+      for (const auto &address : m_addresses)
+        {
+          std::vector<WifiMacQueue::ConstIterator> expected;
+          for (auto it = m_queue->begin (); it != m_queue->end (); it++)
+            {
+              if ((*it)->GetHeader ().IsQosData () && (*it)->GetHeader ().GetQosTid () == tid
+                  && (*it)->GetHeader ().GetAddr1 () == address)
+                {
+                  expected.push_back (it);
+                }
+            }
+          NS_TEST_EXPECT_MSG_EQ (m_queue->GetNPacketsByTidAndAddress (tid, address), expected.size (),
+                                 "Unexpected number of frames for TID " << +tid << " and receiver " << address);
+
+          // peek the frames of the flow one after another
+          std::size_t n = 0;
+          WifiMacQueue::ConstIterator it = m_queue->PeekByTidAndAddress (tid, address);
+          while (it != m_queue->end () && n < expected.size ())
+            {
+              NS_TEST_EXPECT_MSG_EQ ((it == expected[n]), true, "Unexpected frame #" << n << " peeked");
+              it = m_queue->PeekByTidAndAddress (tid, address, ++it);
+              n++;
+            }
+          NS_TEST_EXPECT_MSG_EQ (n, expected.size (), "Unexpected number of frames peeked");
+          NS_TEST_EXPECT_MSG_EQ ((it == m_queue->end ()), true, "Unexpected frame peeked");
+
+          // start the search from every position in the queue
+          n = 0;
+          for (auto pos = m_queue->begin (); pos != m_queue->end (); pos++)
+            {
+              if (n < expected.size () && pos == std::next (expected[n]))
+                {
+                  n++;
+                }
+              it = m_queue->PeekByTidAndAddress (tid, address, pos);
+              NS_TEST_EXPECT_MSG_EQ ((it == (n < expected.size () ? expected[n] : m_queue->end ())), true,
+                                     "Unexpected frame peeked from a given position");
+            }
+        }
+    }
+}
+
+void
+WifiMacQueueFlowTest::EnqueueForExpiry (void)
+{
+  for (uint16_t i = 0; i < 12; i++)
+    {
+      WifiMacHeader hdr;
+      hdr.SetType (WIFI_MAC_QOSDATA);
+      hdr.SetAddr1 (m_addresses[i % m_addresses.size ()]);
+      hdr.SetQosTid (i % 2);
+      hdr.SetSequenceNumber (i);
+      // the frames enqueued at the front are the oldest ones
+      Ptr<WifiMacQueueItem> item = Create<WifiMacQueueItem> (Create<Packet> (100), hdr,
+                                                             i < 6 ? Seconds (0) : MilliSeconds (50));
+      if (i < 6)
+        {
+          m_queue->PushFront (item);
+        }
+      else
+        {
+          m_queue->Enqueue (item);
+        }
+    }
+}
+
+void
+WifiMacQueueFlowTest::CheckExpiry (void)
+{
+  for (uint8_t tid = 0; tid < 2; tid++)
+    {
+      for (const auto &address : m_addresses)
+        {
+          WifiMacQueue::ConstIterator it = m_queue->PeekByTidAndAddress (tid, address);
+          NS_TEST_EXPECT_MSG_EQ ((it != m_queue->end ()), true, "Expected a frame to be peeked");
+          NS_TEST_EXPECT_MSG_GT_OR_EQ ((*it)->GetHeader ().GetSequenceNumber (), 6, "Expired frame peeked");
+          NS_TEST_EXPECT_MSG_EQ (m_queue->GetNPacketsByTidAndAddress (tid, address), 1,
+                                 "Unexpected number of frames after expiry");
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_nExpired, 6, "Unexpected number of expired frames");
+  NS_TEST_EXPECT_MSG_EQ (m_queue->GetNPackets (), 6, "Unexpected number of frames after expiry");
+}
+
+void
+WifiMacQueueFlowTest::CheckExpiryWhenFull (void)
+{
+  // the queue is full and all its frames expired at 150 ms
+  m_queue->SetMaxQueueSize (QueueSize ("6p"));
+  WifiMacHeader hdr;
+  hdr.SetType (WIFI_MAC_QOSDATA);
+  hdr.SetAddr1 (m_addresses[0]);
+  hdr.SetQosTid (0);
+  NS_TEST_EXPECT_MSG_EQ (m_queue->Enqueue (Create<WifiMacQueueItem> (Create<Packet> (100), hdr)), true,
+                         "The expired frames should have been removed to make room");
+  NS_TEST_EXPECT_MSG_EQ (m_nExpired, 12, "Unexpected number of expired frames");
+  NS_TEST_EXPECT_MSG_EQ (m_queue->GetNPackets (), 1, "Unexpected number of frames after expiry");
+  NS_TEST_EXPECT_MSG_EQ (m_queue->GetNPacketsByTidAndAddress (0, m_addresses[0]), 1,
+                         "Unexpected number of frames after expiry");
+}
+
+void
+WifiMacQueueFlowTest::DoRun (void)
+{
+  m_addresses = {Mac48Address ("00:00:00:00:00:01"), Mac48Address ("00:00:00:00:00:02"),
+                 Mac48Address ("00:00:00:00:00:03")};
+  m_queue = CreateObject<WifiMacQueue> ();
+  m_queue->SetMaxQueueSize (QueueSize ("1000p"));
+
+  // enqueue QoS Data and Data frames at the tail, at the head and in the middle
+  for (uint16_t i = 0; i < 200; i++)
+    {
+      WifiMacHeader hdr;
+      hdr.SetType (i % 5 == 0 ? WIFI_MAC_DATA : WIFI_MAC_QOSDATA);
+      hdr.SetAddr1 (m_addresses[(i * 7) % m_addresses.size ()]);
+      if (hdr.IsQosData ())
+        {
+          hdr.SetQosTid (i % 2);
+        }
+      hdr.SetSequenceNumber (i);
+      Ptr<WifiMacQueueItem> item = Create<WifiMacQueueItem> (Create<Packet> (100), hdr);
+      if (i % 4 == 0)
+        {
+          m_queue->PushFront (item);
+        }
+      else if (i % 4 == 1)
+        {
+          m_queue->Insert (std::next (m_queue->begin (), (i * 13) % (m_queue->GetNPackets () + 1)), item);
+        }
+      else
+        {
+          m_queue->Enqueue (item);
+        }
+    }
+  CheckFlows ();
+
+  // remove frames anywhere in the queue
+  uint32_t n = 0;
+  for (WifiMacQueue::ConstIterator it = m_queue->begin (); it != m_queue->end (); )
+    {
+      it = (n++ % 3 == 0 ? m_queue->Remove (it) : std::next (it));
+    }
+  m_queue->DequeueByTidAndAddress (1, m_addresses[0]);
+  m_queue->Dequeue ();
+  CheckFlows ();
+
+  m_queue->Flush ();
+  NS_TEST_EXPECT_MSG_EQ (m_queue->GetNPacketsByTidAndAddress (0, m_addresses[0]), 0,
+                         "Unexpected frames after flushing the queue");
+
+  // expire the oldest frames of every flow
+  m_queue->SetMaxDelay (MilliSeconds (100));
+  m_queue->TraceConnectWithoutContext ("Expired", MakeCallback (&WifiMacQueueFlowTest::NotifyExpired, this));
+  Simulator::Schedule (MilliSeconds (60), &WifiMacQueueFlowTest::EnqueueForExpiry, this);
+  Simulator::Schedule (MilliSeconds (120), &WifiMacQueueFlowTest::CheckExpiry, this);
+  Simulator::Schedule (MilliSeconds (170), &WifiMacQueueFlowTest::CheckExpiryWhenFull, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_queue = 0;
+}
+
 //-----------------------------------------------------------------------------
 /**
  * \ingroup wifi-test
@@ -2253,6 +2478,169 @@ HeRuMcsDataRateTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (retval, true, "Data rate verification for RUs above 52-tone RU (included) failed");
 }
 
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Log-distance loss model counting the number of losses it computes
+ */
+class YansPathCacheLossModel : public PropagationLossModel
+{
+public:
+  YansPathCacheLossModel ();
+
+  uint32_t m_nComputations; ///< the number of losses computed
+
+private:
+  virtual double DoCalcRxPower (double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
+  virtual int64_t DoAssignStreams (int64_t stream);
+  virtual bool DoIsDeterministic (void) const;
+};
+
+YansPathCacheLossModel::YansPathCacheLossModel ()
+  : m_nComputations (0)
+{
+}
+
+double
+YansPathCacheLossModel::DoCalcRxPower (double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const
+{
+  const_cast<YansPathCacheLossModel *> (this)->m_nComputations++;
+  return txPowerDbm - 40 - 30 * std::log10 (a->GetDistanceFrom (b));
+}
+
+int64_t
+YansPathCacheLossModel::DoAssignStreams (int64_t stream)
+{
+  return 0;
+}
+
+bool
+YansPathCacheLossModel::DoIsDeterministic (void) const
+{
+  return true;
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Check that the path cache of YansWifiChannel does not change the
+ * receive power, including after a node has moved and after the transmit
+ * power has changed.
+ */
+class YansWifiChannelPathCacheTest : public TestCase
+{
+public:
+  YansWifiChannelPathCacheTest ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Run a scenario where each PHY transmits three times in turn, one PHY
+   * being moved after the first round of transmissions and another PHY
+   * transmitting at a higher power in the last round.
+   *
+   * \param cachePaths the value of the CachePaths attribute
+   * \param log the log of receptions
+   * \return the number of losses computed by the loss model
+   */
+  uint32_t RunScenario (bool cachePaths, std::vector<double> &log);
+  /**
+   * Log the time and the receive power of a PPDU
+   * \param log the log of receptions
+   * \param p the packet
+   * \param rxPowersW the receive power per band
+   */
+  static void RxBegin (std::vector<double> *log, Ptr<const Packet> p, RxPowerWattPerChannelBand rxPowersW);
+};
+
+YansWifiChannelPathCacheTest::YansWifiChannelPathCacheTest ()
+  : TestCase ("Check the path cache of YansWifiChannel")
+{
+}
+
+void
+YansWifiChannelPathCacheTest::RxBegin (std::vector<double> *log, Ptr<const Packet> p, RxPowerWattPerChannelBand rxPowersW)
+{
+  log->push_back (Simulator::Now ().GetSeconds ());
+  log->push_back (rxPowersW.GetRxPowerW (std::make_pair (0, 0)));
+}
+
+uint32_t
+YansWifiChannelPathCacheTest::RunScenario (bool cachePaths, std::vector<double> &log)
+{
+  const uint32_t nPhys = 4;
+  const uint32_t nRounds = 3;
+
+  Ptr<YansWifiChannel> channel = CreateObject<YansWifiChannel> ();
+  channel->SetAttribute ("CachePaths", BooleanValue (cachePaths));
+  Ptr<YansPathCacheLossModel> loss = CreateObject<YansPathCacheLossModel> ();
+  channel->SetPropagationLossModel (loss);
+  channel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+
+  std::vector<Ptr<YansWifiPhy> > phys;
+  std::vector<Ptr<MobilityModel> > mobilities;
+  for (uint32_t i = 0; i < nPhys; i++)
+    {
+      Ptr<YansWifiPhy> phy = CreateObject<YansWifiPhy> ();
+      phy->SetErrorRateModel (CreateObject<YansErrorRateModel> ());
+      phy->SetChannel (channel);
+      phy->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+      Ptr<MobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+      mobility->SetPosition (Vector (10.0 * i, 5.0 * (i % 2), 0));
+      phy->SetMobility (mobility);
+      phy->TraceConnectWithoutContext ("PhyRxBegin", MakeBoundCallback (&YansWifiChannelPathCacheTest::RxBegin, &log));
+      phys.push_back (phy);
+      mobilities.push_back (mobility);
+    }
+
+  WifiTxVector txVector = WifiTxVector (WifiPhy::GetOfdmRate6Mbps (), 0, WIFI_PREAMBLE_LONG, 800, 1, 1, 0, 20, false, false);
+  WifiMacHeader hdr;
+  hdr.SetType (WIFI_MAC_DATA);
+  Ptr<WifiPsdu> psdu = Create<WifiPsdu> (Create<Packet> (100), hdr);
+  Time txDuration = WifiPhy::CalculateTxDuration (psdu->GetSize (), txVector, phys[0]->GetFrequency ());
+  uint64_t uid = 0;
+  for (uint32_t round = 0; round < nRounds; round++)
+    {
+      for (uint32_t i = 0; i < nPhys; i++)
+        {
+          Ptr<WifiPpdu> ppdu = Create<WifiPpdu> (psdu, txVector, txDuration, phys[i]->GetFrequency (), uid++);
+          double txPowerDbm = (round == 2 && i == 1) ? 20 : 10;
+          Simulator::Schedule (Seconds (round * 10 + i * 0.01), &YansWifiChannel::Send, channel, phys[i], ppdu, txPowerDbm);
+        }
+    }
+  Simulator::Schedule (Seconds (5), &MobilityModel::SetPosition, mobilities[2], Vector (50, 50, 0));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  for (uint32_t i = 0; i < nPhys; i++)
+    {
+      phys[i]->Dispose ();
+    }
+  channel->Dispose ();
+  return loss->m_nComputations;
+}
+
+void
+YansWifiChannelPathCacheTest::DoRun (void)
+{
+  const uint32_t nPaths = 4 * 3;
+
+  std::vector<double> referenceLog;
+  uint32_t referenceComputations = RunScenario (false, referenceLog);
+  NS_TEST_ASSERT_MSG_EQ (referenceLog.size (), 2 * 3 * nPaths, "Every transmission should be received by every other PHY");
+  NS_TEST_ASSERT_MSG_EQ (referenceComputations, 3 * nPaths, "Unexpected number of loss computations without cache");
+
+  std::vector<double> cachedLog;
+  uint32_t cachedComputations = RunScenario (true, cachedLog);
+  NS_TEST_ASSERT_MSG_EQ ((cachedLog == referenceLog), true, "The path cache changed the receive power");
+  // every path is computed in the first round, then the 6 paths to and
+  // from the PHY that moved are computed again in the second round, and
+  // the 3 paths from the PHY whose transmit power changed in the last round
+  NS_TEST_ASSERT_MSG_EQ (cachedComputations, nPaths + 6 + 3, "Unexpected number of loss computations with cache");
+}
+
 
 /**
  * \ingroup wifi-test
@@ -2282,6 +2670,8 @@ WifiTestSuite::WifiTestSuite ()
   AddTestCase (new StaWifiMacScanningTestCase, TestCase::QUICK); //Bug 2399
   AddTestCase (new Bug2470TestCase, TestCase::QUICK); //Bug 2470
   AddTestCase (new HeRuMcsDataRateTestCase, TestCase::QUICK);
+  AddTestCase (new WifiMacQueueFlowTest, TestCase::QUICK);
+  AddTestCase (new YansWifiChannelPathCacheTest, TestCase::QUICK);
 }
 
 static WifiTestSuite g_wifiTestSuite; ///< the test suite